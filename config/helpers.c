@@ -307,3 +307,91 @@ const char *cs_subset_string(const struct ConfigSubset *sub, const char *name)
 
   return (const char *) value;
 }
+
+/**
+ * cs_handle_bool - Get a boolean config item by handle
+ * @param sub Config Subset
+ * @param ch  Config handle
+ * @retval bool Boolean value
+ */
+bool cs_handle_bool(const struct ConfigSubset *sub, struct ConfigHandle *ch)
+{
+  assert(sub && ch);
+
+  struct HashElem *he = cs_subset_handle(sub, ch);
+  assert(he);
+
+  struct HashElem *he_base = cs_get_base(he);
+  assert(DTYPE(he_base->type) == DT_BOOL);
+
+  intptr_t value = cs_subset_he_native_get(sub, he, NULL);
+  assert(value != INT_MIN);
+
+  return (bool) value;
+}
+
+/**
+ * cs_handle_number - Get a number config item by handle
+ * @param sub Config Subset
+ * @param ch  Config handle
+ * @retval num Number
+ */
+short cs_handle_number(const struct ConfigSubset *sub, struct ConfigHandle *ch)
+{
+  assert(sub && ch);
+
+  struct HashElem *he = cs_subset_handle(sub, ch);
+  assert(he);
+
+  struct HashElem *he_base = cs_get_base(he);
+  assert(DTYPE(he_base->type) == DT_NUMBER);
+
+  intptr_t value = cs_subset_he_native_get(sub, he, NULL);
+  assert(value != INT_MIN);
+
+  return (short) value;
+}
+
+/**
+ * cs_handle_sort - Get a sort config item by handle
+ * @param sub Config Subset
+ * @param ch  Config handle
+ * @retval num Sort
+ */
+short cs_handle_sort(const struct ConfigSubset *sub, struct ConfigHandle *ch)
+{
+  assert(sub && ch);
+
+  struct HashElem *he = cs_subset_handle(sub, ch);
+  assert(he);
+
+  struct HashElem *he_base = cs_get_base(he);
+  assert(DTYPE(he_base->type) == DT_SORT);
+
+  intptr_t value = cs_subset_he_native_get(sub, he, NULL);
+  assert(value != INT_MIN);
+
+  return (short) value;
+}
+
+/**
+ * cs_handle_string - Get a string config item by handle
+ * @param sub Config Subset
+ * @param ch  Config handle
+ * @retval ptr String
+ */
+const char *cs_handle_string(const struct ConfigSubset *sub, struct ConfigHandle *ch)
+{
+  assert(sub && ch);
+
+  struct HashElem *he = cs_subset_handle(sub, ch);
+  assert(he);
+
+  struct HashElem *he_base = cs_get_base(he);
+  assert(DTYPE(he_base->type) == DT_STRING);
+
+  intptr_t value = cs_subset_he_native_get(sub, he, NULL);
+  assert(value != INT_MIN);
+
+  return (const char *) value;
+}
@@ -26,6 +26,7 @@
 #include <stdbool.h>
 #include "quad.h"
 
+struct ConfigHandle;
 struct ConfigSubset;
 
 const struct Address *cs_subset_address(const struct ConfigSubset *sub, const char *name);
@@ -41,5 +42,10 @@ const struct Slist *  cs_subset_slist  (const struct ConfigSubset *sub, const ch
 short                 cs_subset_sort   (const struct ConfigSubset *sub, const char *name);
 const char *          cs_subset_string (const struct ConfigSubset *sub, const char *name);
 
+bool                  cs_handle_bool   (const struct ConfigSubset *sub, struct ConfigHandle *ch);
+short                 cs_handle_number (const struct ConfigSubset *sub, struct ConfigHandle *ch);
+short                 cs_handle_sort   (const struct ConfigSubset *sub, struct ConfigHandle *ch);
+const char *          cs_handle_string (const struct ConfigSubset *sub, struct ConfigHandle *ch);
+
 #endif /* MUTT_CONFIG_HELPERS_H */
 
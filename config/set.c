@@ -148,6 +148,9 @@ static struct HashElem *reg_one_var(const struct ConfigSet *cs,
   return he;
 }
 
+/// Changes whenever a config item, or Subset, may have been freed, see ConfigHandle
+unsigned int ConfigGeneration = 1;
+
 /**
  * cs_new - Create a new Config Set
  * @param size Number of expected config items
@@ -175,6 +178,7 @@ void cs_free(struct ConfigSet **ptr)
   struct ConfigSet *cs = *ptr;
 
   mutt_hash_free(&cs->hash);
+  ConfigGeneration++;
   FREE(ptr);
 }
 
@@ -334,6 +338,7 @@ void cs_uninherit_variable(const struct ConfigSet *cs, const char *name)
     return;
 
   mutt_hash_delete(cs->hash, name, NULL);
+  ConfigGeneration++;
 }
 
 /**
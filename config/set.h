@@ -231,6 +231,8 @@ struct ConfigSet
   struct ConfigSetType types[18]; ///< All the defined config types
 };
 
+extern unsigned int ConfigGeneration;
+
 struct ConfigSet *cs_new(size_t size);
 void              cs_free(struct ConfigSet **ptr);
 
@@ -119,6 +119,7 @@ void cs_subset_free(struct ConfigSubset **ptr)
   notify_free(&sub->notify);
   FREE(&sub->name);
   FREE(ptr);
+  ConfigGeneration++;
 }
 
 /**
@@ -209,6 +210,31 @@ struct HashElem *cs_subset_create_inheritance(const struct ConfigSubset *sub, co
   return cs_inherit_variable(sub->cs, he, scope);
 }
 
+/**
+ * cs_subset_handle - Get the HashElem of a ConfigHandle
+ * @param sub Config Subset
+ * @param ch  Config handle
+ * @retval ptr  HashElem representing config item
+ * @retval NULL Error
+ *
+ * The config item is only looked up, and its inheritance created, the first
+ * time the handle is used with this Subset.
+ */
+struct HashElem *cs_subset_handle(const struct ConfigSubset *sub, struct ConfigHandle *ch)
+{
+  if (!sub || !ch)
+    return NULL;
+
+  if (!ch->he || (ch->sub != sub) || (ch->generation != ConfigGeneration))
+  {
+    ch->he = cs_subset_create_inheritance(sub, ch->name);
+    ch->sub = sub;
+    ch->generation = ConfigGeneration;
+  }
+
+  return ch->he;
+}
+
 /**
  * cs_subset_notify_observers - Notify all observers of an event
  * @param sub  Config Subset
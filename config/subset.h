@@ -74,11 +74,34 @@ struct EventConfig
   struct HashElem *he;            ///< Config item that changed
 };
 
+/**
+ * struct ConfigHandle - A config item that has been looked up
+ *
+ * Reading a config item by name hashes its (scoped) name every time.
+ * A static ConfigHandle remembers the HashElem, with inheritance resolved, so
+ * only the first read has to look it up.  The value is still read from the
+ * HashElem, so it's always current.
+ *
+ * The HashElem is looked up again if a different Subset is used, or if any
+ * config item may have been freed, see #ConfigGeneration.
+ */
+struct ConfigHandle
+{
+  const char *name;               ///< Name of the config item
+  const struct ConfigSubset *sub; ///< Subset the HashElem was looked up in
+  unsigned int generation;        ///< #ConfigGeneration at the time of the lookup
+  struct HashElem *he;            ///< Config item
+};
+
+/// Initialise a ConfigHandle for the config item called NAME
+#define CONFIG_HANDLE(NAME) { NAME, NULL, 0, NULL }
+
 struct ConfigSubset *cs_subset_new (const char *name, struct ConfigSubset *sub_parent, struct Notify *not_parent);
 void                 cs_subset_free(struct ConfigSubset **ptr);
 
 struct HashElem *cs_subset_create_inheritance(const struct ConfigSubset *sub, const char *name);
 struct HashElem *cs_subset_lookup            (const struct ConfigSubset *sub, const char *name);
+struct HashElem *cs_subset_handle            (const struct ConfigSubset *sub, struct ConfigHandle *ch);
 void             cs_subset_notify_observers  (const struct ConfigSubset *sub, struct HashElem *he, enum NotifyConfig ev);
 
 intptr_t cs_subset_he_native_get          (const struct ConfigSubset *sub, struct HashElem *he,                    struct Buffer *err);
@@ -200,6 +200,37 @@ int mutt_socket_poll(struct Connection *conn, time_t wait_secs)
   return -1;
 }
 
+/**
+ * socket_fill - Make sure there's some data in the input buffer
+ * @param conn Connection to a server
+ * @retval  0 Success, Connection::inbuf has unread data
+ * @retval -1 Error, the Connection has been closed
+ */
+static int socket_fill(struct Connection *conn)
+{
+  if (conn->bufpos < conn->available)
+    return 0;
+
+  if (conn->fd >= 0)
+    conn->available = conn->read(conn, conn->inbuf, sizeof(conn->inbuf));
+  else
+  {
+    mutt_debug(LL_DEBUG1, "attempt to read from closed connection\n");
+    return -1;
+  }
+  conn->bufpos = 0;
+  if (conn->available == 0)
+  {
+    mutt_error(_("Connection to %s closed"), conn->account.host);
+  }
+  if (conn->available <= 0)
+  {
+    mutt_socket_close(conn);
+    return -1;
+  }
+  return 0;
+}
+
 /**
  * mutt_socket_readchar - simple read buffering to speed things up
  * @param[in]  conn Connection to a server
@@ -209,26 +240,9 @@ int mutt_socket_poll(struct Connection *conn, time_t wait_secs)
  */
 int mutt_socket_readchar(struct Connection *conn, char *c)
 {
-  if (conn->bufpos >= conn->available)
-  {
-    if (conn->fd >= 0)
-      conn->available = conn->read(conn, conn->inbuf, sizeof(conn->inbuf));
-    else
-    {
-      mutt_debug(LL_DEBUG1, "attempt to read from closed connection\n");
-      return -1;
-    }
-    conn->bufpos = 0;
-    if (conn->available == 0)
-    {
-      mutt_error(_("Connection to %s closed"), conn->account.host);
-    }
-    if (conn->available <= 0)
-    {
-      mutt_socket_close(conn);
-      return -1;
-    }
-  }
+  if (socket_fill(conn) < 0)
+    return -1;
+
   *c = conn->inbuf[conn->bufpos];
   conn->bufpos++;
   return 1;
@@ -245,20 +259,31 @@ int mutt_socket_readchar(struct Connection *conn, char *c)
  */
 int mutt_socket_readln_d(char *buf, size_t buflen, struct Connection *conn, int dbg)
 {
-  char ch;
-  int i;
+  size_t i = 0;
 
-  for (i = 0; i < buflen - 1; i++)
+  /* Copy whole runs of the input buffer, up to the newline */
+  while (i < (buflen - 1))
   {
-    if (mutt_socket_readchar(conn, &ch) != 1)
+    if (socket_fill(conn) < 0)
     {
       buf[i] = '\0';
       return -1;
     }
 
-    if (ch == '\n')
+    const char *start = conn->inbuf + conn->bufpos;
+    const size_t len = MIN(conn->available - conn->bufpos, buflen - 1 - i);
+    const char *nl = memchr(start, '\n', len);
+    const size_t n = nl ? (nl - start) : len;
+
+    memcpy(buf + i, start, n);
+    i += n;
+    conn->bufpos += n;
+
+    if (nl)
+    {
+      conn->bufpos++; /* consume the newline */
       break;
-    buf[i] = ch;
+    }
   }
 
   /* strip \r from \r\n termination */
@@ -272,6 +297,97 @@ int mutt_socket_readln_d(char *buf, size_t buflen, struct Connection *conn, int
   return i + 1;
 }
 
+/**
+ * mutt_socket_buffer_readln_d - Read a line of any length from a socket
+ * @param buf  Buffer to store the line
+ * @param conn Connection to a server
+ * @param dbg  Debug level for logging
+ * @retval  0 Success
+ * @retval -1 Error
+ *
+ * The line is stored without its \r\n termination.  The Buffer grows as
+ * necessary, so the caller never sees a partial line.
+ */
+int mutt_socket_buffer_readln_d(struct Buffer *buf, struct Connection *conn, int dbg)
+{
+  if (!buf || !conn)
+    return -1;
+
+  /* Don't clear the whole Buffer, it may be large */
+  mutt_buffer_seek(buf, 0);
+  if (buf->data)
+    *buf->dptr = '\0';
+
+  while (true)
+  {
+    if (socket_fill(conn) < 0)
+      return -1;
+
+    const char *start = conn->inbuf + conn->bufpos;
+    const size_t len = conn->available - conn->bufpos;
+    const char *nl = memchr(start, '\n', len);
+    const size_t n = nl ? (nl - start) : len;
+
+    /* Grow geometrically, so a long line isn't copied over and over */
+    const size_t used = mutt_buffer_len(buf);
+    if ((used + n + 1) > buf->dsize)
+      mutt_buffer_alloc(buf, MAX(buf->dsize * 2, used + n + 1));
+
+    mutt_buffer_addstr_n(buf, start, n);
+    conn->bufpos += n;
+
+    if (nl)
+    {
+      conn->bufpos++; /* consume the newline */
+      break;
+    }
+  }
+
+  /* strip \r from \r\n termination */
+  if ((buf->dptr > buf->data) && (buf->dptr[-1] == '\r'))
+  {
+    buf->dptr--;
+    *buf->dptr = '\0';
+  }
+
+  mutt_debug(dbg, "%d< %s\n", conn->fd, mutt_buffer_string(buf));
+  return 0;
+}
+
+/**
+ * mutt_socket_buffer_readn - Read a number of bytes from a socket
+ * @param buf  Buffer to append the data to
+ * @param conn Connection to a server
+ * @param len  Number of bytes to read
+ * @retval  0 Success
+ * @retval -1 Error
+ *
+ * The data is appended to the Buffer, in bulk, from the Connection's input
+ * buffer.
+ */
+int mutt_socket_buffer_readn(struct Buffer *buf, struct Connection *conn, size_t len)
+{
+  if (!buf || !conn)
+    return -1;
+
+  const size_t used = mutt_buffer_len(buf);
+  if ((used + len + 1) > buf->dsize)
+    mutt_buffer_alloc(buf, MAX(buf->dsize * 2, used + len + 1));
+
+  while (len > 0)
+  {
+    if (socket_fill(conn) < 0)
+      return -1;
+
+    const size_t n = MIN(conn->available - conn->bufpos, len);
+    mutt_buffer_addstr_n(buf, conn->inbuf + conn->bufpos, n);
+    conn->bufpos += n;
+    len -= n;
+  }
+
+  return 0;
+}
+
 /**
  * mutt_socket_new - allocate and initialise a new connection
  * @param type Type of the new Connection
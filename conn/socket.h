@@ -26,6 +26,7 @@
 
 #include <time.h>
 
+struct Buffer;
 struct Connection;
 
 /**
@@ -46,6 +47,8 @@ int                mutt_socket_poll    (struct Connection *conn, time_t wait_sec
 int                mutt_socket_read    (struct Connection *conn, char *buf, size_t len);
 int                mutt_socket_readchar(struct Connection *conn, char *c);
 int                mutt_socket_readln_d(char *buf, size_t buflen, struct Connection *conn, int dbg);
+int                mutt_socket_buffer_readln_d(struct Buffer *buf, struct Connection *conn, int dbg);
+int                mutt_socket_buffer_readn(struct Buffer *buf, struct Connection *conn, size_t len);
 int                mutt_socket_write   (struct Connection *conn, const char *buf, size_t len);
 int                mutt_socket_write_d (struct Connection *conn, const char *buf, int len, int dbg);
 
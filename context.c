@@ -126,8 +126,19 @@ void ctx_update(struct Context *ctx)
 
   struct Mailbox *m = ctx->mailbox;
 
-  mutt_hash_free(&m->subj_hash);
-  mutt_hash_free(&m->id_hash);
+  /* if new emails have just been appended, they can be added to the threads */
+  const short c_sort = cs_subset_sort(NeoMutt->sub, "sort");
+  int first = 0;
+  if ((c_sort & SORT_MASK) == SORT_THREADS)
+    first = mutt_thread_first_new(ctx->threads);
+
+  if ((first <= 0) || (first >= m->msg_count))
+  {
+    first = 0;
+    mutt_hash_free(&m->subj_hash);
+    mutt_hash_free(&m->id_hash);
+    mutt_clear_threads(ctx->threads);
+  }
 
   /* reset counters */
   m->msg_unread = 0;
@@ -138,8 +149,6 @@ void ctx_update(struct Context *ctx)
   m->vcount = 0;
   m->changed = false;
 
-  mutt_clear_threads(ctx->threads);
-
   struct Email *e = NULL;
   for (int msgno = 0; msgno < m->msg_count; msgno++)
   {
@@ -165,7 +174,7 @@ void ctx_update(struct Context *ctx)
     e->msgno = msgno;
 
     const bool c_score = cs_subset_bool(NeoMutt->sub, "score");
-    if (e->env->supersedes)
+    if ((msgno >= first) && e->env->supersedes)
     {
       struct Email *e2 = NULL;
 
@@ -182,10 +191,13 @@ void ctx_update(struct Context *ctx)
     }
 
     /* add this message to the hash tables */
-    if (m->id_hash && e->env->message_id)
-      mutt_hash_insert(m->id_hash, e->env->message_id, e);
-    if (m->subj_hash && e->env->real_subj)
-      mutt_hash_insert(m->subj_hash, e->env->real_subj, e);
+    if (msgno >= first)
+    {
+      if (m->id_hash && e->env->message_id)
+        mutt_hash_insert(m->id_hash, e->env->message_id, e);
+      if (m->subj_hash && e->env->real_subj)
+        mutt_hash_insert(m->subj_hash, e->env->real_subj, e);
+    }
     mutt_label_hash_add(m, e);
 
     if (c_score)
@@ -207,8 +219,8 @@ void ctx_update(struct Context *ctx)
     }
   }
 
-  /* rethread from scratch */
-  mutt_sort_headers(ctx->mailbox, ctx->threads, true, &ctx->vsize);
+  /* rethread from scratch, unless the new emails can be threaded on their own */
+  mutt_sort_headers(ctx->mailbox, ctx->threads, (first == 0), &ctx->vsize);
 }
 
 /**
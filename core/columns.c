@@ -0,0 +1,121 @@
+/**
+ * @file
+ * Packed copies of the Emails' index fields
+ *
+ * @authors
+ * Copyright (C) 2021 Richard Russon <rich@flatcap.org>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @page core_columns Packed copies of the Emails' index fields
+ *
+ * A structure-of-arrays view of a Mailbox's Emails, for operations that scan
+ * every Email, e.g. sorting and limiting.
+ */
+
+#include "config.h"
+#include <stddef.h>
+#include "mutt/lib.h"
+#include "email/lib.h"
+#include "columns.h"
+#include "mailbox.h"
+
+/**
+ * columns_flags - Pack an Email's flags
+ * @param e Email
+ * @retval num Flags, e.g. #EMAIL_COL_READ
+ */
+static EmailColFlags columns_flags(const struct Email *e)
+{
+  EmailColFlags flags = EMAIL_COL_NO_FLAGS;
+  if (e->read)
+    flags |= EMAIL_COL_READ;
+  if (e->old)
+    flags |= EMAIL_COL_OLD;
+  if (e->flagged)
+    flags |= EMAIL_COL_FLAGGED;
+  if (e->tagged)
+    flags |= EMAIL_COL_TAGGED;
+  if (e->deleted)
+    flags |= EMAIL_COL_DELETED;
+  if (e->replied)
+    flags |= EMAIL_COL_REPLIED;
+  if (e->expired)
+    flags |= EMAIL_COL_EXPIRED;
+  if (e->superseded)
+    flags |= EMAIL_COL_SUPERSEDED;
+  return flags;
+}
+
+/**
+ * mailbox_columns_new - Copy the index fields of a Mailbox's Emails
+ * @param m Mailbox
+ * @retval ptr New MailboxColumns
+ *
+ * The columns stop at the first missing Email.
+ */
+struct MailboxColumns *mailbox_columns_new(struct Mailbox *m)
+{
+  struct MailboxColumns *mc = mutt_mem_calloc(1, sizeof(*mc));
+  if (!m)
+    return mc;
+
+  size_t count = 0;
+  while ((count < (size_t) m->msg_count) && m->emails[count])
+    count++;
+
+  const size_t n = MAX(count, 1);
+  mc->count = count;
+  mc->flags = mutt_mem_malloc(n * sizeof(*mc->flags));
+  mc->date_sent = mutt_mem_malloc(n * sizeof(*mc->date_sent));
+  mc->received = mutt_mem_malloc(n * sizeof(*mc->received));
+  mc->size = mutt_mem_malloc(n * sizeof(*mc->size));
+  mc->score = mutt_mem_malloc(n * sizeof(*mc->score));
+  mc->index = mutt_mem_malloc(n * sizeof(*mc->index));
+
+  for (size_t i = 0; i < count; i++)
+  {
+    const struct Email *e = m->emails[i];
+    mc->flags[i] = columns_flags(e);
+    mc->date_sent[i] = e->date_sent;
+    mc->received[i] = e->received;
+    mc->size[i] = e->body ? e->body->length : 0;
+    mc->score[i] = e->score;
+    mc->index[i] = e->index;
+  }
+
+  return mc;
+}
+
+/**
+ * mailbox_columns_free - Free a MailboxColumns
+ * @param[out] ptr MailboxColumns to free
+ */
+void mailbox_columns_free(struct MailboxColumns **ptr)
+{
+  if (!ptr || !*ptr)
+    return;
+
+  struct MailboxColumns *mc = *ptr;
+  FREE(&mc->flags);
+  FREE(&mc->date_sent);
+  FREE(&mc->received);
+  FREE(&mc->size);
+  FREE(&mc->score);
+  FREE(&mc->index);
+  FREE(ptr);
+}
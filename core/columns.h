@@ -0,0 +1,68 @@
+/**
+ * @file
+ * Packed copies of the Emails' index fields
+ *
+ * @authors
+ * Copyright (C) 2021 Richard Russon <rich@flatcap.org>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MUTT_CORE_COLUMNS_H
+#define MUTT_CORE_COLUMNS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+#include "mutt/lib.h"
+
+struct Mailbox;
+
+typedef uint16_t EmailColFlags;           ///< Flags for MailboxColumns::flags, e.g. #EMAIL_COL_READ
+#define EMAIL_COL_NO_FLAGS          0     ///< No flags are set
+#define EMAIL_COL_READ        (1 << 0)    ///< Email is read
+#define EMAIL_COL_OLD         (1 << 1)    ///< Email is seen, but unread
+#define EMAIL_COL_FLAGGED     (1 << 2)    ///< Email is marked important
+#define EMAIL_COL_TAGGED      (1 << 3)    ///< Email is tagged
+#define EMAIL_COL_DELETED     (1 << 4)    ///< Email is deleted
+#define EMAIL_COL_REPLIED     (1 << 5)    ///< Email has been replied to
+#define EMAIL_COL_EXPIRED     (1 << 6)    ///< Already expired?
+#define EMAIL_COL_SUPERSEDED  (1 << 7)    ///< Got superseded?
+
+/**
+ * struct MailboxColumns - Packed copies of the Emails' index fields
+ *
+ * Sorting and limiting only need a few small fields of each Email.  Copying
+ * them into parallel arrays, in one pass, means that the comparisons don't
+ * chase pointers into the Email, Envelope and Body.
+ *
+ * Element `i` of each array describes `Mailbox::emails[i]`.  The columns are a
+ * snapshot -- they aren't updated when the Emails change.
+ */
+struct MailboxColumns
+{
+  size_t count;           ///< Number of Emails
+  EmailColFlags *flags;   ///< Email flags, e.g. #EMAIL_COL_READ
+  time_t *date_sent;      ///< Time when the message was sent (UTC)
+  time_t *received;       ///< Time when the message was placed in the mailbox
+  LOFF_T *size;           ///< Length of the message body
+  int *score;             ///< Message score
+  int *index;             ///< The absolute (unsorted) message number
+};
+
+void                   mailbox_columns_free(struct MailboxColumns **ptr);
+struct MailboxColumns *mailbox_columns_new (struct Mailbox *m);
+
+#endif /* MUTT_CORE_COLUMNS_H */
@@ -28,6 +28,7 @@
  * | File                | Description                |
  * | :------------------ | :------------------------- |
  * | core/account.c      | @subpage core_account      |
+ * | core/columns.c      | @subpage core_columns      |
  * | core/mailbox.c      | @subpage core_mailbox      |
  * | core/neomutt.c      | @subpage core_neomutt      |
  */
@@ -37,6 +38,7 @@
 
 // IWYU pragma: begin_exports
 #include "account.h"
+#include "columns.h"
 #include "mailbox.h"
 #include "mxapi.h"
 #include "neomutt.h"
@@ -60,6 +60,7 @@ struct Mailbox *mailbox_new(void)
   m->emails = mutt_mem_calloc(m->email_max, sizeof(struct Email *));
   m->v2r = mutt_mem_calloc(m->email_max, sizeof(int));
   m->gen = mailbox_gen();
+  m->slab = mutt_slab_new();
 
   return m;
 }
@@ -83,6 +84,7 @@ void mailbox_free(struct Mailbox **ptr)
   for (size_t i = 0; i < m->email_max; i++)
     email_free(&m->emails[i]);
 
+  mutt_slab_free(&m->slab);
   mutt_buffer_dealloc(&m->pathbuf);
   cs_subset_free(&m->sub);
   FREE(&m->name);
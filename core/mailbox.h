@@ -127,6 +127,7 @@ struct Mailbox
   struct HashTable *id_hash;          ///< Hash Table by msg id
   struct HashTable *subj_hash;        ///< Hash Table by subject
   struct HashTable *label_hash;       ///< Hash Table for x-labels
+  struct Slab *slab;                  ///< Allocator for the Emails, Envelopes and Bodies
 
   struct Account *account;            ///< Account that owns this Mailbox
   int opened;                         ///< Number of times mailbox is opened
@@ -1508,6 +1508,9 @@
 ** .pp
 ** Header caching can greatly improve speed when opening POP, IMAP
 ** MH or Maildir folders, see "$caching" for details.
+** .pp
+** For mbox folders, the cache also remembers the length of each message, so
+** reopening a large mailbox only needs to read the parts that have changed.
 */
 
 { "header_cache_backend", DT_STRING, 0 },
@@ -1517,6 +1520,17 @@
 ** \fIunset\fP so no header caching will be used.
 */
 
+{ "header_cache_body_index", DT_BOOL, false },
+/*
+** .pp
+** When \fIset\fP, NeoMutt keeps a compact index of the text of Maildir and
+** MH messages in the header cache.  Body and header searches, e.g. ``~b'',
+** use it to skip the messages that can't contain a match, without opening
+** them.  Each message is indexed the first time it's searched.
+** .pp
+** Encrypted messages are never indexed.
+*/
+
 #ifdef USE_HCACHE_COMPRESSION
 { "header_cache_compress_level", DT_NUMBER, 1 },
 /*
@@ -2218,6 +2232,17 @@
 */
 #endif
 
+{ "maildir_read_threads", DT_NUMBER, 0 },
+/*
+** .pp
+** When opening a Maildir or MH mailbox, NeoMutt uses this many threads to
+** \fCstat(2)\fP and open the message files, ahead of the header parser.
+** This greatly speeds up opening large mailboxes when the files aren't
+** in the disk cache, e.g. on NFS.
+** .pp
+** A value of 0 means one thread per CPU.  A value of 1 disables the threads.
+*/
+
 { "maildir_trash", DT_BOOL, false },
 /*
 ** .pp
@@ -2271,6 +2296,16 @@
 ** Also see the $$move variable.
 */
 
+{ "mbox_read_threads", DT_NUMBER, 0 },
+/*
+** .pp
+** When opening an mbox mailbox, NeoMutt maps the file into memory and uses
+** this many threads to search it for the message separators, ahead of the
+** header parser.  This speeds up opening very large mailboxes.
+** .pp
+** A value of 0 means one thread per CPU.  A value of 1 disables the threads.
+*/
+
 { "mbox_type", DT_ENUM, MUTT_MBOX },
 /*
 ** .pp
@@ -3922,6 +3957,17 @@
 ** before search results. By default, search results will be top-aligned.
 */
 
+{ "search_threads", DT_NUMBER, 0 },
+/*
+** .pp
+** When searching the headers or bodies of the messages in an mbox, MMDF,
+** Maildir or MH mailbox, e.g. with ``~b'', NeoMutt uses this many threads
+** to read the messages ahead of the search.  Without $$thorough_search,
+** the threads search the raw messages, too.
+** .pp
+** A value of 0 means one thread per CPU.  A value of 1 disables the threads.
+*/
+
 { "send_charset", DT_STRING, "us-ascii:iso-8859-1:utf-8" },
 /*
 ** .pp
@@ -4721,6 +4767,16 @@
 ** non-$$reply_regex parts of both messages are identical.
 */
 
+{ "sort_threads", DT_NUMBER, 0 },
+/*
+** .pp
+** When sorting a large mailbox, NeoMutt splits the work between this many
+** threads.  The sort keys, e.g. the senders' names, are always worked out
+** by the main thread.  Small mailboxes are sorted by the main thread alone.
+** .pp
+** A value of 0 means one thread per CPU.  A value of 1 disables the threads.
+*/
+
 { "spam_separator", DT_STRING, "," },
 /*
 ** .pp
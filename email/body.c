@@ -42,7 +42,18 @@
  */
 struct Body *mutt_body_new(void)
 {
-  struct Body *p = mutt_mem_calloc(1, sizeof(struct Body));
+  return mutt_body_new_slab(NULL);
+}
+
+/**
+ * mutt_body_new_slab - Create a new Body in a Slab
+ * @param slab Slab to allocate from, NULL for the heap
+ * @retval ptr Newly allocated Body
+ */
+struct Body *mutt_body_new_slab(struct Slab *slab)
+{
+  struct Body *p = mutt_slab_alloc(slab, sizeof(struct Body));
+  p->slab = slab;
 
   p->disposition = DISP_ATTACH;
   p->use_disp = true;
@@ -93,7 +104,7 @@ void mutt_body_free(struct Body **ptr)
 
     mutt_env_free(&b->mime_headers);
     mutt_body_free(&b->parts);
-    FREE(&b);
+    mutt_slab_release(b->slab, b, sizeof(struct Body));
   }
 
   *ptr = NULL;
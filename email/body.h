@@ -82,11 +82,14 @@ struct Body
 
   bool collapsed : 1;             ///< Used by recvattach
   bool attach_qualifies : 1;      ///< This attachment should be counted
+
+  struct Slab *slab;              ///< Allocator that owns the Body, NULL if it's on the heap
 };
 
 bool         mutt_body_cmp_strict(const struct Body *b1, const struct Body *b2);
 void         mutt_body_free      (struct Body **ptr);
 char *       mutt_body_get_charset(struct Body *b, char *buf, size_t buflen);
 struct Body *mutt_body_new       (void);
+struct Body *mutt_body_new_slab  (struct Slab *slab);
 
 #endif /* MUTT_EMAIL_BODY_H */
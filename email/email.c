@@ -55,6 +55,7 @@ void email_free(struct Email **ptr)
   mutt_body_free(&e->body);
   FREE(&e->tree);
   FREE(&e->path);
+  FREE(&e->index_line);
 #ifdef MIXMASTER
   mutt_list_free(&e->chain);
 #endif
@@ -63,7 +64,8 @@ void email_free(struct Email **ptr)
 #endif
   driver_tags_free(&e->tags);
 
-  FREE(ptr);
+  mutt_slab_release(e->slab, e, sizeof(struct Email));
+  *ptr = NULL;
 }
 
 /**
@@ -71,10 +73,24 @@ void email_free(struct Email **ptr)
  * @retval ptr Newly created Email
  */
 struct Email *email_new(void)
+{
+  return email_new_slab(NULL);
+}
+
+/**
+ * email_new_slab - Create a new Email in a Slab
+ * @param slab Slab to allocate from, NULL for the heap
+ * @retval ptr Newly created Email
+ *
+ * The Email's Envelope and Body should be allocated from the same Slab, see
+ * mutt_env_new_slab() and mutt_body_new_slab().
+ */
+struct Email *email_new_slab(struct Slab *slab)
 {
   static size_t sequence = 0;
 
-  struct Email *e = mutt_mem_calloc(1, sizeof(struct Email));
+  struct Email *e = mutt_slab_alloc(slab, sizeof(struct Email));
+  e->slab = slab;
 #ifdef MIXMASTER
   STAILQ_INIT(&e->chain);
 #endif
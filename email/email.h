@@ -26,6 +26,7 @@
 #include "config.h"
 #include <stddef.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <time.h>
 #include "mutt/lib.h"
 #include "ncrypt/lib.h"
@@ -68,6 +69,7 @@ struct Email
   bool matched  : 1;           ///< Search matches this Email
 
   bool attach_valid : 1;       ///< true when the attachment count is valid
+  bool score_exact  : 1;       ///< An exact score rule matched, so no more apply
 
   // the following are used to support collapsing threads
   bool collapsed : 1;          ///< Is this message part of a collapsed thread?
@@ -78,6 +80,13 @@ struct Email
   short recipient;             ///< User_is_recipient()'s return value, cached
 
   int pair;                    ///< Color-pair to use when displaying in the index
+  int pair_rule;               ///< Index of the 'color index' rule that set `pair`
+  uint8_t pair_stale;          ///< Inputs of the colour rules that have changed, e.g. #PAT_DEP_FLAGS
+
+  char *index_line;            ///< Cached line of the index, see index_make_entry()
+  unsigned int index_line_gen; ///< Generation of the index when index_line was made
+  int index_line_cols;         ///< Width of index_line
+  uint8_t index_line_flags;    ///< Format flags of index_line, e.g. #MUTT_FORMAT_TREE
 
   time_t date_sent;            ///< Time when the message was sent (UTC)
   time_t received;             ///< Time when the message was placed in the mailbox
@@ -87,6 +96,9 @@ struct Email
   int msgno;                   ///< Number displayed to the user
   int vnum;                    ///< Virtual message number
   int score;                   ///< Message score
+  int score_sum;               ///< Total of the matching score rules, before clamping
+  int score_seq;               ///< Score rules that have been applied, see mutt_rescore_message()
+  uint8_t score_stale;         ///< Inputs of the score rules that have changed, e.g. #PAT_DEP_FLAGS
   struct Envelope *env;        ///< Envelope information
   struct Body *body;           ///< List of MIME parts
   char *path;                  ///< Path of Email (for local Mailboxes)
@@ -117,6 +129,7 @@ struct Email
   void (*edata_free)(void **ptr);
 
   struct Notify *notify;       ///< Notifications handler
+  struct Slab *slab;           ///< Allocator that owns the Email, NULL if it's on the heap
 };
 
 /**
@@ -172,6 +185,7 @@ struct EventHeader
 bool          email_cmp_strict(const struct Email *e1, const struct Email *e2);
 void          email_free      (struct Email **ptr);
 struct Email *email_new       (void);
+struct Email *email_new_slab  (struct Slab *slab);
 size_t        email_size      (const struct Email *e);
 
 int  emaillist_add_email(struct EmailList *el, struct Email *e);
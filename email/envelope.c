@@ -41,7 +41,18 @@
  */
 struct Envelope *mutt_env_new(void)
 {
-  struct Envelope *e = mutt_mem_calloc(1, sizeof(struct Envelope));
+  return mutt_env_new_slab(NULL);
+}
+
+/**
+ * mutt_env_new_slab - Create a new Envelope in a Slab
+ * @param slab Slab to allocate from, NULL for the heap
+ * @retval ptr New Envelope
+ */
+struct Envelope *mutt_env_new_slab(struct Slab *slab)
+{
+  struct Envelope *e = mutt_slab_alloc(slab, sizeof(struct Envelope));
+  e->slab = slab;
   TAILQ_INIT(&e->return_path);
   TAILQ_INIT(&e->from);
   TAILQ_INIT(&e->to);
@@ -137,7 +148,8 @@ void mutt_env_free(struct Envelope **ptr)
   mutt_autocrypthdr_free(&env->autocrypt_gossip);
 #endif
 
-  FREE(ptr);
+  mutt_slab_release(env->slab, env, sizeof(struct Envelope));
+  *ptr = NULL;
 }
 
 /**
@@ -86,12 +86,14 @@ struct Envelope
   struct AutocryptHeader *autocrypt_gossip;
 #endif
   unsigned char changed;               ///< Changed fields, e.g. #MUTT_ENV_CHANGED_SUBJECT
+  struct Slab *slab;                   ///< Allocator that owns the Envelope, NULL if it's on the heap
 };
 
 bool             mutt_env_cmp_strict(const struct Envelope *e1, const struct Envelope *e2);
 void             mutt_env_free      (struct Envelope **ptr);
 void             mutt_env_merge     (struct Envelope *base, struct Envelope **extra);
 struct Envelope *mutt_env_new       (void);
+struct Envelope *mutt_env_new_slab  (struct Slab *slab);
 int              mutt_env_to_intl   (struct Envelope *env, const char **tag, char **err);
 void             mutt_env_to_local  (struct Envelope *e);
 
@@ -165,11 +165,12 @@ static void parse_parameters(struct ParameterList *pl, const char *s, bool allow
         if (*s == '"')
         {
           bool state_ascii = true;
+          static struct ConfigHandle ch_assumed_charset = CONFIG_HANDLE("assumed_charset");
+          const char *const c_assumed_charset =
+              cs_handle_string(NeoMutt->sub, &ch_assumed_charset);
           s++;
           for (; *s; s++)
           {
-            const char *const c_assumed_charset =
-                cs_subset_string(NeoMutt->sub, "assumed_charset");
             if (c_assumed_charset)
             {
               // As iso-2022-* has a character of '"' with non-ascii state, ignore it
@@ -909,8 +910,8 @@ int mutt_rfc822_parse_line(struct Envelope *env, struct Email *e, char *line,
             {
               case 'O':
               {
-                const bool c_mark_old =
-                    cs_subset_bool(NeoMutt->sub, "mark_old");
+                static struct ConfigHandle ch_mark_old = CONFIG_HANDLE("mark_old");
+                const bool c_mark_old = cs_handle_bool(NeoMutt->sub, &ch_mark_old);
                 e->old = c_mark_old;
                 break;
               }
@@ -1025,7 +1026,8 @@ int mutt_rfc822_parse_line(struct Envelope *env, struct Email *e, char *line,
     /* restore the original line */
     line[strlen(line)] = ':';
 
-    const bool c_weed = cs_subset_bool(NeoMutt->sub, "weed");
+    static struct ConfigHandle ch_weed = CONFIG_HANDLE("weed");
+    const bool c_weed = cs_handle_bool(NeoMutt->sub, &ch_weed);
     if (!(weed && c_weed && mutt_matches_ignore(line)))
     {
       struct ListNode *np = mutt_list_insert_tail(&env->userhdrs, mutt_str_dup(line));
@@ -1111,24 +1113,132 @@ char *mutt_rfc822_read_line(FILE *fp, char *line, size_t *linelen)
 }
 
 /**
- * mutt_rfc822_read_header - parses an RFC822 header
- * @param fp        Stream to read from
+ * struct HeaderSource - Where the header lines come from
+ *
+ * The header is either read from a stream, or from a block of memory.
+ */
+struct HeaderSource
+{
+  FILE *fp;         ///< Stream to read from, or NULL
+  const char *data; ///< Memory to read from, if fp is NULL
+  size_t len;       ///< Length of data
+  size_t pos;       ///< Current position in data
+};
+
+/**
+ * read_line_mem - Read a header line from memory
+ * @param hs      Memory source
+ * @param line    Buffer to store the result
+ * @param linelen Length of buffer
+ * @retval ptr Line read from memory
+ *
+ * This behaves like mutt_rfc822_read_line(), except that the end of the data
+ * also ends the last line.
+ */
+static char *read_line_mem(struct HeaderSource *hs, char *line, size_t *linelen)
+{
+  const char *end = hs->data + hs->len;
+  size_t offset = 0;
+
+  while (true)
+  {
+    const char *start = hs->data + hs->pos;
+    if ((start >= end) || (IS_SPACE(*start) && !offset)) /* end of headers */
+    {
+      const char *nl = memchr(start, '\n', end - start);
+      hs->pos = nl ? (nl + 1 - hs->data) : hs->len;
+      *line = '\0';
+      return line;
+    }
+
+    const char *nl = memchr(start, '\n', end - start);
+    const size_t len = (nl ? nl : end) - start;
+    hs->pos = nl ? (nl + 1 - hs->data) : hs->len;
+
+    if (*linelen < (offset + len + 256))
+    {
+      /* grow the buffer */
+      *linelen = offset + len + 256;
+      mutt_mem_realloc(&line, *linelen);
+    }
+
+    memcpy(line + offset, start, len);
+    char *buf = line + offset + len;
+    *buf = '\0';
+
+    /* remove trailing space */
+    while ((buf > line) && IS_SPACE(buf[-1]))
+      *--buf = '\0';
+
+    /* check to see if the next line is a continuation line */
+    if ((hs->pos >= hs->len) || ((hs->data[hs->pos] != ' ') && (hs->data[hs->pos] != '\t')))
+      return line; /* next line is a separate header field or EOH */
+
+    /* eat tabs and spaces from the beginning of the continuation line */
+    while ((hs->pos < hs->len) && ((hs->data[hs->pos] == ' ') || (hs->data[hs->pos] == '\t')))
+      hs->pos++;
+
+    *buf++ = ' ';
+    *buf = '\0';
+    offset = buf - line;
+  }
+  /* not reached */
+}
+
+/**
+ * source_read_line - Read a header line from a HeaderSource
+ * @param hs      Source
+ * @param line    Buffer to store the result
+ * @param linelen Length of buffer
+ * @retval ptr Line read
+ */
+static char *source_read_line(struct HeaderSource *hs, char *line, size_t *linelen)
+{
+  if (hs->fp)
+    return mutt_rfc822_read_line(hs->fp, line, linelen);
+  return read_line_mem(hs, line, linelen);
+}
+
+/**
+ * source_tell - Get the position in a HeaderSource
+ * @param hs Source
+ * @retval num Offset, or -1 on error
+ */
+static LOFF_T source_tell(struct HeaderSource *hs)
+{
+  if (hs->fp)
+    return ftello(hs->fp);
+  return hs->pos;
+}
+
+/**
+ * source_seek - Set the position in a HeaderSource
+ * @param hs  Source
+ * @param loc Offset, previously returned by source_tell()
+ */
+static void source_seek(struct HeaderSource *hs, LOFF_T loc)
+{
+  if (hs->fp)
+    fseeko(hs->fp, loc, SEEK_SET);
+  else
+    hs->pos = loc;
+}
+
+/**
+ * read_header - Parse an RFC822 header from a HeaderSource
+ * @param hs        Source to read from
  * @param e         Current Email (optional)
  * @param user_hdrs If set, store user headers
- *                  Used for recall-message and postpone modes
- * @param weed      If this parameter is set and the user has activated the
- *                  $weed option, honor the header weed list for user headers.
- *                  Used for recall-message
+ * @param weed      If set, honor the header weed list for user headers
  * @retval ptr Newly allocated envelope structure
  *
- * Caller should free the Envelope using mutt_env_free().
+ * @sa mutt_rfc822_read_header()
  */
-struct Envelope *mutt_rfc822_read_header(FILE *fp, struct Email *e, bool user_hdrs, bool weed)
+static struct Envelope *read_header(struct HeaderSource *hs, struct Email *e,
+                                    bool user_hdrs, bool weed)
 {
-  if (!fp)
-    return NULL;
-
-  struct Envelope *env = mutt_env_new();
+  struct Slab *slab = e ? e->slab : NULL;
+  struct Envelope *env = mutt_env_new_slab(slab);
   char *p = NULL;
   LOFF_T loc;
   size_t linelen = 1024;
@@ -1139,7 +1249,7 @@ struct Envelope *mutt_rfc822_read_header(FILE *fp, struct Email *e, bool user_hd
   {
     if (!e->body)
     {
-      e->body = mutt_body_new();
+      e->body = mutt_body_new_slab(slab);
 
       /* set the defaults from RFC1521 */
       e->body->type = TYPE_TEXT;
@@ -1152,9 +1262,9 @@ struct Envelope *mutt_rfc822_read_header(FILE *fp, struct Email *e, bool user_hd
     }
   }
 
-  while ((loc = ftello(fp)) != -1)
+  while ((loc = source_tell(hs)) != -1)
   {
-    line = mutt_rfc822_read_line(fp, line, &linelen);
+    line = source_read_line(hs, line, &linelen);
     if (*line == '\0')
       break;
     p = strpbrk(line, ": \t");
@@ -1174,7 +1284,7 @@ struct Envelope *mutt_rfc822_read_header(FILE *fp, struct Email *e, bool user_hd
         continue;
       }
 
-      fseeko(fp, loc, SEEK_SET);
+      source_seek(hs, loc);
       break; /* end of header */
     }
 
@@ -1232,7 +1342,7 @@ struct Envelope *mutt_rfc822_read_header(FILE *fp, struct Email *e, bool user_hd
   if (e)
   {
     e->body->hdr_offset = e->offset;
-    e->body->offset = ftello(fp);
+    e->body->offset = source_tell(hs);
 
     rfc2047_decode_envelope(env);
 
@@ -1279,6 +1389,54 @@ struct Envelope *mutt_rfc822_read_header(FILE *fp, struct Email *e, bool user_hd
   return env;
 }
 
+/**
+ * mutt_rfc822_read_header - parses an RFC822 header
+ * @param fp        Stream to read from
+ * @param e         Current Email (optional)
+ * @param user_hdrs If set, store user headers
+ *                  Used for recall-message and postpone modes
+ * @param weed      If this parameter is set and the user has activated the
+ *                  $weed option, honor the header weed list for user headers.
+ *                  Used for recall-message
+ * @retval ptr Newly allocated envelope structure
+ *
+ * Caller should free the Envelope using mutt_env_free().
+ *
+ * If the Email was allocated from a Slab, the Envelope and Body will be too.
+ */
+struct Envelope *mutt_rfc822_read_header(FILE *fp, struct Email *e, bool user_hdrs, bool weed)
+{
+  if (!fp)
+    return NULL;
+
+  struct HeaderSource hs = { .fp = fp };
+  return read_header(&hs, e, user_hdrs, weed);
+}
+
+/**
+ * mutt_rfc822_read_header_mem - Parse an RFC822 header held in memory
+ * @param data      Header text, need not be NUL-terminated
+ * @param len       Length of the header text
+ * @param e         Current Email (optional)
+ * @param user_hdrs If set, store user headers
+ * @param weed      If set, honor the header weed list for user headers
+ * @retval ptr Newly allocated envelope structure
+ *
+ * This is mutt_rfc822_read_header() without the stream.  The Body's offset is
+ * relative to the start of data.
+ *
+ * Caller should free the Envelope using mutt_env_free().
+ */
+struct Envelope *mutt_rfc822_read_header_mem(const char *data, size_t len,
+                                             struct Email *e, bool user_hdrs, bool weed)
+{
+  if (!data)
+    return NULL;
+
+  struct HeaderSource hs = { .data = data, .len = len };
+  return read_header(&hs, e, user_hdrs, weed);
+}
+
 /**
  * mutt_read_mime_header - Parse a MIME header
  * @param fp      stream to read from
@@ -201,11 +201,11 @@ static size_t try_block(const char *d, size_t dlen, const char *fromcode,
         (iconv(cd, NULL, NULL, &ob, &obl) == (size_t)(-1)))
     {
       assert(errno == E2BIG);
-      iconv_close(cd);
+      mutt_ch_iconv_close(cd);
       assert(ib > d);
       return ((ib - d) == dlen) ? dlen : ib - d + 1;
     }
-    iconv_close(cd);
+    mutt_ch_iconv_close(cd);
   }
   else
   {
@@ -281,7 +281,7 @@ static size_t encode_block(char *str, char *buf, size_t buflen, const char *from
   const size_t n1 = iconv(cd, (ICONV_CONST char **) &ib, &ibl, &ob, &obl);
   const size_t n2 = iconv(cd, NULL, NULL, &ob, &obl);
   assert(n1 != (size_t)(-1) && n2 != (size_t)(-1));
-  iconv_close(cd);
+  mutt_ch_iconv_close(cd);
   return (*encoder)(str, tmp, ob - tmp, tocode);
 }
 
@@ -322,6 +322,21 @@ static size_t choose_block(char *d, size_t dlen, int col, const char *fromcode,
   return n;
 }
 
+/**
+ * is_printable_ascii - Is a string only printable ASCII characters?
+ * @param s String to check
+ * @retval true Every character is in the range space to '~'
+ */
+static bool is_printable_ascii(const char *s)
+{
+  for (; *s; s++)
+  {
+    if ((*s < ' ') || (*s > '~'))
+      return false;
+  }
+  return true;
+}
+
 /**
  * finalize_chunk - Perform charset conversion and filtering
  * @param[out] res        Buffer where the resulting string is appended
@@ -337,9 +352,25 @@ static void finalize_chunk(struct Buffer *res, struct Buffer *buf, char *charset
     return;
   char end = charset[charsetlen];
   charset[charsetlen] = '\0';
-  const char *const c_charset = cs_subset_string(NeoMutt->sub, "charset");
-  mutt_ch_convert_string(&buf->data, charset, c_charset, MUTT_ICONV_HOOK_FROM);
+
+  /* UTF-8 text doesn't need converting for a UTF-8 display.  Filtering the
+   * unprintable characters also replaces any invalid sequences. */
+  const bool utf8 = CharsetIsUtf8 && mutt_ch_is_utf8(charset) &&
+                    !mutt_ch_charset_lookup(charset);
+  if (!utf8)
+  {
+    const char *const c_charset = cs_subset_string(NeoMutt->sub, "charset");
+    mutt_ch_convert_string(&buf->data, charset, c_charset, MUTT_ICONV_HOOK_FROM);
+  }
   charset[charsetlen] = end;
+
+  if (utf8 && is_printable_ascii(mutt_buffer_string(buf)))
+  {
+    mutt_buffer_addstr(res, mutt_buffer_string(buf));
+    mutt_buffer_reset(buf);
+    return;
+  }
+
   mutt_mb_filter_unprintable(&buf->data);
   mutt_buffer_addstr(res, buf->data);
   FREE(&buf->data);
@@ -348,57 +379,63 @@ static void finalize_chunk(struct Buffer *res, struct Buffer *buf, char *charset
 
 /**
  * decode_word - Decode an RFC2047-encoded string
+ * @param buf Buffer for the result
  * @param s   String to decode
  * @param len Length of the string
  * @param enc Encoding type
- * @retval ptr Decoded string
+ * @retval true  Success
+ * @retval false The string couldn't be decoded
  *
- * @note The caller must free the returned string
+ * The decoded text is appended to the Buffer.  Like a C string, it stops at
+ * the first NUL character.
  */
-static char *decode_word(const char *s, size_t len, enum ContentEncoding enc)
+static bool decode_word(struct Buffer *buf, const char *s, size_t len,
+                        enum ContentEncoding enc)
 {
   const char *it = s;
   const char *end = s + len;
 
   if (enc == ENC_QUOTED_PRINTABLE)
   {
-    struct Buffer buf = mutt_buffer_make(0);
     for (; it < end; it++)
     {
       if (*it == '_')
       {
-        mutt_buffer_addch(&buf, ' ');
+        mutt_buffer_addch(buf, ' ');
       }
       else if ((it[0] == '=') && (!(it[1] & ~127) && (hexval(it[1]) != -1)) &&
                (!(it[2] & ~127) && (hexval(it[2]) != -1)))
       {
-        mutt_buffer_addch(&buf, (hexval(it[1]) << 4) | hexval(it[2]));
+        const char c = (hexval(it[1]) << 4) | hexval(it[2]);
+        if (c == '\0')
+          break;
+        mutt_buffer_addch(buf, c);
         it += 2;
       }
       else
       {
-        mutt_buffer_addch(&buf, *it);
+        mutt_buffer_addch(buf, *it);
       }
     }
-    mutt_buffer_addch(&buf, '\0');
-    return buf.data;
+    return true;
   }
   else if (enc == ENC_BASE64)
   {
     const int olen = 3 * len / 4 + 1;
-    char *out = mutt_mem_malloc(olen);
-    int dlen = mutt_b64_decode(it, out, olen);
+    mutt_buffer_alloc(buf, mutt_buffer_len(buf) + olen + 1);
+    int dlen = mutt_b64_decode(it, buf->dptr, olen);
     if (dlen == -1)
     {
-      FREE(&out);
-      return NULL;
+      *buf->dptr = '\0';
+      return false;
     }
-    out[dlen] = '\0';
-    return out;
+    buf->dptr += strnlen(buf->dptr, dlen);
+    *buf->dptr = '\0';
+    return true;
   }
 
   assert(0); /* The enc parameter has an invalid value */
-  return NULL;
+  return false;
 }
 
 /**
@@ -630,6 +667,25 @@ void rfc2047_encode(char **pd, const char *specials, int col, const char *charse
   *pd = e;
 }
 
+/**
+ * is_plain_text - Is a header plain text, whatever charset is assumed?
+ * @param s String to check
+ * @retval true The string is ASCII, without any shift sequences
+ *
+ * Some 7-bit charsets switch modes with a sequence of characters, e.g.
+ * ESC in ISO-2022-JP, `~{` in HZ or `+` in UTF-7.  Text in them still needs
+ * to be converted from the `$assumed_charset`.
+ */
+static bool is_plain_text(const char *s)
+{
+  for (; *s; s++)
+  {
+    if ((*s & 0x80) || (*s == '\033') || (*s == '+') || ((s[0] == '~') && (s[1] == '{')))
+      return false;
+  }
+  return true;
+}
+
 /**
  * rfc2047_decode - Decode any RFC2047-encoded header fields
  * @param[in,out] pd  String to be decoded, and resulting decoded string
@@ -643,6 +699,11 @@ void rfc2047_decode(char **pd)
   if (!pd || !*pd)
     return;
 
+  /* Most headers aren't encoded, so they're left as they are */
+  const char *const c_assumed_charset = cs_subset_string(NeoMutt->sub, "assumed_charset");
+  if (!strstr(*pd, "=?") && (!c_assumed_charset || is_plain_text(*pd)))
+    return;
+
   struct Buffer buf = mutt_buffer_make(0); /* Output buffer            */
   char *s = *pd;            /* Read pointer                           */
   char *beg = NULL;         /* Begin of encoded word                  */
@@ -682,8 +743,6 @@ void rfc2047_decode(char **pd)
 
       /* Add non-encoded part */
       {
-        const char *const c_assumed_charset =
-            cs_subset_string(NeoMutt->sub, "assumed_charset");
         if (c_assumed_charset)
         {
           char *conv = mutt_strn_dup(s, holelen);
@@ -702,21 +761,21 @@ void rfc2047_decode(char **pd)
     {
       /* Some encoded text was found */
       text[textlen] = '\0';
-      char *decoded = decode_word(text, textlen, enc);
-      if (!decoded)
-      {
-        return;
-      }
-      if (prev.data && ((prev_charsetlen != charsetlen) ||
-                        !mutt_strn_equal(prev_charset, charset, charsetlen)))
+      if (!mutt_buffer_is_empty(&prev) &&
+          ((prev_charsetlen != charsetlen) ||
+           !mutt_strn_equal(prev_charset, charset, charsetlen)))
       {
         /* Different charset, convert the previous chunk and add it to the
          * final result */
         finalize_chunk(&buf, &prev, prev_charset, prev_charsetlen);
       }
 
-      mutt_buffer_addstr(&prev, decoded);
-      FREE(&decoded);
+      if (!decode_word(&prev, text, textlen, enc))
+      {
+        mutt_buffer_dealloc(&prev);
+        mutt_buffer_dealloc(&buf);
+        return;
+      }
       prev_charset = charset;
       prev_charsetlen = charsetlen;
       s = text + textlen + 2; /* Skip final ?= */
@@ -724,10 +783,11 @@ void rfc2047_decode(char **pd)
   }
 
   /* Save the last chunk */
-  if (prev.data)
+  if (!mutt_buffer_is_empty(&prev))
   {
     finalize_chunk(&buf, &prev, prev_charset, prev_charsetlen);
   }
+  mutt_buffer_dealloc(&prev);
 
   mutt_buffer_addch(&buf, '\0');
   FREE(pd);
@@ -36,6 +36,7 @@
 #include "gui/lib.h"
 #include "mutt.h"
 #include "index/lib.h"
+#include "pattern/lib.h"
 #include "keymap.h"
 #include "protos.h"
 
@@ -328,7 +329,8 @@ void mutt_set_flag_update(struct Mailbox *m, struct Email *e,
 
   if (update)
   {
-    mutt_set_header_color(m, e);
+    e->score_stale |= PAT_DEP_FLAGS;
+    mutt_header_color_stale(e, PAT_DEP_FLAGS);
   }
 
   /* if the message status has changed, we need to invalidate the cached
@@ -1002,6 +1002,7 @@ static enum CommandResult add_pattern(struct Colors *c, struct ColorLineList *to
         color_line_free(c, &tmp, true);
         return MUTT_CMD_ERROR;
       }
+      tmp->color_deps = mutt_pattern_deps(tmp->color_pattern);
     }
     else
     {
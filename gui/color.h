@@ -38,6 +38,7 @@ struct ColorLine
   int match;                         ///< Substring to match, 0 for old behaviour
   char *pattern;                     ///< Pattern to match
   struct PatternList *color_pattern; ///< Compiled pattern to speed up index color calculation
+  uint8_t color_deps;                ///< Inputs of color_pattern, see mutt_pattern_deps()
   uint32_t fg;                       ///< Foreground colour
   uint32_t bg;                       ///< Background colour
   int pair;                          ///< Colour pair index
@@ -117,6 +117,9 @@ static struct ConfigDef HcacheVars[] = {
   { "header_cache_backend", DT_STRING, 0, 0, hcache_validator,
     "(hcache) Header cache backend to use"
   },
+  { "header_cache_body_index", DT_BOOL, false, 0, NULL,
+    "(hcache) Index the text of local messages, to speed up body searches"
+  },
 #if defined(USE_HCACHE_COMPRESSION)
   // These two are not in alphabetical order because `level`s validator depends on `method`
   { "header_cache_compress_method", DT_STRING, 0, 0, compress_method_validator,
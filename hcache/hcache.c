@@ -30,6 +30,15 @@
  * This module implements the gateway between the user visible part of the
  * header cache API and the backend specific API. Also, this module implements
  * the serialization/deserialization routines for the Header structure.
+ *
+ * Each record consists of:
+ * - uidvalidity and crc (never compressed, so they can be checked cheaply)
+ * - Email and Body fields, in size-prefixed records of fixed layout
+ * - Envelope, Body strings and tags
+ *
+ * The fixed-layout records don't depend on the layout of struct Email or
+ * struct Body, so those structs can change without invalidating the cache.
+ * New fields are appended to the records; older caches simply lack them.
  */
 
 #include "config.h"
@@ -62,6 +71,9 @@
 
 static unsigned int hcachever = 0x0;
 
+/// Maximum number of writes in one transaction, to limit its size
+#define HCACHE_BATCH_SIZE 10000
+
 /**
  * header_size - Compute the size of the header with uuid validity
  * and crc.
@@ -84,7 +96,6 @@ static size_t header_size(void)
  */
 static void *dump(struct HeaderCache *hc, const struct Email *e, int *off, uint32_t uidvalidity)
 {
-  struct Email e_dump;
   bool convert = !CharsetIsUtf8;
 
   *off = 0;
@@ -95,37 +106,9 @@ static void *dump(struct HeaderCache *hc, const struct Email *e, int *off, uint3
 
   assert((size_t) *off == header_size());
 
-  lazy_realloc(&d, *off + sizeof(struct Email));
-  memcpy(&e_dump, e, sizeof(struct Email));
-
-  /* some fields are not safe to cache */
-  e_dump.tagged = false;
-  e_dump.changed = false;
-  e_dump.threaded = false;
-  e_dump.recip_valid = false;
-  e_dump.searched = false;
-  e_dump.matched = false;
-  e_dump.collapsed = false;
-  e_dump.visible = true;
-  e_dump.num_hidden = 0;
-  e_dump.recipient = 0;
-  e_dump.pair = 0;
-  e_dump.attach_valid = false;
-  e_dump.path = NULL;
-  e_dump.tree = NULL;
-  e_dump.thread = NULL;
-  e_dump.sequence = 0;
-  STAILQ_INIT(&e_dump.tags);
-#ifdef MIXMASTER
-  STAILQ_INIT(&e_dump.chain);
-#endif
-  e_dump.edata = NULL;
-
-  memcpy(d + *off, &e_dump, sizeof(struct Email));
-  *off += sizeof(struct Email);
-
-  d = serial_dump_envelope(e_dump.env, d, off, convert);
-  d = serial_dump_body(e_dump.body, d, off, convert);
+  d = serial_dump_email(e, d, off);
+  d = serial_dump_envelope(e->env, d, off, convert);
+  d = serial_dump_body(e->body, d, off, convert);
   d = serial_dump_tags(&e->tags, d, off);
 
   return d;
@@ -133,16 +116,17 @@ static void *dump(struct HeaderCache *hc, const struct Email *e, int *off, uint3
 
 /**
  * restore - Restore an Email from data retrieved from the cache
- * @param d Data retrieved using mutt_hcache_dump
+ * @param d    Data retrieved using mutt_hcache_dump
+ * @param slab Slab to allocate the Email from, may be NULL
  * @retval ptr Success, the restored header (can't be NULL)
  *
  * @note The returned Email must be free'd by caller code with
  *       email_free()
  */
-static struct Email *restore(const unsigned char *d)
+static struct Email *restore(const unsigned char *d, struct Slab *slab)
 {
   int off = 0;
-  struct Email *e = email_new();
+  struct Email *e = email_new_slab(slab);
   bool convert = !CharsetIsUtf8;
 
   /* skip validate */
@@ -151,20 +135,12 @@ static struct Email *restore(const unsigned char *d)
   /* skip crc */
   off += sizeof(unsigned int);
 
-  size_t sequence = e->sequence;
-  memcpy(e, d + off, sizeof(struct Email));
-  off += sizeof(struct Email);
-  e->sequence = sequence;
-
-  STAILQ_INIT(&e->tags);
-#ifdef MIXMASTER
-  STAILQ_INIT(&e->chain);
-#endif
+  serial_restore_email(e, d, &off);
 
-  e->env = mutt_env_new();
+  e->env = mutt_env_new_slab(slab);
   serial_restore_envelope(e->env, d, &off, convert);
 
-  e->body = mutt_body_new();
+  e->body = mutt_body_new_slab(slab);
   serial_restore_body(e->body, d, &off, convert);
   serial_restore_tags(&e->tags, d, &off);
 
@@ -187,8 +163,9 @@ static struct RealKey *realkey(const char *key, size_t keylen)
 {
   static struct RealKey rk;
 #ifdef USE_HCACHE_COMPRESSION
+  static struct ConfigHandle ch_compress_method = CONFIG_HANDLE("header_cache_compress_method");
   const char *const c_header_cache_compress_method =
-      cs_subset_string(NeoMutt->sub, "header_cache_compress_method");
+      cs_handle_string(NeoMutt->sub, &ch_compress_method);
   if (c_header_cache_compress_method)
   {
     const struct ComprOps *cops = compress_get_ops(c_header_cache_compress_method);
@@ -323,6 +300,25 @@ static char *get_foldername(const char *folder)
   return p;
 }
 
+/**
+ * hcache_batch_write - Count a write, committing the transaction if it's full
+ * @param hc  Header cache handle
+ * @param ops Store backend
+ */
+static void hcache_batch_write(struct HeaderCache *hc, const struct StoreOps *ops)
+{
+  if (!hc->batch || !ops->commit)
+    return;
+
+  if (++hc->batch_writes < HCACHE_BATCH_SIZE)
+    return;
+
+  mutt_debug(LL_DEBUG3, "committing %zu writes\n", hc->batch_writes);
+  hc->batch_writes = 0;
+  if ((ops->commit(hc->ctx) != 0) || (ops->begin(hc->ctx) != 0))
+    hc->batch = false;
+}
+
 /**
  * mutt_hcache_open - Multiplexor for StoreOps::open
  */
@@ -437,6 +433,8 @@ void mutt_hcache_close(struct HeaderCache *hc)
   if (!hc || !ops)
     return;
 
+  mutt_hcache_commit(hc);
+
 #ifdef USE_HCACHE_COMPRESSION
   const char *const c_header_cache_compress_method =
       cs_subset_string(NeoMutt->sub, "header_cache_compress_method");
@@ -452,6 +450,46 @@ void mutt_hcache_close(struct HeaderCache *hc)
   FREE(&hc);
 }
 
+/**
+ * mutt_hcache_begin - Multiplexor for StoreOps::begin
+ */
+int mutt_hcache_begin(struct HeaderCache *hc)
+{
+  const char *const c_header_cache_backend =
+      cs_subset_string(NeoMutt->sub, "header_cache_backend");
+  const struct StoreOps *ops = store_get_backend_ops(c_header_cache_backend);
+  if (!hc || !ops)
+    return -1;
+
+  if (hc->batch)
+    return 0;
+
+  int rc = ops->begin ? ops->begin(hc->ctx) : 0;
+  if (rc == 0)
+  {
+    hc->batch = true;
+    hc->batch_writes = 0;
+  }
+
+  return rc;
+}
+
+/**
+ * mutt_hcache_commit - Multiplexor for StoreOps::commit
+ */
+int mutt_hcache_commit(struct HeaderCache *hc)
+{
+  const char *const c_header_cache_backend =
+      cs_subset_string(NeoMutt->sub, "header_cache_backend");
+  const struct StoreOps *ops = store_get_backend_ops(c_header_cache_backend);
+  if (!hc || !ops || !hc->batch)
+    return 0;
+
+  hc->batch = false;
+  hc->batch_writes = 0;
+  return ops->commit ? ops->commit(hc->ctx) : 0;
+}
+
 /**
  * mutt_hcache_fetch - Multiplexor for StoreOps::fetch
  */
@@ -496,7 +534,7 @@ struct HCacheEntry mutt_hcache_fetch(struct HeaderCache *hc, const char *key,
   }
 #endif
 
-  entry.email = restore(data);
+  entry.email = restore(data, hc->slab);
 
 end:
   mutt_hcache_free_raw(hc, &to_free);
@@ -625,6 +663,9 @@ int mutt_hcache_store_raw(struct HeaderCache *hc, const char *key,
   int rc = ops->store(hc->ctx, mutt_buffer_string(&path), keylen, data, dlen);
   mutt_buffer_dealloc(&path);
 
+  if (rc == 0)
+    hcache_batch_write(hc, ops);
+
   return rc;
 }
 
@@ -646,5 +687,62 @@ int mutt_hcache_delete_record(struct HeaderCache *hc, const char *key, size_t ke
 
   int rc = ops->delete_record(hc->ctx, mutt_buffer_string(&path), keylen);
   mutt_buffer_dealloc(&path);
+
+  if (rc == 0)
+    hcache_batch_write(hc, ops);
+
+  return rc;
+}
+
+/**
+ * body_index_key - Create the key of a message's body index
+ * @param key    Message identification string
+ * @param keylen Length of the string pointed to by key
+ * @param buf    Buffer for the result
+ * @retval num Length of the key
+ *
+ * The index is stored next to the message's header, under a key that no
+ * message can have.
+ */
+static size_t body_index_key(const char *key, size_t keylen, struct Buffer *buf)
+{
+  return mutt_buffer_printf(buf, "%.*s/body-index", (int) keylen, key);
+}
+
+/**
+ * mutt_hcache_fetch_body_index - Fetch the body index of a message
+ */
+void *mutt_hcache_fetch_body_index(struct HeaderCache *hc, const char *key,
+                                   size_t keylen, size_t *dlen)
+{
+  struct Buffer *buf = mutt_buffer_pool_get();
+  keylen = body_index_key(key, keylen, buf);
+  void *data = mutt_hcache_fetch_raw(hc, mutt_buffer_string(buf), keylen, dlen);
+  mutt_buffer_pool_release(&buf);
+  return data;
+}
+
+/**
+ * mutt_hcache_store_body_index - Store the body index of a message
+ */
+int mutt_hcache_store_body_index(struct HeaderCache *hc, const char *key,
+                                 size_t keylen, void *data, size_t dlen)
+{
+  struct Buffer *buf = mutt_buffer_pool_get();
+  keylen = body_index_key(key, keylen, buf);
+  int rc = mutt_hcache_store_raw(hc, mutt_buffer_string(buf), keylen, data, dlen);
+  mutt_buffer_pool_release(&buf);
+  return rc;
+}
+
+/**
+ * mutt_hcache_delete_body_index - Delete the body index of a message
+ */
+int mutt_hcache_delete_body_index(struct HeaderCache *hc, const char *key, size_t keylen)
+{
+  struct Buffer *buf = mutt_buffer_pool_get();
+  keylen = body_index_key(key, keylen, buf);
+  int rc = mutt_hcache_delete_record(hc, mutt_buffer_string(buf), keylen);
+  mutt_buffer_pool_release(&buf);
   return rc;
 }
@@ -1,7 +1,7 @@
 #!/bin/sh
 
-BASEVERSION=7
-STRUCTURES="Address Body Buffer Email Envelope ListNode Parameter"
+BASEVERSION=8
+STRUCTURES="Address Buffer Envelope ListNode Parameter"
 
 cleanstruct () {
   echo "$1" | sed -e 's/.* //'
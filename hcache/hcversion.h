@@ -0,0 +1,8 @@
+/* base version: 8
+ * Buffer: char *data; char *dptr; size_t dsize;
+ * ListNode: char *data; struct { struct ListNode *stqe_next; } entries;
+ * Address: char *personal; char *mailbox; _Bool group : 1; _Bool is_intl : 1; _Bool intl_checked : 1; struct { struct Address *tqe_next; struct Address **tqe_prev; } entries;
+ * Envelope: struct AddressList return_path; struct AddressList from; struct AddressList to; struct AddressList cc; struct AddressList bcc; struct AddressList sender; struct AddressList reply_to; struct AddressList mail_followup_to; struct AddressList x_original_to; char *list_post; char *subject; char *real_subj; char *disp_subj; char *message_id; char *supersedes; char *date; char *x_label; char *organization; char *newsgroups; char *xref; char *followup_to; char *x_comment_to; struct Buffer spam; struct ListHead references; struct ListHead in_reply_to; struct ListHead userhdrs; unsigned char changed; struct Slab *slab;
+ * Parameter: char *attribute; char *value; struct { struct Parameter *tqe_next; struct Parameter **tqe_prev; } entries;
+ */
+#define HCACHEVER 0xe23ce9d9
@@ -67,6 +67,7 @@
 #ifndef MUTT_HCACHE_LIB_H
 #define MUTT_HCACHE_LIB_H
 
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
@@ -87,6 +88,9 @@ struct HeaderCache
   unsigned int crc;
   void *ctx;
   void *cctx;
+  bool batch;          ///< A batch of writes is in progress
+  size_t batch_writes; ///< Number of writes in the current transaction
+  struct Slab *slab;   ///< Allocator for restored Emails, e.g. Mailbox::slab
 };
 
 /**
@@ -123,6 +127,26 @@ struct HeaderCache *mutt_hcache_open(const char *path, const char *folder, hcach
  */
 void mutt_hcache_close(struct HeaderCache *hc);
 
+/**
+ * mutt_hcache_begin - start a batch of writes
+ * @param hc Pointer to the struct HeaderCache structure got by mutt_hcache_open()
+ * @retval 0   Success
+ * @retval num Generic or backend-specific error code otherwise
+ *
+ * Until mutt_hcache_commit() is called, writes will be grouped into a few
+ * large transactions, if the backend supports them.  Batches don't nest.
+ * Closing the header cache will commit any pending writes.
+ */
+int mutt_hcache_begin(struct HeaderCache *hc);
+
+/**
+ * mutt_hcache_commit - finish a batch of writes
+ * @param hc Pointer to the struct HeaderCache structure got by mutt_hcache_open()
+ * @retval 0   Success
+ * @retval num Generic or backend-specific error code otherwise
+ */
+int mutt_hcache_commit(struct HeaderCache *hc);
+
 /**
  * mutt_hcache_store - store a Header along with a validity datum
  * @param hc          Pointer to the struct HeaderCache structure got by mutt_hcache_open()
@@ -171,4 +195,37 @@ void mutt_hcache_free_raw(struct HeaderCache *hc, void **data);
  */
 int mutt_hcache_delete_record(struct HeaderCache *hc, const char *key, size_t keylen);
 
+/**
+ * mutt_hcache_fetch_body_index - Fetch the body index of a message
+ * @param hc     Pointer to the struct HeaderCache structure got by mutt_hcache_open()
+ * @param key    Message identification string, the same as for the header
+ * @param keylen Length of the string pointed to by key
+ * @param dlen   Length of the data
+ * @retval ptr  Data, to be freed with mutt_hcache_free_raw()
+ * @retval NULL No index was found
+ */
+void *mutt_hcache_fetch_body_index(struct HeaderCache *hc, const char *key, size_t keylen, size_t *dlen);
+
+/**
+ * mutt_hcache_store_body_index - Store the body index of a message
+ * @param hc     Pointer to the struct HeaderCache structure got by mutt_hcache_open()
+ * @param key    Message identification string, the same as for the header
+ * @param keylen Length of the string pointed to by key
+ * @param data   Index data
+ * @param dlen   Length of the data
+ * @retval 0   Success
+ * @retval num Generic or backend-specific error code otherwise
+ */
+int mutt_hcache_store_body_index(struct HeaderCache *hc, const char *key, size_t keylen, void *data, size_t dlen);
+
+/**
+ * mutt_hcache_delete_body_index - Delete the body index of a message
+ * @param hc     Pointer to the struct HeaderCache structure got by mutt_hcache_open()
+ * @param key    Message identification string, the same as for the header
+ * @param keylen Length of the string pointed to by key
+ * @retval 0   Success
+ * @retval num Generic or backend-specific error code otherwise
+ */
+int mutt_hcache_delete_body_index(struct HeaderCache *hc, const char *key, size_t keylen);
+
 #endif /* MUTT_HCACHE_LIB_H */
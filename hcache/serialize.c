@@ -40,12 +40,93 @@
 #include "core/lib.h"
 #include "serialize.h"
 
+/**
+ * struct EmailRecord - Cached fields of an Email
+ *
+ * The record is stored with a fixed layout, independent of struct Email.
+ *
+ * @note New fields must be added to the end, and zero must be a safe default.
+ */
+struct EmailRecord
+{
+  int64_t date_sent;     ///< Email.date_sent
+  int64_t received;      ///< Email.received
+  int64_t offset;        ///< Email.offset
+  uint32_t flags;        ///< Email flags, e.g. #EMAIL_REC_READ
+  uint32_t security;     ///< Email.security
+  int32_t lines;         ///< Email.lines
+  int32_t index;         ///< Email.index
+  int32_t msgno;         ///< Email.msgno
+  int32_t vnum;          ///< Email.vnum
+  int32_t score;         ///< Email.score
+  uint8_t zhours;        ///< Email.zhours
+  uint8_t zminutes;      ///< Email.zminutes
+  int16_t attach_total;  ///< Email.attach_total
+};
+_Static_assert(sizeof(struct EmailRecord) == 56, "EmailRecord must not have padding");
+
+#define EMAIL_REC_MIME            (1 << 0)  ///< Email.mime
+#define EMAIL_REC_FLAGGED         (1 << 1)  ///< Email.flagged
+#define EMAIL_REC_DELETED         (1 << 2)  ///< Email.deleted
+#define EMAIL_REC_PURGE           (1 << 3)  ///< Email.purge
+#define EMAIL_REC_QUASI_DELETED   (1 << 4)  ///< Email.quasi_deleted
+#define EMAIL_REC_ATTACH_DEL      (1 << 5)  ///< Email.attach_del
+#define EMAIL_REC_OLD             (1 << 6)  ///< Email.old
+#define EMAIL_REC_READ            (1 << 7)  ///< Email.read
+#define EMAIL_REC_EXPIRED         (1 << 8)  ///< Email.expired
+#define EMAIL_REC_SUPERSEDED      (1 << 9)  ///< Email.superseded
+#define EMAIL_REC_REPLIED         (1 << 10) ///< Email.replied
+#define EMAIL_REC_SUBJECT_CHANGED (1 << 11) ///< Email.subject_changed
+#define EMAIL_REC_DISPLAY_SUBJECT (1 << 12) ///< Email.display_subject
+#define EMAIL_REC_ACTIVE          (1 << 13) ///< Email.active
+#define EMAIL_REC_TRASH           (1 << 14) ///< Email.trash
+#define EMAIL_REC_ZOCCIDENT       (1 << 15) ///< Email.zoccident
+
+/**
+ * struct BodyRecord - Cached fields of a Body
+ *
+ * The record is stored with a fixed layout, independent of struct Body.
+ *
+ * @note New fields must be taken from the end of the padding, and zero must be
+ *       a safe default.
+ */
+struct BodyRecord
+{
+  int64_t hdr_offset;    ///< Body.hdr_offset
+  int64_t offset;        ///< Body.offset
+  int64_t length;        ///< Body.length
+  int64_t stamp;         ///< Body.stamp
+  uint32_t flags;        ///< Body flags, e.g. #BODY_REC_USE_DISP
+  int16_t attach_count;  ///< Body.attach_count
+  uint8_t type;          ///< Body.type
+  uint8_t encoding;      ///< Body.encoding
+  uint8_t disposition;   ///< Body.disposition
+  uint8_t pad[7];        ///< Unused, always zero
+};
+_Static_assert(sizeof(struct BodyRecord) == 48, "BodyRecord must not have padding");
+
+#define BODY_REC_USE_DISP         (1 << 0)  ///< Body.use_disp
+#define BODY_REC_UNLINK           (1 << 1)  ///< Body.unlink
+#define BODY_REC_TAGGED           (1 << 2)  ///< Body.tagged
+#define BODY_REC_DELETED          (1 << 3)  ///< Body.deleted
+#define BODY_REC_NOCONV           (1 << 4)  ///< Body.noconv
+#define BODY_REC_NOWRAP           (1 << 5)  ///< Body.nowrap
+#define BODY_REC_FORCE_CHARSET    (1 << 6)  ///< Body.force_charset
+#define BODY_REC_GOODSIG          (1 << 7)  ///< Body.goodsig
+#define BODY_REC_WARNSIG          (1 << 8)  ///< Body.warnsig
+#define BODY_REC_BADSIG           (1 << 9)  ///< Body.badsig
+#define BODY_REC_IS_AUTOCRYPT     (1 << 10) ///< Body.is_autocrypt
+#define BODY_REC_COLLAPSED        (1 << 11) ///< Body.collapsed
+#define BODY_REC_ATTACH_QUALIFIES (1 << 12) ///< Body.attach_qualifies
+
 /**
  * lazy_realloc - Reallocate some memory
  * @param ptr Pointer to resize
  * @param size Minimum size
  *
  * The minimum size is 4KiB to avoid repeated resizing.
+ * Larger blocks are rounded up to a power of two, so a growing blob is only
+ * moved a logarithmic number of times.
  */
 void lazy_realloc(void *ptr, size_t size)
 {
@@ -54,7 +135,55 @@ void lazy_realloc(void *ptr, size_t size)
   if (p && (size < 4096))
     return;
 
-  mutt_mem_realloc(ptr, size);
+  size_t alloc = 4096;
+  while (alloc < size)
+    alloc *= 2;
+
+  mutt_mem_realloc(ptr, alloc);
+}
+
+/**
+ * serial_dump_record - Pack a fixed-size record into a binary blob
+ * @param rec  Record to pack
+ * @param size Size of the record
+ * @param d    Binary blob to add to
+ * @param off  Offset into the blob
+ * @retval ptr End of the newly packed binary
+ *
+ * The record is preceded by its size, so that a later version of NeoMutt can
+ * add fields to the end of it without invalidating the cache.
+ */
+static unsigned char *serial_dump_record(const void *rec, size_t size,
+                                         unsigned char *d, int *off)
+{
+  d = serial_dump_uint32_t(size, d, off);
+
+  lazy_realloc(&d, *off + size);
+  memcpy(d + *off, rec, size);
+  *off += size;
+
+  return d;
+}
+
+/**
+ * serial_restore_record - Unpack a fixed-size record from a binary blob
+ * @param[out] rec  Store the unpacked record here
+ * @param[in]  size Size of the record
+ * @param[in]  d    Binary blob to read from
+ * @param[out] off  Offset into the blob
+ *
+ * If the cached record is shorter than @a size (it was written by an older
+ * version of NeoMutt), the missing fields will be zero.  If it's longer, the
+ * unknown fields will be skipped.
+ */
+static void serial_restore_record(void *rec, size_t size, const unsigned char *d, int *off)
+{
+  uint32_t stored = 0;
+  serial_restore_uint32_t(&stored, d, off);
+
+  memset(rec, 0, size);
+  memcpy(rec, d + *off, MIN(size, stored));
+  *off += stored;
 }
 
 /**
@@ -137,7 +266,8 @@ unsigned char *serial_dump_char_size(char *c, ssize_t size, unsigned char *d,
   if (convert && !mutt_str_is_ascii(c, size))
   {
     p = mutt_strn_dup(c, size);
-    const char *const c_charset = cs_subset_string(NeoMutt->sub, "charset");
+    static struct ConfigHandle ch_charset = CONFIG_HANDLE("charset");
+    const char *const c_charset = cs_handle_string(NeoMutt->sub, &ch_charset);
     if (mutt_ch_convert_string(&p, c_charset, "utf-8", MUTT_ICONV_NO_FLAGS) == 0)
     {
       size = mutt_str_len(p) + 1;
@@ -191,7 +321,8 @@ void serial_restore_char(char **c, const unsigned char *d, int *off, bool conver
   if (convert && !mutt_str_is_ascii(*c, size))
   {
     char *tmp = mutt_str_dup(*c);
-    const char *const c_charset = cs_subset_string(NeoMutt->sub, "charset");
+    static struct ConfigHandle ch_charset = CONFIG_HANDLE("charset");
+    const char *const c_charset = cs_handle_string(NeoMutt->sub, &ch_charset);
     if (mutt_ch_convert_string(&tmp, "utf-8", c_charset, MUTT_ICONV_NO_FLAGS) == 0)
     {
       FREE(c);
@@ -424,33 +555,57 @@ void serial_restore_parameter(struct ParameterList *pl, const unsigned char *d,
  */
 unsigned char *serial_dump_body(struct Body *c, unsigned char *d, int *off, bool convert)
 {
-  struct Body nb;
-
-  memcpy(&nb, c, sizeof(struct Body));
-
-  /* some fields are not safe to cache */
-  nb.content = NULL;
-  nb.charset = NULL;
-  nb.next = NULL;
-  nb.parts = NULL;
-  nb.email = NULL;
-  nb.aptr = NULL;
-  nb.mime_headers = NULL;
-  nb.language = NULL;
+  struct BodyRecord rec = { 0 };
+
+  rec.hdr_offset = c->hdr_offset;
+  rec.offset = c->offset;
+  rec.length = c->length;
+  rec.stamp = c->stamp;
+  rec.attach_count = c->attach_count;
+  rec.type = c->type;
+  rec.encoding = c->encoding;
+  rec.disposition = c->disposition;
+
+  if (c->use_disp)
+    rec.flags |= BODY_REC_USE_DISP;
+  if (c->unlink)
+    rec.flags |= BODY_REC_UNLINK;
+  if (c->tagged)
+    rec.flags |= BODY_REC_TAGGED;
+  if (c->deleted)
+    rec.flags |= BODY_REC_DELETED;
+  if (c->noconv)
+    rec.flags |= BODY_REC_NOCONV;
+  if (c->nowrap)
+    rec.flags |= BODY_REC_NOWRAP;
+  if (c->force_charset)
+    rec.flags |= BODY_REC_FORCE_CHARSET;
+  if (c->goodsig)
+    rec.flags |= BODY_REC_GOODSIG;
+  if (c->warnsig)
+    rec.flags |= BODY_REC_WARNSIG;
+  if (c->badsig)
+    rec.flags |= BODY_REC_BADSIG;
+#ifdef USE_AUTOCRYPT
+  if (c->is_autocrypt)
+    rec.flags |= BODY_REC_IS_AUTOCRYPT;
+#endif
+  if (c->collapsed)
+    rec.flags |= BODY_REC_COLLAPSED;
+  if (c->attach_qualifies)
+    rec.flags |= BODY_REC_ATTACH_QUALIFIES;
 
-  lazy_realloc(&d, *off + sizeof(struct Body));
-  memcpy(d + *off, &nb, sizeof(struct Body));
-  *off += sizeof(struct Body);
+  d = serial_dump_record(&rec, sizeof(rec), d, off);
 
-  d = serial_dump_char(nb.xtype, d, off, false);
-  d = serial_dump_char(nb.subtype, d, off, false);
+  d = serial_dump_char(c->xtype, d, off, false);
+  d = serial_dump_char(c->subtype, d, off, false);
 
-  d = serial_dump_parameter(&nb.parameter, d, off, convert);
+  d = serial_dump_parameter(&c->parameter, d, off, convert);
 
-  d = serial_dump_char(nb.description, d, off, convert);
-  d = serial_dump_char(nb.form_name, d, off, convert);
-  d = serial_dump_char(nb.filename, d, off, convert);
-  d = serial_dump_char(nb.d_filename, d, off, convert);
+  d = serial_dump_char(c->description, d, off, convert);
+  d = serial_dump_char(c->form_name, d, off, convert);
+  d = serial_dump_char(c->filename, d, off, convert);
+  d = serial_dump_char(c->d_filename, d, off, convert);
 
   return d;
 }
@@ -464,14 +619,37 @@ unsigned char *serial_dump_body(struct Body *c, unsigned char *d, int *off, bool
  */
 void serial_restore_body(struct Body *c, const unsigned char *d, int *off, bool convert)
 {
-  memcpy(c, d + *off, sizeof(struct Body));
-  *off += sizeof(struct Body);
-  c->language = NULL;
+  struct BodyRecord rec;
+  serial_restore_record(&rec, sizeof(rec), d, off);
+
+  c->hdr_offset = rec.hdr_offset;
+  c->offset = rec.offset;
+  c->length = rec.length;
+  c->stamp = rec.stamp;
+  c->attach_count = rec.attach_count;
+  c->type = rec.type;
+  c->encoding = rec.encoding;
+  c->disposition = rec.disposition;
+
+  c->use_disp = (rec.flags & BODY_REC_USE_DISP);
+  c->unlink = (rec.flags & BODY_REC_UNLINK);
+  c->tagged = (rec.flags & BODY_REC_TAGGED);
+  c->deleted = (rec.flags & BODY_REC_DELETED);
+  c->noconv = (rec.flags & BODY_REC_NOCONV);
+  c->nowrap = (rec.flags & BODY_REC_NOWRAP);
+  c->force_charset = (rec.flags & BODY_REC_FORCE_CHARSET);
+  c->goodsig = (rec.flags & BODY_REC_GOODSIG);
+  c->warnsig = (rec.flags & BODY_REC_WARNSIG);
+  c->badsig = (rec.flags & BODY_REC_BADSIG);
+#ifdef USE_AUTOCRYPT
+  c->is_autocrypt = (rec.flags & BODY_REC_IS_AUTOCRYPT);
+#endif
+  c->collapsed = (rec.flags & BODY_REC_COLLAPSED);
+  c->attach_qualifies = (rec.flags & BODY_REC_ATTACH_QUALIFIES);
 
   serial_restore_char(&c->xtype, d, off, false);
   serial_restore_char(&c->subtype, d, off, false);
 
-  TAILQ_INIT(&c->parameter);
   serial_restore_parameter(&c->parameter, d, off, convert);
 
   serial_restore_char(&c->description, d, off, convert);
@@ -480,6 +658,111 @@ void serial_restore_body(struct Body *c, const unsigned char *d, int *off, bool
   serial_restore_char(&c->d_filename, d, off, convert);
 }
 
+/**
+ * serial_dump_email - Pack an Email into a binary blob
+ * @param e   Email to pack
+ * @param d   Binary blob to add to
+ * @param off Offset into the blob
+ * @retval ptr End of the newly packed binary
+ *
+ * Only the fields of the Email itself are packed.
+ * Fields that aren't safe to cache, e.g. tagged, are skipped.
+ */
+unsigned char *serial_dump_email(const struct Email *e, unsigned char *d, int *off)
+{
+  struct EmailRecord rec = { 0 };
+
+  rec.date_sent = e->date_sent;
+  rec.received = e->received;
+  rec.offset = e->offset;
+  rec.security = e->security;
+  rec.lines = e->lines;
+  rec.index = e->index;
+  rec.msgno = e->msgno;
+  rec.vnum = e->vnum;
+  rec.score = e->score;
+  rec.zhours = e->zhours;
+  rec.zminutes = e->zminutes;
+  rec.attach_total = e->attach_total;
+
+  if (e->mime)
+    rec.flags |= EMAIL_REC_MIME;
+  if (e->flagged)
+    rec.flags |= EMAIL_REC_FLAGGED;
+  if (e->deleted)
+    rec.flags |= EMAIL_REC_DELETED;
+  if (e->purge)
+    rec.flags |= EMAIL_REC_PURGE;
+  if (e->quasi_deleted)
+    rec.flags |= EMAIL_REC_QUASI_DELETED;
+  if (e->attach_del)
+    rec.flags |= EMAIL_REC_ATTACH_DEL;
+  if (e->old)
+    rec.flags |= EMAIL_REC_OLD;
+  if (e->read)
+    rec.flags |= EMAIL_REC_READ;
+  if (e->expired)
+    rec.flags |= EMAIL_REC_EXPIRED;
+  if (e->superseded)
+    rec.flags |= EMAIL_REC_SUPERSEDED;
+  if (e->replied)
+    rec.flags |= EMAIL_REC_REPLIED;
+  if (e->subject_changed)
+    rec.flags |= EMAIL_REC_SUBJECT_CHANGED;
+  if (e->display_subject)
+    rec.flags |= EMAIL_REC_DISPLAY_SUBJECT;
+  if (e->active)
+    rec.flags |= EMAIL_REC_ACTIVE;
+  if (e->trash)
+    rec.flags |= EMAIL_REC_TRASH;
+  if (e->zoccident)
+    rec.flags |= EMAIL_REC_ZOCCIDENT;
+
+  return serial_dump_record(&rec, sizeof(rec), d, off);
+}
+
+/**
+ * serial_restore_email - Unpack an Email from a binary blob
+ * @param e   Store the unpacked Email here
+ * @param d   Binary blob to read from
+ * @param off Offset into the blob
+ */
+void serial_restore_email(struct Email *e, const unsigned char *d, int *off)
+{
+  struct EmailRecord rec;
+  serial_restore_record(&rec, sizeof(rec), d, off);
+
+  e->date_sent = rec.date_sent;
+  e->received = rec.received;
+  e->offset = rec.offset;
+  e->security = rec.security;
+  e->lines = rec.lines;
+  e->index = rec.index;
+  e->msgno = rec.msgno;
+  e->vnum = rec.vnum;
+  e->score = rec.score;
+  e->zhours = rec.zhours;
+  e->zminutes = rec.zminutes;
+  e->attach_total = rec.attach_total;
+
+  e->mime = (rec.flags & EMAIL_REC_MIME);
+  e->flagged = (rec.flags & EMAIL_REC_FLAGGED);
+  e->deleted = (rec.flags & EMAIL_REC_DELETED);
+  e->purge = (rec.flags & EMAIL_REC_PURGE);
+  e->quasi_deleted = (rec.flags & EMAIL_REC_QUASI_DELETED);
+  e->attach_del = (rec.flags & EMAIL_REC_ATTACH_DEL);
+  e->old = (rec.flags & EMAIL_REC_OLD);
+  e->read = (rec.flags & EMAIL_REC_READ);
+  e->expired = (rec.flags & EMAIL_REC_EXPIRED);
+  e->superseded = (rec.flags & EMAIL_REC_SUPERSEDED);
+  e->replied = (rec.flags & EMAIL_REC_REPLIED);
+  e->subject_changed = (rec.flags & EMAIL_REC_SUBJECT_CHANGED);
+  e->display_subject = (rec.flags & EMAIL_REC_DISPLAY_SUBJECT);
+  e->active = (rec.flags & EMAIL_REC_ACTIVE);
+  e->trash = (rec.flags & EMAIL_REC_TRASH);
+  e->zoccident = (rec.flags & EMAIL_REC_ZOCCIDENT);
+}
+
 /**
  * serial_dump_envelope - Pack an Envelope into a binary blob
  * @param env     Envelope to pack
@@ -551,7 +834,8 @@ void serial_restore_envelope(struct Envelope *env, const unsigned char *d, int *
 
   serial_restore_char(&env->list_post, d, off, convert);
 
-  const bool c_auto_subscribe = cs_subset_bool(NeoMutt->sub, "auto_subscribe");
+  static struct ConfigHandle ch_auto_subscribe = CONFIG_HANDLE("auto_subscribe");
+  const bool c_auto_subscribe = cs_handle_bool(NeoMutt->sub, &ch_auto_subscribe);
   if (c_auto_subscribe)
     mutt_auto_subscribe(env->list_post);
 
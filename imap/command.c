@@ -1081,7 +1081,6 @@ int imap_cmd_step(struct ImapAccountData *adata)
   if (!adata)
     return -1;
 
-  size_t len = 0;
   int c;
   int rc;
   int stillrunning = 0;
@@ -1093,37 +1092,25 @@ int imap_cmd_step(struct ImapAccountData *adata)
     return IMAP_RES_BAD;
   }
 
-  /* read into buffer, expanding buffer as necessary until we have a full
-   * line */
-  do
+  /* read a full line into adata->buf, which grows as necessary */
+  struct Buffer line = { 0 };
+  line.data = adata->buf;
+  line.dptr = adata->buf;
+  line.dsize = adata->blen;
+  rc = mutt_socket_buffer_readln_d(&line, adata->conn, MUTT_SOCK_LOG_FULL);
+  adata->buf = line.data;
+  adata->blen = line.dsize;
+  if (rc < 0)
   {
-    if (len == adata->blen)
-    {
-      mutt_mem_realloc(&adata->buf, adata->blen + IMAP_CMD_BUFSIZE);
-      adata->blen = adata->blen + IMAP_CMD_BUFSIZE;
-      mutt_debug(LL_DEBUG3, "grew buffer to %lu bytes\n", adata->blen);
-    }
-
-    /* back up over '\0' */
-    if (len)
-      len--;
-    c = mutt_socket_readln_d(adata->buf + len, adata->blen - len, adata->conn, MUTT_SOCK_LOG_FULL);
-    if (c <= 0)
-    {
-      mutt_debug(LL_DEBUG1, "Error reading server response\n");
-      cmd_handle_fatal(adata);
-      return IMAP_RES_BAD;
-    }
-
-    len += c;
+    mutt_debug(LL_DEBUG1, "Error reading server response\n");
+    cmd_handle_fatal(adata);
+    return IMAP_RES_BAD;
   }
-  /* if we've read all the way to the end of the buffer, we haven't read a
-   * full line (mutt_socket_readln strips the \r, so we always have at least
-   * one character free when we've read a full line) */
-  while (len == adata->blen);
+
+  const size_t len = mutt_buffer_len(&line);
 
   /* don't let one large string make cmd->buf hog memory forever */
-  if ((adata->blen > IMAP_CMD_BUFSIZE) && (len <= IMAP_CMD_BUFSIZE))
+  if ((adata->blen > IMAP_CMD_BUFSIZE) && (len < IMAP_CMD_BUFSIZE))
   {
     mutt_mem_realloc(&adata->buf, IMAP_CMD_BUFSIZE);
     adata->blen = IMAP_CMD_BUFSIZE;
@@ -645,6 +645,59 @@ int imap_read_literal(FILE *fp, struct ImapAccountData *adata,
   return 0;
 }
 
+/**
+ * imap_read_literal_buffer - Read bytes bytes from server into a Buffer
+ * @param buf   Buffer to append the literal to
+ * @param adata Imap Account data
+ * @param bytes Number of bytes to read
+ * @retval  0 Success
+ * @retval -1 Failure
+ *
+ * Like imap_read_literal(), but the data is copied in bulk from the
+ * Connection's input buffer, without any file I/O.
+ *
+ * @note Strips `\r` from `\r\n`.
+ */
+int imap_read_literal_buffer(struct Buffer *buf, struct ImapAccountData *adata,
+                             unsigned long bytes)
+{
+  mutt_debug(LL_DEBUG2, "reading %ld bytes\n", bytes);
+
+  const size_t start = mutt_buffer_len(buf);
+  if (mutt_socket_buffer_readn(buf, adata->conn, bytes) < 0)
+  {
+    mutt_debug(LL_DEBUG1, "error during read\n");
+    adata->status = IMAP_FATAL;
+    return -1;
+  }
+
+  /* Squeeze out the \r of each \r\n, in place */
+  char *src = buf->data + start;
+  char *dst = src;
+  char *end = buf->dptr;
+  while (src < end)
+  {
+    char *cr = memchr(src, '\r', end - src);
+    if (!cr)
+      cr = end;
+    if (dst != src)
+      memmove(dst, src, cr - src);
+    dst += cr - src;
+    src = cr;
+    if (src < end)
+    {
+      if (((src + 1) < end) && (src[1] != '\n'))
+        *dst++ = '\r';
+      src++;
+    }
+  }
+  buf->dptr = dst;
+  *dst = '\0';
+
+  mutt_debug(IMAP_LOG_LTRL, "\n%s", buf->data + start);
+  return 0;
+}
+
 /**
  * imap_notify_delete_email - Inform IMAP that an Email has been deleted
  * @param m Mailbox
@@ -394,14 +394,15 @@ static int msg_parse_fetch(struct ImapHeader *h, char *s)
  * @param m   Mailbox
  * @param ih  ImapHeader
  * @param buf Server string containing FETCH response
- * @param fp  Connection to server
+ * @param hdr Buffer for the header literal, may be NULL
  * @retval  0 Success
  * @retval -1 String is not a fetch response
  * @retval -2 String is a corrupt fetch response
  *
  * Expects string beginning with * n FETCH.
  */
-static int msg_fetch_header(struct Mailbox *m, struct ImapHeader *ih, char *buf, FILE *fp)
+static int msg_fetch_header(struct Mailbox *m, struct ImapHeader *ih, char *buf,
+                            struct Buffer *hdr)
 {
   int rc = -1; /* default now is that string isn't FETCH response */
 
@@ -431,13 +432,14 @@ static int msg_fetch_header(struct Mailbox *m, struct ImapHeader *ih, char *buf,
   int parse_rc = msg_parse_fetch(ih, buf);
   if (parse_rc == 0)
     return 0;
-  if ((parse_rc != -2) || !fp)
+  if ((parse_rc != -2) || !hdr)
     return rc;
 
   unsigned int bytes = 0;
   if (imap_get_literal_count(buf, &bytes) == 0)
   {
-    imap_read_literal(fp, adata, bytes, NULL);
+    if (imap_read_literal_buffer(hdr, adata, bytes) < 0)
+      return rc;
 
     /* we may have other fields of the FETCH _after_ the literal
      * (eg Domino puts FLAGS here). Nothing wrong with that, either.
@@ -939,6 +941,8 @@ static int read_headers_condstore_qresync_updates(struct ImapAccountData *adata,
     imap_expunge_mailbox(m);
 
     imap_hcache_open(adata, mdata);
+    if (mdata->hcache)
+      mdata->hcache->slab = m->slab;
     mdata->reopen &= ~IMAP_EXPUNGE_PENDING;
   }
 
@@ -1043,10 +1047,9 @@ static int read_headers_fetch_new(struct Mailbox *m, unsigned int msn_begin,
   unsigned int fetch_msn_end = 0;
   struct Progress progress;
   char *hdrreq = NULL;
-  struct Buffer *tempfile = NULL;
-  FILE *fp = NULL;
   struct ImapHeader h;
   struct Buffer *buf = NULL;
+  struct Buffer hdr = mutt_buffer_make(0);
   static const char *const want_headers =
       "DATE FROM SENDER SUBJECT TO CC MESSAGE-ID REFERENCES CONTENT-TYPE "
       "CONTENT-DESCRIPTION IN-REPLY-TO REPLY-TO LINES LIST-POST X-LABEL "
@@ -1094,17 +1097,9 @@ static int read_headers_fetch_new(struct Mailbox *m, unsigned int msn_begin,
   mutt_buffer_pool_release(&hdr_list);
 
   /* instead of downloading all headers and then parsing them, we parse them
-   * as they come in. */
-  tempfile = mutt_buffer_pool_get();
-  mutt_buffer_mktemp(tempfile);
-  fp = mutt_file_fopen(mutt_buffer_string(tempfile), "w+");
-  if (!fp)
-  {
-    mutt_error(_("Could not create temporary file %s"), mutt_buffer_string(tempfile));
-    goto bail;
-  }
-  unlink(mutt_buffer_string(tempfile));
-  mutt_buffer_pool_release(&tempfile);
+   * as they come in.  Each header is read into the same Buffer, which is
+   * parsed straight from memory. */
+  mutt_buffer_alloc(&hdr, 4096);
 
   if (m->verbose)
   {
@@ -1114,6 +1109,11 @@ static int read_headers_fetch_new(struct Mailbox *m, unsigned int msn_begin,
 
   buf = mutt_buffer_pool_get();
 
+#ifdef USE_HCACHE
+  /* group the new headers into a few large transactions */
+  mutt_hcache_begin(mdata->hcache);
+#endif
+
   /* NOTE:
    *   The (fetch_msn_end < msn_end) used to be important to prevent
    *   an infinite loop, in the event the server did not return all
@@ -1142,7 +1142,9 @@ static int read_headers_fetch_new(struct Mailbox *m, unsigned int msn_begin,
       if (m->verbose)
         mutt_progress_update(&progress, msgno, -1);
 
-      rewind(fp);
+      /* Don't clear the whole Buffer, it's reused for every header */
+      mutt_buffer_seek(&hdr, 0);
+      *hdr.dptr = '\0';
       memset(&h, 0, sizeof(h));
       h.edata = imap_edata_new();
 
@@ -1155,19 +1157,16 @@ static int read_headers_fetch_new(struct Mailbox *m, unsigned int msn_begin,
         if (rc != IMAP_RES_CONTINUE)
           break;
 
-        mfhrc = msg_fetch_header(m, &h, adata->buf, fp);
+        mfhrc = msg_fetch_header(m, &h, adata->buf, &hdr);
         if (mfhrc < 0)
           continue;
 
-        if (!ftello(fp))
+        if (mutt_buffer_is_empty(&hdr))
         {
           mutt_debug(LL_DEBUG2, "ignoring fetch response with no body\n");
           continue;
         }
 
-        /* make sure we don't get remnants from older larger message headers */
-        fputs("\n\n", fp);
-
         if ((h.edata->msn < 1) || (h.edata->msn > fetch_msn_end))
         {
           mutt_debug(LL_DEBUG1, "skipping FETCH response for unknown message number %d\n",
@@ -1183,7 +1182,7 @@ static int read_headers_fetch_new(struct Mailbox *m, unsigned int msn_begin,
           continue;
         }
 
-        struct Email *e = email_new();
+        struct Email *e = email_new_slab(m->slab);
         m->emails[idx] = e;
 
         imap_msn_set(&mdata->msn, h.edata->msn - 1, e);
@@ -1212,11 +1211,10 @@ static int read_headers_fetch_new(struct Mailbox *m, unsigned int msn_begin,
         if (*maxuid < h.edata->uid)
           *maxuid = h.edata->uid;
 
-        rewind(fp);
         /* NOTE: if Date: header is missing, mutt_rfc822_read_header depends
          *   on h.received being set */
-        e->env = mutt_rfc822_read_header(fp, e, false, false);
-        /* body built as a side-effect of mutt_rfc822_read_header */
+        e->env = mutt_rfc822_read_header_mem(hdr.data, mutt_buffer_len(&hdr), e, false, false);
+        /* body built as a side-effect of mutt_rfc822_read_header_mem */
         e->body->length = h.content_length;
         mailbox_size_add(m, e);
 
@@ -1262,10 +1260,12 @@ static int read_headers_fetch_new(struct Mailbox *m, unsigned int msn_begin,
   retval = 0;
 
 bail:
+#ifdef USE_HCACHE
+  mutt_hcache_commit(mdata->hcache);
+#endif
   mutt_buffer_pool_release(&hdr_list);
   mutt_buffer_pool_release(&buf);
-  mutt_buffer_pool_release(&tempfile);
-  mutt_file_fclose(&fp);
+  mutt_buffer_dealloc(&hdr);
   FREE(&hdrreq);
 
   return retval;
@@ -1326,6 +1326,8 @@ retry:
 
 #ifdef USE_HCACHE
   imap_hcache_open(adata, mdata);
+  if (mdata->hcache)
+    mdata->hcache->slab = m->slab;
 
   if (mdata->hcache && initial_download)
   {
@@ -472,8 +472,13 @@ static void update_index_threaded(struct Context *ctx, enum MxStatus check, int
   /* Sort first to thread the new messages, because some patterns
    * require the threading information.
    *
-   * If the mailbox was reopened, need to rethread from scratch. */
-  mutt_sort_headers(m, ctx->threads, (check == MX_STATUS_REOPENED), &ctx->vsize);
+   * If the mailbox was reopened, need to rethread from scratch.
+   * If the new mail has already been threaded by ctx_update(), there's nothing to do. */
+  if ((check != MX_STATUS_NEW_MAIL) || (num_new == 0) ||
+      (mutt_thread_first_new(ctx->threads) != m->msg_count))
+  {
+    mutt_sort_headers(m, ctx->threads, (check == MX_STATUS_REOPENED), &ctx->vsize);
+  }
 
   if (lmt)
   {
@@ -841,8 +846,80 @@ static void change_folder_string(struct Menu *menu, char *buf, size_t buflen,
   change_folder_mailbox(menu, m, oldcount, shared, read_only);
 }
 
+/// Generation of the cached index lines, see index_invalidate_lines()
+static unsigned int IndexLineGen = 1;
+
+/**
+ * index_invalidate_lines - Forget the cached lines of the index
+ *
+ * This is called for anything, e.g. a config change or a command, that might
+ * change the lines of the index without marking the Emails as changed.
+ */
+void index_invalidate_lines(void)
+{
+  IndexLineGen++;
+  if (IndexLineGen == 0)
+    IndexLineGen = 1;
+}
+
+/**
+ * index_format_cacheable - Can the lines of an index format be cached?
+ * @param fmt Format string, e.g. $index_format
+ * @retval true The lines only depend on the Emails
+ *
+ * The lines can't be cached if they depend on the current time (`%<`, or the
+ * relative dates of `%?[` and `%?(`), on the `index-format-hook` patterns
+ * (`%@`), or on the output of a filter.
+ */
+static bool index_format_cacheable(const char *fmt)
+{
+  if (!fmt)
+    return false;
+
+  for (const char *p = fmt; *p; p++)
+  {
+    if (*p == '\\')
+    {
+      if (p[1] != '\0')
+        p++;
+      continue;
+    }
+
+    if (*p == '|')
+    {
+      if (p[1] == '\0')
+        return false; /* filter */
+      continue;
+    }
+
+    if (*p != '%')
+      continue;
+
+    p++;
+    if (*p == '%')
+      continue;
+
+    const bool optional = (*p == '?');
+    if (optional)
+      p++;
+    while (*p && (strchr("-0123456789.=_*", *p)))
+      p++;
+
+    if ((*p == '<') || (*p == '@') || (optional && ((*p == '[') || (*p == '('))))
+      return false;
+    if (*p == '\0')
+      break;
+  }
+
+  return true;
+}
+
 /**
  * index_make_entry - Format a menu item for the index list - Implements Menu::make_entry()
+ *
+ * The line is cached in the Email, until the Email changes, see
+ * mutt_set_header_color(), or the index is invalidated, see
+ * index_invalidate_lines().
  */
 void index_make_entry(struct Menu *menu, char *buf, size_t buflen, int line)
 {
@@ -862,7 +939,7 @@ void index_make_entry(struct Menu *menu, char *buf, size_t buflen, int line)
   struct MuttThread *tmp = NULL;
 
   const short c_sort = cs_subset_sort(shared->sub, "sort");
-  if (((c_sort & SORT_MASK) == SORT_THREADS) && e->tree)
+  if (((c_sort & SORT_MASK) == SORT_THREADS) && mutt_thread_tree(e))
   {
     flags |= MUTT_FORMAT_TREE; /* display the thread tree */
     if (e->display_subject)
@@ -918,8 +995,29 @@ void index_make_entry(struct Menu *menu, char *buf, size_t buflen, int line)
 
   const char *const c_index_format =
       cs_subset_string(shared->sub, "index_format");
-  mutt_make_string(buf, buflen, menu->win_index->state.cols, NONULL(c_index_format),
-                   m, shared->ctx->msg_in_pager, e, flags, NULL);
+  const int cols = menu->win_index->state.cols;
+
+  /* The message in the pager is shown differently */
+  const bool cache = (shared->ctx->msg_in_pager != e->msgno) &&
+                     index_format_cacheable(c_index_format);
+
+  if (cache && e->index_line && (e->index_line_gen == IndexLineGen) &&
+      (e->index_line_cols == cols) && (e->index_line_flags == flags))
+  {
+    mutt_str_copy(buf, e->index_line, buflen);
+    return;
+  }
+
+  mutt_make_string(buf, buflen, cols, NONULL(c_index_format), m,
+                   shared->ctx->msg_in_pager, e, flags, NULL);
+
+  if (cache)
+  {
+    mutt_str_replace(&e->index_line, buf);
+    e->index_line_gen = IndexLineGen;
+    e->index_line_cols = cols;
+    e->index_line_flags = flags;
+  }
 }
 
 /**
@@ -936,7 +1034,7 @@ int index_color(struct Menu *menu, int line)
   if (!e)
     return 0;
 
-  if (e->pair)
+  if (e->pair && !e->pair_stale)
     return e->pair;
 
   mutt_set_header_color(m, e);
@@ -1134,6 +1232,40 @@ static void index_custom_redraw(struct Menu *menu)
   menu->redraw = REDRAW_NO_FLAGS;
 }
 
+/**
+ * op_is_motion - Does an operation only move around the index?
+ * @param op Operation, e.g. OP_NEXT_PAGE
+ * @retval true The operation doesn't change any Emails
+ */
+static bool op_is_motion(int op)
+{
+  switch (op)
+  {
+    case OP_BOTTOM_PAGE:
+    case OP_CURRENT_BOTTOM:
+    case OP_CURRENT_MIDDLE:
+    case OP_CURRENT_TOP:
+    case OP_FIRST_ENTRY:
+    case OP_HALF_DOWN:
+    case OP_HALF_UP:
+    case OP_LAST_ENTRY:
+    case OP_MAIN_NEXT_UNDELETED:
+    case OP_MAIN_PREV_UNDELETED:
+    case OP_MIDDLE_PAGE:
+    case OP_NEXT_ENTRY:
+    case OP_NEXT_LINE:
+    case OP_NEXT_PAGE:
+    case OP_PREV_ENTRY:
+    case OP_PREV_LINE:
+    case OP_PREV_PAGE:
+    case OP_REDRAW:
+    case OP_TOP_PAGE:
+      return true;
+    default:
+      return false;
+  }
+}
+
 /**
  * mutt_index_menu - Display a list of emails
  * @param dlg Dialog containing Windows to draw on
@@ -1224,6 +1356,7 @@ struct Mailbox *mutt_index_menu(struct MuttWindow *dlg, struct Mailbox *m_init)
           ((c_sort & SORT_MASK) == SORT_THREADS))
       {
         mutt_draw_tree(shared->ctx->threads);
+        index_invalidate_lines();
         priv->menu->redraw |= REDRAW_STATUS;
         OptRedrawTree = false;
       }
@@ -1255,6 +1388,8 @@ struct Mailbox *mutt_index_menu(struct MuttWindow *dlg, struct Mailbox *m_init)
       else if ((check == MX_STATUS_NEW_MAIL) || (check == MX_STATUS_REOPENED) ||
                (check == MX_STATUS_FLAGS))
       {
+        index_invalidate_lines();
+
         /* notify the user of new mail */
         if (check == MX_STATUS_REOPENED)
         {
@@ -1404,6 +1539,7 @@ struct Mailbox *mutt_index_menu(struct MuttWindow *dlg, struct Mailbox *m_init)
       if (op < 0)
       {
         mutt_timeout_hook();
+        index_invalidate_lines();
         if (priv->tag)
           mutt_window_clearline(MessageWindow, 0);
         continue;
@@ -1463,6 +1599,10 @@ struct Mailbox *mutt_index_menu(struct MuttWindow *dlg, struct Mailbox *m_init)
     nm_db_debug_check(shared->mailbox);
 #endif
 
+    /* Anything but moving around may change the lines of the index */
+    if (!op_is_motion(op))
+      index_invalidate_lines();
+
     switch (op)
     {
         /* ----------------------------------------------------------------------
@@ -4148,29 +4288,69 @@ struct Mailbox *mutt_index_menu(struct MuttWindow *dlg, struct Mailbox *m_init)
   return m;
 }
 
+/**
+ * mutt_header_color_stale - Choose the colour of a message again, later
+ * @param e    Email
+ * @param deps Inputs of the colour rules that have changed, e.g. #PAT_DEP_FLAGS
+ *
+ * The colour will be selected, by mutt_set_header_color(), when the message
+ * is next displayed, see index_color().  Changing many Emails at once, e.g.
+ * tagging by pattern, only costs the colour rules of the ones on screen.
+ */
+void mutt_header_color_stale(struct Email *e, uint8_t deps)
+{
+  if (!e)
+    return;
+
+  e->pair_stale |= deps;
+  FREE(&e->index_line);
+}
+
 /**
  * mutt_set_header_color - Select a colour for a message
  * @param m Mailbox
  * @param e Current Email
+ *
+ * If the Email already has a colour, only the rules that depend on
+ * Email::pair_stale are matched again.  The earlier rules that didn't match,
+ * and the rule that did, keep their results.
  */
 void mutt_set_header_color(struct Mailbox *m, struct Email *e)
 {
   if (!e)
     return;
 
+  const PatternDeps stale = e->pair ? e->pair_stale : PAT_DEP_ALL;
+  const int prev = e->pair_rule;
+  e->pair_stale = PAT_DEP_NO_FLAGS;
+
+  /* Whatever changed the colour may change the index line, too */
+  if (stale)
+    FREE(&e->index_line);
+
   struct ColorLine *color = NULL;
   struct PatternCache cache = { 0 };
+  int rule = 0;
 
   STAILQ_FOREACH(color, &Colors->index_list, entries)
   {
-    if (mutt_pattern_exec(SLIST_FIRST(color->color_pattern),
-                          MUTT_MATCH_FULL_ADDRESS, m, e, &cache))
+    bool match;
+    if ((rule <= prev) && !(color->color_deps & stale))
+      match = (rule == prev);
+    else
+      match = mutt_pattern_exec(SLIST_FIRST(color->color_pattern),
+                                MUTT_MATCH_FULL_ADDRESS, m, e, &cache);
+
+    if (match)
     {
       e->pair = color->pair;
+      e->pair_rule = rule;
       return;
     }
+    rule++;
   }
   e->pair = Colors->defs[MT_COLOR_NORMAL];
+  e->pair_rule = rule;
 }
 
 /**
@@ -33,6 +33,7 @@
 #include "email/lib.h"
 #include "core/lib.h"
 #include "gui/lib.h"
+#include "lib.h"
 #include "alternates.h"
 #include "attachments.h"
 #include "options.h"
@@ -172,6 +173,9 @@ static int index_config_observer(struct NotifyCallback *nc)
   struct EventConfig *ec = nc->event_data;
   struct MuttWindow *dlg = nc->global_data;
 
+  /* Almost any config can change the lines of the index */
+  index_invalidate_lines();
+
   if (mutt_str_equal(ec->name, "pager_index_lines"))
     return config_pager_index_lines(dlg);
 
@@ -198,6 +202,7 @@ static int index_subjrx_observer(struct NotifyCallback *nc)
   struct IndexSharedData *shared = dlg->wdata;
 
   subjrx_clear_mods(shared->mailbox);
+  index_invalidate_lines();
   return 0;
 }
 
@@ -215,6 +220,7 @@ static int index_attach_observer(struct NotifyCallback *nc)
   struct IndexSharedData *shared = dlg->wdata;
 
   mutt_attachments_reset(shared->mailbox);
+  index_invalidate_lines();
   return 0;
 }
 
@@ -232,6 +238,7 @@ static int index_altern_observer(struct NotifyCallback *nc)
   struct IndexSharedData *shared = dlg->wdata;
 
   mutt_alternates_reset(shared->mailbox);
+  index_invalidate_lines();
   return 0;
 }
 
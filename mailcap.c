@@ -218,6 +218,312 @@ static int get_field_text(char *field, char **entry, const char *type,
   }
 }
 
+/**
+ * struct MailcapLine - An entry of a mailcap file
+ */
+struct MailcapLine
+{
+  char *fields;             ///< Fields after the type, unparsed
+  int line;                 ///< Line number of the entry
+  int index;                ///< Position of the entry in the file
+  struct MailcapLine *next; ///< Next entry for the same type
+};
+
+/**
+ * struct MailcapFile - A mailcap file, indexed by type
+ */
+struct MailcapFile
+{
+  char *path;                        ///< Path of the file
+  struct FileStamp stamp;            ///< Version of the file that was read
+  struct HashTable *types;           ///< Type -> first MailcapLine for that type
+  STAILQ_ENTRY(MailcapFile) entries; ///< Linked list
+};
+STAILQ_HEAD(MailcapFileList, MailcapFile);
+
+static struct MailcapFileList MailcapFiles = STAILQ_HEAD_INITIALIZER(MailcapFiles);
+
+/**
+ * mailcap_line_free - Free a list of MailcapLines - Implements ::hash_hdata_free_t
+ */
+static void mailcap_line_free(int type, void *obj, intptr_t data)
+{
+  struct MailcapLine *ml = obj;
+  while (ml)
+  {
+    struct MailcapLine *next = ml->next;
+    FREE(&ml->fields);
+    FREE(&ml);
+    ml = next;
+  }
+}
+
+/**
+ * mailcap_file_read - Read and index a mailcap file
+ * @param mf Mailcap file
+ *
+ * The entries are indexed by their type field, e.g. "text/html", "text/\*" or
+ * "text".  Entries with the same type are kept in file order.
+ */
+static void mailcap_file_read(struct MailcapFile *mf)
+{
+  mutt_hash_free(&mf->types);
+  mf->types = mutt_hash_new(64, MUTT_HASH_STRCASECMP | MUTT_HASH_STRDUP_KEYS);
+  mutt_hash_set_destructor(mf->types, mailcap_line_free, 0);
+
+  FILE *fp = fopen(mf->path, "r");
+  if (!fp)
+    return;
+
+  char *buf = NULL;
+  size_t buflen = 0;
+  int line = 0;
+  int index = 0;
+  while ((buf = mutt_file_read_line(buf, &buflen, fp, &line, MUTT_RL_CONT)))
+  {
+    /* ignore comments */
+    if (*buf == '#')
+      continue;
+
+    char *ch = get_field(buf);
+    if (*buf == '\0')
+      continue;
+
+    struct MailcapLine *ml = mutt_mem_calloc(1, sizeof(*ml));
+    ml->fields = mutt_str_dup(ch);
+    ml->line = line;
+    ml->index = index++;
+
+    struct MailcapLine *first = mutt_hash_find(mf->types, buf);
+    if (first)
+    {
+      while (first->next)
+        first = first->next;
+      first->next = ml;
+    }
+    else
+    {
+      mutt_hash_insert(mf->types, buf, ml);
+    }
+  }
+  mutt_file_fclose(&fp);
+  FREE(&buf);
+}
+
+/**
+ * mailcap_file_get - Get the index of a mailcap file
+ * @param path Path of the file
+ * @retval ptr Mailcap file
+ *
+ * The file is only read again if it has changed.
+ */
+static struct MailcapFile *mailcap_file_get(const char *path)
+{
+  struct MailcapFile *mf = NULL;
+  STAILQ_FOREACH(mf, &MailcapFiles, entries)
+  {
+    if (mutt_str_equal(mf->path, path))
+      break;
+  }
+
+  if (!mf)
+  {
+    mf = mutt_mem_calloc(1, sizeof(*mf));
+    mf->path = mutt_str_dup(path);
+    STAILQ_INSERT_TAIL(&MailcapFiles, mf, entries);
+  }
+
+  if (mutt_file_stamp_changed(path, &mf->stamp) || !mf->types)
+    mailcap_file_read(mf);
+
+  return mf;
+}
+
+/**
+ * mailcap_cache_free - Free the index of the mailcap files
+ */
+void mailcap_cache_free(void)
+{
+  struct MailcapFile *mf = NULL, *tmp = NULL;
+  STAILQ_FOREACH_SAFE(mf, &MailcapFiles, entries, tmp)
+  {
+    mutt_hash_free(&mf->types);
+    FREE(&mf->path);
+    FREE(&mf);
+  }
+  STAILQ_INIT(&MailcapFiles);
+}
+
+/**
+ * mailcap_parse_entry - Parse the fields of a mailcap entry
+ * @param a        Email Body
+ * @param ch       Fields after the type (will be modified)
+ * @param filename Mailcap filename
+ * @param line     Mailcap line
+ * @param type     Type, e.g. "text/plain"
+ * @param entry    Entry, e.g. "compose"
+ * @param opt      Option, see #MailcapLookup
+ * @retval true  The entry matches
+ * @retval false The entry doesn't match, e.g. its test failed
+ */
+static bool mailcap_parse_entry(struct Body *a, char *ch, const char *filename, int line,
+                                const char *type, struct MailcapEntry *entry,
+                                enum MailcapLookup opt)
+{
+  /* next field is the viewcommand */
+  char *field = ch;
+  ch = get_field(ch);
+  if (entry)
+    entry->command = mutt_str_dup(field);
+
+  /* parse the optional fields */
+  bool found = true;
+  bool copiousoutput = false;
+  bool composecommand = false;
+  bool editcommand = false;
+  bool printcommand = false;
+
+  while (ch)
+  {
+    field = ch;
+    ch = get_field(ch);
+    mutt_debug(LL_DEBUG2, "field: %s\n", field);
+    size_t plen;
+
+    if (mutt_istr_equal(field, "needsterminal"))
+    {
+      if (entry)
+        entry->needsterminal = true;
+    }
+    else if (mutt_istr_equal(field, "copiousoutput"))
+    {
+      copiousoutput = true;
+      if (entry)
+        entry->copiousoutput = true;
+    }
+    else if ((plen = mutt_istr_startswith(field, "composetyped")))
+    {
+      /* this compare most occur before compose to match correctly */
+      if (get_field_text(field + plen, entry ? &entry->composetypecommand : NULL,
+                         type, filename, line))
+      {
+        composecommand = true;
+      }
+    }
+    else if ((plen = mutt_istr_startswith(field, "compose")))
+    {
+      if (get_field_text(field + plen, entry ? &entry->composecommand : NULL,
+                         type, filename, line))
+      {
+        composecommand = true;
+      }
+    }
+    else if ((plen = mutt_istr_startswith(field, "print")))
+    {
+      if (get_field_text(field + plen, entry ? &entry->printcommand : NULL,
+                         type, filename, line))
+      {
+        printcommand = true;
+      }
+    }
+    else if ((plen = mutt_istr_startswith(field, "edit")))
+    {
+      if (get_field_text(field + plen, entry ? &entry->editcommand : NULL,
+                         type, filename, line))
+        editcommand = true;
+    }
+    else if ((plen = mutt_istr_startswith(field, "nametemplate")))
+    {
+      get_field_text(field + plen, entry ? &entry->nametemplate : NULL,
+                     type, filename, line);
+    }
+    else if ((plen = mutt_istr_startswith(field, "x-convert")))
+    {
+      get_field_text(field + plen, entry ? &entry->convert : NULL, type, filename, line);
+    }
+    else if ((plen = mutt_istr_startswith(field, "test")))
+    {
+      /* This routine executes the given test command to determine
+       * if this is the right entry.  */
+      char *test_command = NULL;
+
+      if (get_field_text(field + plen, &test_command, type, filename, line) && test_command)
+      {
+        struct Buffer *command = mutt_buffer_pool_get();
+        struct Buffer *afilename = mutt_buffer_pool_get();
+        mutt_buffer_strcpy(command, test_command);
+        const bool c_mailcap_sanitize =
+            cs_subset_bool(NeoMutt->sub, "mailcap_sanitize");
+        if (c_mailcap_sanitize)
+          mutt_buffer_sanitize_filename(afilename, NONULL(a->filename), true);
+        else
+          mutt_buffer_strcpy(afilename, NONULL(a->filename));
+        mailcap_expand_command(a, mutt_buffer_string(afilename), type, command);
+        if (mutt_system(mutt_buffer_string(command)))
+        {
+          /* a non-zero exit code means test failed */
+          found = false;
+        }
+        FREE(&test_command);
+        mutt_buffer_pool_release(&command);
+        mutt_buffer_pool_release(&afilename);
+      }
+    }
+    else if (mutt_istr_startswith(field, "x-neomutt-keep"))
+    {
+      if (entry)
+        entry->xneomuttkeep = true;
+    }
+    else if (mutt_istr_startswith(field, "x-neomutt-nowrap"))
+    {
+      if (entry)
+        entry->xneomuttnowrap = true;
+      a->nowrap = true;
+    }
+  } /* while (ch) */
+
+  if (opt == MUTT_MC_AUTOVIEW)
+  {
+    if (!copiousoutput)
+      found = false;
+  }
+  else if (opt == MUTT_MC_COMPOSE)
+  {
+    if (!composecommand)
+      found = false;
+  }
+  else if (opt == MUTT_MC_EDIT)
+  {
+    if (!editcommand)
+      found = false;
+  }
+  else if (opt == MUTT_MC_PRINT)
+  {
+    if (!printcommand)
+      found = false;
+  }
+
+  if (!found)
+  {
+    /* reset */
+    if (entry)
+    {
+      FREE(&entry->command);
+      FREE(&entry->composecommand);
+      FREE(&entry->composetypecommand);
+      FREE(&entry->editcommand);
+      FREE(&entry->printcommand);
+      FREE(&entry->nametemplate);
+      FREE(&entry->convert);
+      entry->needsterminal = false;
+      entry->copiousoutput = false;
+      entry->xneomuttkeep = false;
+    }
+  }
+
+  return found;
+}
+
 /**
  * rfc1524_mailcap_parse - Parse a mailcap entry
  * @param a        Email Body
@@ -231,9 +537,7 @@ static int get_field_text(char *field, char **entry, const char *type,
 static bool rfc1524_mailcap_parse(struct Body *a, const char *filename, const char *type,
                                   struct MailcapEntry *entry, enum MailcapLookup opt)
 {
-  char *buf = NULL;
   bool found = false;
-  int line = 0;
 
   /* rfc1524 mailcap file is of the format:
    * base/type; command; extradefs
@@ -251,180 +555,43 @@ static bool rfc1524_mailcap_parse(struct Body *a, const char *filename, const ch
     return false;
   const int btlen = ch - type;
 
-  FILE *fp = fopen(filename, "r");
-  if (fp)
+  /* The entries for the type, its base type (implicit wild) and the
+   * wildsubtype are merged, in file order */
+  char base[256];
+  char wild[256];
+  snprintf(base, sizeof(base), "%.*s", btlen, type);
+  snprintf(wild, sizeof(wild), "%.*s/*", btlen, type);
+
+  struct MailcapFile *mf = mailcap_file_get(filename);
+  struct MailcapLine *cands[3] = {
+    mutt_hash_find(mf->types, type),
+    mutt_hash_find(mf->types, base),
+    mutt_hash_find(mf->types, wild),
+  };
+
+  while (!found)
   {
-    size_t buflen;
-    while (!found && (buf = mutt_file_read_line(buf, &buflen, fp, &line, MUTT_RL_CONT)))
+    struct MailcapLine *ml = NULL;
+    for (size_t i = 0; i < mutt_array_size(cands); i++)
     {
-      /* ignore comments */
-      if (*buf == '#')
-        continue;
-      mutt_debug(LL_DEBUG2, "mailcap entry: %s\n", buf);
-
-      /* check type */
-      ch = get_field(buf);
-      if (!mutt_istr_equal(buf, type) && (!mutt_istrn_equal(buf, type, btlen) ||
-                                          ((buf[btlen] != '\0') && /* implicit wild */
-                                           !mutt_str_equal(buf + btlen, "/*")))) /* wildsubtype */
-      {
-        continue;
-      }
-
-      /* next field is the viewcommand */
-      char *field = ch;
-      ch = get_field(ch);
-      if (entry)
-        entry->command = mutt_str_dup(field);
-
-      /* parse the optional fields */
-      found = true;
-      bool copiousoutput = false;
-      bool composecommand = false;
-      bool editcommand = false;
-      bool printcommand = false;
-
-      while (ch)
-      {
-        field = ch;
-        ch = get_field(ch);
-        mutt_debug(LL_DEBUG2, "field: %s\n", field);
-        size_t plen;
+      if (cands[i] && (!ml || (cands[i]->index < ml->index)))
+        ml = cands[i];
+    }
+    if (!ml)
+      break;
 
-        if (mutt_istr_equal(field, "needsterminal"))
-        {
-          if (entry)
-            entry->needsterminal = true;
-        }
-        else if (mutt_istr_equal(field, "copiousoutput"))
-        {
-          copiousoutput = true;
-          if (entry)
-            entry->copiousoutput = true;
-        }
-        else if ((plen = mutt_istr_startswith(field, "composetyped")))
-        {
-          /* this compare most occur before compose to match correctly */
-          if (get_field_text(field + plen, entry ? &entry->composetypecommand : NULL,
-                             type, filename, line))
-          {
-            composecommand = true;
-          }
-        }
-        else if ((plen = mutt_istr_startswith(field, "compose")))
-        {
-          if (get_field_text(field + plen, entry ? &entry->composecommand : NULL,
-                             type, filename, line))
-          {
-            composecommand = true;
-          }
-        }
-        else if ((plen = mutt_istr_startswith(field, "print")))
-        {
-          if (get_field_text(field + plen, entry ? &entry->printcommand : NULL,
-                             type, filename, line))
-          {
-            printcommand = true;
-          }
-        }
-        else if ((plen = mutt_istr_startswith(field, "edit")))
-        {
-          if (get_field_text(field + plen, entry ? &entry->editcommand : NULL,
-                             type, filename, line))
-            editcommand = true;
-        }
-        else if ((plen = mutt_istr_startswith(field, "nametemplate")))
-        {
-          get_field_text(field + plen, entry ? &entry->nametemplate : NULL,
-                         type, filename, line);
-        }
-        else if ((plen = mutt_istr_startswith(field, "x-convert")))
-        {
-          get_field_text(field + plen, entry ? &entry->convert : NULL, type, filename, line);
-        }
-        else if ((plen = mutt_istr_startswith(field, "test")))
-        {
-          /* This routine executes the given test command to determine
-           * if this is the right entry.  */
-          char *test_command = NULL;
-
-          if (get_field_text(field + plen, &test_command, type, filename, line) && test_command)
-          {
-            struct Buffer *command = mutt_buffer_pool_get();
-            struct Buffer *afilename = mutt_buffer_pool_get();
-            mutt_buffer_strcpy(command, test_command);
-            const bool c_mailcap_sanitize =
-                cs_subset_bool(NeoMutt->sub, "mailcap_sanitize");
-            if (c_mailcap_sanitize)
-              mutt_buffer_sanitize_filename(afilename, NONULL(a->filename), true);
-            else
-              mutt_buffer_strcpy(afilename, NONULL(a->filename));
-            mailcap_expand_command(a, mutt_buffer_string(afilename), type, command);
-            if (mutt_system(mutt_buffer_string(command)))
-            {
-              /* a non-zero exit code means test failed */
-              found = false;
-            }
-            FREE(&test_command);
-            mutt_buffer_pool_release(&command);
-            mutt_buffer_pool_release(&afilename);
-          }
-        }
-        else if (mutt_istr_startswith(field, "x-neomutt-keep"))
-        {
-          if (entry)
-            entry->xneomuttkeep = true;
-        }
-        else if (mutt_istr_startswith(field, "x-neomutt-nowrap"))
-        {
-          if (entry)
-            entry->xneomuttnowrap = true;
-          a->nowrap = true;
-        }
-      } /* while (ch) */
+    for (size_t i = 0; i < mutt_array_size(cands); i++)
+    {
+      if (cands[i] == ml)
+        cands[i] = ml->next;
+    }
 
-      if (opt == MUTT_MC_AUTOVIEW)
-      {
-        if (!copiousoutput)
-          found = false;
-      }
-      else if (opt == MUTT_MC_COMPOSE)
-      {
-        if (!composecommand)
-          found = false;
-      }
-      else if (opt == MUTT_MC_EDIT)
-      {
-        if (!editcommand)
-          found = false;
-      }
-      else if (opt == MUTT_MC_PRINT)
-      {
-        if (!printcommand)
-          found = false;
-      }
+    char *fields = mutt_str_dup(ml->fields);
+    mutt_debug(LL_DEBUG2, "mailcap entry: %s; %s\n", type, NONULL(fields));
+    found = mailcap_parse_entry(a, fields, filename, ml->line, type, entry, opt);
+    FREE(&fields);
+  }
 
-      if (!found)
-      {
-        /* reset */
-        if (entry)
-        {
-          FREE(&entry->command);
-          FREE(&entry->composecommand);
-          FREE(&entry->composetypecommand);
-          FREE(&entry->editcommand);
-          FREE(&entry->printcommand);
-          FREE(&entry->nametemplate);
-          FREE(&entry->convert);
-          entry->needsterminal = false;
-          entry->copiousoutput = false;
-          entry->xneomuttkeep = false;
-        }
-      }
-    } /* while (!found && (buf = mutt_file_read_line ())) */
-    mutt_file_fclose(&fp);
-  } /* if ((fp = fopen ())) */
-  FREE(&buf);
   return found;
 }
 
@@ -44,6 +44,9 @@ static struct ConfigDef MaildirVars[] = {
     "Check for maildir changes when opening mailbox"
   },
 #endif
+  { "maildir_read_threads", DT_NUMBER|DT_NOT_NEGATIVE, 0, 0, NULL,
+    "(maildir,mh) Number of threads used to read messages (0 = one per CPU)"
+  },
   { "maildir_trash", DT_BOOL, false, 0, NULL,
     "Use the maildir 'trashed' flag, rather than deleting"
   },
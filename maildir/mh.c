@@ -520,7 +520,7 @@ int mh_parse_dir(struct Mailbox *m, struct MdEmailArray *mda, struct Progress *p
     /* FOO - really ignore the return value? */
     mutt_debug(LL_DEBUG2, "queueing %s\n", de->d_name);
 
-    e = email_new();
+    e = email_new_slab(m->slab);
     e->edata = maildir_edata_new();
     e->edata_free = maildir_edata_free;
 
@@ -558,112 +558,112 @@ int mh_cmp_path(const void *a, const void *b)
   return strcmp((*pa)->email->path, (*pb)->email->path);
 }
 
-/**
- * mh_parse_message - Actually parse an MH message
- * @param fname  Message filename
- * @param e      Email to populate (OPTIONAL)
- * @retval ptr Populated Email
- *
- * This may also be used to fill out a fake header structure generated by lazy
- * maildir parsing.
- */
-struct Email *mh_parse_message(const char *fname, struct Email *e)
-{
-  FILE *fp = fopen(fname, "r");
-  if (!fp)
-    return NULL;
-
-  if (!e)
-  {
-    e = email_new();
-    e->edata = maildir_edata_new();
-    e->edata_free = maildir_edata_free;
-  }
-  e->env = mutt_rfc822_read_header(fp, e, false, false);
-
-  struct stat st;
-  fstat(fileno(fp), &st);
-
-  if (!e->received)
-    e->received = e->date_sent;
-
-  /* always update the length since we have fresh information available. */
-  e->body->length = st.st_size - e->body->offset;
-  e->index = -1;
-
-  mutt_file_fclose(&fp);
-  return e;
-}
-
 /**
  * mh_delayed_parsing - This function does the second parsing pass
  * @param[in]  m   Mailbox
  * @param[out] mda Maildir array to parse
  * @param[in]  progress Progress bar
+ *
+ * The Emails are first looked up in the header cache.  Any that are missing
+ * are then parsed from their files.  In both passes, the file operations are
+ * performed on worker threads, see $maildir_read_threads.
  */
 void mh_delayed_parsing(struct Mailbox *m, struct MdEmailArray *mda, struct Progress *progress)
 {
   char fn[PATH_MAX];
+  size_t done = 0;
+  struct MdReadahead *ra = NULL;
+  struct MdEmail *md = NULL;
+  struct MdEmail **mdp = NULL;
+
+  const short c_maildir_read_threads =
+      cs_subset_number(NeoMutt->sub, "maildir_read_threads");
 
 #ifdef USE_HCACHE
   const char *const c_header_cache =
       cs_subset_path(NeoMutt->sub, "header_cache");
   struct HeaderCache *hc = mutt_hcache_open(c_header_cache, mailbox_path(m), NULL);
-#endif
 
-  struct MdEmail *md = NULL;
-  struct MdEmail **mdp = NULL;
-  ARRAY_FOREACH(mdp, mda)
+  if (hc)
   {
-    md = *mdp;
-    if (!md || !md->email || md->header_parsed)
-      continue;
-
-    if (m->verbose && progress)
-      mutt_progress_update(progress, ARRAY_FOREACH_IDX, -1);
-
-    snprintf(fn, sizeof(fn), "%s/%s", mailbox_path(m), md->email->path);
-
-#ifdef USE_HCACHE
-    struct stat lastchanged = { 0 };
-    int rc = 0;
+    hc->slab = m->slab;
     const bool c_maildir_header_cache_verify =
         cs_subset_bool(NeoMutt->sub, "maildir_header_cache_verify");
     if (c_maildir_header_cache_verify)
+      ra = maildir_readahead_new(m, mda, MD_READ_STAT, c_maildir_read_threads);
+
+    ARRAY_FOREACH(mdp, mda)
     {
-      rc = stat(fn, &lastchanged);
-    }
+      md = *mdp;
+      if (!md || !md->email || md->header_parsed)
+        continue;
 
-    const char *key = md->email->path;
-    size_t keylen = strlen(key);
-    struct HCacheEntry hce = mutt_hcache_fetch(hc, key, keylen, 0);
+      struct stat lastchanged = { 0 };
+      int rc = 0;
+      if (ra)
+        rc = maildir_readahead_stat(ra, ARRAY_FOREACH_IDX, &lastchanged);
+
+      const char *key = md->email->path;
+      size_t keylen = strlen(key);
+      struct HCacheEntry hce = mutt_hcache_fetch(hc, key, keylen, 0);
+
+      if (!hce.email || (rc != 0) || (lastchanged.st_mtime > hce.uidvalidity))
+      {
+        email_free(&hce.email);
+        continue;
+      }
+
+      if (m->verbose && progress)
+        mutt_progress_update(progress, done++, -1);
 
-    if (hce.email && (rc == 0) && (lastchanged.st_mtime <= hce.uidvalidity))
-    {
       hce.email->edata = maildir_edata_new();
       hce.email->edata_free = maildir_edata_free;
       hce.email->old = md->email->old;
       hce.email->path = mutt_str_dup(md->email->path);
       email_free(&md->email);
       md->email = hce.email;
+      md->header_parsed = true;
     }
-    else
+    maildir_readahead_free(&ra);
+  }
+#endif
+
+#ifdef USE_HCACHE
+  /* group the new headers into a few large transactions */
+  mutt_hcache_begin(hc);
 #endif
+
+  ra = maildir_readahead_new(m, mda, MD_READ_OPEN, c_maildir_read_threads);
+  ARRAY_FOREACH(mdp, mda)
+  {
+    md = *mdp;
+    if (!md || !md->email || md->header_parsed)
+      continue;
+
+    if (m->verbose && progress)
+      mutt_progress_update(progress, done++, -1);
+
+    snprintf(fn, sizeof(fn), "%s/%s", mailbox_path(m), md->email->path);
+    FILE *fp = maildir_readahead_fp(ra, ARRAY_FOREACH_IDX);
+    if (!fp)
+      fp = fopen(fn, "r");
+    if (fp && maildir_parse_stream(MUTT_MH, fp, fn, false, md->email))
     {
-      if (mh_parse_message(fn, md->email))
-      {
-        md->header_parsed = true;
+      md->header_parsed = true;
 #ifdef USE_HCACHE
-        key = md->email->path;
-        keylen = strlen(key);
-        mutt_hcache_store(hc, key, keylen, md->email, 0);
+      const char *key = md->email->path;
+      size_t keylen = strlen(key);
+      mutt_hcache_store(hc, key, keylen, md->email, 0);
 #endif
-      }
-      else
-        email_free(&md->email);
     }
+    else
+      email_free(&md->email);
+    mutt_file_fclose(&fp);
   }
+  maildir_readahead_free(&ra);
+
 #ifdef USE_HCACHE
+  mutt_hcache_commit(hc);
   mutt_hcache_close(hc);
 #endif
 
@@ -764,6 +764,7 @@ int mh_sync_mailbox_message(struct Mailbox *m, int msgno, struct HeaderCache *hc
         const char *key = e->path;
         size_t keylen = strlen(key);
         mutt_hcache_delete_record(hc, key, keylen);
+        mutt_hcache_delete_body_index(hc, key, keylen);
       }
 #endif
       unlink(path);
@@ -28,10 +28,25 @@
 #include <sys/types.h>
 
 struct MdEmailArray;
+struct MdReadahead;
 struct Mailbox;
+struct stat;
 
-int    maildir_move_to_mailbox(struct Mailbox *m, struct MdEmailArray *mda);
-bool   mh_mkstemp             (struct Mailbox *m, FILE **fp, char **tgt);
-mode_t mh_umask               (struct Mailbox *m);
+/**
+ * enum MdReadMode - What the Readahead should do with each file
+ */
+enum MdReadMode
+{
+  MD_READ_STAT, ///< stat() the file, e.g. to verify the header cache
+  MD_READ_OPEN, ///< Open the file and pre-read its headers
+};
+
+int                 maildir_move_to_mailbox(struct Mailbox *m, struct MdEmailArray *mda);
+void                maildir_readahead_free (struct MdReadahead **ptr);
+FILE *              maildir_readahead_fp   (struct MdReadahead *ra, size_t index);
+struct MdReadahead *maildir_readahead_new  (struct Mailbox *m, struct MdEmailArray *mda, enum MdReadMode mode, int threads);
+int                 maildir_readahead_stat (struct MdReadahead *ra, size_t index, struct stat *st);
+bool                mh_mkstemp             (struct Mailbox *m, FILE **fp, char **tgt);
+mode_t              mh_umask               (struct Mailbox *m);
 
 #endif /* MUTT_MAILDIR_PRIVATE_H */
@@ -0,0 +1,224 @@
+/**
+ * @file
+ * Read Maildir/MH files ahead of the parser
+ *
+ * @authors
+ * Copyright (C) 2021 Richard Russon <rich@flatcap.org>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @page maildir_readahead Read Maildir/MH files ahead of the parser
+ *
+ * Opening a large Maildir/MH mailbox, with a cold disk cache, is dominated by
+ * the latency of `stat()`, `open()` and the first `read()` of each file.
+ *
+ * The Readahead uses a pool of worker threads to perform these operations in
+ * parallel, a little way ahead of the main thread.  The main thread still
+ * parses the headers, in order, but the files are already open and their
+ * headers are in the page cache.
+ *
+ * The workers only make system calls; they don't touch any of NeoMutt's shared
+ * state (logging, config, Buffer pool).
+ */
+
+#include "config.h"
+#include <limits.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "private.h"
+#include "mutt/lib.h"
+#include "email/lib.h"
+#include "core/lib.h"
+#include "mdemail.h"
+
+/// Number of bytes to pre-read from each file -- enough for most headers
+#define READAHEAD_BYTES 16384
+
+/// How many files each thread may have open, ahead of the parser
+#define READAHEAD_WINDOW 32
+
+/// Fraction of the open file limit that the Readahead may use
+#define READAHEAD_FD_SHARE 4
+
+/**
+ * struct MdReadFile - The results of reading ahead one file
+ */
+struct MdReadFile
+{
+  FILE *fp;        ///< Open file (if opening)
+  struct stat st;  ///< File info (if statting)
+  int stat_rc;     ///< Result of stat()
+};
+
+/**
+ * struct MdReadahead - Read Maildir/MH files ahead of the parser
+ */
+struct MdReadahead
+{
+  struct Mailbox *m;          ///< Mailbox being read
+  struct MdEmailArray *mda;   ///< Emails being read
+  enum MdReadMode mode;       ///< What to do with each file
+  bool preread;               ///< Read the start of each file into the page cache
+  struct MdReadFile *files;   ///< Results, one per Email
+  struct WorkerPool *pool;    ///< Worker threads
+};
+
+/**
+ * readahead_job - Stat or open one file - Implements ::worker_job_t
+ */
+static void readahead_job(void *data, size_t index)
+{
+  struct MdReadahead *ra = data;
+  struct MdEmail **mdp = ARRAY_GET(ra->mda, index);
+  struct MdEmail *md = mdp ? *mdp : NULL;
+  if (!md || !md->email || md->header_parsed)
+    return;
+
+  struct MdReadFile *rf = &ra->files[index];
+  char fn[PATH_MAX];
+  snprintf(fn, sizeof(fn), "%s/%s", mailbox_path(ra->m), md->email->path);
+
+  if (ra->mode == MD_READ_STAT)
+  {
+    rf->stat_rc = stat(fn, &rf->st);
+    return;
+  }
+
+  rf->fp = fopen(fn, "r");
+  if (!rf->fp || !ra->preread)
+    return;
+
+  /* Pull the headers into the page cache; the parser will read them again.
+   * This is only a hint, so errors are left for the parser to find. */
+  char buf[READAHEAD_BYTES];
+  ssize_t rc = pread(fileno(rf->fp), buf, sizeof(buf), 0);
+  (void) rc;
+}
+
+/**
+ * readahead_window - How many files may be read ahead
+ * @param mode    What to do with each file, e.g. #MD_READ_OPEN
+ * @param threads Number of threads
+ * @retval num Size of the window
+ *
+ * Open files count against `RLIMIT_NOFILE`, so only use a small share of it.
+ */
+static size_t readahead_window(enum MdReadMode mode, int threads)
+{
+  size_t window = READAHEAD_WINDOW * threads;
+  if (mode != MD_READ_OPEN)
+    return window;
+
+  struct rlimit rl = { 0 };
+  if ((getrlimit(RLIMIT_NOFILE, &rl) == 0) && (rl.rlim_cur != RLIM_INFINITY))
+    window = MIN(window, rl.rlim_cur / READAHEAD_FD_SHARE);
+
+  return MAX(window, 1);
+}
+
+/**
+ * maildir_readahead_new - Start reading ahead
+ * @param m       Mailbox
+ * @param mda     Emails to read
+ * @param mode    What to do with each file, e.g. #MD_READ_OPEN
+ * @param threads Number of threads to use, 0 means one per CPU
+ * @retval ptr New Readahead
+ *
+ * Emails that are missing, or already parsed, will be skipped.
+ */
+struct MdReadahead *maildir_readahead_new(struct Mailbox *m, struct MdEmailArray *mda,
+                                          enum MdReadMode mode, int threads)
+{
+  struct MdReadahead *ra = mutt_mem_calloc(1, sizeof(*ra));
+  ra->m = m;
+  ra->mda = mda;
+  ra->mode = mode;
+
+  const size_t count = ARRAY_SIZE(mda);
+  ra->files = mutt_mem_calloc(MAX(count, 1), sizeof(struct MdReadFile));
+
+  threads = mutt_worker_threads(threads);
+  ra->preread = (threads > 1);
+  ra->pool = mutt_worker_new(count, threads, readahead_window(mode, threads),
+                             readahead_job, ra);
+  return ra;
+}
+
+/**
+ * maildir_readahead_fp - Get an open file from the Readahead
+ * @param ra    Readahead
+ * @param index Index of the Email
+ * @retval ptr  Open file, the caller must close it
+ * @retval NULL The file couldn't be opened
+ *
+ * If this fails, e.g. the worker ran out of file descriptors, the caller should
+ * try to open the file itself.
+ */
+FILE *maildir_readahead_fp(struct MdReadahead *ra, size_t index)
+{
+  if (!ra || (ra->mode != MD_READ_OPEN) || (index >= ARRAY_SIZE(ra->mda)))
+    return NULL;
+
+  mutt_worker_wait(ra->pool, index);
+
+  FILE *fp = ra->files[index].fp;
+  ra->files[index].fp = NULL;
+  return fp;
+}
+
+/**
+ * maildir_readahead_stat - Get the file info from the Readahead
+ * @param[in]  ra    Readahead
+ * @param[in]  index Index of the Email
+ * @param[out] st    File info
+ * @retval  0 Success
+ * @retval -1 The file couldn't be stat'd
+ */
+int maildir_readahead_stat(struct MdReadahead *ra, size_t index, struct stat *st)
+{
+  if (!ra || !st || (ra->mode != MD_READ_STAT) || (index >= ARRAY_SIZE(ra->mda)))
+    return -1;
+
+  mutt_worker_wait(ra->pool, index);
+
+  *st = ra->files[index].st;
+  return ra->files[index].stat_rc;
+}
+
+/**
+ * maildir_readahead_free - Stop reading ahead and free the Readahead
+ * @param[out] ptr Readahead to free
+ *
+ * Any files that were opened, but not collected, will be closed.
+ */
+void maildir_readahead_free(struct MdReadahead **ptr)
+{
+  if (!ptr || !*ptr)
+    return;
+
+  struct MdReadahead *ra = *ptr;
+  mutt_worker_free(&ra->pool);
+
+  for (size_t i = 0; i < ARRAY_SIZE(ra->mda); i++)
+    mutt_file_fclose(&ra->files[i].fp);
+
+  FREE(&ra->files);
+  FREE(ptr);
+}
@@ -66,6 +66,7 @@
 #include "hook.h"
 #include "init.h"
 #include "keymap.h"
+#include "mailcap.h"
 #include "mutt_attach.h"
 #include "mutt_globals.h"
 #include "mutt_history.h"
@@ -1304,6 +1305,9 @@ main_exit:
   mutt_keys_free();
   myvarlist_free(&MyVars);
   mutt_prex_free();
+  mutt_ch_cache_cleanup();
+  mailcap_cache_free();
+  mutt_mime_types_free();
   neomutt_free(&NeoMutt);
   cs_free(&cs);
   log_queue_flush(log_disp_terminal);
@@ -36,6 +36,9 @@ static struct ConfigDef MboxVars[] = {
   { "check_mbox_size", DT_BOOL, false, 0, NULL,
     "(mbox,mmdf) Use mailbox size as an indicator of new mail"
   },
+  { "mbox_read_threads", DT_NUMBER|DT_NOT_NEGATIVE, 0, 0, NULL,
+    "(mbox) Number of threads used to scan a mailbox (0 = one per CPU)"
+  },
   { NULL },
   // clang-format on
 };
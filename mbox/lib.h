@@ -30,6 +30,7 @@
  * | :------------ | :------------------- |
  * | mbox/config.c | @subpage mbox_config |
  * | mbox/mbox.c   | @subpage mbox_mbox   |
+ * | mbox/scan.c   | @subpage mbox_scan   |
  */
 
 #ifndef MUTT_MBOX_LIB_H
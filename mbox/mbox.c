@@ -31,6 +31,7 @@
  */
 
 #include "config.h"
+#include <errno.h>
 #include <fcntl.h>
 #include <inttypes.h> // IWYU pragma: keep
 #include <limits.h>
@@ -38,6 +39,7 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <time.h>
 #include <unistd.h>
@@ -56,6 +58,10 @@
 #include "mx.h"
 #include "progress.h"
 #include "protos.h"
+#include "scan.h"
+#ifdef USE_HCACHE
+#include "hcache/lib.h"
+#endif
 
 /**
  * struct MUpdate - Store of new offsets, used by mutt_sync_mailbox()
@@ -236,7 +242,7 @@ static enum MxOpenReturns mmdf_parse_mailbox(struct Mailbox *m)
 
       if (m->msg_count == m->email_max)
         mx_alloc_memory(m);
-      e = email_new();
+      e = email_new_slab(m->slab);
       m->emails[m->msg_count] = e;
       e->offset = loc;
       e->index = m->msg_count;
@@ -330,6 +336,518 @@ static enum MxOpenReturns mmdf_parse_mailbox(struct Mailbox *m)
   return MX_OPEN_OK;
 }
 
+/**
+ * mbox_finish_email - Set the length of an Email, once the next one's been found
+ * @param e     Email
+ * @param end   Offset of the next message
+ * @param lines Number of lines from the end of the headers to the next message
+ */
+static void mbox_finish_email(struct Email *e, LOFF_T end, int lines)
+{
+  if (e->body->length < 0)
+  {
+    e->body->length = end - e->body->offset - 1;
+    if (e->body->length < 0)
+      e->body->length = 0;
+  }
+
+  if (!e->lines)
+    e->lines = lines ? lines - 1 : 0;
+}
+
+/**
+ * struct MboxMap - A memory-mapped mailbox being parsed
+ */
+struct MboxMap
+{
+  const char *map;        ///< Mapped file
+  LOFF_T start;           ///< Offset to start parsing
+  LOFF_T size;            ///< Size of the mapping
+  struct MboxScan *ms;    ///< Scanner, or NULL to search for separators as needed
+  struct HeaderCache *hc; ///< Header cache, may be NULL
+  struct Buffer keys;     ///< Cache keys of the messages seen, each NUL-terminated
+};
+
+/**
+ * mbox_is_sep - Does a message separator begin here?
+ * @param mm  Mapped mailbox
+ * @param pos Offset to check
+ * @retval true A line beginning "From " starts at @a pos
+ */
+static bool mbox_is_sep(const struct MboxMap *mm, LOFF_T pos)
+{
+  if ((pos <= 0) || ((mm->size - pos) < 5))
+    return false;
+
+  return (mm->map[pos - 1] == '\n') && (memcmp(mm->map + pos, "From ", 5) == 0);
+}
+
+/**
+ * mbox_map_next - Find the next possible message separator
+ * @param[in]  mm   Mapped mailbox
+ * @param[in]  skip Ignore any separators before this offset
+ * @param[out] sep  Separator
+ * @retval true  Separator found
+ * @retval false End of the file, @a sep is set to the end
+ *
+ * Without a Scanner, the separators are found by searching from @a skip, and
+ * the line numbers aren't counted.
+ */
+static bool mbox_map_next(struct MboxMap *mm, LOFF_T skip, struct MboxSep *sep)
+{
+  if (mm->ms)
+  {
+    while (mbox_scan_next(mm->ms, sep))
+    {
+      if (sep->offset >= skip)
+        return true;
+    }
+    return false;
+  }
+
+  sep->line = 0;
+  LOFF_T pos = skip;
+  const char *nl = NULL;
+
+  /* Move to the start of a line */
+  if ((pos > mm->start) && (pos < mm->size) && (mm->map[pos - 1] != '\n'))
+  {
+    nl = memchr(mm->map + pos, '\n', mm->size - pos);
+    pos = nl ? (nl - mm->map + 1) : mm->size;
+  }
+
+  while (pos < mm->size)
+  {
+    if (((mm->size - pos) >= 5) && (memcmp(mm->map + pos, "From ", 5) == 0))
+    {
+      sep->offset = pos;
+      return true;
+    }
+
+    nl = memchr(mm->map + pos, '\n', mm->size - pos);
+    pos = nl ? (nl - mm->map + 1) : mm->size;
+  }
+
+  sep->offset = mm->size;
+  return false;
+}
+
+/**
+ * mbox_map_lines - Count the lines in a message body
+ * @param mm        Mapped mailbox
+ * @param body      Offset of the start of the body
+ * @param body_line Line number of the start of the body (if using a Scanner)
+ * @param sep       Next message separator
+ * @retval num Number of lines
+ */
+static size_t mbox_map_lines(const struct MboxMap *mm, LOFF_T body,
+                             size_t body_line, const struct MboxSep *sep)
+{
+  size_t lines;
+  if (mm->ms)
+    lines = sep->line - body_line;
+  else
+    lines = mbox_count_lines(mm->map, body, sep->offset);
+
+  /* count an unterminated last line */
+  if ((sep->offset == mm->size) && (mm->map[mm->size - 1] != '\n'))
+    lines++;
+
+  return lines;
+}
+
+#ifdef USE_HCACHE
+/**
+ * mbox_header_end - Find the end of a message's headers
+ * @param mm  Mapped mailbox
+ * @param pos Offset of the message separator
+ * @retval num Offset of the start of the body
+ * @retval -1  No blank line found
+ */
+static LOFF_T mbox_header_end(const struct MboxMap *mm, LOFF_T pos)
+{
+  const char *p = mm->map + pos;
+  const char *end = mm->map + mm->size;
+
+  while ((p = memchr(p, '\n', end - p)))
+  {
+    p++;
+    if ((p < end) && (*p == '\n'))
+      return p + 1 - mm->map;
+    if (((end - p) > 1) && (p[0] == '\r') && (p[1] == '\n'))
+      return p + 2 - mm->map;
+  }
+
+  return -1;
+}
+
+/**
+ * mbox_cache_key - Generate the header cache key for a message
+ * @param[in]  mm   Mapped mailbox
+ * @param[in]  pos  Offset of the message separator
+ * @param[in]  body Offset of the start of the body
+ * @param[out] key  Buffer for the key, at least 33 bytes
+ *
+ * The key is a hash of the separator and headers, so a message can be found
+ * in the cache, even if it's moved within the file.
+ */
+static void mbox_cache_key(const struct MboxMap *mm, LOFF_T pos, LOFF_T body, char *key)
+{
+  unsigned char digest[16];
+  mutt_md5_bytes(mm->map + pos, body - pos, digest);
+  mutt_md5_toascii(digest, key);
+}
+
+/**
+ * mbox_cache_chunks - Get the number of key lists in the header cache
+ * @param mm Mapped mailbox
+ * @retval num Number of key lists, "/KEYS/0" to "/KEYS/n-1"
+ */
+static unsigned int mbox_cache_chunks(const struct MboxMap *mm)
+{
+  unsigned int chunks = 0;
+  size_t dlen = 0;
+  void *data = mutt_hcache_fetch_raw(mm->hc, "/KEYS", 5, &dlen);
+  if (data && (dlen == sizeof(chunks)))
+    memcpy(&chunks, data, sizeof(chunks));
+  mutt_hcache_free_raw(mm->hc, &data);
+  return chunks;
+}
+
+/**
+ * mbox_cache_prune - Record the cached messages and delete the stale ones
+ * @param mm   Mapped mailbox
+ * @param full true if the whole mailbox was read
+ *
+ * The keys of the messages in the mailbox are saved in the cache, in a few
+ * lists, "/KEYS/0", "/KEYS/1", etc.  The number of lists is saved as "/KEYS".
+ *
+ * When new mail is appended, only its keys are saved, in a new list.  After
+ * reading the whole mailbox, any cached message that wasn't seen, e.g. it's
+ * been rewritten or expunged, is deleted.  Then all the lists are replaced by
+ * one list of the keys seen.
+ */
+static void mbox_cache_prune(struct MboxMap *mm, bool full)
+{
+  if (!mm->hc)
+    return;
+
+  char name[32];
+  unsigned int chunks = mbox_cache_chunks(mm);
+  const size_t len = mutt_buffer_len(&mm->keys);
+
+  if (!full)
+  {
+    if (len == 0)
+      return;
+
+    snprintf(name, sizeof(name), "/KEYS/%u", chunks);
+    mutt_hcache_store_raw(mm->hc, name, strlen(name), mm->keys.data, len);
+    chunks++;
+    mutt_hcache_store_raw(mm->hc, "/KEYS", 5, &chunks, sizeof(chunks));
+    return;
+  }
+
+  struct HashTable *seen = mutt_hash_new(MAX(len / 33, 1), MUTT_HASH_NO_FLAGS);
+  for (const char *key = mm->keys.data; key && (key < (mm->keys.data + len));
+       key += strlen(key) + 1)
+  {
+    mutt_hash_insert(seen, key, (void *) key);
+  }
+
+  for (unsigned int i = 0; i < chunks; i++)
+  {
+    snprintf(name, sizeof(name), "/KEYS/%u", i);
+    size_t dlen = 0;
+    char *old = mutt_hcache_fetch_raw(mm->hc, name, strlen(name), &dlen);
+    if (old && (dlen > 0) && (old[dlen - 1] == '\0'))
+    {
+      for (const char *key = old; key < (old + dlen); key += strlen(key) + 1)
+      {
+        if (!mutt_hash_find(seen, key))
+          mutt_hcache_delete_record(mm->hc, key, strlen(key));
+      }
+    }
+    mutt_hcache_free_raw(mm->hc, (void **) &old);
+
+    if (i > 0)
+      mutt_hcache_delete_record(mm->hc, name, strlen(name));
+  }
+  mutt_hash_free(&seen);
+
+  chunks = 1;
+  mutt_hcache_store_raw(mm->hc, "/KEYS/0", 7, mm->keys.data ? mm->keys.data : "", len);
+  mutt_hcache_store_raw(mm->hc, "/KEYS", 5, &chunks, sizeof(chunks));
+}
+#endif
+
+/**
+ * mbox_cache_fetch - Get a message from the header cache
+ * @param[in]  mm  Mapped mailbox
+ * @param[in]  pos Offset of the message separator
+ * @param[out] end Offset of the next message
+ * @retval ptr  Email
+ * @retval NULL Not in the cache, or the cached length is wrong
+ *
+ * The cached length is only trusted if it ends at the end of the file or at
+ * the start of another message.
+ */
+static struct Email *mbox_cache_fetch(struct MboxMap *mm, LOFF_T pos, LOFF_T *end)
+{
+#ifdef USE_HCACHE
+  if (!mm->hc)
+    return NULL;
+
+  LOFF_T body = mbox_header_end(mm, pos);
+  if (body < 0)
+    return NULL;
+
+  char key[33];
+  mbox_cache_key(mm, pos, body, key);
+  struct HCacheEntry hce = mutt_hcache_fetch(mm->hc, key, strlen(key), 0);
+  struct Email *e = hce.email;
+  if (!e)
+    return NULL;
+
+  LOFF_T next = body + e->body->length + 1;
+  if (((e->body->offset - e->offset) != (body - pos)) || (e->body->length < 0) ||
+      (next > mm->size) || ((next < mm->size) && !mbox_is_sep(mm, next)))
+  {
+    email_free(&e);
+    return NULL;
+  }
+
+  e->offset = pos;
+  e->body->hdr_offset = pos;
+  e->body->offset = body;
+  *end = next;
+  mutt_buffer_addstr_n(&mm->keys, key, sizeof(key));
+  return e;
+#else
+  return NULL;
+#endif
+}
+
+/**
+ * mbox_cache_store - Save a message to the header cache
+ * @param mm Mapped mailbox
+ * @param e  Email, with its length set
+ */
+static void mbox_cache_store(struct MboxMap *mm, struct Email *e)
+{
+#ifdef USE_HCACHE
+  if (!mm->hc)
+    return;
+
+  char key[33];
+  mbox_cache_key(mm, e->offset, e->body->offset, key);
+  mutt_hcache_store(mm->hc, key, strlen(key), e, 0);
+  mutt_buffer_addstr_n(&mm->keys, key, sizeof(key));
+#endif
+}
+
+/**
+ * mbox_parse_map - Read a memory-mapped mailbox
+ * @param m        Mailbox
+ * @param progress Progress bar
+ * @retval true  Success, or the user interrupted
+ * @retval false The mailbox couldn't be mapped, nothing has been read
+ *
+ * The mailbox is read from the current file position to m->size.
+ * The message separators are found in the mapped file, then the headers are
+ * parsed from the mailbox stream, at the offsets found.
+ *
+ * If the header cache is enabled, each message is saved under a hash of its
+ * headers, with its length.  When the mailbox is read again, a cached message
+ * lets the parser skip straight to the next one.  Only the new, or changed,
+ * parts of the mailbox need to be searched and parsed.  Cached messages that
+ * are no longer in the mailbox are deleted by mbox_cache_prune().
+ *
+ * Otherwise, or if the first message isn't cached, the separators are found
+ * by the Scanner, in parallel.
+ *
+ * @note The mailbox must be locked, so that it won't be truncated while it's
+ *       mapped.
+ */
+static bool mbox_parse_map(struct Mailbox *m, struct Progress *progress)
+{
+  struct MboxAccountData *adata = mbox_adata_get(m);
+  const LOFF_T start = ftello(adata->fp);
+  const LOFF_T size = m->size;
+
+  if ((start < 0) || (size <= start) || ((uintmax_t) size > SIZE_MAX))
+    return false;
+
+  char *map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fileno(adata->fp), 0);
+  if (map == MAP_FAILED)
+  {
+    mutt_debug(LL_DEBUG1, "mmap() failed: %s\n", strerror(errno));
+    return false;
+  }
+  posix_madvise(map, size, POSIX_MADV_SEQUENTIAL);
+
+  struct MboxMap mm = { map, start, size, NULL, NULL, { 0 } };
+  const short c_mbox_read_threads = cs_subset_number(NeoMutt->sub, "mbox_read_threads");
+
+#ifdef USE_HCACHE
+  const char *const c_header_cache = cs_subset_path(NeoMutt->sub, "header_cache");
+  mm.hc = mutt_hcache_open(c_header_cache, mailbox_path(m), NULL);
+  if (mm.hc)
+    mm.hc->slab = m->slab;
+  mutt_hcache_begin(mm.hc);
+#endif
+  if (!mm.hc)
+    mm.ms = mbox_scan_new(map, start, size, c_mbox_read_threads);
+
+  char buf[1024], return_path[256];
+  time_t t = 0;
+  int count = 0;
+  struct Email *e_cur = NULL;
+  bool cached = false;      // Did e_cur come from the cache?
+  LOFF_T skip = start;      // Ignore separators before here, e.g. in the headers
+  LOFF_T body = 0;          // Start of e_cur's body
+  size_t body_line = 0;     // Line number of the start of e_cur's body
+  bool count_lines = false; // Does e_cur need its lines counting?
+  struct MboxSep sep = { 0 };
+
+  while (mbox_map_next(&mm, skip, &sep) && (SigInt != 1))
+  {
+    const char *line = map + sep.offset;
+    const char *nl = memchr(line, '\n', size - sep.offset);
+    const LOFF_T hdr = nl ? (nl - map + 1) : size;
+
+    const size_t len = MIN(hdr - sep.offset, sizeof(buf) - 1);
+    memcpy(buf, line, len);
+    buf[len] = '\0';
+
+    if (!is_from(buf, return_path, sizeof(return_path), &t))
+    {
+      skip = sep.offset + 1;
+      continue;
+    }
+
+    if (e_cur)
+    {
+      mbox_finish_email(e_cur, sep.offset,
+                        count_lines ? mbox_map_lines(&mm, body, body_line, &sep) : 0);
+      if (!cached)
+        mbox_cache_store(&mm, e_cur);
+    }
+
+    count++;
+
+    if (m->verbose)
+      mutt_progress_update(progress, count, (int) (sep.offset / (size / 100 + 1)));
+
+    if (m->msg_count == m->email_max)
+      mx_alloc_memory(m);
+
+    LOFF_T next = 0;
+    e_cur = mbox_cache_fetch(&mm, sep.offset, &next);
+    cached = e_cur;
+    if (e_cur)
+    {
+      e_cur->index = m->msg_count;
+      m->emails[m->msg_count] = e_cur;
+      m->msg_count++;
+      skip = next;
+      count_lines = false;
+      continue;
+    }
+
+    /* The mailbox isn't cached, search the rest of it in parallel */
+    if (!mm.ms && (count == 1))
+      mm.ms = mbox_scan_new(map, sep.offset, size, c_mbox_read_threads);
+
+    m->emails[m->msg_count] = email_new_slab(m->slab);
+    e_cur = m->emails[m->msg_count];
+    e_cur->received = t - mutt_date_local_tz(t);
+    e_cur->offset = sep.offset;
+    e_cur->index = m->msg_count;
+
+    if (fseeko(adata->fp, hdr, SEEK_SET) != 0)
+      mutt_debug(LL_DEBUG1, "#1 fseek() failed\n");
+    e_cur->env = mutt_rfc822_read_header(adata->fp, e_cur, false, false);
+
+    body = ftello(adata->fp);
+    body_line = sep.line + mbox_count_lines(map, sep.offset, body);
+    skip = body;
+    count_lines = true;
+
+    if (e_cur->body->length > 0)
+    {
+      /* The test below avoids a potential integer overflow if the
+       * content-length is huge (thus necessarily invalid).  */
+      LOFF_T tmploc = (e_cur->body->length < size) ? (body + e_cur->body->length + 1) : -1;
+
+      if ((tmploc > 0) && (tmploc < size))
+      {
+        /* check to see if the content-length looks valid.  we expect to
+         * to see a valid message separator at this point in the stream */
+        if (!mbox_is_sep(&mm, tmploc))
+        {
+          mutt_debug(LL_DEBUG1, "bad content-length in message %d (cl=" OFF_T_FMT ")\n",
+                     e_cur->index, e_cur->body->length);
+          e_cur->body->length = -1;
+        }
+      }
+      else if (tmploc != size)
+      {
+        /* content-length would put us past the end of the file, so it
+         * must be wrong */
+        e_cur->body->length = -1;
+      }
+
+      if (e_cur->body->length != -1)
+      {
+        /* good content-length.  check to see if we know how many lines
+         * are in this message.  */
+        if (e_cur->lines == 0)
+          e_cur->lines = mbox_count_lines(map, body, body + e_cur->body->length);
+
+        /* skip any "From " lines in the body */
+        skip = tmploc;
+        count_lines = false;
+      }
+    }
+
+    m->msg_count++;
+
+    if (TAILQ_EMPTY(&e_cur->env->return_path) && return_path[0])
+    {
+      mutt_addrlist_parse(&e_cur->env->return_path, return_path);
+    }
+
+    if (TAILQ_EMPTY(&e_cur->env->from))
+      mutt_addrlist_copy(&e_cur->env->from, &e_cur->env->return_path, false);
+  }
+
+  /* Only set the content-length of the previous message if we have read more
+   * than one message during _this_ invocation.  If this routine is called
+   * when new mail is received, we need to make sure not to clobber what
+   * previously was the last message since the headers may be sorted.  */
+  if (e_cur)
+  {
+    mbox_finish_email(e_cur, sep.offset,
+                      count_lines ? mbox_map_lines(&mm, body, body_line, &sep) : 0);
+    if (!cached && (SigInt != 1))
+      mbox_cache_store(&mm, e_cur);
+  }
+
+  mbox_scan_free(&mm.ms);
+#ifdef USE_HCACHE
+  mbox_cache_prune(&mm, (start == 0) && (SigInt != 1));
+  mutt_hcache_close(mm.hc);
+#endif
+  mutt_buffer_dealloc(&mm.keys);
+  munmap(map, size);
+
+  if (fseeko(adata->fp, sep.offset, SEEK_SET) != 0)
+    mutt_debug(LL_DEBUG1, "#2 fseek() failed\n");
+
+  return true;
+}
+
 /**
  * mbox_parse_mailbox - Read a mailbox from disk
  * @param m Mailbox
@@ -379,6 +897,9 @@ static enum MxOpenReturns mbox_parse_mailbox(struct Mailbox *m)
     mutt_progress_init(&progress, msg, MUTT_PROGRESS_READ, 0);
   }
 
+  if (mbox_parse_map(m, &progress))
+    goto done;
+
   loc = ftello(adata->fp);
   while ((fgets(buf, sizeof(buf), adata->fp)) && (SigInt != 1))
   {
@@ -386,17 +907,7 @@ static enum MxOpenReturns mbox_parse_mailbox(struct Mailbox *m)
     {
       /* Save the Content-Length of the previous message */
       if (count > 0)
-      {
-        struct Email *e = m->emails[m->msg_count - 1];
-        if (e->body->length < 0)
-        {
-          e->body->length = loc - e->body->offset - 1;
-          if (e->body->length < 0)
-            e->body->length = 0;
-        }
-        if (!e->lines)
-          e->lines = lines ? lines - 1 : 0;
-      }
+        mbox_finish_email(m->emails[m->msg_count - 1], loc, lines);
 
       count++;
 
@@ -409,7 +920,7 @@ static enum MxOpenReturns mbox_parse_mailbox(struct Mailbox *m)
       if (m->msg_count == m->email_max)
         mx_alloc_memory(m);
 
-      m->emails[m->msg_count] = email_new();
+      m->emails[m->msg_count] = email_new_slab(m->slab);
       e_cur = m->emails[m->msg_count];
       e_cur->received = t - mutt_date_local_tz(t);
       e_cur->offset = loc;
@@ -502,19 +1013,9 @@ static enum MxOpenReturns mbox_parse_mailbox(struct Mailbox *m)
    * when new mail is received, we need to make sure not to clobber what
    * previously was the last message since the headers may be sorted.  */
   if (count > 0)
-  {
-    struct Email *e = m->emails[m->msg_count - 1];
-    if (e->body->length < 0)
-    {
-      e->body->length = ftello(adata->fp) - e->body->offset - 1;
-      if (e->body->length < 0)
-        e->body->length = 0;
-    }
-
-    if (!e->lines)
-      e->lines = lines ? lines - 1 : 0;
-  }
+    mbox_finish_email(m->emails[m->msg_count - 1], ftello(adata->fp), lines);
 
+done:
   if (SigInt == 1)
   {
     SigInt = 0;
@@ -0,0 +1,232 @@
+/**
+ * @file
+ * Find the message separators in a memory-mapped mbox
+ *
+ * @authors
+ * Copyright (C) 2021 Richard Russon <rich@flatcap.org>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @page mbox_scan Find the message separators in a memory-mapped mbox
+ *
+ * Most of an mbox file is message bodies, which the parser doesn't need to
+ * see.  The Scanner searches the mapped file for lines beginning "From ",
+ * counting the lines as it goes.  The parser only has to check the possible
+ * separators and read the headers.
+ *
+ * The file is split into chunks which are scanned by a pool of worker threads,
+ * a little way ahead of the parser.  The workers only read the mapped memory.
+ */
+
+#include "config.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "mutt/lib.h"
+#include "scan.h"
+
+/// Size of the chunks of the file given to each job
+#define SCAN_CHUNK_SIZE (16 * 1024 * 1024)
+
+/// How many chunks each thread may scan, ahead of the parser
+#define SCAN_WINDOW 4
+
+ARRAY_HEAD(MboxSepArray, struct MboxSep);
+
+/**
+ * struct ScanChunk - The results of scanning one chunk of the file
+ */
+struct ScanChunk
+{
+  struct MboxSepArray seps; ///< Possible separators, line numbers relative to the chunk
+  size_t lines;             ///< Number of lines in the chunk
+};
+
+/**
+ * struct MboxScan - Find the message separators in an mbox
+ */
+struct MboxScan
+{
+  const char *map;            ///< Mapped file
+  LOFF_T start;               ///< Offset to start scanning
+  LOFF_T end;                 ///< Offset to stop scanning
+  size_t num_chunks;          ///< Number of chunks
+  struct ScanChunk *chunks;   ///< Results, one per chunk
+  struct WorkerPool *pool;    ///< Worker threads
+
+  size_t chunk;               ///< Current chunk
+  size_t sep;                 ///< Next separator in the current chunk
+  size_t lines;               ///< Number of lines before the current chunk
+};
+
+/**
+ * mbox_count_lines - Count the newlines in some mapped memory
+ * @param map   Mapped file
+ * @param start Offset to start counting
+ * @param end   Offset to stop counting
+ * @retval num Number of newlines
+ */
+size_t mbox_count_lines(const char *map, LOFF_T start, LOFF_T end)
+{
+  if (!map || (start >= end))
+    return 0;
+
+  size_t lines = 0;
+  const char *p = map + start;
+  const char *stop = map + end;
+  while ((p = memchr(p, '\n', stop - p)))
+  {
+    lines++;
+    p++;
+  }
+
+  return lines;
+}
+
+/**
+ * scan_job - Scan one chunk of the file - Implements ::worker_job_t
+ */
+static void scan_job(void *data, size_t index)
+{
+  struct MboxScan *ms = data;
+  struct ScanChunk *sc = &ms->chunks[index];
+
+  const LOFF_T start = ms->start + (LOFF_T) index * SCAN_CHUNK_SIZE;
+  const LOFF_T end = MIN(start + SCAN_CHUNK_SIZE, ms->end);
+
+  const char *p = ms->map + start;
+  const char *stop = ms->map + end;
+  size_t lines = 0;
+
+  /* Does the chunk begin with a new line? */
+  if ((start != ms->start) && (p[-1] != '\n'))
+  {
+    p = memchr(p, '\n', stop - p);
+    if (p)
+    {
+      p++;
+      lines++;
+    }
+  }
+
+  while (p && (p < stop))
+  {
+    if (((ms->map + ms->end - p) >= 5) && (memcmp(p, "From ", 5) == 0))
+    {
+      struct MboxSep sep = { p - ms->map, lines };
+      ARRAY_ADD(&sc->seps, sep);
+    }
+
+    p = memchr(p, '\n', stop - p);
+    if (p)
+    {
+      p++;
+      lines++;
+    }
+  }
+
+  sc->lines = lines;
+}
+
+/**
+ * mbox_scan_new - Start scanning an mbox
+ * @param map     Mapped file
+ * @param start   Offset to start scanning, must be the start of a line
+ * @param end     Offset to stop scanning, usually the size of the file
+ * @param threads Number of threads to use, 0 means one per CPU
+ * @retval ptr New Scanner
+ */
+struct MboxScan *mbox_scan_new(const char *map, LOFF_T start, LOFF_T end, int threads)
+{
+  struct MboxScan *ms = mutt_mem_calloc(1, sizeof(*ms));
+  ms->map = map;
+  ms->start = start;
+  ms->end = MAX(start, end);
+  ms->num_chunks = (ms->end - start + SCAN_CHUNK_SIZE - 1) / SCAN_CHUNK_SIZE;
+  ms->chunks = mutt_mem_calloc(MAX(ms->num_chunks, 1), sizeof(struct ScanChunk));
+
+  threads = mutt_worker_threads(threads);
+  ms->pool = mutt_worker_new(ms->num_chunks, threads, SCAN_WINDOW * threads,
+                             scan_job, ms);
+
+  if (ms->num_chunks > 0)
+    mutt_worker_wait(ms->pool, 0);
+
+  return ms;
+}
+
+/**
+ * mbox_scan_next - Get the next possible message separator
+ * @param[in]  ms  Scanner
+ * @param[out] sep Separator
+ * @retval true  Separator found
+ * @retval false End of the file
+ *
+ * The separator is a line beginning "From ".  The caller must check that it's
+ * a valid separator.
+ *
+ * At the end of the file, @a sep is set to the end offset and the total number
+ * of lines.
+ */
+bool mbox_scan_next(struct MboxScan *ms, struct MboxSep *sep)
+{
+  if (!ms || !sep)
+    return false;
+
+  while (ms->chunk < ms->num_chunks)
+  {
+    struct ScanChunk *sc = &ms->chunks[ms->chunk];
+    struct MboxSep *found = ARRAY_GET(&sc->seps, ms->sep);
+    if (found)
+    {
+      ms->sep++;
+      sep->offset = found->offset;
+      sep->line = ms->lines + found->line;
+      return true;
+    }
+
+    /* Move on to the next chunk */
+    ms->lines += sc->lines;
+    ARRAY_FREE(&sc->seps);
+    ms->sep = 0;
+    ms->chunk++;
+    mutt_worker_wait(ms->pool, ms->chunk);
+  }
+
+  sep->offset = ms->end;
+  sep->line = ms->lines;
+  return false;
+}
+
+/**
+ * mbox_scan_free - Stop scanning and free the Scanner
+ * @param[out] ptr Scanner to free
+ */
+void mbox_scan_free(struct MboxScan **ptr)
+{
+  if (!ptr || !*ptr)
+    return;
+
+  struct MboxScan *ms = *ptr;
+  mutt_worker_free(&ms->pool);
+
+  for (size_t i = 0; i < ms->num_chunks; i++)
+    ARRAY_FREE(&ms->chunks[i].seps);
+
+  FREE(&ms->chunks);
+  FREE(ptr);
+}
@@ -0,0 +1,44 @@
+/**
+ * @file
+ * Find the message separators in a memory-mapped mbox
+ *
+ * @authors
+ * Copyright (C) 2021 Richard Russon <rich@flatcap.org>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MUTT_MBOX_SCAN_H
+#define MUTT_MBOX_SCAN_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "mutt/lib.h"
+
+/**
+ * struct MboxSep - A possible message separator
+ */
+struct MboxSep
+{
+  LOFF_T offset; ///< Offset of the start of the "From " line
+  size_t line;   ///< Number of lines before the separator
+};
+
+struct MboxScan *mbox_scan_new  (const char *map, LOFF_T start, LOFF_T end, int threads);
+bool             mbox_scan_next (struct MboxScan *ms, struct MboxSep *sep);
+void             mbox_scan_free (struct MboxScan **ptr);
+size_t           mbox_count_lines(const char *map, LOFF_T start, LOFF_T end);
+
+#endif /* MUTT_MBOX_SCAN_H */
@@ -77,6 +77,27 @@ TAILQ_HEAD(LookupList, Lookup);
 
 static struct LookupList Lookups = TAILQ_HEAD_INITIALIZER(Lookups);
 
+/// Number of iconv descriptors to keep open for reuse
+#define ICONV_CACHE_SIZE 16
+
+/**
+ * struct IconvCache - An iconv descriptor that can be reused
+ *
+ * Opening an iconv descriptor is expensive, so mutt_ch_iconv_close() keeps
+ * the recently used ones open, for mutt_ch_iconv_open() to hand out again.
+ */
+struct IconvCache
+{
+  char *tocode;     ///< Destination character set, as given to iconv_open()
+  char *fromcode;   ///< Source character set, as given to iconv_open()
+  iconv_t cd;       ///< iconv descriptor
+  bool in_use;      ///< The descriptor has been given to a caller
+  size_t last_used; ///< When the descriptor was last given out
+};
+
+static struct IconvCache IconvCache[ICONV_CACHE_SIZE];
+static size_t IconvCacheClock = 0;
+
 /**
  * struct MimeNames - MIME name lookup entry
  */
@@ -551,6 +572,8 @@ const char *mutt_ch_charset_lookup(const char *chs)
  * @param flags    Flags, e.g. #MUTT_ICONV_HOOK_FROM
  * @retval ptr iconv handle for the conversion
  *
+ * The handle must be released with mutt_ch_iconv_close().
+ *
  * Like iconv_open, but canonicalises the charsets, applies charset-hooks,
  * recanonicalises, and finally applies iconv-hooks. Parameter flags=0 skips
  * charset-hooks, while MUTT_ICONV_HOOK_FROM applies them to fromcode. Callers
@@ -595,12 +618,92 @@ iconv_t mutt_ch_iconv_open(const char *tocode, const char *fromcode, uint8_t fla
   fromcode2 = mutt_ch_iconv_lookup(fromcode1);
   fromcode2 = fromcode2 ? fromcode2 : fromcode1;
 
+  /* reuse an idle descriptor for the same conversion, if there is one,
+   * otherwise make room for the new one, evicting the least recently used */
+  struct IconvCache *slot = NULL;
+  for (size_t i = 0; i < ICONV_CACHE_SIZE; i++)
+  {
+    struct IconvCache *ic = &IconvCache[i];
+    if (!ic->tocode)
+    {
+      if (!slot || slot->tocode)
+        slot = ic;
+      continue;
+    }
+    if (ic->in_use)
+      continue;
+
+    if (mutt_str_equal(ic->tocode, tocode2) && mutt_str_equal(ic->fromcode, fromcode2))
+    {
+      iconv(ic->cd, NULL, NULL, NULL, NULL); /* reset the shift state */
+      ic->in_use = true;
+      ic->last_used = ++IconvCacheClock;
+      return ic->cd;
+    }
+
+    if (!slot || (slot->tocode && (ic->last_used < slot->last_used)))
+      slot = ic;
+  }
+
   /* call system iconv with names it appreciates */
   cd = iconv_open(tocode2, fromcode2);
-  if (cd != (iconv_t) -1)
+  if ((cd == (iconv_t) -1) || !slot)
     return cd;
 
-  return (iconv_t) -1;
+  if (slot->tocode)
+  {
+    iconv_close(slot->cd);
+    FREE(&slot->tocode);
+    FREE(&slot->fromcode);
+  }
+  slot->tocode = mutt_str_dup(tocode2);
+  slot->fromcode = mutt_str_dup(fromcode2);
+  slot->cd = cd;
+  slot->in_use = true;
+  slot->last_used = ++IconvCacheClock;
+  return cd;
+}
+
+/**
+ * mutt_ch_iconv_close - Finish with an iconv descriptor
+ * @param cd iconv descriptor from mutt_ch_iconv_open()
+ *
+ * The descriptor may be kept open, to be reused by mutt_ch_iconv_open().
+ */
+void mutt_ch_iconv_close(iconv_t cd)
+{
+  if (cd == (iconv_t) -1)
+    return;
+
+  for (size_t i = 0; i < ICONV_CACHE_SIZE; i++)
+  {
+    struct IconvCache *ic = &IconvCache[i];
+    if (ic->tocode && ic->in_use && (ic->cd == cd))
+    {
+      ic->in_use = false;
+      return;
+    }
+  }
+
+  iconv_close(cd);
+}
+
+/**
+ * mutt_ch_cache_cleanup - Close the cached iconv descriptors
+ */
+void mutt_ch_cache_cleanup(void)
+{
+  for (size_t i = 0; i < ICONV_CACHE_SIZE; i++)
+  {
+    struct IconvCache *ic = &IconvCache[i];
+    if (!ic->tocode)
+      continue;
+
+    iconv_close(ic->cd);
+    FREE(&ic->tocode);
+    FREE(&ic->fromcode);
+    ic->in_use = false;
+  }
 }
 
 /**
@@ -738,7 +841,7 @@ int mutt_ch_check(const char *s, size_t slen, const char *from, const char *to)
     rc = errno;
 
   FREE(&saved_out);
-  iconv_close(cd);
+  mutt_ch_iconv_close(cd);
   return rc;
 }
 
@@ -797,7 +900,7 @@ int mutt_ch_convert_string(char **ps, const char *from, const char *to, uint8_t
   ob = buf;
 
   mutt_ch_iconv(cd, &ib, &ibl, &ob, &obl, inrepls, outrepl, &rc);
-  iconv_close(cd);
+  mutt_ch_iconv_close(cd);
 
   *ob = '\0';
 
@@ -842,7 +945,7 @@ bool mutt_ch_check_charset(const char *cs, bool strict)
   iconv_t cd = mutt_ch_iconv_open(cs, cs, MUTT_ICONV_NO_FLAGS);
   if (cd != (iconv_t)(-1))
   {
-    iconv_close(cd);
+    mutt_ch_iconv_close(cd);
     return true;
   }
 
@@ -894,8 +997,7 @@ void mutt_ch_fgetconv_close(struct FgetConv **fc)
   if (!fc || !*fc)
     return;
 
-  if ((*fc)->cd != (iconv_t) -1)
-    iconv_close((*fc)->cd);
+  mutt_ch_iconv_close((*fc)->cd);
   FREE(fc);
 }
 
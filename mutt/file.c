@@ -1019,6 +1019,41 @@ void mutt_file_set_mtime(const char *from, const char *to)
   }
 }
 
+/**
+ * mutt_file_stamp_changed - Has a file changed since it was last checked?
+ * @param[in]     path  Path of the file
+ * @param[in,out] stamp Version of the file when it was last checked
+ * @retval true The file has been created, deleted or modified
+ *
+ * The stamp is updated to the current version of the file.  A zeroed stamp
+ * matches a file that doesn't exist.
+ */
+bool mutt_file_stamp_changed(const char *path, struct FileStamp *stamp)
+{
+  if (!path || !stamp)
+    return false;
+
+  struct FileStamp cur = { 0 };
+  struct stat st;
+  if (stat(path, &st) == 0)
+  {
+    struct timespec ts;
+    mutt_file_get_stat_timespec(&ts, &st, MUTT_STAT_MTIME);
+    cur.dev = st.st_dev;
+    cur.ino = st.st_ino;
+    cur.size = st.st_size;
+    cur.mtime = ts.tv_sec;
+    cur.mtime_nsec = ts.tv_nsec;
+    cur.exists = true;
+  }
+
+  const bool changed = (cur.exists != stamp->exists) || (cur.dev != stamp->dev) ||
+                       (cur.ino != stamp->ino) || (cur.size != stamp->size) ||
+                       (cur.mtime != stamp->mtime) || (cur.mtime_nsec != stamp->mtime_nsec);
+  *stamp = cur;
+  return changed;
+}
+
 /**
  * mutt_file_touch_atime - Set the access time to current time
  * @param fd File descriptor of the file to alter
@@ -64,6 +64,19 @@ enum MuttStatType
   MUTT_STAT_CTIME, ///< File/dir's ctime - creation time
 };
 
+/**
+ * struct FileStamp - A version of a file, see mutt_file_stamp_changed()
+ */
+struct FileStamp
+{
+  dev_t dev;        ///< Device of the file
+  ino_t ino;        ///< Inode of the file
+  off_t size;       ///< Size of the file
+  time_t mtime;     ///< Last modified time, seconds
+  long mtime_nsec;  ///< Last modified time, nanoseconds
+  bool exists;      ///< The file existed
+};
+
 /**
  * struct MuttFileIter - State record for mutt_file_iter_line()
  */
@@ -116,6 +129,7 @@ int         mutt_file_safe_rename(const char *src, const char *target);
 void        mutt_file_sanitize_filename(char *path, bool slash);
 int         mutt_file_sanitize_regex(struct Buffer *dest, const char *src);
 void        mutt_file_set_mtime(const char *from, const char *to);
+bool        mutt_file_stamp_changed(const char *path, struct FileStamp *stamp);
 int         mutt_file_stat_compare(struct stat *sba, enum MuttStatType sba_type, struct stat *sbb, enum MuttStatType sbb_type);
 int         mutt_file_stat_timespec_compare(struct stat *sba, enum MuttStatType type, struct timespec *b);
 int         mutt_file_symlink(const char *oldpath, const char *newpath);
@@ -25,30 +25,81 @@
  * @page mutt_hash Hash Table data structure
  *
  * Hash Table data structure.
+ *
+ * The table uses open addressing with linear probing.  The slots store the
+ * full hash of their key, so most probes don't need to compare keys, and the
+ * table can be resized without hashing the keys again.
+ *
+ * The HashElem's are allocated individually, so pointers to them remain valid
+ * when the table is resized.  Elements with duplicate keys are chained
+ * together in one slot.
  */
 
 #include "config.h"
 #include <ctype.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
 #include "hash.h"
 #include "memory.h"
 #include "string2.h"
 
-#define SOME_PRIME 149711
+/// Smallest number of slots in a Hash Table
+#define HASH_MIN_SLOTS 8
+
+/**
+ * hash_mix - Mix the bits of a hash
+ * @param h Hash to mix
+ * @retval num Mixed hash
+ *
+ * This is the finaliser of SplitMix64.
+ */
+static uint64_t hash_mix(uint64_t h)
+{
+  h ^= h >> 30;
+  h *= 0xbf58476d1ce4e5b9ULL;
+  h ^= h >> 27;
+  h *= 0x94d049bb133111ebULL;
+  h ^= h >> 31;
+  return h;
+}
+
+/**
+ * hash_word - Add 8 bytes to a string hash
+ * @param h Hash so far
+ * @param w Next 8 bytes of the string
+ * @retval num New hash
+ */
+static uint64_t hash_word(uint64_t h, uint64_t w)
+{
+  h ^= w;
+  h *= 0x9e3779b97f4a7c15ULL;
+  return (h << 29) | (h >> 35);
+}
 
 /**
  * gen_string_hash - Generate a hash from a string - Implements hash_gen_hash_t
+ *
+ * The string is hashed eight bytes at a time.
  */
-static size_t gen_string_hash(union HashKey key, size_t num_elems)
+static size_t gen_string_hash(union HashKey key)
 {
-  size_t hash = 0;
   const unsigned char *s = (const unsigned char *) key.strkey;
+  size_t len = strlen(key.strkey);
+  uint64_t h = len;
+  uint64_t w;
 
-  while (*s != '\0')
-    hash += ((hash << 7) + *s++);
-  hash = (hash * SOME_PRIME) % num_elems;
+  for (; len >= sizeof(w); len -= sizeof(w), s += sizeof(w))
+  {
+    memcpy(&w, s, sizeof(w));
+    h = hash_word(h, w);
+  }
+
+  w = 0;
+  memcpy(&w, s, len);
+  h = hash_word(h, w);
 
-  return hash;
+  return hash_mix(h);
 }
 
 /**
@@ -62,16 +113,20 @@ static int cmp_string_key(union HashKey a, union HashKey b)
 /**
  * gen_case_string_hash - Generate a hash from a string (ignore the case) - Implements hash_gen_hash_t
  */
-static size_t gen_case_string_hash(union HashKey key, size_t num_elems)
+static size_t gen_case_string_hash(union HashKey key)
 {
-  size_t hash = 0;
   const unsigned char *s = (const unsigned char *) key.strkey;
+  uint64_t h = 0;
 
   while (*s != '\0')
-    hash += ((hash << 7) + tolower(*s++));
-  hash = (hash * SOME_PRIME) % num_elems;
+  {
+    uint64_t w = 0;
+    for (size_t i = 0; (i < sizeof(w)) && (*s != '\0'); i++, s++)
+      w |= (uint64_t) tolower(*s) << (i * 8);
+    h = hash_word(h, w);
+  }
 
-  return hash;
+  return hash_mix(h);
 }
 
 /**
@@ -85,9 +140,9 @@ static int cmp_case_string_key(union HashKey a, union HashKey b)
 /**
  * gen_int_hash - Generate a hash from an integer - Implements hash_gen_hash_t
  */
-static size_t gen_int_hash(union HashKey key, size_t num_elems)
+static size_t gen_int_hash(union HashKey key)
 {
-  return (key.intkey % num_elems);
+  return hash_mix(key.intkey);
 }
 
 /**
@@ -107,19 +162,110 @@ static int cmp_int_key(union HashKey a, union HashKey b)
  * @param num_elems Number of elements it should contain
  * @retval ptr New Hash Table
  *
- * The Hash Table can contain more elements than num_elems, but they will be
- * chained together.
+ * The Hash Table will grow if more than num_elems elements are added.
  */
 static struct HashTable *hash_new(size_t num_elems)
 {
   struct HashTable *table = mutt_mem_calloc(1, sizeof(struct HashTable));
-  if (num_elems == 0)
-    num_elems = 2;
-  table->num_elems = num_elems;
-  table->table = mutt_mem_calloc(num_elems, sizeof(struct HashElem *));
+  size_t slots = HASH_MIN_SLOTS;
+  while ((slots / 4 * 3) < num_elems)
+    slots *= 2;
+  table->num_elems = slots;
+  table->slots = mutt_mem_calloc(slots, sizeof(struct HashSlot));
   return table;
 }
 
+/**
+ * hash_find_slot - Find the slot for a key
+ * @param table Hash Table to search
+ * @param key   Key to find
+ * @param hash  Hash of the key
+ * @retval ptr Slot holding the key, or the empty slot where it would go
+ */
+static struct HashSlot *hash_find_slot(const struct HashTable *table,
+                                       union HashKey key, size_t hash)
+{
+  const size_t mask = table->num_elems - 1;
+  for (size_t i = hash & mask;; i = (i + 1) & mask)
+  {
+    struct HashSlot *slot = &table->slots[i];
+    if (!slot->elem)
+      return slot;
+    if ((slot->hash == hash) && (table->cmp_key(slot->elem->key, key) == 0))
+      return slot;
+  }
+}
+
+/**
+ * hash_grow - Double the number of slots in a Hash Table
+ * @param table Hash Table to resize
+ */
+static void hash_grow(struct HashTable *table)
+{
+  struct HashSlot *old = table->slots;
+  const size_t old_num = table->num_elems;
+
+  table->num_elems *= 2;
+  table->slots = mutt_mem_calloc(table->num_elems, sizeof(struct HashSlot));
+
+  const size_t mask = table->num_elems - 1;
+  for (size_t i = 0; i < old_num; i++)
+  {
+    if (!old[i].elem)
+      continue;
+
+    size_t j = old[i].hash & mask;
+    while (table->slots[j].elem)
+      j = (j + 1) & mask;
+    table->slots[j] = old[i];
+  }
+
+  FREE(&old);
+}
+
+/**
+ * hash_remove_slot - Empty a slot, keeping the probe sequences intact
+ * @param table Hash Table
+ * @param slot  Slot to empty
+ *
+ * Later elements of the probe sequence are moved back, so no tombstones are
+ * needed.
+ */
+static void hash_remove_slot(struct HashTable *table, struct HashSlot *slot)
+{
+  const size_t mask = table->num_elems - 1;
+  size_t hole = slot - table->slots;
+
+  for (size_t i = (hole + 1) & mask; table->slots[i].elem; i = (i + 1) & mask)
+  {
+    /* Can the element in slot i move back into the hole? */
+    const size_t home = table->slots[i].hash & mask;
+    if (((i - home) & mask) >= ((i - hole) & mask))
+    {
+      table->slots[hole] = table->slots[i];
+      hole = i;
+    }
+  }
+
+  table->slots[hole].elem = NULL;
+  table->slots[hole].hash = 0;
+  table->num_used--;
+}
+
+/**
+ * hash_free_elem - Free a HashElem
+ * @param table Hash Table that held it
+ * @param he    Element to free
+ */
+static void hash_free_elem(struct HashTable *table, struct HashElem *he)
+{
+  if (table->hdata_free)
+    table->hdata_free(he->type, he->data, table->hdata);
+  if (table->strdup_keys)
+    FREE(&he->key.strkey);
+  FREE(&he);
+}
+
 /**
  * union_hash_insert - Insert into a hash table using a union as a key
  * @param table Hash Table to update
@@ -131,41 +277,31 @@ static struct HashTable *hash_new(size_t num_elems)
 static struct HashElem *union_hash_insert(struct HashTable *table,
                                           union HashKey key, int type, void *data)
 {
-  if (!table)
+  if (!table || !table->slots)
     return NULL; // LCOV_EXCL_LINE
 
+  /* Keep the table at most three-quarters full */
+  if ((table->num_used + 1) > (table->num_elems / 4 * 3))
+    hash_grow(table);
+
+  const size_t hash = table->gen_hash(key);
+  struct HashSlot *slot = hash_find_slot(table, key, hash);
+  if (slot->elem && !table->allow_dups)
+    return NULL;
+
   struct HashElem *he = mutt_mem_calloc(1, sizeof(struct HashElem));
-  size_t hash = table->gen_hash(key, table->num_elems);
   he->key = key;
   he->data = data;
   he->type = type;
 
-  if (table->allow_dups)
+  if (!slot->elem)
   {
-    he->next = table->table[hash];
-    table->table[hash] = he;
+    slot->hash = hash;
+    table->num_used++;
   }
-  else
-  {
-    struct HashElem *tmp = NULL, *last = NULL;
 
-    for (tmp = table->table[hash], last = NULL; tmp; last = tmp, tmp = tmp->next)
-    {
-      const int rc = table->cmp_key(tmp->key, key);
-      if (rc == 0)
-      {
-        FREE(&he);
-        return NULL;
-      }
-      if (rc > 0)
-        break;
-    }
-    if (last)
-      last->next = he;
-    else
-      table->table[hash] = he;
-    he->next = tmp;
-  }
+  he->next = slot->elem;
+  slot->elem = he;
   return he;
 }
 
@@ -177,17 +313,10 @@ static struct HashElem *union_hash_insert(struct HashTable *table,
  */
 static struct HashElem *union_hash_find_elem(const struct HashTable *table, union HashKey key)
 {
-  if (!table)
+  if (!table || !table->slots)
     return NULL; // LCOV_EXCL_LINE
 
-  size_t hash = table->gen_hash(key, table->num_elems);
-  struct HashElem *he = table->table[hash];
-  for (; he; he = he->next)
-  {
-    if (table->cmp_key(key, he->key) == 0)
-      return he;
-  }
-  return NULL;
+  return hash_find_slot(table, key, table->gen_hash(key))->elem;
 }
 
 /**
@@ -214,24 +343,21 @@ static void *union_hash_find(const struct HashTable *table, union HashKey key)
  */
 static void union_hash_delete(struct HashTable *table, union HashKey key, const void *data)
 {
-  if (!table)
+  if (!table || !table->slots)
     return; // LCOV_EXCL_LINE
 
-  size_t hash = table->gen_hash(key, table->num_elems);
-  struct HashElem *he = table->table[hash];
-  struct HashElem **last = &table->table[hash];
+  struct HashSlot *slot = hash_find_slot(table, key, table->gen_hash(key));
+  struct HashElem **last = &slot->elem;
+  struct HashElem *he = slot->elem;
+  struct HashElem *removed = NULL;
 
   while (he)
   {
-    if (((data == he->data) || !data) && (table->cmp_key(he->key, key) == 0))
+    if ((data == he->data) || !data)
     {
       *last = he->next;
-      if (table->hdata_free)
-        table->hdata_free(he->type, he->data, table->hdata);
-      if (table->strdup_keys)
-        FREE(&he->key.strkey);
-      FREE(&he);
-
+      he->next = removed;
+      removed = he;
       he = *last;
     }
     else
@@ -240,6 +366,21 @@ static void union_hash_delete(struct HashTable *table, union HashKey key, const
       he = he->next;
     }
   }
+
+  if (!removed)
+    return;
+
+  if (!slot->elem)
+    hash_remove_slot(table, slot);
+
+  /* Free the elements once the table is consistent,
+   * in case the destructor uses the table */
+  while (removed)
+  {
+    he = removed;
+    removed = removed->next;
+    hash_free_elem(table, he);
+  }
 }
 
 /**
@@ -396,7 +537,8 @@ void *mutt_hash_int_find(const struct HashTable *table, unsigned int intkey)
  * @param strkey String key to search for
  * @retval ptr HashElem matching the key
  *
- * Unlike mutt_hash_find_elem(), this will return the first matching entry.
+ * In a table with duplicate keys, all the matching entries can be found by
+ * following HashElem::next.
  */
 struct HashElem *mutt_hash_find_bucket(const struct HashTable *table, const char *strkey)
 {
@@ -404,10 +546,8 @@ struct HashElem *mutt_hash_find_bucket(const struct HashTable *table, const char
     return NULL;
 
   union HashKey key;
-
   key.strkey = strkey;
-  size_t hash = table->gen_hash(key, table->num_elems);
-  return table->table[hash];
+  return union_hash_find_elem(table, key);
 }
 
 /**
@@ -454,18 +594,14 @@ void mutt_hash_free(struct HashTable **ptr)
 
   for (size_t i = 0; i < table->num_elems; i++)
   {
-    for (elem = table->table[i]; elem;)
+    for (elem = table->slots[i].elem; elem;)
     {
       tmp = elem;
       elem = elem->next;
-      if (table->hdata_free)
-        table->hdata_free(tmp->type, tmp->data, table->hdata);
-      if (table->strdup_keys)
-        FREE(&tmp->key.strkey);
-      FREE(&tmp);
+      hash_free_elem(table, tmp);
     }
   }
-  FREE(&table->table);
+  FREE(&table->slots);
   FREE(ptr);
 }
 
@@ -492,9 +628,9 @@ struct HashElem *mutt_hash_walk(const struct HashTable *table, struct HashWalkSt
 
   while (state->index < table->num_elems)
   {
-    if (table->table[state->index])
+    if (table->slots[state->index].elem)
     {
-      state->last = table->table[state->index];
+      state->last = table->slots[state->index].elem;
       return state->last;
     }
     state->index++;
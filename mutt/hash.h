@@ -45,7 +45,7 @@ struct HashElem
   int type;              ///< Type of data stored in Hash Table, e.g. #DT_STRING
   union HashKey key;     ///< Key representing the data
   void *data;            ///< User-supplied data
-  struct HashElem *next; ///< Linked List
+  struct HashElem *next; ///< Next element with the same key
 };
 
 /**
@@ -58,13 +58,13 @@ typedef void (*hash_hdata_free_t)(int type, void *obj, intptr_t data);
 
 /**
  * typedef hash_gen_hash_t - Prototype for a Key hashing function
- * @param key       Key to hash
- * @param num_elems Number of elements in the Hash Table
+ * @param key Key to hash
+ * @retval num Hash of the key
  *
  * Turn a Key (a string or an integer) into a hash id.
- * The hash id will be a number between 0 and (num_elems-1).
+ * The Hash Table uses the low bits to pick a slot, so they must be well mixed.
  */
-typedef size_t (*hash_gen_hash_t)(union HashKey key, size_t num_elems);
+typedef size_t (*hash_gen_hash_t)(union HashKey key);
 
 /**
  * typedef hash_cmp_key_t - Prototype for a function to compare two Hash keys
@@ -78,15 +78,29 @@ typedef size_t (*hash_gen_hash_t)(union HashKey key, size_t num_elems);
  */
 typedef int (*hash_cmp_key_t)(union HashKey a, union HashKey b);
 
+/**
+ * struct HashSlot - A slot in a Hash Table
+ */
+struct HashSlot
+{
+  size_t hash;           ///< Hash of the key
+  struct HashElem *elem; ///< Elements with this key, NULL if the slot is empty
+};
+
 /**
  * struct HashTable - A Hash Table
+ *
+ * The table uses open addressing (linear probing).  Each used slot holds a
+ * list of all the HashElem's with the same key.  The table doubles in size
+ * when it's three-quarters full.
  */
 struct HashTable
 {
-  size_t num_elems;             ///< Number of elements in the Hash Table
+  size_t num_elems;             ///< Number of slots in the Hash Table, a power of 2
+  size_t num_used;              ///< Number of slots in use
   bool strdup_keys : 1;         ///< if set, the key->strkey is strdup()'d
   bool allow_dups  : 1;         ///< if set, duplicate keys are allowed
-  struct HashElem **table;      ///< Array of Hash keys
+  struct HashSlot *slots;       ///< Array of slots
   hash_gen_hash_t gen_hash;     ///< Function to generate hash id from the key
   hash_cmp_key_t cmp_key;       ///< Function to compare two Hash keys
   intptr_t hdata;               ///< Data to pass to the hdata_free() function
@@ -118,8 +132,8 @@ struct HashElem * mutt_hash_typed_insert  (struct HashTable *table, const char *
  */
 struct HashWalkState
 {
-  size_t index;          ///< Current position in table
-  struct HashElem *last; ///< Current element in linked list
+  size_t index;          ///< Current slot in table
+  struct HashElem *last; ///< Current element in the slot's list
 };
 
 struct HashElem *mutt_hash_walk(const struct HashTable *table, struct HashWalkState *state);
@@ -43,6 +43,7 @@
  * | mutt/mbyte.c     | @subpage mutt_mbyte     |
  * | mutt/md5.c       | @subpage mutt_md5       |
  * | mutt/memory.c    | @subpage mutt_memory    |
+ * | mutt/mergesort.c | @subpage mutt_mergesort |
  * | mutt/notify.c    | @subpage mutt_notify    |
  * | mutt/observer.h  | @subpage mutt_observer  |
  * | mutt/path.c      | @subpage mutt_path      |
@@ -52,7 +53,9 @@
  * | mutt/regex.c     | @subpage mutt_regex     |
  * | mutt/slist.c     | @subpage mutt_slist     |
  * | mutt/signal.c    | @subpage mutt_signal    |
+ * | mutt/slab.c      | @subpage mutt_slab      |
  * | mutt/string.c    | @subpage mutt_string    |
+ * | mutt/worker.c    | @subpage mutt_worker    |
  *
  * @note The library is self-contained -- some files may depend on others in
  *       the library, but none depends on source from outside.
@@ -78,6 +81,7 @@
 #include "mbyte.h"
 #include "md5.h"
 #include "memory.h"
+#include "mergesort.h"
 #include "message.h"
 #include "notify.h"
 #include "notify_type.h"
@@ -89,8 +93,10 @@
 #include "random.h"
 #include "regex3.h"
 #include "signal2.h"
+#include "slab.h"
 #include "slist.h"
 #include "string2.h"
+#include "worker.h"
 // IWYU pragma: end_exports
 
 #endif /* MUTT_MUTT_LIB_H */
@@ -0,0 +1,252 @@
+/**
+ * @file
+ * Stable merge sort, optionally on several threads
+ *
+ * @authors
+ * Copyright (C) 2021 Richard Russon <rich@flatcap.org>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @page mutt_mergesort Stable merge sort, optionally on several threads
+ *
+ * A bottom-up merge sort.  Unlike qsort(), it's stable and the comparison
+ * function is passed some private data, so it doesn't need any globals.
+ *
+ * Short runs are sorted by insertion, then merged in pairs until the whole
+ * array is sorted.  For large arrays, the array is split into one chunk per
+ * thread.  The chunks are sorted on a WorkerPool, then the pairs of chunks are
+ * merged, in parallel, until only one pair is left.
+ */
+
+#include "config.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "mergesort.h"
+#include "memory.h"
+#include "worker.h"
+
+/// Number of elements sorted by insertion before merging
+#define MERGE_RUN 16
+
+/// Smallest array that will be sorted on several threads
+#define MERGE_PARALLEL_MIN 32768
+
+/**
+ * struct MergeSort - The state of one mutt_merge_sort()
+ */
+struct MergeSort
+{
+  char *base;        ///< Array to sort
+  char *tmp;         ///< Scratch space, the same size as the array
+  size_t num;        ///< Number of elements
+  size_t size;       ///< Size of each element
+  merge_cmp_t cmp;   ///< Comparison function
+  void *sdata;       ///< Private data for the comparison function
+  size_t width;      ///< Length of the sorted runs (chunks) to merge
+  const char *src;   ///< Runs to merge
+  char *dst;         ///< Destination of the merged runs
+};
+
+/**
+ * insertion_sort - Sort a short run of elements in place
+ * @param ms  MergeSort
+ * @param lo  First element
+ * @param hi  One past the last element
+ * @param tmp Space for one element
+ */
+static void insertion_sort(const struct MergeSort *ms, size_t lo, size_t hi, char *tmp)
+{
+  const size_t size = ms->size;
+  for (size_t i = lo + 1; i < hi; i++)
+  {
+    char *item = ms->base + (i * size);
+    size_t j = i;
+    while ((j > lo) && (ms->cmp(ms->base + ((j - 1) * size), item, ms->sdata) > 0))
+      j--;
+
+    if (j == i)
+      continue;
+
+    char *pos = ms->base + (j * size);
+    memcpy(tmp, item, size);
+    memmove(pos + size, pos, (i - j) * size);
+    memcpy(pos, tmp, size);
+  }
+}
+
+/**
+ * merge_runs - Merge two adjacent sorted runs
+ * @param ms  MergeSort
+ * @param src Array containing the runs
+ * @param dst Array for the result
+ * @param lo  First element of the first run
+ * @param mid First element of the second run
+ * @param hi  One past the last element of the second run
+ *
+ * If the elements compare equal, the one from the first run is taken first.
+ */
+static void merge_runs(const struct MergeSort *ms, const char *src, char *dst,
+                       size_t lo, size_t mid, size_t hi)
+{
+  const size_t size = ms->size;
+  size_t i = lo;
+  size_t j = mid;
+  size_t k = lo;
+
+  while ((i < mid) && (j < hi))
+  {
+    if (ms->cmp(src + (j * size), src + (i * size), ms->sdata) < 0)
+      memcpy(dst + (k++ * size), src + (j++ * size), size);
+    else
+      memcpy(dst + (k++ * size), src + (i++ * size), size);
+  }
+
+  if (i < mid)
+    memcpy(dst + (k * size), src + (i * size), (mid - i) * size);
+  else if (j < hi)
+    memcpy(dst + (k * size), src + (j * size), (hi - j) * size);
+}
+
+/**
+ * sort_range - Sort part of the array
+ * @param ms MergeSort
+ * @param lo First element
+ * @param hi One past the last element
+ *
+ * The same part of MergeSort::tmp is used as scratch space.
+ */
+static void sort_range(const struct MergeSort *ms, size_t lo, size_t hi)
+{
+  for (size_t i = lo; i < hi; i += MERGE_RUN)
+    insertion_sort(ms, i, MIN(i + MERGE_RUN, hi), ms->tmp + (lo * ms->size));
+
+  const char *src = ms->base;
+  char *dst = ms->tmp;
+  for (size_t width = MERGE_RUN; width < (hi - lo); width *= 2)
+  {
+    for (size_t i = lo; i < hi; i += 2 * width)
+    {
+      const size_t mid = MIN(i + width, hi);
+      merge_runs(ms, src, dst, i, mid, MIN(i + (2 * width), hi));
+    }
+
+    const char *swap = src;
+    src = dst;
+    dst = (char *) swap;
+  }
+
+  if (src != ms->base)
+    memcpy(ms->base + (lo * ms->size), src + (lo * ms->size), (hi - lo) * ms->size);
+}
+
+/**
+ * sort_chunk_job - Sort one chunk of the array - Implements ::worker_job_t
+ */
+static void sort_chunk_job(void *data, size_t index)
+{
+  const struct MergeSort *ms = data;
+  const size_t lo = index * ms->width;
+  sort_range(ms, lo, MIN(lo + ms->width, ms->num));
+}
+
+/**
+ * merge_chunks_job - Merge one pair of sorted chunks - Implements ::worker_job_t
+ */
+static void merge_chunks_job(void *data, size_t index)
+{
+  const struct MergeSort *ms = data;
+  const size_t lo = index * 2 * ms->width;
+  const size_t mid = MIN(lo + ms->width, ms->num);
+  merge_runs(ms, ms->src, ms->dst, lo, mid, MIN(lo + (2 * ms->width), ms->num));
+}
+
+/**
+ * run_jobs - Run a set of jobs on a WorkerPool and wait for them all
+ * @param ms      MergeSort
+ * @param count   Number of jobs
+ * @param threads Number of threads
+ * @param job     Function to run each job
+ */
+static void run_jobs(struct MergeSort *ms, size_t count, int threads, worker_job_t job)
+{
+  struct WorkerPool *wp = mutt_worker_new(count, threads, count, job, ms);
+  for (size_t i = 0; i < count; i++)
+    mutt_worker_wait(wp, i);
+  mutt_worker_free(&wp);
+}
+
+/**
+ * mutt_merge_sort - Sort an array, keeping the order of equal elements
+ * @param base    Array to sort
+ * @param num     Number of elements
+ * @param size    Size of each element
+ * @param cmp     Comparison function
+ * @param sdata   Private data for the comparison function
+ * @param threads Number of threads to use, 0 for one per CPU
+ *
+ * Small arrays are always sorted on the calling thread.
+ */
+void mutt_merge_sort(void *base, size_t num, size_t size, merge_cmp_t cmp,
+                     void *sdata, int threads)
+{
+  if (!base || (num < 2) || (size == 0) || !cmp)
+    return;
+
+  struct MergeSort ms = { 0 };
+  ms.base = base;
+  ms.tmp = mutt_mem_malloc(num * size);
+  ms.num = num;
+  ms.size = size;
+  ms.cmp = cmp;
+  ms.sdata = sdata;
+
+  size_t chunks = 1;
+  if (num >= MERGE_PARALLEL_MIN)
+  {
+    threads = mutt_worker_threads(threads);
+    if (threads > 1)
+      chunks = threads;
+  }
+
+  if (chunks < 2)
+  {
+    sort_range(&ms, 0, num);
+    FREE(&ms.tmp);
+    return;
+  }
+
+  ms.width = (num + chunks - 1) / chunks;
+  run_jobs(&ms, chunks, threads, sort_chunk_job);
+
+  ms.src = ms.base;
+  ms.dst = ms.tmp;
+  for (; ms.width < num; ms.width *= 2)
+  {
+    const size_t pairs = (num + (2 * ms.width) - 1) / (2 * ms.width);
+    run_jobs(&ms, pairs, threads, merge_chunks_job);
+
+    const char *swap = ms.src;
+    ms.src = ms.dst;
+    ms.dst = (char *) swap;
+  }
+
+  if (ms.src != ms.base)
+    memcpy(ms.base, ms.src, num * size);
+
+  FREE(&ms.tmp);
+}
@@ -0,0 +1,44 @@
+/**
+ * @file
+ * Stable merge sort, optionally on several threads
+ *
+ * @authors
+ * Copyright (C) 2021 Richard Russon <rich@flatcap.org>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MUTT_LIB_MERGESORT_H
+#define MUTT_LIB_MERGESORT_H
+
+#include <stddef.h>
+
+/**
+ * typedef merge_cmp_t - Prototype for a function to compare two elements
+ * @param a     First element
+ * @param b     Second element
+ * @param sdata Private data passed to mutt_merge_sort()
+ * @retval <0 a precedes b
+ * @retval  0 a and b are identical
+ * @retval >0 b precedes a
+ *
+ * @note The function may be called on any thread.  It must not touch any
+ *       shared state, see ::worker_job_t.
+ */
+typedef int (*merge_cmp_t)(const void *a, const void *b, void *sdata);
+
+void mutt_merge_sort(void *base, size_t num, size_t size, merge_cmp_t cmp, void *sdata, int threads);
+
+#endif /* MUTT_LIB_MERGESORT_H */
@@ -0,0 +1,270 @@
+/**
+ * @file
+ * Allocator for many small objects with a shared lifetime
+ *
+ * @authors
+ * Copyright (C) 2021 Richard Russon <rich@flatcap.org>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @page mutt_slab Allocator for many small objects with a shared lifetime
+ *
+ * A Slab hands out small, zeroed objects carved from large blocks of memory.
+ * It's used for objects that are created together and freed together, e.g.
+ * the Emails of a Mailbox.
+ *
+ * - Allocation is a pointer bump, or a pop from a free list
+ * - Objects of the same size are packed together, with no per-object header
+ * - Released objects are kept on a free list, for reuse, until the Slab is
+ *   destroyed.  Then all the blocks are returned to the system at once.
+ *
+ * The owner of a Slab drops its reference with mutt_slab_free().  If any
+ * objects are still in use, the memory is kept until the last one has been
+ * released.
+ *
+ * A NULL Slab is valid: the objects will be allocated from the heap.
+ */
+
+#include "config.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "slab.h"
+#include "memory.h"
+
+/// Alignment of every object (and the size granularity)
+#define SLAB_ALIGN 16
+
+/// Largest object that's carved from a block, bigger ones come from the heap
+#define SLAB_MAX_OBJECT 1024
+
+/// Number of object sizes with a free list
+#define SLAB_CLASSES (SLAB_MAX_OBJECT / SLAB_ALIGN)
+
+/// Size of the first block -- small Mailboxes shouldn't waste memory
+#define SLAB_BLOCK_MIN (16 * 1024)
+
+/// Size limit of the blocks -- they double in size until they reach this
+#define SLAB_BLOCK_MAX (1024 * 1024)
+
+/**
+ * struct SlabBlock - A block of memory that objects are carved from
+ */
+struct SlabBlock
+{
+  struct SlabBlock *next; ///< Next (older) block
+};
+
+/// Size of the block header, rounded up to keep the objects aligned
+#define SLAB_BLOCK_HEADER                                                      \
+  ((sizeof(struct SlabBlock) + SLAB_ALIGN - 1) & ~(size_t) (SLAB_ALIGN - 1))
+
+/**
+ * struct SlabFree - A released object, waiting to be reused
+ */
+struct SlabFree
+{
+  struct SlabFree *next; ///< Next free object of the same size
+};
+
+/**
+ * struct Slab - Allocator for many small objects with a shared lifetime
+ */
+struct Slab
+{
+  struct SlabBlock *blocks;               ///< All the blocks, newest first
+  char *next;                             ///< Unused space in the newest block
+  char *end;                              ///< End of the newest block
+  size_t block_size;                      ///< Size of the next block to allocate
+  struct SlabFree *free[SLAB_CLASSES];    ///< Released objects, by size
+  size_t live;                            ///< Number of objects in use
+  bool orphan;                            ///< The owner has freed the Slab
+};
+
+/**
+ * slab_class - Get the size class of an object
+ * @param size Size of the object
+ * @retval num Index into Slab::free
+ */
+static size_t slab_class(size_t size)
+{
+  return (size - 1) / SLAB_ALIGN;
+}
+
+/**
+ * slab_destroy - Return all the Slab's memory to the system
+ * @param slab Slab to destroy
+ */
+static void slab_destroy(struct Slab *slab)
+{
+  struct SlabBlock *block = slab->blocks;
+  while (block)
+  {
+    struct SlabBlock *next = block->next;
+    FREE(&block);
+    block = next;
+  }
+
+  FREE(&slab);
+}
+
+/**
+ * slab_grow - Add a new block to a Slab
+ * @param slab Slab
+ * @param size Size of the object that needs space
+ */
+static void slab_grow(struct Slab *slab, size_t size)
+{
+  /* The unused tail of the current block is abandoned */
+  size_t bytes = slab->block_size;
+  if (bytes < (SLAB_BLOCK_HEADER + size))
+    bytes = SLAB_BLOCK_HEADER + size;
+
+  struct SlabBlock *block = mutt_mem_malloc(bytes);
+  block->next = slab->blocks;
+  slab->blocks = block;
+
+  slab->next = (char *) block + SLAB_BLOCK_HEADER;
+  slab->end = (char *) block + bytes;
+
+  if (slab->block_size < SLAB_BLOCK_MAX)
+    slab->block_size *= 2;
+}
+
+/**
+ * mutt_slab_new - Create a new Slab
+ * @retval ptr New Slab
+ *
+ * No memory is reserved for objects until the first allocation.
+ */
+struct Slab *mutt_slab_new(void)
+{
+  struct Slab *slab = mutt_mem_calloc(1, sizeof(*slab));
+  slab->block_size = SLAB_BLOCK_MIN;
+  return slab;
+}
+
+/**
+ * mutt_slab_free - Release the owner's reference to a Slab
+ * @param[out] ptr Slab to free
+ *
+ * If no objects are in use, the memory is returned to the system immediately.
+ * Otherwise, it's returned when the last object is released.
+ */
+void mutt_slab_free(struct Slab **ptr)
+{
+  if (!ptr || !*ptr)
+    return;
+
+  struct Slab *slab = *ptr;
+  if (slab->live == 0)
+    slab_destroy(slab);
+  else
+    slab->orphan = true;
+
+  *ptr = NULL;
+}
+
+/**
+ * mutt_slab_alloc - Allocate a zeroed object from a Slab
+ * @param slab Slab, may be NULL
+ * @param size Size of the object
+ * @retval ptr New object
+ *
+ * If @a slab is NULL, the object is allocated from the heap.
+ * The object must be freed with mutt_slab_release(), with the same @a slab and
+ * @a size.
+ */
+void *mutt_slab_alloc(struct Slab *slab, size_t size)
+{
+  if (size == 0)
+    size = 1;
+
+  if (!slab || (size > SLAB_MAX_OBJECT))
+  {
+    if (slab)
+      slab->live++;
+    return mutt_mem_calloc(1, size);
+  }
+
+  slab->live++;
+
+  const size_t cls = slab_class(size);
+  struct SlabFree *sf = slab->free[cls];
+  if (sf)
+  {
+    slab->free[cls] = sf->next;
+    memset(sf, 0, size);
+    return sf;
+  }
+
+  size = (cls + 1) * SLAB_ALIGN;
+  if ((size_t) (slab->end - slab->next) < size)
+    slab_grow(slab, size);
+
+  void *obj = slab->next;
+  slab->next += size;
+  memset(obj, 0, size);
+  return obj;
+}
+
+/**
+ * mutt_slab_release - Return an object to its Slab
+ * @param slab Slab the object was allocated from, may be NULL
+ * @param ptr  Object to release
+ * @param size Size of the object
+ *
+ * If the owner has already freed the Slab, releasing the last object destroys
+ * it.
+ */
+void mutt_slab_release(struct Slab *slab, void *ptr, size_t size)
+{
+  if (!ptr)
+    return;
+
+  if (size == 0)
+    size = 1;
+
+  if (!slab || (size > SLAB_MAX_OBJECT))
+  {
+    FREE(&ptr);
+  }
+  else
+  {
+    struct SlabFree *sf = ptr;
+    const size_t cls = slab_class(size);
+    sf->next = slab->free[cls];
+    slab->free[cls] = sf;
+  }
+
+  if (!slab)
+    return;
+
+  slab->live--;
+  if (slab->orphan && (slab->live == 0))
+    slab_destroy(slab);
+}
+
+/**
+ * mutt_slab_live - How many objects are in use?
+ * @param slab Slab
+ * @retval num Number of objects allocated, but not released
+ */
+size_t mutt_slab_live(const struct Slab *slab)
+{
+  return slab ? slab->live : 0;
+}
@@ -0,0 +1,36 @@
+/**
+ * @file
+ * Allocator for many small objects with a shared lifetime
+ *
+ * @authors
+ * Copyright (C) 2021 Richard Russon <rich@flatcap.org>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MUTT_LIB_SLAB_H
+#define MUTT_LIB_SLAB_H
+
+#include <stddef.h>
+
+struct Slab;
+
+void *       mutt_slab_alloc  (struct Slab *slab, size_t size);
+void         mutt_slab_free   (struct Slab **ptr);
+size_t       mutt_slab_live   (const struct Slab *slab);
+struct Slab *mutt_slab_new    (void);
+void         mutt_slab_release(struct Slab *slab, void *ptr, size_t size);
+
+#endif /* MUTT_LIB_SLAB_H */
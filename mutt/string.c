@@ -33,6 +33,7 @@
 #include <limits.h>
 #include <stdarg.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -950,6 +951,19 @@ bool mutt_str_is_ascii(const char *str, size_t len)
   if (!str)
     return true;
 
+  /* Check a word at a time, until one has a NUL or an 8-bit char */
+  const uint64_t lows = 0x0101010101010101ULL;
+  const uint64_t highs = 0x8080808080808080ULL;
+  while (len >= sizeof(uint64_t))
+  {
+    uint64_t word;
+    memcpy(&word, str, sizeof(word));
+    if (((word | (word - lows)) & highs) != 0)
+      break;
+    str += sizeof(word);
+    len -= sizeof(word);
+  }
+
   for (; (*str != '\0') && (len > 0); str++, len--)
     if ((*str & 0x80) != 0)
       return false;
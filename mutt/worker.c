@@ -0,0 +1,250 @@
+/**
+ * @file
+ * Pool of worker threads
+ *
+ * @authors
+ * Copyright (C) 2021 Richard Russon <rich@flatcap.org>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @page mutt_worker Pool of worker threads
+ *
+ * Run a numbered set of jobs on a pool of threads, while the caller consumes
+ * the results in order.
+ *
+ * The workers may run ahead of the caller by, at most, `window` jobs.  This
+ * bounds the resources (open files, memory) held by completed, but unconsumed,
+ * jobs.
+ *
+ * If NeoMutt was built without pthreads, or only one thread is requested, the
+ * jobs are run, in order, by mutt_worker_wait().
+ */
+
+#include "config.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <unistd.h>
+#ifdef USE_PTHREADS
+#include <pthread.h>
+#endif
+#include "worker.h"
+#include "logging.h"
+#include "memory.h"
+
+/// Upper limit on the number of worker threads
+#define WORKER_MAX_THREADS 64
+
+/**
+ * struct WorkerPool - A pool of threads working through a set of jobs
+ */
+struct WorkerPool
+{
+  worker_job_t job; ///< Function to run each job
+  void *data;       ///< Private data for the job
+  size_t count;     ///< Number of jobs
+  size_t window;    ///< How many jobs the workers may run ahead of the caller
+  size_t next;      ///< Next job to be started
+  size_t consumed;  ///< Number of jobs the caller has asked for
+  int num_threads;  ///< Number of worker threads
+#ifdef USE_PTHREADS
+  bool stop;                  ///< Tell the workers to finish early
+  bool *done;                 ///< Which jobs are complete
+  pthread_t *threads;         ///< Worker threads
+  pthread_mutex_t lock;       ///< Protects the fields above
+  pthread_cond_t cond_work;   ///< Signalled when the window moves
+  pthread_cond_t cond_done;   ///< Signalled when a job completes
+#endif
+};
+
+#ifdef USE_PTHREADS
+/**
+ * worker_main - Main loop of a worker thread
+ * @param arg WorkerPool
+ * @retval NULL Always
+ */
+static void *worker_main(void *arg)
+{
+  struct WorkerPool *wp = arg;
+
+  pthread_mutex_lock(&wp->lock);
+  while (true)
+  {
+    while (!wp->stop && (wp->next < wp->count) && (wp->next >= (wp->consumed + wp->window)))
+      pthread_cond_wait(&wp->cond_work, &wp->lock);
+
+    if (wp->stop || (wp->next >= wp->count))
+      break;
+
+    size_t index = wp->next++;
+    pthread_mutex_unlock(&wp->lock);
+
+    wp->job(wp->data, index);
+
+    pthread_mutex_lock(&wp->lock);
+    wp->done[index] = true;
+    pthread_cond_broadcast(&wp->cond_done);
+  }
+  pthread_mutex_unlock(&wp->lock);
+
+  return NULL;
+}
+#endif
+
+/**
+ * mutt_worker_threads - Decide how many worker threads to use
+ * @param requested Number of threads the user asked for, 0 means one per CPU
+ * @retval num Number of threads
+ */
+int mutt_worker_threads(int requested)
+{
+#ifdef USE_PTHREADS
+  if (requested <= 0)
+  {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    requested = (cpus > 0) ? (int) cpus : 1;
+  }
+
+  if (requested > WORKER_MAX_THREADS)
+    requested = WORKER_MAX_THREADS;
+
+  return requested;
+#else
+  return 1;
+#endif
+}
+
+/**
+ * mutt_worker_new - Create a WorkerPool and start its threads
+ * @param count   Number of jobs
+ * @param threads Number of threads to use, see mutt_worker_threads()
+ * @param window  Maximum number of jobs to run ahead of the caller
+ * @param job     Function to run each job
+ * @param data    Private data for the job
+ * @retval ptr New WorkerPool
+ *
+ * The caller must call mutt_worker_wait() for each job it needs, in order, and
+ * must free the pool with mutt_worker_free().
+ */
+struct WorkerPool *mutt_worker_new(size_t count, int threads, size_t window,
+                                   worker_job_t job, void *data)
+{
+  struct WorkerPool *wp = mutt_mem_calloc(1, sizeof(*wp));
+  wp->job = job;
+  wp->data = data;
+  wp->count = count;
+  wp->window = (window > 0) ? window : 1;
+
+#ifdef USE_PTHREADS
+  threads = mutt_worker_threads(threads);
+  if ((size_t) threads > count)
+    threads = count;
+  if (threads < 2)
+    return wp;
+
+  wp->done = mutt_mem_calloc(count, sizeof(bool));
+  wp->threads = mutt_mem_calloc(threads, sizeof(pthread_t));
+  pthread_mutex_init(&wp->lock, NULL);
+  pthread_cond_init(&wp->cond_work, NULL);
+  pthread_cond_init(&wp->cond_done, NULL);
+
+  for (int i = 0; i < threads; i++)
+  {
+    if (pthread_create(&wp->threads[i], NULL, worker_main, wp) != 0)
+    {
+      mutt_debug(LL_DEBUG1, "pthread_create failed, using %d threads\n", i);
+      break;
+    }
+    wp->num_threads++;
+  }
+#endif
+
+  return wp;
+}
+
+/**
+ * mutt_worker_wait - Wait for a job to complete
+ * @param wp    WorkerPool
+ * @param index Job to wait for
+ *
+ * Calling this also allows the workers to move on to later jobs.
+ * If the pool has no threads, the job is run on the caller's thread.
+ */
+void mutt_worker_wait(struct WorkerPool *wp, size_t index)
+{
+  if (!wp || (index >= wp->count))
+    return;
+
+#ifdef USE_PTHREADS
+  if (wp->num_threads > 0)
+  {
+    pthread_mutex_lock(&wp->lock);
+    if (index >= wp->consumed)
+    {
+      wp->consumed = index + 1;
+      pthread_cond_broadcast(&wp->cond_work);
+    }
+    while (!wp->done[index])
+      pthread_cond_wait(&wp->cond_done, &wp->lock);
+    pthread_mutex_unlock(&wp->lock);
+    return;
+  }
+#endif
+
+  if (index >= wp->consumed)
+    wp->consumed = index + 1;
+  while (wp->next <= index)
+    wp->job(wp->data, wp->next++);
+}
+
+/**
+ * mutt_worker_free - Stop the workers and free a WorkerPool
+ * @param[out] ptr WorkerPool to free
+ *
+ * Any jobs that haven't been started will be skipped.
+ * Jobs in progress will be allowed to finish.
+ */
+void mutt_worker_free(struct WorkerPool **ptr)
+{
+  if (!ptr || !*ptr)
+    return;
+
+  struct WorkerPool *wp = *ptr;
+
+#ifdef USE_PTHREADS
+  if (wp->num_threads > 0)
+  {
+    pthread_mutex_lock(&wp->lock);
+    wp->stop = true;
+    pthread_cond_broadcast(&wp->cond_work);
+    pthread_mutex_unlock(&wp->lock);
+
+    for (int i = 0; i < wp->num_threads; i++)
+      pthread_join(wp->threads[i], NULL);
+  }
+
+  if (wp->threads)
+  {
+    pthread_cond_destroy(&wp->cond_done);
+    pthread_cond_destroy(&wp->cond_work);
+    pthread_mutex_destroy(&wp->lock);
+  }
+  FREE(&wp->threads);
+  FREE(&wp->done);
+#endif
+
+  FREE(ptr);
+}
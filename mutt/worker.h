@@ -0,0 +1,45 @@
+/**
+ * @file
+ * Pool of worker threads
+ *
+ * @authors
+ * Copyright (C) 2021 Richard Russon <rich@flatcap.org>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MUTT_LIB_WORKER_H
+#define MUTT_LIB_WORKER_H
+
+#include <stddef.h>
+
+struct WorkerPool;
+
+/**
+ * typedef worker_job_t - Prototype for a job run by a WorkerPool
+ * @param data  Private data passed to mutt_worker_new()
+ * @param index Index of the job, 0 to count-1
+ *
+ * @note The job may be run on any thread.  It must not touch any shared state,
+ *       e.g. logging, the Buffer pool, the precompiled regexes or the GUI.
+ */
+typedef void (*worker_job_t)(void *data, size_t index);
+
+struct WorkerPool *mutt_worker_new    (size_t count, int threads, size_t window, worker_job_t job, void *data);
+void               mutt_worker_free   (struct WorkerPool **ptr);
+int                mutt_worker_threads(int requested);
+void               mutt_worker_wait   (struct WorkerPool *wp, size_t index);
+
+#endif /* MUTT_LIB_WORKER_H */
@@ -78,6 +78,7 @@ int mutt_body_copy(FILE *fp, struct Body **tgt, struct Body *src)
   TAILQ_INIT(&b->parameter);
   b->parts = NULL;
   b->next = NULL;
+  b->slab = NULL;
 
   b->filename = mutt_buffer_strdup(tmp);
   b->use_disp = use_disp;
@@ -42,6 +42,7 @@
 #include "mutt_header.h"
 #include "index/lib.h"
 #include "ncrypt/lib.h"
+#include "pattern/lib.h"
 #include "send/lib.h"
 #include "muttlib.h"
 #include "options.h"
@@ -153,7 +154,8 @@ int mutt_label_message(struct Mailbox *m, struct EmailList *el)
     if (label_message(m, en->email, new_label))
     {
       changed++;
-      mutt_set_header_color(m, en->email);
+      en->email->score_stale |= PAT_DEP_TAGS;
+      mutt_header_color_stale(en->email, PAT_DEP_TAGS);
     }
   }
 
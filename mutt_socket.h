@@ -34,6 +34,7 @@ struct Connection *mutt_conn_find(const struct ConnAccount *account);
 struct Connection *mutt_conn_new(const struct ConnAccount *account);
 
 #define mutt_socket_readln(buf, buflen, conn) mutt_socket_readln_d(buf, buflen, conn, MUTT_SOCK_LOG_CMD)
+#define mutt_socket_buffer_readln(buf, conn)  mutt_socket_buffer_readln_d(buf, conn, MUTT_SOCK_LOG_CMD)
 #define mutt_socket_send(conn, buf)           mutt_socket_send_d(conn, buf, MUTT_SOCK_LOG_CMD)
 #define mutt_socket_send_d(conn, buf, dbg)    mutt_socket_write_d(conn, buf, mutt_str_len(buf), dbg)
 #define mutt_socket_write_n(conn, buf, len)   mutt_socket_write_d(conn, buf, len, MUTT_SOCK_LOG_CMD)
@@ -29,6 +29,7 @@
 #include "config.h"
 #include <limits.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 #include "mutt/lib.h"
@@ -37,21 +38,28 @@
 #include "core/lib.h"
 #include "mutt.h"
 #include "mutt_thread.h"
+#include "pattern/lib.h"
 #include "mx.h"
 #include "options.h"
 #include "protos.h"
 #include "sort.h"
 
 static sort_t sort_func = NULL;
+/* precomputed keys, used instead of sort_func by mutt_sort_subthreads() */
+static struct SortKeys *sort_keys = NULL;
+
+ARRAY_HEAD(MuttThreadArray, struct MuttThread *);
 
 /**
  * struct ThreadsContext - The "current" threading state
  */
 struct ThreadsContext
 {
-  struct Mailbox *mailbox; ///< Current mailbox
-  struct MuttThread *tree; ///< Top of thread tree
-  struct HashTable *hash;  ///< Hash table for threads
+  struct Mailbox *mailbox;      ///< Current mailbox
+  struct MuttThread *tree;      ///< Top of thread tree
+  struct HashTable *hash;       ///< Hash table for threads
+  struct MuttThreadArray roots; ///< Top-level Threads, in the order of the tree
+  int msg_count;                ///< Number of Emails in the tree
 };
 
 /**
@@ -75,8 +83,8 @@ static bool need_display_subject(struct Email *e)
   struct MuttThread *tree = e->thread;
 
   /* if the user disabled subject hiding, display it */
-  const bool c_hide_thread_subject =
-      cs_subset_bool(NeoMutt->sub, "hide_thread_subject");
+  static struct ConfigHandle ch_hide_thread_subject = CONFIG_HANDLE("hide_thread_subject");
+  const bool c_hide_thread_subject = cs_handle_bool(NeoMutt->sub, &ch_hide_thread_subject);
   if (!c_hide_thread_subject)
     return true;
 
@@ -130,8 +138,15 @@ static void linearize_tree(struct ThreadsContext *tctx)
   struct MuttThread *tree = tctx->tree;
   struct Email **array = m->emails + ((c_sort & SORT_REVERSE) ? m->msg_count - 1 : 0);
 
+  /* Every top-level Thread contains at least one Email */
+  ARRAY_SHRINK(&tctx->roots, ARRAY_SIZE(&tctx->roots));
+  ARRAY_RESERVE(&tctx->roots, m->msg_count);
+
   while (tree)
   {
+    if (!tree->parent)
+      ARRAY_ADD(&tctx->roots, tree);
+
     while (!tree->message)
       tree = tree->child;
 
@@ -165,7 +180,7 @@ static void linearize_tree(struct ThreadsContext *tctx)
  * nodes, whether a node itself is visible, whether, if invisible, it has
  * depth anyway, and whether any of its later siblings are roots of visible
  * subtrees.  while it's at it, it frees the old thread display, so we can
- * skip parts of the tree in mutt_draw_tree() if we've decided here that we
+ * skip parts of the tree in draw_tree() if we've decided here that we
  * don't care about them any more.
  */
 static void calculate_visibility(struct MuttThread *tree, int *max_depth)
@@ -300,12 +315,13 @@ void mutt_thread_ctx_free(struct ThreadsContext **tctx)
 {
   (*tctx)->mailbox = NULL;
   mutt_hash_free(&(*tctx)->hash);
+  ARRAY_FREE(&(*tctx)->roots);
   FREE(tctx);
 }
 
 /**
- * mutt_draw_tree - Draw a tree of threaded emails
- * @param tctx Threading context
+ * draw_tree - Draw a list of threads and their descendants
+ * @param tree First top-level thread
  *
  * Since the graphics characters have a value >255, I have to resort to using
  * escape sequences to pass the information to print_enriched_string().  These
@@ -315,18 +331,18 @@ void mutt_thread_ctx_free(struct ThreadsContext **tctx)
  * graphics chars on terminals which don't support them (see the man page for
  * curs_addch).
  */
-void mutt_draw_tree(struct ThreadsContext *tctx)
+static void draw_tree(struct MuttThread *tree)
 {
   char *pfx = NULL, *mypfx = NULL, *arrow = NULL, *myarrow = NULL, *new_tree = NULL;
   const short c_sort = cs_subset_sort(NeoMutt->sub, "sort");
   enum TreeChar corner = (c_sort & SORT_REVERSE) ? MUTT_TREE_ULCORNER : MUTT_TREE_LLCORNER;
   enum TreeChar vtee = (c_sort & SORT_REVERSE) ? MUTT_TREE_BTEE : MUTT_TREE_TTEE;
   const bool c_narrow_tree = cs_subset_bool(NeoMutt->sub, "narrow_tree");
+  const bool c_hide_limited = cs_subset_bool(NeoMutt->sub, "hide_limited");
+  const bool c_hide_missing = cs_subset_bool(NeoMutt->sub, "hide_missing");
   int depth = 0, start_depth = 0, max_depth = 0, width = c_narrow_tree ? 1 : 2;
   struct MuttThread *nextdisp = NULL, *pseudo = NULL, *parent = NULL;
 
-  struct MuttThread *tree = tctx->tree;
-
   /* Do the visibility calculations and free the old thread chars.
    * From now on we can simply ignore invisible subtrees */
   calculate_visibility(tree, &max_depth);
@@ -337,8 +353,6 @@ void mutt_draw_tree(struct ThreadsContext *tctx)
     if (depth != 0)
     {
       myarrow = arrow + (depth - start_depth - ((start_depth != 0) ? 0 : 1)) * width;
-      const bool c_hide_limited = cs_subset_bool(NeoMutt->sub, "hide_limited");
-      const bool c_hide_missing = cs_subset_bool(NeoMutt->sub, "hide_missing");
       if (start_depth == depth)
         myarrow[0] = nextdisp ? MUTT_TREE_LTEE : corner;
       else if (parent->message && !c_hide_limited)
@@ -433,6 +447,67 @@ void mutt_draw_tree(struct ThreadsContext *tctx)
   FREE(&arrow);
 }
 
+/**
+ * draw_thread - Draw a single top-level thread
+ * @param root Top-level thread
+ *
+ * The drawing of a thread doesn't depend on its siblings, so it's temporarily
+ * cut out of the list of top-level threads.
+ */
+static void draw_thread(struct MuttThread *root)
+{
+  struct MuttThread *prev = root->prev;
+  struct MuttThread *next = root->next;
+
+  root->prev = NULL;
+  root->next = NULL;
+  draw_tree(root);
+  root->prev = prev;
+  root->next = next;
+}
+
+/**
+ * mutt_draw_tree - Draw a tree of threaded emails
+ * @param tctx Threading context
+ *
+ * Only the visibility of the threads is worked out now.  The tree strings
+ * are made a thread at a time, when they're displayed, see mutt_thread_tree().
+ */
+void mutt_draw_tree(struct ThreadsContext *tctx)
+{
+  int max_depth = 0;
+  calculate_visibility(tctx->tree, &max_depth);
+
+  for (struct MuttThread *root = tctx->tree; root; root = root->next)
+    root->tree_drawn = false;
+}
+
+/**
+ * mutt_thread_tree - Get the thread tree string of an Email
+ * @param e Email
+ * @retval ptr  Tree string, see Email::tree
+ * @retval NULL The Email isn't drawn with a tree, e.g. it's at the top level
+ *
+ * The first time one of its Emails is displayed, the whole thread is drawn.
+ */
+const char *mutt_thread_tree(struct Email *e)
+{
+  if (!e || !e->thread)
+    return NULL;
+
+  struct MuttThread *root = e->thread;
+  while (root->parent)
+    root = root->parent;
+
+  if (!root->tree_drawn)
+  {
+    draw_thread(root);
+    root->tree_drawn = true;
+  }
+
+  return e->tree;
+}
+
 /**
  * make_subject_list - Create a sorted list of all subjects in a thread
  * @param[out] subjects String List of subjects
@@ -450,6 +525,11 @@ static void make_subject_list(struct ListHead *subjects, struct MuttThread *cur,
   time_t thisdate;
   int rc = 0;
 
+  static struct ConfigHandle ch_thread_received = CONFIG_HANDLE("thread_received");
+  static struct ConfigHandle ch_sort_re = CONFIG_HANDLE("sort_re");
+  const bool c_thread_received = cs_handle_bool(NeoMutt->sub, &ch_thread_received);
+  const bool c_sort_re = cs_handle_bool(NeoMutt->sub, &ch_sort_re);
+
   while (true)
   {
     while (!cur->message)
@@ -457,15 +537,12 @@ static void make_subject_list(struct ListHead *subjects, struct MuttThread *cur,
 
     if (dateptr)
     {
-      const bool c_thread_received =
-          cs_subset_bool(NeoMutt->sub, "thread_received");
       thisdate = c_thread_received ? cur->message->received : cur->message->date_sent;
       if ((*dateptr == 0) || (thisdate < *dateptr))
         *dateptr = thisdate;
     }
 
     env = cur->message->env;
-    const bool c_sort_re = cs_subset_bool(NeoMutt->sub, "sort_re");
     if (env->real_subj && ((env->real_subj != env->subject) || !c_sort_re))
     {
       struct ListNode *np = NULL;
@@ -512,13 +589,14 @@ static struct MuttThread *find_subject(struct Mailbox *m, struct MuttThread *cur
 
   make_subject_list(&subjects, cur, &date);
 
+  static struct ConfigHandle ch_thread_received = CONFIG_HANDLE("thread_received");
+  const bool c_thread_received = cs_handle_bool(NeoMutt->sub, &ch_thread_received);
+
   struct ListNode *np = NULL;
   STAILQ_FOREACH(np, &subjects, entries)
   {
     for (ptr = mutt_hash_find_bucket(m->subj_hash, np->data); ptr; ptr = ptr->next)
     {
-      const bool c_thread_received =
-          cs_subset_bool(NeoMutt->sub, "thread_received");
       tmp = ((struct Email *) ptr->data)->thread;
       if ((tmp != cur) &&                  /* don't match the same message */
           !tmp->fake_thread &&             /* don't match pseudo threads */
@@ -564,6 +642,67 @@ static struct HashTable *make_subj_hash(struct Mailbox *m)
   return hash;
 }
 
+/**
+ * pseudo_thread - Thread a top-level thread by subject
+ * @param[in]     m   Mailbox
+ * @param[in,out] top First top-level thread
+ * @param[in]     cur Top-level thread to attach
+ * @retval ptr  Thread that cur was attached to
+ * @retval NULL No match was found
+ */
+static struct MuttThread *pseudo_thread(struct Mailbox *m, struct MuttThread **top,
+                                        struct MuttThread *cur)
+{
+  struct MuttThread *tmp = NULL, *curchild = NULL, *nextchild = NULL;
+
+  struct MuttThread *parent = find_subject(m, cur);
+  if (!parent)
+    return NULL;
+
+  cur->fake_thread = true;
+  unlink_message(top, cur);
+  insert_message(&parent->child, parent, cur);
+  parent->sort_children = true;
+  tmp = cur;
+  while (true)
+  {
+    while (!tmp->message)
+      tmp = tmp->child;
+
+    /* if the message we're attaching has pseudo-children, they
+     * need to be attached to its parent, so move them up a level.
+     * but only do this if they have the same real subject as the
+     * parent, since otherwise they rightly belong to the message
+     * we're attaching. */
+    if ((tmp == cur) || mutt_str_equal(tmp->message->env->real_subj,
+                                       parent->message->env->real_subj))
+    {
+      tmp->message->subject_changed = false;
+
+      for (curchild = tmp->child; curchild;)
+      {
+        nextchild = curchild->next;
+        if (curchild->fake_thread)
+        {
+          unlink_message(&tmp->child, curchild);
+          insert_message(&parent->child, parent, curchild);
+        }
+        curchild = nextchild;
+      }
+    }
+
+    while (!tmp->next && (tmp != cur))
+    {
+      tmp = tmp->parent;
+    }
+    if (tmp == cur)
+      break;
+    tmp = tmp->next;
+  }
+
+  return parent;
+}
+
 /**
  * pseudo_threads - Thread messages by subject
  * @param tctx Threading context
@@ -579,8 +718,7 @@ static void pseudo_threads(struct ThreadsContext *tctx)
 
   struct MuttThread *tree = tctx->tree;
   struct MuttThread *top = tree;
-  struct MuttThread *tmp = NULL, *cur = NULL, *parent = NULL, *curchild = NULL,
-                    *nextchild = NULL;
+  struct MuttThread *cur = NULL;
 
   if (!m->subj_hash)
     m->subj_hash = make_subj_hash(m);
@@ -589,50 +727,7 @@ static void pseudo_threads(struct ThreadsContext *tctx)
   {
     cur = tree;
     tree = tree->next;
-    parent = find_subject(m, cur);
-    if (parent)
-    {
-      cur->fake_thread = true;
-      unlink_message(&top, cur);
-      insert_message(&parent->child, parent, cur);
-      parent->sort_children = true;
-      tmp = cur;
-      while (true)
-      {
-        while (!tmp->message)
-          tmp = tmp->child;
-
-        /* if the message we're attaching has pseudo-children, they
-         * need to be attached to its parent, so move them up a level.
-         * but only do this if they have the same real subject as the
-         * parent, since otherwise they rightly belong to the message
-         * we're attaching. */
-        if ((tmp == cur) || mutt_str_equal(tmp->message->env->real_subj,
-                                           parent->message->env->real_subj))
-        {
-          tmp->message->subject_changed = false;
-
-          for (curchild = tmp->child; curchild;)
-          {
-            nextchild = curchild->next;
-            if (curchild->fake_thread)
-            {
-              unlink_message(&tmp->child, curchild);
-              insert_message(&parent->child, parent, curchild);
-            }
-            curchild = nextchild;
-          }
-        }
-
-        while (!tmp->next && (tmp != cur))
-        {
-          tmp = tmp->parent;
-        }
-        if (tmp == cur)
-          break;
-        tmp = tmp->next;
-      }
-    }
+    pseudo_thread(m, &top, cur);
   }
   tctx->tree = top;
 }
@@ -658,6 +753,8 @@ void mutt_clear_threads(struct ThreadsContext *tctx)
   }
   tctx->tree = NULL;
   mutt_hash_free(&tctx->hash);
+  ARRAY_SHRINK(&tctx->roots, ARRAY_SIZE(&tctx->roots));
+  tctx->msg_count = 0;
 }
 
 /**
@@ -670,43 +767,48 @@ void mutt_clear_threads(struct ThreadsContext *tctx)
  */
 static int compare_threads(const void *a, const void *b)
 {
-  return (*sort_func)(&(*((struct MuttThread const *const *) a))->sort_key,
-                      &(*((struct MuttThread const *const *) b))->sort_key);
+  const struct MuttThread *ta = *(struct MuttThread const *const *) a;
+  const struct MuttThread *tb = *(struct MuttThread const *const *) b;
+
+  if (sort_keys)
+    return mutt_sort_keys_cmp(sort_keys, ta->sort_key, tb->sort_key);
+
+  return (*sort_func)(&ta->sort_key, &tb->sort_key);
 }
 
 /**
- * mutt_sort_subthreads - Sort the children of a thread
- * @param tctx Threading context
- * @param init If true, rebuild the thread
+ * compare_threads_r - Sorting function for email threads - Implements ::merge_cmp_t
  */
-void mutt_sort_subthreads(struct ThreadsContext *tctx, bool init)
+static int compare_threads_r(const void *a, const void *b, void *sdata)
 {
-  struct MuttThread *thread = tctx->tree;
-  if (!thread)
-    return;
+  return compare_threads(a, b);
+}
 
+/**
+ * sort_subthreads - Sort a list of threads and their children
+ * @param thread First thread of the list
+ * @param c_sort Sort order, already reversed, see mutt_sort_subthreads()
+ * @param init   If true, rebuild the thread
+ * @retval ptr New first thread of the list
+ *
+ * @note sort_func must be set, and `$sort` must be set to c_sort
+ *
+ * If sort_keys is set, the siblings are sorted by their keys, using
+ * `$sort_threads` threads for the long lists.  The Emails' own sort functions
+ * use global state, so they're only ever run on the main thread.
+ */
+static struct MuttThread *sort_subthreads(struct MuttThread *thread, short c_sort, bool init)
+{
   struct MuttThread **array = NULL, *sort_key = NULL, *top = NULL, *tmp = NULL;
   struct Email *oldsort_key = NULL;
   int i, array_size, sort_top = 0;
 
-  /* we put things into the array backwards to save some cycles,
-   * but we want to have to move less stuff around if we're
-   * resorting, so we sort backwards and then put them back
-   * in reverse order so they're forwards */
-  short c_sort = cs_subset_sort(NeoMutt->sub, "sort");
-  c_sort ^= SORT_REVERSE;
-  bool oldresort = OptNeedResort;
-  cs_subset_str_native_set(NeoMutt->sub, "sort", c_sort, NULL);
-  OptNeedResort = oldresort;
-
-  sort_func = mutt_get_sort_func(c_sort & SORT_MASK, mx_type(tctx->mailbox));
-  if (!sort_func)
-  {
-    return;
-  }
-
   top = thread;
 
+  int threads = 1;
+  if (sort_keys)
+    threads = cs_subset_number(NeoMutt->sub, "sort_threads");
+
   array_size = 256;
   array = mutt_mem_calloc(array_size, sizeof(struct MuttThread *));
   while (true)
@@ -752,7 +854,7 @@ void mutt_sort_subthreads(struct ThreadsContext *tctx, bool init)
           array[i] = thread;
         }
 
-        qsort((void *) array, i, sizeof(struct MuttThread *), *compare_threads);
+        mutt_merge_sort(array, i, sizeof(struct MuttThread *), compare_threads_r, NULL, threads);
 
         /* attach them back together.  make thread the last sibling. */
         thread = array[0];
@@ -813,13 +915,8 @@ void mutt_sort_subthreads(struct ThreadsContext *tctx, bool init)
       }
       else
       {
-        oldresort = OptNeedResort;
-        c_sort ^= SORT_REVERSE;
-        cs_subset_str_native_set(NeoMutt->sub, "sort", c_sort, NULL);
-        OptNeedResort = oldresort;
         FREE(&array);
-        tctx->tree = top;
-        return;
+        return top;
       }
     }
 
@@ -827,6 +924,76 @@ void mutt_sort_subthreads(struct ThreadsContext *tctx, bool init)
   }
 }
 
+/**
+ * reverse_sort - Reverse the direction of `$sort`
+ * @retval num The new value of `$sort`
+ *
+ * mutt_sort_subthreads() puts things into an array backwards to save some
+ * cycles, but it wants to move less stuff around when resorting, so it sorts
+ * backwards and then puts them back in reverse order so they're forwards.
+ */
+static short reverse_sort(void)
+{
+  short c_sort = cs_subset_sort(NeoMutt->sub, "sort");
+  c_sort ^= SORT_REVERSE;
+  bool oldresort = OptNeedResort;
+  cs_subset_str_native_set(NeoMutt->sub, "sort", c_sort, NULL);
+  OptNeedResort = oldresort;
+  return c_sort;
+}
+
+/**
+ * mutt_sort_subthreads - Sort the children of a thread
+ * @param tctx Threading context
+ * @param init If true, rebuild the thread
+ */
+void mutt_sort_subthreads(struct ThreadsContext *tctx, bool init)
+{
+  struct MuttThread *thread = tctx->tree;
+  if (!thread)
+    return;
+
+  const short c_sort = reverse_sort();
+
+  sort_func = mutt_get_sort_func(c_sort & SORT_MASK, mx_type(tctx->mailbox));
+  if (!sort_func)
+  {
+    return;
+  }
+
+  /* Only the thread's own sort method is used, like perform_auxsort()
+   * when AuxSort isn't set */
+  sort_keys = mutt_sort_keys_new(tctx->mailbox, c_sort, 0);
+  tctx->tree = sort_subthreads(thread, c_sort, init);
+  mutt_sort_keys_free(&sort_keys);
+  reverse_sort();
+}
+
+/**
+ * check_subject - Find out whether an email's subject differs from its parent's
+ * @param e Email
+ */
+static void check_subject(struct Email *e)
+{
+  /* figure out which messages have subjects different than their parents' */
+  struct MuttThread *tmp = e->thread->parent;
+  while (tmp && !tmp->message)
+  {
+    tmp = tmp->parent;
+  }
+
+  if (!tmp)
+    e->subject_changed = true;
+  else if (e->env->real_subj && tmp->message->env->real_subj)
+  {
+    e->subject_changed = !mutt_str_equal(e->env->real_subj, tmp->message->env->real_subj);
+  }
+  else
+  {
+    e->subject_changed = (e->env->real_subj || tmp->message->env->real_subj);
+  }
+}
+
 /**
  * check_subjects - Find out which emails' subjects differ from their parent's
  * @param m    Mailbox
@@ -848,24 +1015,567 @@ static void check_subjects(struct Mailbox *m, bool init)
     else if (!init)
       continue;
 
-    /* figure out which messages have subjects different than their parents' */
-    struct MuttThread *tmp = e->thread->parent;
-    while (tmp && !tmp->message)
+    check_subject(e);
+  }
+}
+
+/**
+ * next_reference - Get the next Message-ID that an Email refers to
+ * @param[in]     env        Envelope of the Email
+ * @param[in]     ref        Previous reference, if any
+ * @param[in,out] using_refs Which header is being used, start with 0
+ * @retval ptr  Next reference
+ * @retval NULL No more references
+ */
+static struct ListNode *next_reference(struct Envelope *env, struct ListNode *ref,
+                                       int *using_refs)
+{
+  if (*using_refs == 0)
+  {
+    /* look at the beginning of in-reply-to: */
+    ref = STAILQ_FIRST(&env->in_reply_to);
+    if (ref)
+      *using_refs = 1;
+    else
     {
-      tmp = tmp->parent;
+      ref = STAILQ_FIRST(&env->references);
+      *using_refs = 2;
     }
+  }
+  else if (*using_refs == 1)
+  {
+    /* if there's no references header, use all the in-reply-to:
+     * data that we have.  otherwise, use the first reference
+     * if it's different than the first in-reply-to, otherwise use
+     * the second reference (since at least eudora puts the most
+     * recent reference in in-reply-to and the rest in references) */
+    if (STAILQ_EMPTY(&env->references))
+      ref = STAILQ_NEXT(ref, entries);
+    else
+    {
+      if (!mutt_str_equal(ref->data, STAILQ_FIRST(&env->references)->data))
+        ref = STAILQ_FIRST(&env->references);
+      else
+        ref = STAILQ_NEXT(STAILQ_FIRST(&env->references), entries);
+
+      *using_refs = 2;
+    }
+  }
+  else
+    ref = STAILQ_NEXT(ref, entries); /* go on with references */
+
+  return ref;
+}
+
+/**
+ * struct ThreadUpdate - Threads changed by the arrival of new Emails
+ */
+struct ThreadUpdate
+{
+  struct MuttThreadArray touched;  ///< Threads whose descendants have changed
+  struct MuttThreadArray unrooted; ///< Threads taken out of the top level
+};
+
+/**
+ * compare_thread_ptrs - Compare two threads by address
+ * @param a First thread to compare
+ * @param b Second thread to compare
+ * @retval <0 a precedes b
+ * @retval  0 a and b are identical
+ * @retval >0 b precedes a
+ */
+static int compare_thread_ptrs(const void *a, const void *b)
+{
+  const uintptr_t pa = (uintptr_t) *(struct MuttThread const *const *) a;
+  const uintptr_t pb = (uintptr_t) *(struct MuttThread const *const *) b;
+  return (pa > pb) - (pa < pb);
+}
+
+/**
+ * is_top_level - Is a thread in the list of top-level threads?
+ * @param tctx Threading context
+ * @param cur  Thread to check
+ * @retval true The thread is at the top level
+ *
+ * @note Threads which were taken out of a list must have been cleaned by
+ *       detach_thread()
+ */
+static bool is_top_level(struct ThreadsContext *tctx, struct MuttThread *cur)
+{
+  return !cur->parent && (cur->prev || (tctx->tree == cur));
+}
 
-    if (!tmp)
-      e->subject_changed = true;
-    else if (e->env->real_subj && tmp->message->env->real_subj)
+/**
+ * detach_thread - Take a thread out of its list of siblings
+ * @param[in,out] head First thread of the list
+ * @param[in]     cur  Thread to detach
+ */
+static void detach_thread(struct MuttThread **head, struct MuttThread *cur)
+{
+  unlink_message(head, cur);
+  cur->parent = NULL;
+  cur->prev = NULL;
+  cur->next = NULL;
+}
+
+/**
+ * unroot_thread - Take a thread out of the list of top-level threads
+ * @param tctx Threading context
+ * @param tu   Changed threads
+ * @param cur  Top-level thread
+ */
+static void unroot_thread(struct ThreadsContext *tctx, struct ThreadUpdate *tu,
+                          struct MuttThread *cur)
+{
+  detach_thread(&tctx->tree, cur);
+  ARRAY_ADD(&tu->unrooted, cur);
+}
+
+/**
+ * touched_roots - Find the top-level threads of the touched threads
+ * @param[in]  tctx  Threading context
+ * @param[in]  tu    Changed threads
+ * @param[out] roots Distinct top-level threads
+ */
+static void touched_roots(struct ThreadsContext *tctx, struct ThreadUpdate *tu,
+                          struct MuttThreadArray *roots)
+{
+  struct MuttThread **tp = NULL;
+
+  ARRAY_SHRINK(roots, ARRAY_SIZE(roots));
+  ARRAY_FOREACH(tp, &tu->touched)
+  {
+    struct MuttThread *tree = *tp;
+    while (tree->parent)
+      tree = tree->parent;
+
+    /* Missing messages may have been cut loose since they were touched */
+    if (is_top_level(tctx, tree))
+      ARRAY_ADD(roots, tree);
+  }
+
+  ARRAY_SORT(roots, compare_thread_ptrs);
+
+  size_t num = 0;
+  ARRAY_FOREACH(tp, roots)
+  {
+    if ((num == 0) || (*tp != roots->entries[num - 1]))
+      roots->entries[num++] = *tp;
+  }
+  ARRAY_SHRINK(roots, ARRAY_SIZE(roots) - num);
+}
+
+/**
+ * check_thread_subjects - Check the subjects of a thread's flagged emails
+ * @param root Top-level thread
+ *
+ * Like check_subjects(), but only for one thread.
+ */
+static void check_thread_subjects(struct MuttThread *root)
+{
+  struct MuttThread *tree = root;
+
+  while (true)
+  {
+    if (tree->message && tree->check_subject)
     {
-      e->subject_changed = !mutt_str_equal(e->env->real_subj, tmp->message->env->real_subj);
+      tree->check_subject = false;
+      check_subject(tree->message);
     }
+
+    if (tree->child)
+    {
+      tree = tree->child;
+      continue;
+    }
+
+    while (!tree->next && (tree != root))
+      tree = tree->parent;
+    if (tree == root)
+      break;
+    tree = tree->next;
+  }
+}
+
+/**
+ * is_unrooted - Has a thread been taken out of the top level?
+ * @param tu   Changed threads, with ThreadUpdate::unrooted sorted
+ * @param cur  Thread to check
+ * @retval true The thread was taken out of the top level
+ */
+static bool is_unrooted(struct ThreadUpdate *tu, struct MuttThread *cur)
+{
+  return bsearch(&cur, tu->unrooted.entries, ARRAY_SIZE(&tu->unrooted),
+                 ARRAY_ELEM_SIZE(&tu->unrooted), compare_thread_ptrs);
+}
+
+/**
+ * find_root_position - Find where a thread belongs among the top-level threads
+ * @param tctx Threading context
+ * @param tu   Changed threads, with ThreadUpdate::unrooted sorted
+ * @param cur  Thread to place, already sorted
+ * @retval ptr  Top-level thread that cur must precede
+ * @retval NULL cur belongs at the end
+ *
+ * The top-level threads are in descending order of compare_threads().
+ * ThreadsContext::roots still lists them as they were at the last sort, so
+ * the ones which have since been taken out are skipped.
+ */
+static struct MuttThread *find_root_position(struct ThreadsContext *tctx,
+                                             struct ThreadUpdate *tu,
+                                             struct MuttThread *cur)
+{
+  struct MuttThread **roots = tctx->roots.entries;
+  const size_t num = ARRAY_SIZE(&tctx->roots);
+  size_t lo = 0;
+  size_t hi = num;
+
+  while (lo < hi)
+  {
+    const size_t mid = lo + ((hi - lo) / 2);
+    size_t pos = mid;
+    while ((pos < hi) && is_unrooted(tu, roots[pos]))
+      pos++;
+
+    if ((pos == hi) || (compare_threads(&cur, &roots[pos]) > 0))
+      hi = mid;
     else
+      lo = pos + 1;
+  }
+
+  while ((lo < num) && is_unrooted(tu, roots[lo]))
+    lo++;
+
+  return (lo < num) ? roots[lo] : NULL;
+}
+
+/**
+ * thread_new_emails - Add newly arrived Emails to the existing threads
+ * @param[in]  tctx     Threading context
+ * @param[in]  first    Index of the first new Email
+ * @param[out] affected Top-level threads that have changed
+ *
+ * The new Emails are threaded by their References and In-Reply-To, as in
+ * mutt_sort_threads().  Only the threads that they join, and the threads that
+ * they could be a pseudo-thread parent for, are then checked for subject
+ * changes, pseudo-threaded and sorted.  Each of those is placed among the
+ * unchanged top-level threads by a binary search of ThreadsContext::roots.
+ *
+ * @note `$sort` must already be set to `$sort_aux`
+ */
+static void thread_new_emails(struct ThreadsContext *tctx, int first,
+                              struct MuttThreadArray *affected)
+{
+  struct Mailbox *m = tctx->mailbox;
+  struct ThreadUpdate tu = { ARRAY_HEAD_INITIALIZER, ARRAY_HEAD_INITIALIZER };
+  struct MuttThreadArray candidates = ARRAY_HEAD_INITIALIZER;
+  struct MuttThread *thread = NULL, *tnew = NULL, *tmp = NULL;
+  struct MuttThread **tp = NULL;
+  struct ListNode *ref = NULL;
+  struct Email *e = NULL;
+  int using_refs = 0;
+
+  /* put each new message together with the matching messageless MuttThread if
+   * it exists, as in mutt_sort_threads() */
+  const bool c_duplicate_threads = cs_subset_bool(NeoMutt->sub, "duplicate_threads");
+  for (int i = first; i < m->msg_count; i++)
+  {
+    e = m->emails[i];
+    if (!e)
+      continue;
+
+    thread = e->env->message_id ? mutt_hash_find(tctx->hash, e->env->message_id) : NULL;
+    if (thread && !thread->message)
     {
-      e->subject_changed = (e->env->real_subj || tmp->message->env->real_subj);
+      /* this is a message which was missing before */
+      thread->message = e;
+      e->thread = thread;
+      thread->check_subject = true;
+
+      /* mark descendants as needing subject_changed checked */
+      for (tmp = (thread->child ? thread->child : thread); tmp != thread;)
+      {
+        while (!tmp->message)
+          tmp = tmp->child;
+        tmp->check_subject = true;
+        while (!tmp->next && (tmp != thread))
+          tmp = tmp->parent;
+        if (tmp != thread)
+          tmp = tmp->next;
+      }
+
+      if (thread->parent)
+      {
+        /* remove threading info above it, without leaving dangling missing
+         * messages.  it will be rethreaded by its own headers */
+        tmp = thread->parent;
+        detach_thread(&tmp->child, thread);
+        thread->sort_key = NULL;
+        thread->fake_thread = false;
+        while (!tmp->child && !tmp->message)
+        {
+          thread = tmp;
+          tmp = thread->parent;
+          if (!tmp)
+            break;
+          detach_thread(&tmp->child, thread);
+          thread->sort_key = NULL;
+          thread->fake_thread = false;
+        }
+
+        if (tmp)
+        {
+          tmp->sort_children = true;
+          ARRAY_ADD(&tu.touched, tmp);
+        }
+        else
+          unroot_thread(tctx, &tu, thread);
+      }
+      else
+      {
+        thread->sort_key = NULL;
+        if (is_top_level(tctx, thread))
+          unroot_thread(tctx, &tu, thread);
+      }
+    }
+    else
+    {
+      tnew = (c_duplicate_threads ? thread : NULL);
+
+      thread = mutt_mem_calloc(1, sizeof(struct MuttThread));
+      thread->message = e;
+      thread->check_subject = true;
+      e->thread = thread;
+      mutt_hash_insert(tctx->hash, e->env->message_id ? e->env->message_id : "", thread);
+
+      if (tnew)
+      {
+        if (tnew->duplicate_thread)
+          tnew = tnew->parent;
+
+        insert_message(&tnew->child, tnew, thread);
+        tnew->sort_children = true;
+        thread->duplicate_thread = true;
+        thread->message->threaded = true;
+      }
     }
+
+    ARRAY_ADD(&tu.touched, e->thread);
   }
+
+  /* thread by references */
+  for (int i = first; i < m->msg_count; i++)
+  {
+    e = m->emails[i];
+    if (!e || e->threaded)
+      continue;
+    e->threaded = true;
+
+    thread = e->thread;
+    using_refs = 0;
+
+    while (true)
+    {
+      ref = next_reference(e->env, ref, &using_refs);
+      if (!ref)
+        break;
+
+      tnew = mutt_hash_find(tctx->hash, ref->data);
+      if (tnew)
+      {
+        if (tnew->duplicate_thread)
+          tnew = tnew->parent;
+        if (is_descendant(tnew, thread)) /* no loops! */
+          continue;
+      }
+      else
+      {
+        tnew = mutt_mem_calloc(1, sizeof(struct MuttThread));
+        mutt_hash_insert(tctx->hash, ref->data, tnew);
+      }
+
+      if (is_top_level(tctx, thread))
+        unroot_thread(tctx, &tu, thread);
+      insert_message(&tnew->child, tnew, thread);
+      tnew->sort_children = true;
+      thread = tnew;
+      if (thread->message || thread->parent)
+        break;
+    }
+
+    if (!thread->parent && !is_top_level(tctx, thread))
+      insert_message(&tctx->tree, NULL, thread);
+  }
+
+  touched_roots(tctx, &tu, affected);
+  ARRAY_FOREACH(tp, affected)
+  {
+    check_thread_subjects(*tp);
+  }
+
+  const bool c_strict_threads = cs_subset_bool(NeoMutt->sub, "strict_threads");
+  if (!c_strict_threads)
+  {
+    if (!m->subj_hash)
+      m->subj_hash = make_subj_hash(m);
+
+    /* the changed threads may need threading by subject.  so may the threads
+     * with a new email's subject: it may be a better parent for them */
+    ARRAY_FOREACH(tp, affected)
+    {
+      ARRAY_ADD(&candidates, *tp);
+    }
+
+    for (int i = first; i < m->msg_count; i++)
+    {
+      e = m->emails[i];
+      if (!e || !e->env->real_subj)
+        continue;
+
+      struct HashElem *he = mutt_hash_find_bucket(m->subj_hash, e->env->real_subj);
+      for (; he; he = he->next)
+      {
+        struct Email *e2 = he->data;
+        if ((e2 == e) || !e2->thread)
+          continue;
+
+        /* find the thread whose subject list has this email in it */
+        tmp = e2->thread;
+        while (!tmp->fake_thread && tmp->parent && !tmp->parent->message)
+          tmp = tmp->parent;
+
+        if (tmp->fake_thread)
+        {
+          /* unlink the pseudo-thread, it will be attached again by subject */
+          thread = tmp->parent;
+          detach_thread(&thread->child, tmp);
+          thread->sort_children = true;
+          tmp->fake_thread = false;
+          insert_message(&tctx->tree, NULL, tmp);
+          ARRAY_ADD(&tu.touched, thread);
+          ARRAY_ADD(&tu.touched, tmp);
+        }
+        else if (tmp->parent)
+        {
+          continue;
+        }
+
+        ARRAY_ADD(&candidates, tmp);
+      }
+    }
+
+    ARRAY_SORT(&candidates, compare_thread_ptrs);
+    thread = NULL;
+    ARRAY_FOREACH(tp, &candidates)
+    {
+      if ((*tp == thread) || !is_top_level(tctx, *tp))
+        continue;
+      thread = *tp;
+
+      tnew = pseudo_thread(m, &tctx->tree, thread);
+      if (tnew)
+      {
+        ARRAY_ADD(&tu.unrooted, thread);
+        ARRAY_ADD(&tu.touched, tnew);
+      }
+    }
+    ARRAY_FREE(&candidates);
+
+    touched_roots(tctx, &tu, affected);
+  }
+
+  ARRAY_FOREACH(tp, affected)
+  {
+    unroot_thread(tctx, &tu, *tp);
+  }
+  ARRAY_SORT(&tu.unrooted, compare_thread_ptrs);
+
+  const short c_sort = reverse_sort();
+  sort_func = mutt_get_sort_func(c_sort & SORT_MASK, mx_type(m));
+  if (sort_func)
+  {
+    ARRAY_FOREACH(tp, affected)
+    {
+      *tp = sort_subthreads(*tp, c_sort, false);
+    }
+    ARRAY_SORT(affected, compare_threads);
+  }
+
+  /* the top level is in descending order, so insert the largest first */
+  struct MuttThread *last = NULL;
+  for (size_t i = ARRAY_SIZE(&tctx->roots); i > 0; i--)
+  {
+    last = *ARRAY_GET(&tctx->roots, i - 1);
+    if (!is_unrooted(&tu, last))
+      break;
+    last = NULL;
+  }
+
+  for (size_t i = ARRAY_SIZE(affected); i > 0; i--)
+  {
+    thread = *ARRAY_GET(affected, i - 1);
+    tnew = sort_func ? find_root_position(tctx, &tu, thread) : tctx->tree;
+    if (tnew)
+    {
+      /* insert before tnew */
+      thread->prev = tnew->prev;
+      thread->next = tnew;
+      if (tnew->prev)
+        tnew->prev->next = thread;
+      else
+        tctx->tree = thread;
+      tnew->prev = thread;
+    }
+    else
+    {
+      /* append to the list */
+      thread->prev = last;
+      thread->next = NULL;
+      if (last)
+        last->next = thread;
+      else
+        tctx->tree = thread;
+      last = thread;
+    }
+  }
+
+  reverse_sort();
+
+  ARRAY_FREE(&tu.touched);
+  ARRAY_FREE(&tu.unrooted);
+}
+
+/**
+ * mutt_thread_first_new - Find the first Email that hasn't been threaded yet
+ * @param tctx Threading context
+ * @retval num Index of the first new Email, Mailbox::msg_count if there are none
+ * @retval -1  The Mailbox must be rethreaded
+ *
+ * New Emails can only be added to the existing threads if they have been
+ * appended to the Mailbox since it was last threaded.
+ */
+int mutt_thread_first_new(struct ThreadsContext *tctx)
+{
+  if (!tctx || !tctx->mailbox || !tctx->tree || !tctx->hash)
+    return -1;
+
+  struct Mailbox *m = tctx->mailbox;
+  const int first = tctx->msg_count;
+  if ((first <= 0) || (first > m->msg_count))
+    return -1;
+
+  struct Email *e = m->emails[first - 1];
+  if (!e || !e->thread)
+    return -1;
+
+  for (int i = first; i < m->msg_count; i++)
+  {
+    e = m->emails[i];
+    if (!e || e->thread)
+      return -1;
+  }
+
+  return first;
 }
 
 /**
@@ -905,6 +1615,33 @@ void mutt_sort_threads(struct ThreadsContext *tctx, bool init)
     mutt_hash_set_destructor(tctx->hash, thread_hash_destructor, 0);
   }
 
+  /* if the Mailbox has only grown, just add the new Emails to their threads */
+  const int first = (init || OptSortSubthreads) ? -1 : mutt_thread_first_new(tctx);
+  if ((first >= 0) && (first < m->msg_count))
+  {
+    struct MuttThreadArray affected = ARRAY_HEAD_INITIALIZER;
+    struct MuttThread **tp = NULL;
+
+    thread_new_emails(tctx, first, &affected);
+
+    /* restore the oldsort order. */
+    oldresort = OptNeedResort;
+    cs_subset_str_native_set(NeoMutt->sub, "sort", oldsort, NULL);
+    OptNeedResort = oldresort;
+
+    linearize_tree(tctx);
+
+    /* Only the changed threads need to be redrawn */
+    ARRAY_FOREACH(tp, &affected)
+    {
+      (*tp)->tree_drawn = false;
+    }
+    ARRAY_FREE(&affected);
+
+    tctx->msg_count = m->msg_count;
+    return;
+  }
+
   /* we want a quick way to see if things are actually attached to the top of the
    * thread tree or if they're just dangling, so we attach everything to a top
    * node temporarily */
@@ -920,6 +1657,7 @@ void mutt_sort_threads(struct ThreadsContext *tctx, bool init)
    * exists.  otherwise, if there is a MuttThread that already has a message, thread
    * new message as an identical child.  if we didn't attach the message to a
    * MuttThread, make a new one for it. */
+  const bool c_duplicate_threads = cs_subset_bool(NeoMutt->sub, "duplicate_threads");
   for (i = 0; i < m->msg_count; i++)
   {
     e = m->emails[i];
@@ -928,8 +1666,6 @@ void mutt_sort_threads(struct ThreadsContext *tctx, bool init)
 
     if (!e->thread)
     {
-      const bool c_duplicate_threads =
-          cs_subset_bool(NeoMutt->sub, "duplicate_threads");
       if ((!init || c_duplicate_threads) && e->env->message_id)
         thread = mutt_hash_find(tctx->hash, e->env->message_id);
       else
@@ -1032,40 +1768,7 @@ void mutt_sort_threads(struct ThreadsContext *tctx, bool init)
 
     while (true)
     {
-      if (using_refs == 0)
-      {
-        /* look at the beginning of in-reply-to: */
-        ref = STAILQ_FIRST(&e->env->in_reply_to);
-        if (ref)
-          using_refs = 1;
-        else
-        {
-          ref = STAILQ_FIRST(&e->env->references);
-          using_refs = 2;
-        }
-      }
-      else if (using_refs == 1)
-      {
-        /* if there's no references header, use all the in-reply-to:
-         * data that we have.  otherwise, use the first reference
-         * if it's different than the first in-reply-to, otherwise use
-         * the second reference (since at least eudora puts the most
-         * recent reference in in-reply-to and the rest in references) */
-        if (STAILQ_EMPTY(&e->env->references))
-          ref = STAILQ_NEXT(ref, entries);
-        else
-        {
-          if (!mutt_str_equal(ref->data, STAILQ_FIRST(&e->env->references)->data))
-            ref = STAILQ_FIRST(&e->env->references);
-          else
-            ref = STAILQ_NEXT(STAILQ_FIRST(&e->env->references), entries);
-
-          using_refs = 2;
-        }
-      }
-      else
-        ref = STAILQ_NEXT(ref, entries); /* go on with references */
-
+      ref = next_reference(e->env, ref, &using_refs);
       if (!ref)
         break;
 
@@ -1123,6 +1826,8 @@ void mutt_sort_threads(struct ThreadsContext *tctx, bool init)
     /* Draw the thread tree. */
     mutt_draw_tree(tctx);
   }
+
+  tctx->msg_count = tctx->tree ? m->msg_count : 0;
 }
 
 /**
@@ -1333,7 +2038,8 @@ int mutt_traverse_thread(struct Email *e_cur, MuttThreadFlags flag)
 
   if (flag & (MUTT_THREAD_COLLAPSE | MUTT_THREAD_UNCOLLAPSE))
   {
-    e_cur->pair = 0; /* force index entry's color to be re-evaluated */
+    e_cur->pair_stale |= PAT_DEP_THREAD; /* re-evaluate the index entry's color */
+    e_cur->score_stale |= PAT_DEP_THREAD;
     e_cur->collapsed = flag & MUTT_THREAD_COLLAPSE;
     if (e_cur->vnum != -1)
     {
@@ -1367,7 +2073,8 @@ int mutt_traverse_thread(struct Email *e_cur, MuttThreadFlags flag)
     {
       if (flag & (MUTT_THREAD_COLLAPSE | MUTT_THREAD_UNCOLLAPSE))
       {
-        e_cur->pair = 0; /* force index entry's color to be re-evaluated */
+        e_cur->pair_stale |= PAT_DEP_THREAD; /* re-evaluate the index entry's color */
+        e_cur->score_stale |= PAT_DEP_THREAD;
         e_cur->collapsed = flag & MUTT_THREAD_COLLAPSE;
         if (!e_root && e_cur->visible)
         {
@@ -89,6 +89,8 @@ void                   mutt_thread_ctx_free          (struct ThreadsContext **tc
 void                   mutt_thread_collapse_collapsed(struct ThreadsContext *tctx);
 void                   mutt_thread_collapse          (struct ThreadsContext *tctx, bool collapse);
 bool                   mutt_thread_can_collapse      (struct Email *e);
+int                    mutt_thread_first_new         (struct ThreadsContext *tctx);
+const char *           mutt_thread_tree              (struct Email *e);
 
 void                   mutt_clear_threads     (struct ThreadsContext *tctx);
 void                   mutt_draw_tree         (struct ThreadsContext *tctx);
@@ -457,6 +457,11 @@ void mx_fastclose_mailbox(struct Mailbox *m)
     }
   }
 
+  /* Return the Emails' memory to the system in one go.
+   * Any stray Emails will keep the old Slab alive until they're freed. */
+  mutt_slab_free(&m->slab);
+  m->slab = mutt_slab_new();
+
   if (m->flags & MB_HIDDEN)
   {
     mx_ac_remove(m);
@@ -49,6 +49,7 @@
 #include "format_flags.h"
 
 struct ConnAccount;
+struct Email;
 struct NntpAccountData;
 struct stat;
 
@@ -96,6 +97,7 @@ void nntp_mailbox(struct Mailbox *m, char *buf, size_t buflen);
 void nntp_expand_path(char *buf, size_t buflen, struct ConnAccount *acct);
 void nntp_clear_cache(struct NntpAccountData *adata);
 const char *nntp_format_str(char *buf, size_t buflen, size_t col, int cols, char op, const char *src, const char *prec, const char *if_str, const char *else_str, intptr_t data, MuttFormatFlags flags);
+anum_t nntp_article_num(struct Email *e);
 int nntp_compare_order(const void *a, const void *b);
 enum MailboxType nntp_path_probe(const char *path, const struct stat *st);
 const char *group_index_format_str(char *buf, size_t buflen, size_t col, int cols, char op, const char *src, const char *prec, const char *if_str, const char *else_str, intptr_t data, MuttFormatFlags flags);
@@ -773,9 +773,7 @@ static int nntp_fetch_lines(struct NntpMboxData *mdata, char *query, size_t qlen
   while (!done)
   {
     char buf[1024];
-    char *line = NULL;
     unsigned int lines = 0;
-    size_t off = 0;
     struct Progress progress;
 
     if (msg)
@@ -790,48 +788,36 @@ static int nntp_fetch_lines(struct NntpMboxData *mdata, char *query, size_t qlen
       return 1;
     }
 
-    line = mutt_mem_malloc(sizeof(buf));
+    struct Buffer *line = mutt_buffer_pool_get();
     rc = 0;
 
     while (true)
     {
-      char *p = NULL;
-      int chunk = mutt_socket_readln_d(buf, sizeof(buf), mdata->adata->conn, MUTT_SOCK_LOG_FULL);
-      if (chunk < 0)
+      if (mutt_socket_buffer_readln_d(line, mdata->adata->conn, MUTT_SOCK_LOG_FULL) < 0)
       {
         mdata->adata->status = NNTP_NONE;
         break;
       }
 
-      p = buf;
-      if (!off && (buf[0] == '.'))
+      char *p = line->data;
+      if (p[0] == '.')
       {
-        if (buf[1] == '\0')
+        if (p[1] == '\0')
         {
           done = true;
           break;
         }
-        if (buf[1] == '.')
+        if (p[1] == '.')
           p++;
       }
 
-      mutt_str_copy(line + off, p, sizeof(buf));
+      if (msg)
+        mutt_progress_update(&progress, ++lines, -1);
 
-      if (chunk >= sizeof(buf))
-        off += strlen(p);
-      else
-      {
-        if (msg)
-          mutt_progress_update(&progress, ++lines, -1);
-
-        if ((rc == 0) && (func(line, data) < 0))
-          rc = -2;
-        off = 0;
-      }
-
-      mutt_mem_realloc(&line, off + sizeof(buf));
+      if ((rc == 0) && (func(p, data) < 0))
+        rc = -2;
     }
-    FREE(&line);
+    mutt_buffer_pool_release(&line);
     func(NULL, data);
   }
   return rc;
@@ -1063,7 +1049,7 @@ static int parse_overview_line(char *line, void *data)
     mx_alloc_memory(m);
 
   /* parse header */
-  m->emails[m->msg_count] = email_new();
+  m->emails[m->msg_count] = email_new_slab(m->slab);
   e = m->emails[m->msg_count];
   e->env = mutt_rfc822_read_header(fp, e, false, false);
   e->env->newsgroups = mutt_str_dup(mdata->group);
@@ -1175,6 +1161,13 @@ static int nntp_fetch_headers(struct Mailbox *m, void *hc, anum_t first, anum_t
     return -1;
   fc.hc = hc;
 
+#ifdef USE_HCACHE
+  if (fc.hc)
+    fc.hc->slab = m->slab;
+  /* group the new headers into a few large transactions */
+  mutt_hcache_begin(fc.hc);
+#endif
+
   /* fetch list of articles */
   const bool c_nntp_listgroup = cs_subset_bool(NeoMutt->sub, "nntp_listgroup");
   if (c_nntp_listgroup && mdata->adata->hasLISTGROUP && !mdata->deleted)
@@ -1323,7 +1316,7 @@ static int nntp_fetch_headers(struct Mailbox *m, void *hc, anum_t first, anum_t
       }
 
       /* parse header */
-      m->emails[m->msg_count] = email_new();
+      m->emails[m->msg_count] = email_new_slab(m->slab);
       e = m->emails[m->msg_count];
       e->env = mutt_rfc822_read_header(fp, e, false, false);
       e->received = e->date_sent;
@@ -1366,6 +1359,10 @@ static int nntp_fetch_headers(struct Mailbox *m, void *hc, anum_t first, anum_t
     }
   }
 
+#ifdef USE_HCACHE
+  mutt_hcache_commit(fc.hc);
+#endif
+
   FREE(&fc.messages);
   if (rc != 0)
     return -1;
@@ -2162,7 +2159,7 @@ int nntp_check_msgid(struct Mailbox *m, const char *msgid)
   /* parse header */
   if (m->msg_count == m->email_max)
     mx_alloc_memory(m);
-  m->emails[m->msg_count] = email_new();
+  m->emails[m->msg_count] = email_new_slab(m->slab);
   struct Email *e = m->emails[m->msg_count];
   e->edata = nntp_edata_new();
   e->edata_free = nntp_edata_free;
@@ -2267,6 +2264,16 @@ int nntp_check_children(struct Mailbox *m, const char *msgid)
   return (rc < 0) ? -1 : 0;
 }
 
+/**
+ * nntp_article_num - Get the article number of an Email
+ * @param e Email
+ * @retval num Article number
+ */
+anum_t nntp_article_num(struct Email *e)
+{
+  return nntp_edata_get(e)->article_num;
+}
+
 /**
  * nntp_compare_order - Sort to mailbox order - Implements ::sort_t
  */
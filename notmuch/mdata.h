@@ -43,6 +43,10 @@ struct NmMboxData
   int oldmsgcount;
   int ignmsgcount;             ///< Ignored messages
 
+  unsigned long db_revision;   ///< Database revision when the Mailbox was last checked
+  char *db_uuid;               ///< Database UUID, for db_revision
+  char *db_rev_query;          ///< Query that was checked at db_revision
+
   bool noprogress : 1;         ///< Don't show the progress bar
   bool progress_ready : 1;     ///< A progress bar has been initialised
 };
@@ -63,6 +63,7 @@
 #include "hcache/lib.h"
 #include "index/lib.h"
 #include "maildir/lib.h"
+#include "pattern/lib.h"
 #include "adata.h"
 #include "command_parse.h"
 #include "edata.h"
@@ -2093,6 +2094,203 @@ static bool nm_ac_add(struct Account *a, struct Mailbox *m)
   return true;
 }
 
+/**
+ * save_revision - Remember the revision of the database
+ * @param m Mailbox
+ *
+ * The next check only needs to look at the messages that change after this
+ * revision.  This must be called before the query is run.
+ */
+static void save_revision(struct Mailbox *m)
+{
+#if LIBNOTMUCH_CHECK_VERSION(4, 3, 0)
+  struct NmMboxData *mdata = nm_mdata_get(m);
+  notmuch_database_t *db = nm_db_get(m, false);
+  if (!mdata || !db)
+    return;
+
+  const char *uuid = NULL;
+  mdata->db_revision = notmuch_database_get_revision(db, &uuid);
+  mutt_str_replace(&mdata->db_uuid, uuid);
+  mutt_str_replace(&mdata->db_rev_query, mdata->db_query);
+#endif
+}
+
+/**
+ * merge_message - Merge a message, found by a check, into the Mailbox
+ * @param h   Header cache handle
+ * @param m   Mailbox
+ * @param msg Notmuch message
+ * @retval true The Email's tags have changed
+ */
+static bool merge_message(struct HeaderCache *h, struct Mailbox *m, notmuch_message_t *msg)
+{
+  struct Email *e = get_mutt_email(m, msg);
+  if (!e)
+  {
+    /* new email */
+    append_message(h, m, NULL, msg, false);
+    return false;
+  }
+
+  /* message already exists, merge flags */
+  e->active = true;
+
+  /* Check to see if the message has moved to a different subdirectory.
+   * If so, update the associated filename.  */
+  const char *new_file = get_message_last_filename(msg);
+  char old_file[PATH_MAX];
+  email_get_fullpath(e, old_file, sizeof(old_file));
+
+  if (!mutt_str_equal(old_file, new_file))
+    update_message_path(e, new_file);
+
+  if (!e->changed)
+  {
+    /* if the user hasn't modified the flags on this message, update the
+     * flags we just detected.  */
+    struct Email e_tmp = { 0 };
+    e_tmp.edata = maildir_edata_new();
+    maildir_parse_flags(&e_tmp, new_file);
+    maildir_update_flags(m, e, &e_tmp);
+    maildir_edata_free(&e_tmp.edata);
+  }
+
+  return (update_email_tags(e, msg) == 0);
+}
+
+#if LIBNOTMUCH_CHECK_VERSION(4, 3, 0)
+/**
+ * drop_message - Mark an Email that no longer matches the query
+ * @param m   Mailbox
+ * @param msg Notmuch message
+ * @retval true The message was in the Mailbox
+ */
+static bool drop_message(struct Mailbox *m, notmuch_message_t *msg)
+{
+  struct Email *e = get_mutt_email(m, msg);
+  if (!e || !e->active)
+    return false;
+
+  e->active = false;
+  return true;
+}
+#endif
+
+/**
+ * check_changed - Check only the messages that have changed
+ * @param[in]  m         Mailbox
+ * @param[in]  h         Header cache handle
+ * @param[out] new_flags Incremented for each Email whose tags have changed
+ * @param[out] occult    Set if any Emails have left the Mailbox
+ * @retval true  Success
+ * @retval false A full check is needed
+ *
+ * Every change to a message's tags or files increases its lastmod, so only
+ * the messages modified since the last check need to be looked at.  Messages
+ * that have left the database can't be found that way, so the matches are
+ * counted, too.  If the count is wrong, or the database has been rebuilt (its
+ * UUID has changed), the caller must check every message.
+ */
+static bool check_changed(struct Mailbox *m, struct HeaderCache *h,
+                          int *new_flags, bool *occult)
+{
+#if LIBNOTMUCH_CHECK_VERSION(4, 3, 0)
+  struct NmMboxData *mdata = nm_mdata_get(m);
+  notmuch_database_t *db = nm_db_get(m, false);
+  if (!mdata || !db || !mdata->db_uuid || (get_limit(mdata) != 0))
+    return false;
+
+  /* Threads contain messages that don't match the query */
+  if (mdata->query_type == NM_QUERY_TYPE_THREADS)
+    return false;
+
+  const char *str = get_query_string(mdata, true);
+  if (!str || !mutt_str_equal(str, mdata->db_rev_query))
+    return false;
+
+  const char *uuid = NULL;
+  const unsigned long revision = notmuch_database_get_revision(db, &uuid);
+  if (!mutt_str_equal(uuid, mdata->db_uuid))
+    return false;
+
+  mutt_debug(LL_DEBUG1, "nm: checking revisions %lu..%lu\n", mdata->db_revision + 1, revision);
+
+  /* The messages that have changed and still match.  Excluded messages are
+   * flagged, rather than omitted, so they can be dropped. */
+  char *qstr = NULL;
+  mutt_str_asprintf(&qstr, "( %s ) lastmod:%lu..%lu", str, mdata->db_revision + 1, revision);
+  notmuch_query_t *q = notmuch_query_create(db, qstr);
+  FREE(&qstr);
+  if (!q)
+    return false;
+
+  apply_exclude_tags(q);
+  notmuch_query_set_omit_excluded(q, NOTMUCH_EXCLUDE_FLAG);
+  notmuch_query_set_sort(q, NOTMUCH_SORT_NEWEST_FIRST);
+
+  bool rc = false;
+  notmuch_messages_t *msgs = get_messages(q);
+  if (!msgs)
+    goto done;
+
+  for (; notmuch_messages_valid(msgs); notmuch_messages_move_to_next(msgs))
+  {
+    notmuch_message_t *msg = notmuch_messages_get(msgs);
+    if (notmuch_message_get_flag(msg, NOTMUCH_MESSAGE_FLAG_EXCLUDED))
+    {
+      if (drop_message(m, msg))
+        *occult = true;
+    }
+    else if (merge_message(h, m, msg))
+    {
+      (*new_flags)++;
+    }
+    notmuch_message_destroy(msg);
+  }
+  notmuch_query_destroy(q);
+
+  /* The messages that have changed and no longer match */
+  mutt_str_asprintf(&qstr, "lastmod:%lu..%lu and not ( %s )",
+                    mdata->db_revision + 1, revision, str);
+  q = notmuch_query_create(db, qstr);
+  FREE(&qstr);
+  if (!q)
+    return false;
+
+  msgs = get_messages(q);
+  if (!msgs)
+    goto done;
+
+  for (; notmuch_messages_valid(msgs); notmuch_messages_move_to_next(msgs))
+  {
+    notmuch_message_t *msg = notmuch_messages_get(msgs);
+    if (drop_message(m, msg))
+      *occult = true;
+    notmuch_message_destroy(msg);
+  }
+
+  int active = 0;
+  for (int i = 0; i < m->msg_count; i++)
+  {
+    struct Email *e = m->emails[i];
+    if (!e)
+      break;
+    if (e->active)
+      active++;
+  }
+
+  rc = (count_query(db, str, 0) == active);
+  mutt_debug(LL_DEBUG1, "nm: changed messages checked [active=%d, rc=%d]\n", active, rc);
+
+done:
+  notmuch_query_destroy(q);
+  return rc;
+#else
+  return false;
+#endif
+}
+
 /**
  * nm_mbox_open - Open a Mailbox - Implements MxOps::mbox_open()
  */
@@ -2115,6 +2313,7 @@ static enum MxOpenReturns nm_mbox_open(struct Mailbox *m)
   if (q)
   {
     rc = MX_OPEN_OK;
+    save_revision(m);
     switch (mdata->query_type)
     {
       case NM_QUERY_TYPE_UNKNOWN: // UNKNOWN should never occur, but MESGS is default
@@ -2165,13 +2364,33 @@ static enum MxStatus nm_mbox_check(struct Mailbox *m)
 
   mutt_debug(LL_DEBUG1, "nm: checking (db=%lu mailbox=%lu)\n", mtime, m->mtime.tv_sec);
 
-  notmuch_query_t *q = get_query(m, false);
+  mdata->oldmsgcount = m->msg_count;
+  mdata->noprogress = true;
+
+  struct HeaderCache *h = nm_hcache_open(m);
+  notmuch_query_t *q = NULL;
+
+  if (check_changed(m, h, &new_flags, &occult))
+  {
+    nm_hcache_close(h);
+    save_revision(m);
+    goto changed;
+  }
+
+  /* Start again, with a full check */
+  occult = false;
+
+  q = get_query(m, false);
   if (!q)
+  {
+    nm_hcache_close(h);
     goto done;
+  }
+
+  /* The revision must be saved before the query is run */
+  save_revision(m);
 
   mutt_debug(LL_DEBUG1, "nm: start checking (count=%d)\n", m->msg_count);
-  mdata->oldmsgcount = m->msg_count;
-  mdata->noprogress = true;
 
   for (int i = 0; i < m->msg_count; i++)
   {
@@ -2189,54 +2408,24 @@ static enum MxStatus nm_mbox_check(struct Mailbox *m)
   // TODO: Analyze impact of removing this version guard.
 #if LIBNOTMUCH_CHECK_VERSION(5, 0, 0)
   if (!msgs)
+  {
+    nm_hcache_close(h);
     return MX_STATUS_OK;
+  }
 #elif LIBNOTMUCH_CHECK_VERSION(4, 3, 0)
   if (!msgs)
+  {
+    nm_hcache_close(h);
     goto done;
+  }
 #endif
 
-  struct HeaderCache *h = nm_hcache_open(m);
-
   for (int i = 0; notmuch_messages_valid(msgs) && ((limit == 0) || (i < limit));
        notmuch_messages_move_to_next(msgs), i++)
   {
     notmuch_message_t *msg = notmuch_messages_get(msgs);
-    struct Email *e = get_mutt_email(m, msg);
-
-    if (!e)
-    {
-      /* new email */
-      append_message(h, m, NULL, msg, false);
-      notmuch_message_destroy(msg);
-      continue;
-    }
-
-    /* message already exists, merge flags */
-    e->active = true;
-
-    /* Check to see if the message has moved to a different subdirectory.
-     * If so, update the associated filename.  */
-    const char *new_file = get_message_last_filename(msg);
-    char old_file[PATH_MAX];
-    email_get_fullpath(e, old_file, sizeof(old_file));
-
-    if (!mutt_str_equal(old_file, new_file))
-      update_message_path(e, new_file);
-
-    if (!e->changed)
-    {
-      /* if the user hasn't modified the flags on this message, update the
-       * flags we just detected.  */
-      struct Email e_tmp = { 0 };
-      e_tmp.edata = maildir_edata_new();
-      maildir_parse_flags(&e_tmp, new_file);
-      maildir_update_flags(m, e, &e_tmp);
-      maildir_edata_free(&e_tmp.edata);
-    }
-
-    if (update_email_tags(e, msg) == 0)
+    if (merge_message(h, m, msg))
       new_flags++;
-
     notmuch_message_destroy(msg);
   }
 
@@ -2255,6 +2444,7 @@ static enum MxStatus nm_mbox_check(struct Mailbox *m)
     }
   }
 
+changed:
   if (m->msg_count > mdata->oldmsgcount)
     mailbox_changed(m, NT_MAILBOX_INVALID);
 done:
@@ -2488,7 +2678,8 @@ static int nm_tags_commit(struct Mailbox *m, struct Email *e, char *buf)
   update_tags(msg, buf);
   update_email_flags(m, e, buf);
   update_email_tags(e, msg);
-  mutt_set_header_color(m, e);
+  e->score_stale |= PAT_DEP_FLAGS | PAT_DEP_TAGS;
+  mutt_header_color_stale(e, PAT_DEP_FLAGS | PAT_DEP_TAGS);
 
   rc = 0;
   e->changed = true;
@@ -2704,11 +2704,15 @@ int mutt_pager(struct PagerView *pview)
     {
       ch = 0;
       mutt_timeout_hook();
+      index_invalidate_lines();
       continue;
     }
 
     rc = ch;
 
+    /* The command may change the Emails in the index, above the pager */
+    index_invalidate_lines();
+
     switch (ch)
     {
         //=======================================================================
@@ -0,0 +1,598 @@
+/**
+ * @file
+ * Full-text index of local messages
+ *
+ * @authors
+ * Copyright (C) 2021 Richard Russon <rich@flatcap.org>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @page pattern_bodyindex Full-text index of local messages
+ *
+ * Searching the text of a message, e.g. `~b`, means opening, reading and often
+ * decoding it.  If `$header_cache_body_index` is set, a small summary of each
+ * Maildir or MH message is kept in the header cache, next to its header, so
+ * that most messages can be ruled out without being opened.
+ *
+ * The summary is a Bloom filter of the message's trigrams, i.e. every
+ * sequence of three bytes, ignoring ASCII case.  It covers both the raw
+ * message and the decoded text that `$thorough_search` would search, so it's
+ * valid for either setting.  A search that requires a literal (see
+ * Pattern::literals) can't match a message that lacks any of its trigrams.
+ *
+ * A message is indexed the first time it's searched.  The index is only used
+ * while the message's size, Message-ID and the config that changes its decoded
+ * text, e.g. `$assumed_charset`, `auto_view` or the mailcap files, are
+ * unchanged.  Encrypted messages are never
+ * indexed.
+ */
+
+#include "config.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "private.h"
+#include "mutt/lib.h"
+#include "config/lib.h"
+#include "email/lib.h"
+#include "core/lib.h"
+#include "lib.h"
+#include "hcache/lib.h"
+#include "ncrypt/lib.h"
+#include "attachments.h"
+#include "copy.h"
+#include "handler.h"
+#include "mutt_globals.h"
+#include "muttlib.h"
+#include "mx.h"
+#include "state.h"
+
+/// Version of the stored format
+#define BODY_INDEX_VERSION 1
+/// Smallest Bloom filter, in bits
+#define BODY_INDEX_MIN_BITS 1024
+/// Largest Bloom filter, in bits
+#define BODY_INDEX_MAX_BITS (1 << 18)
+/// Number of bytes to read at a time, when indexing a message
+#define BODY_INDEX_READ_SIZE 65536
+
+/**
+ * struct BodyIndexHeader - Stored header of a message's index
+ */
+struct BodyIndexHeader
+{
+  uint64_t size;    ///< Size of the raw message
+  uint32_t version; ///< Format version, #BODY_INDEX_VERSION
+  uint32_t bits;    ///< Size of the Bloom filter, a power of two
+  uint32_t check;   ///< Hash of the Message-ID and the decoding config
+  uint32_t unused;  ///< Padding, always 0
+};
+
+/**
+ * struct BodyIndexEntry - The index of one message
+ */
+struct BodyIndexEntry
+{
+  struct BodyIndexHeader hdr; ///< Header, as stored
+  unsigned char *bloom;       ///< Bloom filter of trigrams, hdr.bits long
+};
+
+/**
+ * struct BodyIndex - The index of a Mailbox
+ */
+struct BodyIndex
+{
+  struct Mailbox *mailbox; ///< Mailbox being searched
+  struct HeaderCache *hc;  ///< Header cache, holding the index
+  uint32_t config;         ///< Hash of the decoding config, see body_index_config()
+};
+
+/**
+ * DecodeConfig - Config that changes the decoded text of a message
+ *
+ * These are the config items that msg_search() and mutt_body_handler() use.
+ * The `auto_view`, `alternative_order` and `mime_lookup` lists and the mailcap
+ * files are hashed too, see body_index_config().
+ */
+static const char *const DecodeConfig[] = {
+  "assumed_charset",
+  "charset",
+  "honor_disposition",
+  "implicit_autoview",
+  "include_encrypted",
+  "include_only_first",
+  "mailcap_path",
+  "mailcap_sanitize",
+  "preferred_languages",
+  "reflow_text",
+  "reflow_wrap",
+  "show_multipart_alternative",
+  "text_flowed",
+};
+
+/**
+ * fnv_hash - Hash a string, using FNV-1a
+ * @param str  String to hash
+ * @param hash Initial hash value
+ * @retval num Hash
+ */
+static uint32_t fnv_hash(const char *str, uint32_t hash)
+{
+  for (; str && *str; str++)
+  {
+    hash ^= (unsigned char) *str;
+    hash *= 16777619;
+  }
+  return hash;
+}
+
+/**
+ * hash_list - Hash a list of strings
+ * @param name Name of the list
+ * @param list List to hash
+ * @param hash Initial hash value
+ * @retval num Hash
+ */
+static uint32_t hash_list(const char *name, const struct ListHead *list, uint32_t hash)
+{
+  hash = fnv_hash(name, hash);
+
+  struct ListNode *np = NULL;
+  STAILQ_FOREACH(np, list, entries)
+  {
+    hash = fnv_hash(np->data, hash);
+    hash = fnv_hash("\n", hash);
+  }
+  return hash;
+}
+
+/**
+ * hash_mailcap - Hash the versions of the mailcap files
+ * @param sub  Config Subset
+ * @param hash Initial hash value
+ * @retval num Hash
+ *
+ * A `copiousoutput` filter in a mailcap file can change the decoded text, so
+ * any change to the files invalidates the index.
+ */
+static uint32_t hash_mailcap(const struct ConfigSubset *sub, uint32_t hash)
+{
+  const struct Slist *c_mailcap_path = cs_subset_slist(sub, "mailcap_path");
+  if (!c_mailcap_path)
+    return hash;
+
+  struct Buffer *path = mutt_buffer_pool_get();
+  char stamp_str[128];
+
+  struct ListNode *np = NULL;
+  STAILQ_FOREACH(np, &c_mailcap_path->head, entries)
+  {
+    mutt_buffer_strcpy(path, np->data);
+    mutt_buffer_expand_path(path);
+
+    struct FileStamp stamp = { 0 };
+    mutt_file_stamp_changed(mutt_buffer_string(path), &stamp);
+    snprintf(stamp_str, sizeof(stamp_str), "%lu:%lu:%ld:%ld.%ld:%d",
+             (unsigned long) stamp.dev, (unsigned long) stamp.ino,
+             (long) stamp.size, (long) stamp.mtime, stamp.mtime_nsec, stamp.exists);
+
+    hash = fnv_hash(mutt_buffer_string(path), hash);
+    hash = fnv_hash(stamp_str, hash);
+  }
+
+  mutt_buffer_pool_release(&path);
+  return hash;
+}
+
+/**
+ * body_index_config - Hash the config that changes the decoded text of a message
+ * @param sub Config Subset
+ * @retval num Hash of the config, see #DecodeConfig
+ *
+ * Besides the config, this covers everything else that mutt_body_handler()'s
+ * output depends on: the `alternative_order`, `auto_view` and `mime_lookup`
+ * lists and the contents of the mailcap files.
+ */
+uint32_t body_index_config(const struct ConfigSubset *sub)
+{
+  uint32_t hash = 2166136261U;
+  struct Buffer *value = mutt_buffer_pool_get();
+
+  for (size_t i = 0; i < mutt_array_size(DecodeConfig); i++)
+  {
+    mutt_buffer_reset(value);
+    if (CSR_RESULT(cs_subset_str_string_get(sub, DecodeConfig[i], value)) != CSR_SUCCESS)
+      mutt_buffer_reset(value);
+
+    hash = fnv_hash(DecodeConfig[i], hash);
+    hash = fnv_hash(mutt_buffer_string(value), hash);
+  }
+  mutt_buffer_pool_release(&value);
+
+  /* The handlers also use these lists and the mailcap files */
+  hash = hash_list("alternative_order", &AlternativeOrderList, hash);
+  hash = hash_list("auto_view", &AutoViewList, hash);
+  hash = hash_list("mime_lookup", &MimeLookupList, hash);
+  hash = hash_mailcap(sub, hash);
+
+  return hash;
+}
+
+/**
+ * message_check - Calculate the check value of an Email
+ * @param bi Body index
+ * @param e  Email
+ * @retval num Hash of the Message-ID and the decoding config
+ */
+static uint32_t message_check(const struct BodyIndex *bi, const struct Email *e)
+{
+  return fnv_hash(e->env ? e->env->message_id : NULL, bi->config);
+}
+
+/**
+ * message_size - Get the size of the raw message
+ * @param e Email
+ * @retval num Size in bytes
+ */
+static uint64_t message_size(const struct Email *e)
+{
+  return e->body->offset - e->offset + e->body->length;
+}
+
+/**
+ * message_key - Get the header cache key of an Email
+ * @param[in]  m      Mailbox
+ * @param[in]  e      Email
+ * @param[out] keylen Length of the key
+ * @retval ptr Key
+ */
+static const char *message_key(struct Mailbox *m, const struct Email *e, size_t *keylen)
+{
+  if (m->type == MUTT_MAILDIR)
+  {
+    /* Skip the "cur" or "new" and drop the flags, like the Maildir code */
+    const char *key = e->path + 3;
+    const char *flags = strrchr(key, ':');
+    *keylen = flags ? (size_t) (flags - key) : mutt_str_len(key);
+    return key;
+  }
+
+  *keylen = mutt_str_len(e->path);
+  return e->path;
+}
+
+/**
+ * trigram_bit - Find the Bloom filter bit for a trigram
+ * @param trigram Three bytes, packed into an integer
+ * @param bits    Size of the filter, a power of two
+ * @retval num Bit number
+ */
+static inline uint32_t trigram_bit(uint32_t trigram, uint32_t bits)
+{
+  uint32_t h = trigram * 0x9E3779B1U;
+  h ^= h >> 15;
+  return h & (bits - 1);
+}
+
+/**
+ * fold_case - Lower-case an ASCII character
+ * @param c Character
+ * @retval num Lower-case character
+ */
+static inline unsigned char fold_case(unsigned char c)
+{
+  return ((c >= 'A') && (c <= 'Z')) ? (c | 0x20) : c;
+}
+
+/**
+ * body_index_entry_new - Create an empty index entry
+ * @param size     Size of the raw message
+ * @param check    Check value, see message_check()
+ * @param text_len Total length of the text that will be added
+ * @retval ptr New index entry, to be freed with body_index_entry_free()
+ */
+struct BodyIndexEntry *body_index_entry_new(uint64_t size, uint32_t check, uint64_t text_len)
+{
+  /* Allow about 8 bits per trigram; many will be repeated */
+  uint32_t bits = BODY_INDEX_MIN_BITS;
+  while ((bits < BODY_INDEX_MAX_BITS) && (bits < (2 * text_len)))
+    bits <<= 1;
+
+  struct BodyIndexEntry *bie = mutt_mem_calloc(1, sizeof(*bie));
+  bie->hdr.size = size;
+  bie->hdr.version = BODY_INDEX_VERSION;
+  bie->hdr.bits = bits;
+  bie->hdr.check = check;
+  bie->bloom = mutt_mem_calloc(1, bits / 8);
+  return bie;
+}
+
+/**
+ * body_index_entry_add - Add the trigrams of some text to an index entry
+ * @param bie Index entry
+ * @param fp  File, positioned at the start of the text
+ * @param len Length of the text
+ */
+void body_index_entry_add(struct BodyIndexEntry *bie, FILE *fp, uint64_t len)
+{
+  if (!bie || !fp)
+    return;
+
+  unsigned char *buf = mutt_mem_malloc(BODY_INDEX_READ_SIZE);
+  uint32_t trigram = 0;
+  uint64_t count = 0;
+
+  while (len > 0)
+  {
+    size_t n = fread(buf, 1, MIN(BODY_INDEX_READ_SIZE, len), fp);
+    if (n == 0)
+      break;
+    len -= n;
+
+    for (size_t i = 0; i < n; i++, count++)
+    {
+      trigram = ((trigram << 8) | fold_case(buf[i])) & 0xFFFFFF;
+      if (count < 2)
+        continue;
+      const uint32_t bit = trigram_bit(trigram, bie->hdr.bits);
+      bie->bloom[bit / 8] |= (1 << (bit % 8));
+    }
+  }
+
+  FREE(&buf);
+}
+
+/**
+ * body_index_entry_has - Might a message contain a literal?
+ * @param bie Index entry
+ * @param lit Literal, at least three bytes long
+ * @retval true  All the literal's trigrams are present
+ * @retval false The message can't contain the literal
+ */
+bool body_index_entry_has(const struct BodyIndexEntry *bie, const char *lit)
+{
+  uint32_t trigram = 0;
+  for (size_t i = 0; lit[i]; i++)
+  {
+    trigram = ((trigram << 8) | fold_case(lit[i])) & 0xFFFFFF;
+    if (i < 2)
+      continue;
+    const uint32_t bit = trigram_bit(trigram, bie->hdr.bits);
+    if ((bie->bloom[bit / 8] & (1 << (bit % 8))) == 0)
+      return false;
+  }
+  return true;
+}
+
+/**
+ * body_index_may_match - Might a message match a Pattern?
+ * @param bie Index entry
+ * @param pat Full-message Pattern, with literals
+ * @retval true  The message might match
+ * @retval false The message can't match
+ */
+bool body_index_may_match(const struct BodyIndexEntry *bie, const struct Pattern *pat)
+{
+  if (!bie || !pat || STAILQ_EMPTY(&pat->literals))
+    return true;
+
+  struct ListNode *np = NULL;
+  STAILQ_FOREACH(np, &pat->literals, entries)
+  {
+    if (body_index_entry_has(bie, np->data))
+      return true;
+  }
+  return false;
+}
+
+/**
+ * body_index_open - Open the index of a Mailbox
+ * @param m Mailbox
+ * @retval ptr  Body index
+ * @retval NULL The Mailbox can't be indexed, or `$header_cache_body_index` is unset
+ */
+struct BodyIndex *body_index_open(struct Mailbox *m)
+{
+  if (!m || ((m->type != MUTT_MAILDIR) && (m->type != MUTT_MH)))
+    return NULL;
+
+  const bool c_header_cache_body_index =
+      cs_subset_bool(NeoMutt->sub, "header_cache_body_index");
+  if (!c_header_cache_body_index)
+    return NULL;
+
+  const char *const c_header_cache = cs_subset_path(NeoMutt->sub, "header_cache");
+  struct HeaderCache *hc = mutt_hcache_open(c_header_cache, mailbox_path(m), NULL);
+  if (!hc)
+    return NULL;
+
+  struct BodyIndex *bi = mutt_mem_calloc(1, sizeof(*bi));
+  bi->mailbox = m;
+  bi->hc = hc;
+  bi->config = body_index_config(NeoMutt->sub);
+  return bi;
+}
+
+/**
+ * body_index_close - Close the index of a Mailbox
+ * @param[out] ptr Body index to close
+ */
+void body_index_close(struct BodyIndex **ptr)
+{
+  if (!ptr || !*ptr)
+    return;
+
+  struct BodyIndex *bi = *ptr;
+  mutt_hcache_close(bi->hc);
+  FREE(ptr);
+}
+
+/**
+ * body_index_fetch - Fetch the index of a message
+ * @param bi Body index
+ * @param e  Email
+ * @retval ptr  Index entry, to be freed with body_index_entry_free()
+ * @retval NULL The message isn't indexed, or the index is out of date
+ */
+struct BodyIndexEntry *body_index_fetch(struct BodyIndex *bi, const struct Email *e)
+{
+  if (!bi || !e || !e->path || !e->body)
+    return NULL;
+
+  size_t keylen = 0;
+  const char *key = message_key(bi->mailbox, e, &keylen);
+
+  size_t dlen = 0;
+  void *data = mutt_hcache_fetch_body_index(bi->hc, key, keylen, &dlen);
+  if (!data)
+    return NULL;
+
+  struct BodyIndexEntry *bie =
+      body_index_entry_unpack(data, dlen, message_size(e), message_check(bi, e));
+  mutt_hcache_free_raw(bi->hc, &data);
+  return bie;
+}
+
+/**
+ * body_index_entry_pack - Pack an index entry, for storage
+ * @param[in]  bie  Index entry
+ * @param[out] dlen Length of the packed data
+ * @retval ptr Packed data, to be freed by the caller
+ */
+void *body_index_entry_pack(const struct BodyIndexEntry *bie, size_t *dlen)
+{
+  *dlen = sizeof(bie->hdr) + (bie->hdr.bits / 8);
+  unsigned char *data = mutt_mem_malloc(*dlen);
+  memcpy(data, &bie->hdr, sizeof(bie->hdr));
+  memcpy(data + sizeof(bie->hdr), bie->bloom, bie->hdr.bits / 8);
+  return data;
+}
+
+/**
+ * body_index_entry_unpack - Unpack a stored index entry
+ * @param data  Packed data, see body_index_entry_pack()
+ * @param dlen  Length of the packed data
+ * @param size  Size of the raw message
+ * @param check Check value of the message, see message_check()
+ * @retval ptr  Index entry, to be freed with body_index_entry_free()
+ * @retval NULL The data is invalid, or out of date
+ */
+struct BodyIndexEntry *body_index_entry_unpack(const void *data, size_t dlen,
+                                               uint64_t size, uint32_t check)
+{
+  struct BodyIndexHeader hdr;
+  if (!data || (dlen < sizeof(hdr)))
+    return NULL;
+
+  memcpy(&hdr, data, sizeof(hdr));
+  if ((hdr.version != BODY_INDEX_VERSION) || (hdr.bits < BODY_INDEX_MIN_BITS) ||
+      ((hdr.bits & (hdr.bits - 1)) != 0) || (dlen != (sizeof(hdr) + (hdr.bits / 8))) ||
+      (hdr.size != size) || (hdr.check != check))
+  {
+    return NULL;
+  }
+
+  struct BodyIndexEntry *bie = mutt_mem_calloc(1, sizeof(*bie));
+  bie->hdr = hdr;
+  bie->bloom = mutt_mem_malloc(hdr.bits / 8);
+  memcpy(bie->bloom, (const unsigned char *) data + sizeof(hdr), hdr.bits / 8);
+  return bie;
+}
+
+/**
+ * body_index_build - Index a message and store the index
+ * @param bi    Body index
+ * @param msgno Index of the Email in the Mailbox
+ * @retval ptr  Index entry, to be freed with body_index_entry_free()
+ * @retval NULL The message can't be indexed
+ *
+ * The message is decoded in the same way as msg_search() does.
+ */
+struct BodyIndexEntry *body_index_build(struct BodyIndex *bi, int msgno)
+{
+  if (!bi || (msgno < 0) || (msgno >= bi->mailbox->msg_count))
+    return NULL;
+
+  struct Mailbox *m = bi->mailbox;
+  struct Email *e = m->emails[msgno];
+  if (!e || !e->path || !e->body)
+    return NULL;
+
+  /* Never store the text of an encrypted message */
+  if ((WithCrypto != 0) && (e->security & SEC_ENCRYPT))
+    return NULL;
+
+  struct Message *msg = mx_msg_open(m, msgno);
+  if (!msg)
+    return NULL;
+
+  struct BodyIndexEntry *bie = NULL;
+  struct State s = { 0 };
+  s.fp_in = msg->fp;
+  s.flags = MUTT_CHARCONV;
+  s.fp_out = mutt_file_mkstemp();
+  if (!s.fp_out)
+    goto done;
+
+  mutt_copy_header(msg->fp, e, s.fp_out, CH_FROM | CH_DECODE, NULL, 0);
+  mutt_parse_mime_message(m, e);
+  if ((WithCrypto != 0) && (e->security & SEC_ENCRYPT))
+    goto done;
+
+  fseeko(msg->fp, e->offset, SEEK_SET);
+  mutt_body_handler(e->body, &s);
+  fflush(s.fp_out);
+  const LOFF_T decoded = ftello(s.fp_out);
+  if (decoded < 0)
+    goto done;
+
+  const uint64_t size = message_size(e);
+  bie = body_index_entry_new(size, message_check(bi, e), size + decoded);
+
+  fseeko(msg->fp, e->offset, SEEK_SET);
+  body_index_entry_add(bie, msg->fp, size);
+  rewind(s.fp_out);
+  body_index_entry_add(bie, s.fp_out, decoded);
+
+  size_t dlen = 0;
+  void *data = body_index_entry_pack(bie, &dlen);
+
+  size_t keylen = 0;
+  const char *key = message_key(m, e, &keylen);
+  mutt_hcache_store_body_index(bi->hc, key, keylen, data, dlen);
+  FREE(&data);
+
+done:
+  mutt_file_fclose(&s.fp_out);
+  mx_msg_close(m, &msg);
+  return bie;
+}
+
+/**
+ * body_index_entry_free - Free an index entry
+ * @param[out] ptr Index entry to free
+ */
+void body_index_entry_free(struct BodyIndexEntry **ptr)
+{
+  if (!ptr || !*ptr)
+    return;
+
+  struct BodyIndexEntry *bie = *ptr;
+  FREE(&bie->bloom);
+  FREE(ptr);
+}
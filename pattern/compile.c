@@ -74,6 +74,195 @@ enum EatRangeError
 #define KILO 1024
 #define MEGA 1048576
 
+/// Shortest literal worth scanning a message for
+#define LITERAL_MIN_LEN 3
+/// Longest literal to scan a message for
+#define LITERAL_MAX_LEN 64
+
+/**
+ * skip_bracket - Skip over a regex bracket expression, e.g. `[^]a-z]`
+ * @param p   Opening '['
+ * @param end End of the regex
+ * @retval ptr Character after the closing ']'
+ */
+static const char *skip_bracket(const char *p, const char *end)
+{
+  p++;
+  if ((p < end) && (*p == '^'))
+    p++;
+  if ((p < end) && (*p == ']'))
+    p++;
+  while ((p < end) && (*p != ']'))
+  {
+    /* Character classes, e.g. [:alpha:], may contain a ']' */
+    if ((*p == '[') && ((p + 1) < end) && strchr(":.=", p[1]))
+    {
+      const char delim = p[1];
+      for (p += 2; (p + 1) < end; p++)
+        if ((p[0] == delim) && (p[1] == ']'))
+          break;
+      p++;
+    }
+    p++;
+  }
+  return (p < end) ? p + 1 : end;
+}
+
+/**
+ * skip_group - Skip over a parenthesised regex group
+ * @param p   Opening '('
+ * @param end End of the regex
+ * @retval ptr Character after the closing ')'
+ */
+static const char *skip_group(const char *p, const char *end)
+{
+  int depth = 0;
+  while (p < end)
+  {
+    if (*p == '\\')
+    {
+      p += 2;
+      continue;
+    }
+    if (*p == '[')
+    {
+      p = skip_bracket(p, end);
+      continue;
+    }
+    if (*p == '(')
+      depth++;
+    else if ((*p == ')') && (--depth == 0))
+      return p + 1;
+    p++;
+  }
+  return end;
+}
+
+/**
+ * add_literal - Add the longest literal of a branch to a Pattern
+ * @param pat  Pattern to update
+ * @param best Longest literal found
+ * @retval true  The literal is long enough to be useful
+ * @retval false The branch may match without any useful literal
+ */
+static bool add_literal(struct Pattern *pat, struct Buffer *best)
+{
+  if (mutt_buffer_len(best) < LITERAL_MIN_LEN)
+    return false;
+
+  if (mutt_buffer_len(best) > LITERAL_MAX_LEN)
+    best->data[LITERAL_MAX_LEN] = '\0';
+  mutt_list_insert_tail(&pat->literals, mutt_str_dup(mutt_buffer_string(best)));
+  return true;
+}
+
+/**
+ * compile_literals - Find the text that any match of a full-message search must contain
+ * @param pat  Pattern, e.g. #MUTT_PAT_BODY
+ * @param expr Regex or string to search for
+ *
+ * The message can be scanned for these literals in bulk, before it's searched
+ * line by line.  Each top-level alternative of the regex contributes its
+ * longest run of plain characters.  If any alternative has no usable run, no
+ * literals are set, and every message is searched in full.
+ *
+ * The scan is conservative: bracket expressions, groups, escapes and anything
+ * that isn't plain ASCII end a run; a character made optional by a quantifier
+ * is dropped.  Header lines are unfolded before they're searched, so runs in a
+ * header search also end at whitespace.
+ */
+static void compile_literals(struct Pattern *pat, const char *expr)
+{
+  STAILQ_INIT(&pat->literals);
+
+  if ((pat->op != MUTT_PAT_BODY) && (pat->op != MUTT_PAT_HEADER) &&
+      (pat->op != MUTT_PAT_WHOLE_MSG))
+  {
+    return;
+  }
+
+  const bool header = (pat->op == MUTT_PAT_HEADER);
+  const bool regex = !pat->string_match;
+  const char *end = expr + mutt_str_len(expr);
+  struct Buffer *run = mutt_buffer_pool_get();
+  struct Buffer *best = mutt_buffer_pool_get();
+  bool ok = true;
+
+  for (const char *p = expr; ok; )
+  {
+    char c = (p < end) ? *p : '\0';
+    bool lit = false;
+
+    if (regex && (c == '\\'))
+    {
+      /* An escaped metacharacter is literal, e.g. \.
+       * Anything else is a class or an anchor, e.g. \w, \<, \` */
+      c = ((p + 1) < end) ? p[1] : '\0';
+      lit = (c != '\0') && strchr(".[]()*+?{}|^$\\", c);
+      p += ((p + 1) < end) ? 2 : 1;
+    }
+    else if (regex && ((c == '*') || (c == '?') || (c == '{')))
+    {
+      /* The previous character is optional, or repeated */
+      if (!mutt_buffer_is_empty(run))
+        *--run->dptr = '\0';
+      if (c == '{')
+      {
+        while ((p < end) && (*p != '}'))
+          p++;
+      }
+      p++;
+    }
+    else if (regex && (c == '['))
+    {
+      p = skip_bracket(p, end);
+    }
+    else if (regex && (c == '('))
+    {
+      p = skip_group(p, end);
+    }
+    else if (regex && (c != '\0') && strchr(".^$)+", c))
+    {
+      p++;
+    }
+    else if (c == '\0' || (regex && (c == '|')))
+    {
+      /* End of an alternative */
+      if (mutt_buffer_len(run) > mutt_buffer_len(best))
+        mutt_buffer_copy(best, run);
+      ok = add_literal(pat, best);
+      mutt_buffer_reset(run);
+      mutt_buffer_reset(best);
+      if (c == '\0')
+        break;
+      p++;
+      continue;
+    }
+    else
+    {
+      lit = ((c & 0x80) == 0) && !(header && ((c == ' ') || (c == '\t')));
+      p++;
+    }
+
+    if (lit)
+    {
+      mutt_buffer_addch(run, c);
+      continue;
+    }
+
+    /* The run has ended */
+    if (mutt_buffer_len(run) > mutt_buffer_len(best))
+      mutt_buffer_copy(best, run);
+    mutt_buffer_reset(run);
+  }
+
+  if (!ok)
+    mutt_list_free(&pat->literals);
+
+  mutt_buffer_pool_release(&run);
+  mutt_buffer_pool_release(&best);
+}
+
 /**
  * eat_regex - Parse a regex - Implements ::eat_arg_t
  */
@@ -101,6 +290,7 @@ static bool eat_regex(struct Pattern *pat, PatternCompFlags flags,
   {
     pat->p.str = mutt_str_dup(buf.data);
     pat->ign_case = mutt_mb_is_lower(buf.data);
+    compile_literals(pat, buf.data);
     FREE(&buf.data);
   }
   else if (pat->group_match)
@@ -122,6 +312,8 @@ static bool eat_regex(struct Pattern *pat, PatternCompFlags flags,
       FREE(&pat->p.regex);
       return false;
     }
+    pat->ign_case = (case_flags != 0);
+    compile_literals(pat, buf.data);
     FREE(&buf.data);
   }
 
@@ -1058,6 +1250,7 @@ void mutt_pattern_free(struct PatternList **pat)
       FREE(&np->p.regex);
     }
 
+    mutt_list_free(&np->literals);
     mutt_pattern_free(&np->child);
     FREE(&np);
 
@@ -1080,6 +1273,256 @@ static struct PatternList *mutt_pattern_node_new(void)
   return h;
 }
 
+/**
+ * enum PatternCost - Relative cost of matching a Pattern against an Email
+ */
+enum PatternCost
+{
+  PAT_COST_FLAG,    ///< Test a flag of the Email
+  PAT_COST_NUMBER,  ///< Compare a number or a date
+  PAT_COST_STRING,  ///< Match a header string
+  PAT_COST_ADDRESS, ///< Match a list of Addresses
+  PAT_COST_MESSAGE, ///< Read the message, or match other Emails in the thread
+};
+
+/**
+ * pattern_cost - Get the cost of matching a simple Pattern
+ * @param pat Pattern, not 'and' or 'or'
+ * @retval enum Cost, e.g. #PAT_COST_FLAG
+ */
+static enum PatternCost pattern_cost(const struct Pattern *pat)
+{
+  if (pat->op < MUTT_MT_MAX)
+    return PAT_COST_FLAG;
+
+  switch (pat->op)
+  {
+    case MUTT_PAT_COLLAPSED:
+    case MUTT_PAT_CRYPT_ENCRYPT:
+    case MUTT_PAT_CRYPT_SIGN:
+    case MUTT_PAT_CRYPT_VERIFIED:
+    case MUTT_PAT_PGP_KEY:
+      return PAT_COST_FLAG;
+
+    case MUTT_PAT_BROKEN:
+    case MUTT_PAT_DATE:
+    case MUTT_PAT_DATE_RECEIVED:
+    case MUTT_PAT_DUPLICATED:
+    case MUTT_PAT_MESSAGE:
+    case MUTT_PAT_SCORE:
+    case MUTT_PAT_SIZE:
+    case MUTT_PAT_UNREFERENCED:
+      return PAT_COST_NUMBER;
+
+    case MUTT_PAT_DRIVER_TAGS:
+    case MUTT_PAT_HORMEL:
+    case MUTT_PAT_ID:
+    case MUTT_PAT_ID_EXTERNAL:
+#ifdef USE_NNTP
+    case MUTT_PAT_NEWSGROUPS:
+#endif
+    case MUTT_PAT_REFERENCE:
+    case MUTT_PAT_SUBJECT:
+    case MUTT_PAT_XLABEL:
+      return PAT_COST_STRING;
+
+    case MUTT_PAT_ADDRESS:
+    case MUTT_PAT_CC:
+    case MUTT_PAT_FROM:
+    case MUTT_PAT_LIST:
+    case MUTT_PAT_PERSONAL_FROM:
+    case MUTT_PAT_PERSONAL_RECIP:
+    case MUTT_PAT_RECIPIENT:
+    case MUTT_PAT_SENDER:
+    case MUTT_PAT_SUBSCRIBED_LIST:
+    case MUTT_PAT_TO:
+      return PAT_COST_ADDRESS;
+
+    default:
+      return PAT_COST_MESSAGE;
+  }
+}
+
+/**
+ * pattern_node_free - Free a single Pattern, and its children
+ * @param pat Pattern to free
+ */
+static void pattern_node_free(struct Pattern *pat)
+{
+  struct PatternList *list = mutt_mem_calloc(1, sizeof(struct PatternList));
+  SLIST_INIT(list);
+  SLIST_NEXT(pat, entries) = NULL;
+  SLIST_INSERT_HEAD(list, pat, entries);
+  mutt_pattern_free(&list);
+}
+
+/**
+ * pattern_optimise - Reorder the arguments of 'and' and 'or', cheapest first
+ * @param pat Pattern to optimise
+ * @retval enum Cost of the Pattern, e.g. #PAT_COST_FLAG
+ *
+ * 'and' and 'or' stop at the first argument that decides the result, so
+ * testing the cheap arguments first, e.g. a flag before a body search, avoids
+ * most of the expensive work.  Arguments of the same cost keep their order.
+ *
+ * Arguments that can't affect the result, e.g. `~A` in an 'and', are removed.
+ * If one argument decides the result, e.g. `~A` in an 'or', it's the only one
+ * kept.
+ */
+static enum PatternCost pattern_optimise(struct Pattern *pat)
+{
+  struct Pattern *p = NULL;
+
+  switch (pat->op)
+  {
+    case MUTT_PAT_AND:
+    case MUTT_PAT_OR:
+      break;
+
+    case MUTT_PAT_THREAD:
+    case MUTT_PAT_PARENT:
+    case MUTT_PAT_CHILDREN:
+      SLIST_FOREACH(p, pat->child, entries)
+      {
+        pattern_optimise(p);
+      }
+      return PAT_COST_MESSAGE;
+
+    default:
+      return pattern_cost(pat);
+  }
+
+  /* The value of an argument that decides the result, and of one that can't */
+  const bool decisive = (pat->op == MUTT_PAT_OR);
+
+  struct Pattern *args[64];
+  enum PatternCost costs[64];
+  size_t count = 0;
+  struct Pattern *winner = NULL;
+
+  SLIST_FOREACH(p, pat->child, entries)
+  {
+    if (count == mutt_array_size(args))
+      return PAT_COST_MESSAGE; /* Too complex; leave it alone */
+    args[count++] = p;
+    if (!winner && (p->op == MUTT_ALL) && (p->pat_not != decisive))
+      winner = p;
+  }
+
+  /* Without a winner, any constants can't affect the result */
+  size_t variable = 0;
+  for (size_t i = 0; i < count; i++)
+  {
+    if (args[i]->op != MUTT_ALL)
+      variable++;
+  }
+
+  size_t kept = 0;
+  for (size_t i = 0; i < count; i++)
+  {
+    bool drop;
+    if (winner)
+      drop = (args[i] != winner);
+    else
+      drop = (args[i]->op == MUTT_ALL) && ((variable > 0) || (kept > 0));
+
+    if (drop)
+      pattern_node_free(args[i]);
+    else
+      args[kept++] = args[i];
+  }
+  count = kept;
+
+  /* Stable insertion sort, by cost */
+  enum PatternCost max = PAT_COST_FLAG;
+  for (size_t i = 0; i < count; i++)
+  {
+    costs[i] = pattern_optimise(args[i]);
+    max = MAX(max, costs[i]);
+    for (size_t j = i; (j > 0) && (costs[j - 1] > costs[j]); j--)
+    {
+      struct Pattern *tmp_pat = args[j];
+      args[j] = args[j - 1];
+      args[j - 1] = tmp_pat;
+      enum PatternCost tmp_cost = costs[j];
+      costs[j] = costs[j - 1];
+      costs[j - 1] = tmp_cost;
+    }
+  }
+
+  SLIST_INIT(pat->child);
+  for (size_t i = count; i > 0; i--)
+  {
+    SLIST_INSERT_HEAD(pat->child, args[i - 1], entries);
+  }
+
+  return max;
+}
+
+/**
+ * mutt_pattern_deps - Find the inputs of a Pattern
+ * @param pat Pattern
+ * @retval num Inputs, e.g. #PAT_DEP_FLAGS
+ *
+ * The result of a Pattern can only change if one of its inputs does.  This
+ * lets the callers that cache results, e.g. the index colours, only re-match
+ * the Patterns that may be affected by a change to an Email.
+ */
+PatternDeps mutt_pattern_deps(const struct PatternList *pat)
+{
+  PatternDeps deps = PAT_DEP_NO_FLAGS;
+  if (!pat)
+    return deps;
+
+  const struct Pattern *p = NULL;
+  SLIST_FOREACH(p, pat, entries)
+  {
+    switch (p->op)
+    {
+      case MUTT_ALL:
+      case MUTT_NONE:
+        break;
+
+      case MUTT_PAT_AND:
+      case MUTT_PAT_OR:
+        deps |= mutt_pattern_deps(p->child);
+        break;
+
+      case MUTT_PAT_THREAD:
+      case MUTT_PAT_PARENT:
+      case MUTT_PAT_CHILDREN:
+        deps |= PAT_DEP_THREAD | mutt_pattern_deps(p->child);
+        break;
+
+      case MUTT_PAT_BROKEN:
+      case MUTT_PAT_COLLAPSED:
+      case MUTT_PAT_DUPLICATED:
+      case MUTT_PAT_MESSAGE:
+      case MUTT_PAT_UNREFERENCED:
+        deps |= PAT_DEP_THREAD;
+        break;
+
+      case MUTT_PAT_DRIVER_TAGS:
+      case MUTT_PAT_XLABEL:
+        deps |= PAT_DEP_TAGS;
+        break;
+
+      case MUTT_PAT_SCORE:
+        deps |= PAT_DEP_SCORE;
+        break;
+
+      default:
+        if (p->op < MUTT_MT_MAX)
+          deps |= PAT_DEP_FLAGS;
+        else
+          deps |= PAT_DEP_MESSAGE;
+        break;
+    }
+  }
+
+  return deps;
+}
+
 /**
  * mutt_pattern_comp - Create a Pattern
  * @param m     Mailbox
@@ -1361,6 +1804,7 @@ struct PatternList *mutt_pattern_comp(struct Mailbox *m, struct Menu *menu, cons
     curlist = tmp;
   }
 
+  pattern_optimise(SLIST_FIRST(curlist));
   return curlist;
 
 cleanup:
@@ -57,6 +57,9 @@
 #include <sys/stat.h>
 #endif
 
+/// Number of bytes to read at a time, when scanning a message for literals
+#define SCAN_BLOCK_SIZE 65536
+
 /**
  * patmatch - Compare a string to a Pattern
  * @param pat Pattern to use
@@ -97,6 +100,132 @@ static void print_crypt_pattern_op_error(int op)
   }
 }
 
+/**
+ * scan_literals - Scan part of a message for a Pattern's literals
+ * @param pat Pattern to find
+ * @param fp  File to scan, positioned at the start of the text
+ * @param len Length of the text
+ * @retval true  One of the literals was found, so the Pattern might match
+ * @retval false The Pattern can't match
+ *
+ * The text is read in large blocks and scanned with memmem(), which is much
+ * faster than matching the Pattern against each line.  Like the line-by-line
+ * search, the scan continues to the end of the last line.
+ */
+static bool scan_literals(const struct Pattern *pat, FILE *fp, long len)
+{
+  size_t keep = 0;
+  struct ListNode *np = NULL;
+  STAILQ_FOREACH(np, &pat->literals, entries)
+  {
+    keep = MAX(keep, mutt_str_len(np->data) - 1);
+  }
+
+  char *buf = mutt_mem_malloc(SCAN_BLOCK_SIZE);
+  size_t have = 0;
+  bool found = false;
+  bool done = false;
+
+  while (!found && !done)
+  {
+    size_t n = 0;
+    if (len > 0)
+    {
+      n = fread(buf + have, 1, MIN(SCAN_BLOCK_SIZE - have, (size_t) len), fp);
+      len -= n;
+      done = (n == 0) || ((len == 0) && (buf[have + n - 1] == '\n'));
+    }
+    else
+    {
+      int ch = EOF;
+      while ((have + n < SCAN_BLOCK_SIZE) && ((ch = fgetc(fp)) != EOF))
+      {
+        buf[have + n++] = ch;
+        if (ch == '\n')
+          break;
+      }
+      done = (ch == '\n') || (ch == EOF);
+    }
+
+    if (pat->ign_case)
+    {
+      /* The literals are lower-case ASCII */
+      for (size_t i = have; i < (have + n); i++)
+        if ((buf[i] >= 'A') && (buf[i] <= 'Z'))
+          buf[i] |= 0x20;
+    }
+    have += n;
+
+    STAILQ_FOREACH(np, &pat->literals, entries)
+    {
+      if (memmem(buf, have, np->data, mutt_str_len(np->data)))
+      {
+        found = true;
+        break;
+      }
+    }
+
+    /* Keep the tail, in case a literal spans two blocks */
+    if (have > keep)
+    {
+      memmove(buf, buf + have - keep, keep);
+      have = keep;
+    }
+  }
+
+  FREE(&buf);
+  return found;
+}
+
+/**
+ * msg_search_fp - Search the lines of a message
+ * @param pat Pattern to find
+ * @param fp  File, positioned at the start of the text to search
+ * @param len Number of bytes to search
+ * @retval true Pattern found
+ *
+ * This may be called by a worker thread, see pattern_search_new().
+ */
+bool msg_search_fp(const struct Pattern *pat, FILE *fp, long len)
+{
+  if (!STAILQ_EMPTY(&pat->literals))
+  {
+    /* Skip the line-by-line search if the message can't match */
+    const LOFF_T pos = ftello(fp);
+    if (pos >= 0)
+    {
+      if (!scan_literals(pat, fp, len) || (fseeko(fp, pos, SEEK_SET) != 0))
+        return false;
+    }
+  }
+
+  bool match = false;
+  size_t blen = 256;
+  char *buf = mutt_mem_malloc(blen);
+
+  /* search the file "fp" */
+  while (len > 0)
+  {
+    if (pat->op == MUTT_PAT_HEADER)
+    {
+      buf = mutt_rfc822_read_line(fp, buf, &blen);
+      if (*buf == '\0')
+        break;
+    }
+    else if (!fgets(buf, blen - 1, fp))
+      break; /* don't loop forever */
+    if (patmatch(pat, buf))
+    {
+      match = true;
+      break;
+    }
+    len -= mutt_str_len(buf);
+  }
+
+  FREE(&buf);
+  return match;
+}
+
 /**
  * msg_search - Search an email
  * @param m   Mailbox
@@ -107,6 +236,10 @@ static void print_crypt_pattern_op_error(int op)
  */
 static bool msg_search(struct Mailbox *m, struct Pattern *pat, int msgno)
 {
+  /* The message may already have been searched by a worker thread */
+  if (pat->search_results && (pat->search_results[msgno] != 0))
+    return (pat->search_results[msgno] == 2);
+
   bool match = false;
   struct Message *msg = mx_msg_open(m, msgno);
   if (!msg)
@@ -221,29 +354,7 @@ static bool msg_search(struct Mailbox *m, struct Pattern *pat, int msgno)
     }
   }
 
-  size_t blen = 256;
-  char *buf = mutt_mem_malloc(blen);
-
-  /* search the file "fp" */
-  while (len > 0)
-  {
-    if (pat->op == MUTT_PAT_HEADER)
-    {
-      buf = mutt_rfc822_read_line(fp, buf, &blen);
-      if (*buf == '\0')
-        break;
-    }
-    else if (!fgets(buf, blen - 1, fp))
-      break; /* don't loop forever */
-    if (patmatch(pat, buf))
-    {
-      match = true;
-      break;
-    }
-    len -= mutt_str_len(buf);
-  }
-
-  FREE(&buf);
+  match = msg_search_fp(pat, fp, len);
 
   mx_msg_close(m, &msg);
 
@@ -1068,3 +1179,127 @@ int mutt_pattern_alias_exec(struct Pattern *pat, PatternExecFlags flags,
 
   return 0;
 }
+
+/**
+ * mutt_pattern_columnar - Can a Pattern be matched using MailboxColumns?
+ * @param pat Pattern to check
+ * @retval true The Pattern only tests flags, dates, scores and sizes
+ */
+bool mutt_pattern_columnar(const struct Pattern *pat)
+{
+  if (!pat)
+    return false;
+
+  switch (pat->op)
+  {
+    case MUTT_PAT_AND:
+    case MUTT_PAT_OR:
+    {
+      struct Pattern *p = NULL;
+      SLIST_FOREACH(p, pat->child, entries)
+      {
+        if (!mutt_pattern_columnar(p))
+          return false;
+      }
+      return true;
+    }
+    case MUTT_ALL:
+    case MUTT_EXPIRED:
+    case MUTT_SUPERSEDED:
+    case MUTT_FLAG:
+    case MUTT_TAG:
+    case MUTT_NEW:
+    case MUTT_UNREAD:
+    case MUTT_REPLIED:
+    case MUTT_OLD:
+    case MUTT_READ:
+    case MUTT_DELETED:
+    case MUTT_PAT_DATE:
+    case MUTT_PAT_DATE_RECEIVED:
+    case MUTT_PAT_SCORE:
+    case MUTT_PAT_SIZE:
+      return true;
+    default:
+      return false;
+  }
+}
+
+/**
+ * mutt_pattern_exec_columns - Match a Pattern against an Email's packed fields
+ * @param pat Pattern to match, see mutt_pattern_columnar()
+ * @param mc  Packed Email fields
+ * @param i   Index of the Email
+ * @retval 1 Success, pattern matched
+ * @retval 0 Pattern did not match
+ *
+ * This gives the same results as mutt_pattern_exec(), without touching the
+ * Email.
+ */
+int mutt_pattern_exec_columns(struct Pattern *pat, const struct MailboxColumns *mc, size_t i)
+{
+  const EmailColFlags flags = mc->flags[i];
+  const bool read = (flags & EMAIL_COL_READ);
+  const bool old = (flags & EMAIL_COL_OLD);
+
+  switch (pat->op)
+  {
+    case MUTT_PAT_AND:
+    {
+      struct Pattern *p = NULL;
+      SLIST_FOREACH(p, pat->child, entries)
+      {
+        if (mutt_pattern_exec_columns(p, mc, i) <= 0)
+          return pat->pat_not;
+      }
+      return !pat->pat_not;
+    }
+    case MUTT_PAT_OR:
+    {
+      struct Pattern *p = NULL;
+      SLIST_FOREACH(p, pat->child, entries)
+      {
+        if (mutt_pattern_exec_columns(p, mc, i) > 0)
+          return !pat->pat_not;
+      }
+      return pat->pat_not;
+    }
+    case MUTT_ALL:
+      return !pat->pat_not;
+    case MUTT_EXPIRED:
+      return pat->pat_not ^ !!(flags & EMAIL_COL_EXPIRED);
+    case MUTT_SUPERSEDED:
+      return pat->pat_not ^ !!(flags & EMAIL_COL_SUPERSEDED);
+    case MUTT_FLAG:
+      return pat->pat_not ^ !!(flags & EMAIL_COL_FLAGGED);
+    case MUTT_TAG:
+      return pat->pat_not ^ !!(flags & EMAIL_COL_TAGGED);
+    case MUTT_NEW:
+      return pat->pat_not ? old || read : !(old || read);
+    case MUTT_UNREAD:
+      return pat->pat_not ? read : !read;
+    case MUTT_REPLIED:
+      return pat->pat_not ^ !!(flags & EMAIL_COL_REPLIED);
+    case MUTT_OLD:
+      return pat->pat_not ? (!old || read) : (old && !read);
+    case MUTT_READ:
+      return pat->pat_not ^ read;
+    case MUTT_DELETED:
+      return pat->pat_not ^ !!(flags & EMAIL_COL_DELETED);
+    case MUTT_PAT_DATE:
+      if (pat->dynamic)
+        match_update_dynamic_date(pat);
+      return pat->pat_not ^ (mc->date_sent[i] >= pat->min && mc->date_sent[i] <= pat->max);
+    case MUTT_PAT_DATE_RECEIVED:
+      if (pat->dynamic)
+        match_update_dynamic_date(pat);
+      return pat->pat_not ^ (mc->received[i] >= pat->min && mc->received[i] <= pat->max);
+    case MUTT_PAT_SCORE:
+      return pat->pat_not ^ (mc->score[i] >= pat->min &&
+                             (pat->max == MUTT_MAXRANGE || mc->score[i] <= pat->max));
+    case MUTT_PAT_SIZE:
+      return pat->pat_not ^ (mc->size[i] >= pat->min &&
+                             (pat->max == MUTT_MAXRANGE || mc->size[i] <= pat->max));
+  }
+
+  return 0;
+}
@@ -28,12 +28,14 @@
  *
  * | File                 | Description                 |
  * | :------------------- | :-------------------------- |
+ * | pattern/bodyindex.c  | @subpage pattern_bodyindex  |
  * | pattern/compile.c    | @subpage pattern_compile    |
  * | pattern/config.c     | @subpage pattern_config     |
  * | pattern/dlgpattern.c | @subpage pattern_dlgpattern |
  * | pattern/exec.c       | @subpage pattern_exec       |
  * | pattern/flags.c      | @subpage pattern_flags      |
  * | pattern/pattern.c    | @subpage pattern_pattern    |
+ * | pattern/search.c     | @subpage pattern_search     |
  */
 
 #ifndef MUTT_PATTERN_LIB_H
@@ -52,6 +54,7 @@ struct Context;
 struct Email;
 struct Envelope;
 struct Mailbox;
+struct MailboxColumns;
 struct Menu;
 
 #define MUTT_ALIAS_SIMPLESEARCH "~f %s | ~t %s | ~c %s"
@@ -72,7 +75,7 @@ struct Pattern
   bool all_addr     : 1;         ///< All Addresses in the list must match
   bool string_match : 1;         ///< Check a string for a match
   bool group_match  : 1;         ///< Check a group of Addresses
-  bool ign_case     : 1;         ///< Ignore case for local string_match searches
+  bool ign_case     : 1;         ///< Ignore case for local string_match searches and literal scans
   bool is_alias     : 1;         ///< Is there an alias for this Address?
   bool dynamic      : 1;         ///< Evaluate date ranges at run time
   bool sendmode     : 1;         ///< Evaluate searches in send-mode
@@ -80,6 +83,8 @@ struct Pattern
   int min;                       ///< Minimum for range checks
   int max;                       ///< Maximum for range checks
   struct PatternList *child;     ///< Arguments to logical operation
+  unsigned char *search_results; ///< Results of a threaded search, by msgno: 0 unknown, 1 false, 2 true
+  struct ListHead literals;      ///< Text that any match must contain one of (full-message searches)
   union {
     regex_t *regex;              ///< Compiled regex, for non-pattern matching
     struct Group *group;         ///< Address group if group_match is set
@@ -94,6 +99,15 @@ typedef uint8_t PatternExecFlags;         ///< Flags for mutt_pattern_exec(), e.
 #define MUTT_PAT_EXEC_NO_FLAGS         0  ///< No flags are set
 #define MUTT_MATCH_FULL_ADDRESS  (1 << 0) ///< Match the full address
 
+typedef uint8_t PatternDeps;              ///< Inputs of a Pattern, see mutt_pattern_deps(), e.g. #PAT_DEP_FLAGS
+#define PAT_DEP_NO_FLAGS               0  ///< No flags are set
+#define PAT_DEP_FLAGS            (1 << 0) ///< Status flags, e.g. `~N`, `~T`
+#define PAT_DEP_TAGS             (1 << 1) ///< Labels and driver tags, e.g. `~y`, `~G`
+#define PAT_DEP_THREAD           (1 << 2) ///< Threads and numbering, e.g. `~(...)`, `~v`, `~m`
+#define PAT_DEP_SCORE            (1 << 3) ///< Score, `~n`
+#define PAT_DEP_MESSAGE          (1 << 4) ///< Headers and contents of the message, e.g. `~s`, `~b`
+#define PAT_DEP_ALL              0x1f     ///< Everything
+
 /**
  * struct PatternCache - Cache commonly-used patterns
  *
@@ -174,9 +188,12 @@ int mutt_pattern_exec(struct Pattern *pat, PatternExecFlags flags, struct Mailbo
                       struct Email *e, struct PatternCache *cache);
 int mutt_pattern_alias_exec(struct Pattern *pat, PatternExecFlags flags,
                             struct AliasView *av, struct PatternCache *cache);
+bool mutt_pattern_columnar(const struct Pattern *pat);
+int mutt_pattern_exec_columns(struct Pattern *pat, const struct MailboxColumns *mc, size_t i);
 
 struct PatternList *mutt_pattern_comp(struct Mailbox *m, struct Menu *menu, const char *s, PatternCompFlags flags, struct Buffer *err);
 void mutt_check_simple(struct Buffer *s, const char *simple);
+PatternDeps mutt_pattern_deps(const struct PatternList *pat);
 void mutt_pattern_free(struct PatternList **pat);
 bool dlg_select_pattern(char *buf, size_t buflen);
 
@@ -402,6 +402,23 @@ int mutt_pattern_func(struct Context *ctx, int op, char *prompt)
     ctx->collapsed = false;
     int padding = mx_msg_padding_size(m);
 
+    /* Simple patterns can be matched against packed copies of the flags */
+    struct MailboxColumns *mc = NULL;
+    struct PatternSearch *ps = NULL;
+    if (!match_all && mutt_pattern_columnar(SLIST_FIRST(pat)))
+    {
+      mc = mailbox_columns_new(m);
+    }
+    else if (!match_all)
+    {
+      /* Full-message searches can be done ahead, on worker threads */
+      int *msgnos = mutt_mem_calloc(MAX(m->msg_count, 1), sizeof(int));
+      for (int i = 0; i < m->msg_count; i++)
+        msgnos[i] = i;
+      ps = pattern_search_new(m, pat, msgnos, m->msg_count);
+      FREE(&msgnos);
+    }
+
     for (int i = 0; i < m->msg_count; i++)
     {
       struct Email *e = m->emails[i];
@@ -414,8 +431,17 @@ int mutt_pattern_func(struct Context *ctx, int op, char *prompt)
       e->visible = false;
       e->collapsed = false;
       e->num_hidden = 0;
-      if (match_all ||
-          mutt_pattern_exec(SLIST_FIRST(pat), MUTT_MATCH_FULL_ADDRESS, m, e, NULL))
+      bool match = match_all;
+      if (!match && mc)
+      {
+        match = mutt_pattern_exec_columns(SLIST_FIRST(pat), mc, i);
+      }
+      else if (!match)
+      {
+        pattern_search_wait(ps, i);
+        match = mutt_pattern_exec(SLIST_FIRST(pat), MUTT_MATCH_FULL_ADDRESS, m, e, NULL);
+      }
+      if (match)
       {
         e->vnum = m->vcount;
         e->visible = true;
@@ -425,15 +451,19 @@ int mutt_pattern_func(struct Context *ctx, int op, char *prompt)
         ctx->vsize += b->length + b->offset - b->hdr_offset + padding;
       }
     }
+    pattern_search_free(&ps);
+    mailbox_columns_free(&mc);
   }
   else
   {
+    struct PatternSearch *ps = pattern_search_new(m, pat, m->v2r, m->vcount);
     for (int i = 0; i < m->vcount; i++)
     {
       struct Email *e = mutt_get_virt_email(m, i);
       if (!e)
         continue;
       mutt_progress_update(&progress, i, -1);
+      pattern_search_wait(ps, i);
       if (mutt_pattern_exec(SLIST_FIRST(pat), MUTT_MATCH_FULL_ADDRESS, m, e, NULL))
       {
         switch (op)
@@ -451,6 +481,7 @@ int mutt_pattern_func(struct Context *ctx, int op, char *prompt)
         }
       }
     }
+    pattern_search_free(&ps);
   }
 
   mutt_clear_error();
@@ -568,11 +599,32 @@ int mutt_search_command(struct Mailbox *m, struct Menu *menu, int cur, int op)
 
   mutt_progress_init(&progress, _("Searching..."), MUTT_PROGRESS_READ, m->vcount);
 
+  /* Full-message searches can be done ahead, on worker threads,
+   * for the messages that haven't been searched yet */
+  const bool c_wrap_search = cs_subset_bool(NeoMutt->sub, "wrap_search");
+  int *msgnos = mutt_mem_calloc(MAX(m->vcount, 1), sizeof(int));
+  size_t num_jobs = 0;
+  for (int i = cur + incr, j = 0; j != m->vcount; j++, i += incr)
+  {
+    if ((i > m->vcount - 1) || (i < 0))
+    {
+      if (!c_wrap_search)
+        break;
+      i = (i < 0) ? m->vcount - 1 : 0;
+    }
+    struct Email *e = mutt_get_virt_email(m, i);
+    if (e && !e->searched)
+      msgnos[num_jobs++] = e->msgno;
+  }
+  struct PatternSearch *ps = pattern_search_new(m, SearchPattern, msgnos, num_jobs);
+  FREE(&msgnos);
+  size_t job = 0;
+  int rc = -1;
+
   for (int i = cur + incr, j = 0; j != m->vcount; j++)
   {
     const char *msg = NULL;
     mutt_progress_update(&progress, j, -1);
-    const bool c_wrap_search = cs_subset_bool(NeoMutt->sub, "wrap_search");
     if (i > m->vcount - 1)
     {
       i = 0;
@@ -581,7 +633,7 @@ int mutt_search_command(struct Mailbox *m, struct Menu *menu, int cur, int op)
       else
       {
         mutt_message(_("Search hit bottom without finding match"));
-        return -1;
+        goto done;
       }
     }
     else if (i < 0)
@@ -592,7 +644,7 @@ int mutt_search_command(struct Mailbox *m, struct Menu *menu, int cur, int op)
       else
       {
         mutt_message(_("Search hit top without finding match"));
-        return -1;
+        goto done;
       }
     }
 
@@ -605,12 +657,14 @@ int mutt_search_command(struct Mailbox *m, struct Menu *menu, int cur, int op)
         mutt_clear_error();
         if (msg && *msg)
           mutt_message(msg);
-        return i;
+        rc = i;
+        goto done;
       }
     }
     else
     {
       /* remember that we've already searched this message */
+      pattern_search_wait(ps, job++);
       e->searched = true;
       e->matched = mutt_pattern_exec(SLIST_FIRST(SearchPattern),
                                      MUTT_MATCH_FULL_ADDRESS, m, e, NULL);
@@ -619,7 +673,8 @@ int mutt_search_command(struct Mailbox *m, struct Menu *menu, int cur, int op)
         mutt_clear_error();
         if (msg && *msg)
           mutt_message(msg);
-        return i;
+        rc = i;
+        goto done;
       }
     }
 
@@ -627,14 +682,17 @@ int mutt_search_command(struct Mailbox *m, struct Menu *menu, int cur, int op)
     {
       mutt_error(_("Search interrupted"));
       SigInt = 0;
-      return -1;
+      goto done;
     }
 
     i += incr;
   }
 
   mutt_error(_("Not found"));
-  return -1;
+
+done:
+  pattern_search_free(&ps);
+  return rc;
 }
 
 /**
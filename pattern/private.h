@@ -25,9 +25,15 @@
 
 #include "config.h"
 #include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
 #include "mutt/lib.h"
 #include "lib.h"
 
+struct BodyIndex;
+struct BodyIndexEntry;
+struct ConfigSubset;
+
 /**
  * enum PatternEat - Function to process pattern arguments
  *
@@ -124,5 +130,26 @@ extern const struct PatternFlags Flags[];
 const struct PatternFlags *lookup_op(int op);
 const struct PatternFlags *lookup_tag(char tag);
 bool eval_date_minmax(struct Pattern *pat, const char *s, struct Buffer *err);
+bool msg_search_fp(const struct Pattern *pat, FILE *fp, long len);
+
+#ifdef USE_HCACHE
+struct BodyIndex      *body_index_open      (struct Mailbox *m);
+void                   body_index_close     (struct BodyIndex **ptr);
+struct BodyIndexEntry *body_index_build     (struct BodyIndex *bi, int msgno);
+void                   body_index_entry_free(struct BodyIndexEntry **ptr);
+struct BodyIndexEntry *body_index_fetch     (struct BodyIndex *bi, const struct Email *e);
+bool                   body_index_may_match (const struct BodyIndexEntry *bie, const struct Pattern *pat);
+
+uint32_t               body_index_config      (const struct ConfigSubset *sub);
+void                   body_index_entry_add   (struct BodyIndexEntry *bie, FILE *fp, uint64_t len);
+bool                   body_index_entry_has   (const struct BodyIndexEntry *bie, const char *lit);
+struct BodyIndexEntry *body_index_entry_new   (uint64_t size, uint32_t check, uint64_t text_len);
+void *                 body_index_entry_pack  (const struct BodyIndexEntry *bie, size_t *dlen);
+struct BodyIndexEntry *body_index_entry_unpack(const void *data, size_t dlen, uint64_t size, uint32_t check);
+#endif
+
+struct PatternSearch *pattern_search_new (struct Mailbox *m, struct PatternList *pat, const int *msgnos, size_t count);
+void                  pattern_search_free(struct PatternSearch **ptr);
+void                  pattern_search_wait(struct PatternSearch *ps, size_t index);
 
 #endif /* MUTT_PATTERN_PRIVATE_H */
@@ -0,0 +1,1170 @@
+/**
+ * @file
+ * Search local messages on worker threads
+ *
+ * @authors
+ * Copyright (C) 2021 Richard Russon <rich@flatcap.org>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @page pattern_search Search local messages on worker threads
+ *
+ * Searching the headers or bodies of a large local mailbox, e.g. `~b`, is
+ * dominated by opening and reading each message file in turn.
+ *
+ * The PatternSearch uses a pool of worker threads to search the messages a
+ * little way ahead of the main thread, which still evaluates the Pattern, in
+ * order.  The result of each full-message search is stored in
+ * Pattern::search_results, where msg_search() will find it.
+ *
+ * Without `$thorough_search`, the workers search the raw messages themselves.
+ * With it, the messages must be decoded, which depends on shared state
+ * (logging, the Buffer pool, the mailcap cache, the GUI), so it stays on the
+ * main thread.  Instead, the workers gather all the text that decoding could
+ * produce, see #SearchText.  If none of a search's literals appear in it, the
+ * message can't match, so the main thread doesn't need to decode it at all.
+ *
+ * Only the searches that are joined by 'and' or 'or' are done in advance;
+ * those inside thread patterns, e.g. `~(...)`, are evaluated against other
+ * Emails, so they're left to the main thread.
+ *
+ * If the Mailbox has a body index, see @ref pattern_bodyindex, it's consulted
+ * first.  The messages it rules out aren't read at all.  Messages that aren't
+ * indexed yet are indexed on the main thread, as they're reached.
+ */
+
+#include "config.h"
+#include <ctype.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include "private.h"
+#include "mutt/lib.h"
+#include "config/lib.h"
+#include "email/lib.h"
+#include "core/lib.h"
+#include "lib.h"
+#include "mutt_globals.h"
+
+/// Number of bytes to read at a time, when warming the page cache
+#define SEARCH_READ_BYTES 65536
+
+/// How many messages each thread may search, ahead of the main thread
+#define SEARCH_WINDOW 32
+
+/// Largest message that a worker will read, to rule it out of a thorough search
+#define SEARCH_MAX_TEXT (16 * 1024 * 1024)
+
+/// Longest piece of a quoted-printable line that the handler decodes at once
+#define SEARCH_QP_LINE 255
+
+/// Longest piece of a line that mutt_parse_multipart() reads at once
+#define SEARCH_MIME_LINE 1023
+
+/// Most multipart boundaries that a worker will follow, see decode_base64()
+#define SEARCH_MAX_BOUNDARIES 16
+
+/// Characters that may be added or removed when an address field is decoded
+#define SEARCH_ADDR_PUNCT "\"<>\\,;:"
+
+ARRAY_HEAD(PatternArray, struct Pattern *);
+
+/**
+ * struct SearchJob - The location of one message to be searched
+ */
+struct SearchJob
+{
+  int msgno;          ///< Index of the Email in the Mailbox
+  char *path;         ///< Path of the message file, relative to the Mailbox (Maildir/MH)
+  LOFF_T offset;      ///< Start of the headers
+  LOFF_T body_offset; ///< Start of the body
+  LOFF_T body_length; ///< Length of the body
+  bool decided;       ///< The body index has answered every search
+  bool build;         ///< The message needs to be indexed
+};
+
+/**
+ * struct PatternSearch - Search local messages on worker threads
+ */
+struct PatternSearch
+{
+  char *file;                   ///< Mailbox file (mbox) or directory (Maildir/MH)
+  bool is_dir;                  ///< Each message is a separate file
+  bool thorough;                ///< The messages must be decoded before they're searched
+  bool prefilter;               ///< Rule out messages from a thorough search, see #SearchText
+  bool autoview;                ///< Some attachments may be autoviewed
+  bool reflow;                  ///< Flowed text is reflowed, `$reflow_text`
+  size_t max_literal;           ///< Length of the longest literal of any search
+  struct PatternArray leaves;   ///< Full-message searches to do in advance
+  struct SearchJob *jobs;       ///< Messages to search, in order
+  size_t count;                 ///< Number of jobs
+  struct WorkerPool *pool;      ///< Worker threads
+#ifdef USE_HCACHE
+  struct BodyIndex *index;      ///< Body index of the Mailbox
+#endif
+};
+
+/**
+ * find_leaves - Find the full-message searches in a Pattern
+ * @param pat    Pattern to search
+ * @param leaves Array for the results
+ */
+static void find_leaves(struct PatternList *pat, struct PatternArray *leaves)
+{
+  struct Pattern *p = NULL;
+  SLIST_FOREACH(p, pat, entries)
+  {
+    switch (p->op)
+    {
+      case MUTT_PAT_AND:
+      case MUTT_PAT_OR:
+        find_leaves(p->child, leaves);
+        break;
+      case MUTT_PAT_BODY:
+      case MUTT_PAT_HEADER:
+      case MUTT_PAT_WHOLE_MSG:
+        if (!p->sendmode)
+          ARRAY_ADD(leaves, p);
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+#ifdef USE_HCACHE
+/**
+ * apply_index - Answer the searches of one message from its body index
+ * @param ps  PatternSearch
+ * @param job Message to search
+ * @param bie Index of the message
+ */
+static void apply_index(struct PatternSearch *ps, struct SearchJob *job,
+                        const struct BodyIndexEntry *bie)
+{
+  bool decided = true;
+  struct Pattern **pp = NULL;
+  ARRAY_FOREACH(pp, &ps->leaves)
+  {
+    struct Pattern *pat = *pp;
+    if (pat->search_results[job->msgno] != 0)
+      continue;
+
+    if (body_index_may_match(bie, pat))
+      decided = false;
+    else
+      pat->search_results[job->msgno] = 1;
+  }
+  job->decided = decided;
+}
+#endif
+
+/**
+ * search_leaf - Search one message for a Pattern
+ * @param job Message to search
+ * @param pat Full-message Pattern
+ * @param fp  Open message
+ * @retval true Pattern found
+ *
+ * This mirrors the raw search of msg_search().
+ */
+static bool search_leaf(const struct SearchJob *job, const struct Pattern *pat, FILE *fp)
+{
+  LOFF_T start = job->offset;
+  long len = 0;
+
+  if (pat->op != MUTT_PAT_BODY)
+    len = job->body_offset - job->offset;
+  if (pat->op != MUTT_PAT_HEADER)
+  {
+    if (pat->op == MUTT_PAT_BODY)
+      start = job->body_offset;
+    len += job->body_length;
+  }
+
+  if (fseeko(fp, start, SEEK_SET) != 0)
+    return false;
+
+  return msg_search_fp(pat, fp, len);
+}
+
+/**
+ * struct SearchText - All the text that a thorough search of a message could see
+ *
+ * A thorough search decodes the message before searching it, which can't be
+ * done on a worker thread.  Instead, the worker gathers everything that the
+ * decoded text could contain: the raw message, plus the body with any
+ * quoted-printable and base64 undone.  Converting the result to UTF-8 doesn't
+ * create any new ASCII text.
+ *
+ * Anything else that could add text, e.g. an encoded header or an autoviewed
+ * attachment, marks that part of the message as not ok.
+ */
+struct SearchText
+{
+  struct Buffer raw;     ///< Raw header, then raw body
+  size_t hdr_len;        ///< Length of the raw header
+  struct Buffer decoded; ///< Body with quoted-printable and base64 undone
+  struct Buffer addrs;   ///< Address fields, without whitespace or punctuation
+  struct Buffer lower;   ///< Lower-case copy of raw, decoded and addrs, for case-insensitive searches
+  const char *bounds[SEARCH_MAX_BOUNDARIES]; ///< Multipart boundaries, pointing into raw
+  size_t bound_lens[SEARCH_MAX_BOUNDARIES];  ///< Lengths of the boundaries
+  int num_bounds;        ///< Number of boundaries
+  bool hdr_ok;           ///< Decoding the header can't add any text
+  bool body_ok;          ///< Decoding the body can't add any text that isn't in raw or decoded
+};
+
+/**
+ * line_end - Find the end of a line
+ * @param s   Text
+ * @param pos Start of the line
+ * @param end End of the text
+ * @retval num Offset after the line's newline, or end
+ */
+static size_t line_end(const char *s, size_t pos, size_t end)
+{
+  const char *nl = memchr(s + pos, '\n', end - pos);
+  return nl ? (size_t) (nl + 1 - s) : end;
+}
+
+/**
+ * field_end - Find the end of a header field, including its continuation lines
+ * @param s   Text
+ * @param pos Start of the field
+ * @param end End of the text
+ * @retval num Offset after the field
+ */
+static size_t field_end(const char *s, size_t pos, size_t end)
+{
+  pos = line_end(s, pos, end);
+  while ((pos < end) && ((s[pos] == ' ') || (s[pos] == '\t')))
+    pos = line_end(s, pos, end);
+  return pos;
+}
+
+/**
+ * find_ci - Find some text, ignoring case
+ * @param s      Text to search
+ * @param len    Length of the text
+ * @param needle Text to find
+ * @retval true The text was found
+ */
+static bool find_ci(const char *s, size_t len, const char *needle)
+{
+  const size_t nlen = mutt_str_len(needle);
+  for (size_t i = 0; (i + nlen) <= len; i++)
+  {
+    if (mutt_istrn_equal(s + i, needle, nlen))
+      return true;
+  }
+  return false;
+}
+
+/**
+ * next_param - Find the next value of a MIME parameter
+ * @param[in]     s    Parameters of a field, e.g. `; charset="us-ascii"`
+ * @param[in]     len  Length of the parameters
+ * @param[in,out] pos  Where to start looking, updated to the end of the value
+ * @param[in]     name Name of the parameter
+ * @param[out]    vlen Length of the value
+ * @retval ptr  Value, without quotes, or "*" for an RFC2231 parameter
+ * @retval NULL No more values
+ */
+static const char *next_param(const char *s, size_t len, size_t *pos,
+                              const char *name, size_t *vlen)
+{
+  const size_t nlen = mutt_str_len(name);
+  for (size_t i = *pos; (i + nlen) <= len; i++)
+  {
+    if (!mutt_istrn_equal(s + i, name, nlen))
+      continue;
+
+    size_t k = i + nlen;
+    while ((k < len) && IS_SPACE(s[k]))
+      k++;
+    if ((k < len) && (s[k] == '*'))
+    {
+      *pos = k + 1;
+      *vlen = 1;
+      return s + k;
+    }
+    if ((k >= len) || (s[k] != '='))
+      continue;
+    k++;
+    while ((k < len) && IS_SPACE(s[k]))
+      k++;
+
+    const bool quoted = (k < len) && (s[k] == '"');
+    if (quoted)
+      k++;
+    const char *val = s + k;
+    while ((k < len) && (quoted ? (s[k] != '"') : ((s[k] != ';') && !IS_SPACE(s[k]))))
+      k++;
+    *vlen = (s + k) - val;
+    *pos = k;
+    return val;
+  }
+  return NULL;
+}
+
+/**
+ * charset_ok - Does a charset convert ASCII to itself, and nothing else to ASCII?
+ * @param cs  Name of the charset
+ * @param len Length of the name
+ * @retval true The charset is ASCII-compatible, e.g. "iso-8859-1"
+ */
+static bool charset_ok(const char *cs, size_t len)
+{
+  static const char *const names[] = { "us-ascii", "ascii", "utf-8", "utf8" };
+  static const char *const prefixes[] = { "iso-8859-", "iso8859-", "windows-125",
+                                          "cp125", "koi8-" };
+
+  for (size_t i = 0; i < mutt_array_size(names); i++)
+  {
+    if ((len == mutt_str_len(names[i])) && mutt_istrn_equal(cs, names[i], len))
+      return true;
+  }
+  for (size_t i = 0; i < mutt_array_size(prefixes); i++)
+  {
+    const size_t plen = mutt_str_len(prefixes[i]);
+    if ((len > plen) && mutt_istrn_equal(cs, prefixes[i], plen))
+      return true;
+  }
+  return false;
+}
+
+/**
+ * content_type_ok - Can decoding a MIME part only produce its own text?
+ * @param ps  PatternSearch
+ * @param st  SearchText, for the multipart boundary
+ * @param val Value of the Content-Type field, including continuation lines
+ * @param len Length of the value
+ * @retval true The part is text/plain in a simple charset, a multipart, or an
+ *              attachment that won't be shown
+ */
+static bool content_type_ok(const struct PatternSearch *ps, struct SearchText *st,
+                            const char *val, size_t len)
+{
+  static const char *const risky[] = {
+    "message/",        "multipart/encrypted", "multipart/digest",  "text/enriched",
+    "application/pgp", "application/x-pgp",   "application/pkcs7", "application/x-pkcs7",
+  };
+
+  size_t i = 0;
+  while ((i < len) && IS_SPACE(val[i]))
+    i++;
+  const char *type = val + i;
+  while ((i < len) && (val[i] != ';') && !IS_SPACE(val[i]))
+    i++;
+  const size_t tlen = (val + i) - type;
+
+  if (!memchr(type, '/', tlen))
+    return false;
+  for (size_t r = 0; r < mutt_array_size(risky); r++)
+  {
+    const size_t rlen = mutt_str_len(risky[r]);
+    if ((tlen >= rlen) && mutt_istrn_equal(type, risky[r], rlen))
+      return false;
+  }
+
+  const bool plain = (tlen == 10) && mutt_istrn_equal(type, "text/plain", 10);
+  const bool multi = (tlen > 10) && mutt_istrn_equal(type, "multipart/", 10);
+  if (ps->autoview && !plain && !multi)
+    return false;
+
+  /* Inline PGP and flowed text are changed by the handlers */
+  const char *params = val + i;
+  const size_t plen = len - i;
+  if (find_ci(params, plen, "action") || (ps->reflow && find_ci(params, plen, "flowed")))
+    return false;
+
+  size_t pos = 0;
+  size_t vlen = 0;
+  const char *cs = NULL;
+  while ((cs = next_param(params, plen, &pos, "charset", &vlen)))
+  {
+    if (!charset_ok(cs, vlen))
+      return false;
+  }
+
+  /* The boundaries are needed to find the base64 parts, see decode_base64() */
+  pos = 0;
+  const char *bound = next_param(params, plen, &pos, "boundary", &vlen);
+  if (bound)
+  {
+    if ((vlen == 0) || (*bound == '*') || memchr(bound, '\\', vlen) ||
+        next_param(params, plen, &pos, "boundary", &vlen) ||
+        (st->num_bounds == SEARCH_MAX_BOUNDARIES))
+    {
+      return false;
+    }
+    st->bounds[st->num_bounds] = bound;
+    st->bound_lens[st->num_bounds] = vlen;
+    st->num_bounds++;
+  }
+
+  return true;
+}
+
+/**
+ * is_address_field - Is a header field one that's reformatted when it's decoded?
+ * @param s Start of the field
+ * @retval true It's an address field, see address_header_decode()
+ */
+static bool is_address_field(const char *s)
+{
+  static const char *const names[] = { "bcc:", "cc:", "from:", "mail-followup-to:",
+                                       "reply-to:", "sender:", "to:" };
+
+  for (size_t i = 0; i < mutt_array_size(names); i++)
+  {
+    if (mutt_istr_startswith(s, names[i]))
+      return true;
+  }
+  return false;
+}
+
+/**
+ * add_address_field - Add an address field to a SearchText
+ * @param st  SearchText
+ * @param s   Start of the field
+ * @param len Length of the field
+ *
+ * When the field is decoded, it's parsed and written out again, which can
+ * change the whitespace, quoting, brackets and separators, but not the order
+ * of the rest.  Comments can move, so they can't be searched this way.
+ */
+static void add_address_field(struct SearchText *st, const char *s, size_t len)
+{
+  if (memchr(s, '(', len))
+    st->hdr_ok = false;
+
+  for (size_t i = 0; i < len; i++)
+  {
+    if (!IS_SPACE(s[i]) && !strchr(SEARCH_ADDR_PUNCT, s[i]))
+      mutt_buffer_addch(&st->addrs, s[i]);
+  }
+  mutt_buffer_addch(&st->addrs, '\n');
+}
+
+/**
+ * is_boundary - Is a line a multipart boundary?
+ * @param st  SearchText
+ * @param s   Start of the line
+ * @param len Length of the line
+ * @retval true The line starts or ends a MIME part
+ *
+ * This matches the boundaries the same way as mutt_parse_multipart().
+ */
+static bool is_boundary(const struct SearchText *st, const char *s, size_t len)
+{
+  if ((len < 2) || (s[0] != '-') || (s[1] != '-'))
+    return false;
+
+  for (int i = 0; i < st->num_bounds; i++)
+  {
+    const size_t start = st->bound_lens[i] + 2;
+    if ((len < start) || (memcmp(s + 2, st->bounds[i], st->bound_lens[i]) != 0))
+      continue;
+
+    size_t last = len;
+    while ((last > start) && IS_SPACE(s[last - 1]))
+      last--;
+    if ((last == start) ||
+        (((last - start) == 2) && (s[start] == '-') && (s[start + 1] == '-')))
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * decode_qp_piece - Undo quoted-printable on a piece of a line, as the handler would
+ * @param st   SearchText to append to
+ * @param s    Text to decode
+ * @param len  Length of the text
+ * @param full The piece ends the line, so trailing whitespace is removed
+ */
+static void decode_qp_piece(struct SearchText *st, const char *s, size_t len, bool full)
+{
+  if (full)
+  {
+    while ((len > 0) && IS_SPACE(s[len - 1]))
+      len--;
+  }
+
+  bool soft = false;
+  for (size_t i = 0; i < len;)
+  {
+    if ((s[i] == '=') && ((i + 1) == len))
+    {
+      soft = true;
+      i++;
+    }
+    else if ((s[i] == '=') && ((i + 2) < len) && isxdigit((unsigned char) s[i + 1]) &&
+             isxdigit((unsigned char) s[i + 2]))
+    {
+      mutt_buffer_addch(&st->decoded, (hexval(s[i + 1]) << 4) | hexval(s[i + 2]));
+      i += 3;
+    }
+    else
+    {
+      mutt_buffer_addch(&st->decoded, s[i++]);
+    }
+  }
+
+  if (!soft && full)
+    mutt_buffer_addch(&st->decoded, '\n');
+}
+
+/**
+ * ends_line - Does some decoded text end with a newline?
+ * @param buf Decoded text
+ * @retval true The text is empty, or ends with a newline
+ */
+static bool ends_line(const struct Buffer *buf)
+{
+  return (mutt_buffer_len(buf) == 0) || (buf->dptr[-1] == '\n');
+}
+
+/**
+ * decode_quoted - Undo quoted-printable, as the handler would
+ * @param ps PatternSearch
+ * @param st SearchText to append to
+ *
+ * Every line of the body is decoded, whether or not it's in a quoted-printable
+ * part.  Like the handler, long lines are decoded in pieces.
+ *
+ * The last line of a part is read without its newline, so its trailing
+ * whitespace isn't removed.  If that matters, the line is decoded both ways:
+ * the other way is added on a line of its own, after enough of the decoded
+ * line to hold the longest literal.
+ */
+static void decode_quoted(const struct PatternSearch *ps, struct SearchText *st)
+{
+  const char *s = st->raw.data;
+  const size_t len = mutt_buffer_len(&st->raw);
+  size_t line_start = mutt_buffer_len(&st->decoded);
+
+  for (size_t pos = st->hdr_len; pos < len;)
+  {
+    const size_t end = line_end(s, pos, len);
+    for (size_t piece = pos; piece < end;)
+    {
+      const size_t plen = MIN(end - piece, SEARCH_QP_LINE);
+      const bool full = (s[piece + plen - 1] == '\n');
+      const size_t before = mutt_buffer_len(&st->decoded);
+
+      decode_qp_piece(st, s + piece, plen, full);
+
+      size_t vlen = plen - 1;
+      if (full && (vlen > 0) && (s[piece + vlen - 1] == '\r'))
+        vlen--;
+      if (full && (vlen > 0) && IS_SPACE(s[piece + vlen - 1]))
+      {
+        const size_t after = mutt_buffer_len(&st->decoded);
+        const size_t tail = MIN(before - line_start, ps->max_literal);
+        const bool open = !ends_line(&st->decoded);
+
+        /* The Buffer mustn't move while it's copied from */
+        mutt_buffer_alloc(&st->decoded, after + tail + vlen + ps->max_literal + plen + 4);
+        mutt_buffer_addch(&st->decoded, '\n');
+        mutt_buffer_addstr_n(&st->decoded, st->decoded.data + before - tail, tail);
+        decode_qp_piece(st, s + piece, vlen, false);
+        mutt_buffer_addch(&st->decoded, '\n');
+
+        /* A soft line break continues the line, so repeat the end of it */
+        if (open)
+        {
+          const size_t keep = MIN(after - line_start, ps->max_literal);
+          line_start = mutt_buffer_len(&st->decoded);
+          mutt_buffer_addstr_n(&st->decoded, st->decoded.data + after - keep, keep);
+        }
+      }
+
+      if (ends_line(&st->decoded))
+        line_start = mutt_buffer_len(&st->decoded);
+      piece += plen;
+    }
+    pos = end;
+  }
+
+  mutt_buffer_addch(&st->decoded, '\n');
+}
+
+/**
+ * decode_base64 - Undo base64, as the handler would
+ * @param st  SearchText to append to
+ * @param b64 The message's body is base64-encoded
+ *
+ * The boundaries are followed to find the base64 parts.  Like the handler,
+ * anything outside the alphabet is skipped and decoding stops at the padding.
+ */
+static void decode_base64(struct SearchText *st, bool b64)
+{
+  const char *s = st->raw.data;
+  const size_t len = mutt_buffer_len(&st->raw);
+  bool headers = false;
+  bool part_b64 = false;
+  bool done = false;
+  char buf[4];
+  int n = 0;
+
+  for (size_t pos = st->hdr_len; pos < len;)
+  {
+    const size_t end = line_end(s, pos, len);
+
+    /* mutt_parse_multipart() reads long lines in pieces */
+    for (size_t piece = pos + SEARCH_MIME_LINE; piece < end; piece += SEARCH_MIME_LINE)
+    {
+      if (is_boundary(st, s + piece, MIN(end - piece, SEARCH_MIME_LINE)))
+        st->body_ok = false;
+    }
+
+    if (is_boundary(st, s + pos, MIN(end - pos, SEARCH_MIME_LINE)))
+    {
+      if (b64)
+        mutt_buffer_addch(&st->decoded, '\n');
+      headers = true;
+      part_b64 = false;
+      b64 = false;
+      pos = end;
+      continue;
+    }
+
+    if (headers)
+    {
+      size_t last = end;
+      while ((last > pos) && IS_SPACE(s[last - 1]))
+        last--;
+
+      if (last == pos)
+      {
+        /* A blank continuation line might not end the headers */
+        if ((s[pos] == ' ') || (s[pos] == '\t'))
+          st->body_ok = false;
+        headers = false;
+        b64 = part_b64;
+        done = false;
+        n = 0;
+      }
+      else if (mutt_istr_startswith(s + pos, "content-transfer-encoding:"))
+      {
+        part_b64 = find_ci(s + pos, field_end(s, pos, len) - pos, "base64");
+      }
+      pos = end;
+      continue;
+    }
+
+    for (size_t i = pos; b64 && !done && (i < end); i++)
+    {
+      const unsigned char ch = s[i];
+      if ((ch >= 128) || ((base64val(ch) == -1) && (ch != '=')))
+        continue;
+
+      buf[n++] = ch;
+      if (n < 4)
+        continue;
+      n = 0;
+
+      const int c1 = base64val(buf[0]);
+      const int c2 = base64val(buf[1]);
+      mutt_buffer_addch(&st->decoded, (c1 << 2) | (c2 >> 4));
+      if (buf[2] == '=')
+      {
+        done = true;
+        break;
+      }
+      const int c3 = base64val(buf[2]);
+      mutt_buffer_addch(&st->decoded, ((c2 & 0xf) << 4) | (c3 >> 2));
+      if (buf[3] == '=')
+      {
+        done = true;
+        break;
+      }
+      const int c4 = base64val(buf[3]);
+      mutt_buffer_addch(&st->decoded, ((c3 & 0x3) << 6) | c4);
+    }
+    pos = end;
+  }
+
+  mutt_buffer_addch(&st->decoded, '\n');
+}
+
+/**
+ * search_text_scan - Check the raw message and gather its decoded text
+ * @param ps PatternSearch
+ * @param st SearchText, holding the raw message
+ */
+static void search_text_scan(const struct PatternSearch *ps, struct SearchText *st)
+{
+  const char *s = st->raw.data;
+  const size_t len = mutt_buffer_len(&st->raw);
+  bool b64 = false;
+
+  st->hdr_ok = true;
+  st->body_ok = true;
+
+  /* Encoded words and international domain names are decoded */
+  if (find_ci(s, st->hdr_len, "=?") || find_ci(s, st->hdr_len, "xn--"))
+    st->hdr_ok = false;
+
+  /* Check the fields of the message and of its parts, wherever they might be */
+  for (size_t pos = 0; pos < len;)
+  {
+    if ((s[pos] == ' ') || (s[pos] == '\t'))
+    {
+      pos = line_end(s, pos, len);
+      continue;
+    }
+
+    const size_t end = field_end(s, pos, len);
+    size_t n;
+    if ((pos < st->hdr_len) && is_address_field(s + pos))
+    {
+      add_address_field(st, s + pos, MIN(end, st->hdr_len) - pos);
+    }
+    else if ((n = mutt_istr_startswith(s + pos, "content-type:")))
+    {
+      if (!content_type_ok(ps, st, s + pos + n, end - pos - n))
+        st->body_ok = false;
+    }
+    else if ((n = mutt_istr_startswith(s + pos, "content-transfer-encoding:")))
+    {
+      if (find_ci(s + pos + n, end - pos - n, "uu"))
+        st->body_ok = false;
+      if ((pos < st->hdr_len) && find_ci(s + pos + n, end - pos - n, "base64"))
+        b64 = true;
+    }
+    pos = end;
+  }
+
+  decode_quoted(ps, st);
+  decode_base64(st, b64);
+}
+
+/**
+ * search_text_may_match - Could a thorough search of a message match?
+ * @param st  SearchText of the message
+ * @param pat Full-message Pattern, with literals
+ * @retval true  The message must be searched in full
+ * @retval false The Pattern can't match the decoded message
+ */
+static bool search_text_may_match(struct SearchText *st, const struct Pattern *pat)
+{
+  const bool hdr = (pat->op != MUTT_PAT_BODY);
+  const bool body = (pat->op != MUTT_PAT_HEADER);
+  if ((hdr && !st->hdr_ok) || (body && !st->body_ok))
+    return true;
+
+  const size_t raw_len = mutt_buffer_len(&st->raw);
+  const size_t dec_len = mutt_buffer_len(&st->decoded);
+  const size_t addr_len = mutt_buffer_len(&st->addrs);
+  const char *raw = st->raw.data;
+  const char *decoded = st->decoded.data;
+  const char *addrs = st->addrs.data;
+  if (pat->ign_case)
+  {
+    /* The literals are lower-case ASCII */
+    if (mutt_buffer_len(&st->lower) == 0)
+    {
+      mutt_buffer_alloc(&st->lower, raw_len + dec_len + addr_len + 1);
+      mutt_buffer_addstr_n(&st->lower, raw, raw_len);
+      mutt_buffer_addstr_n(&st->lower, decoded, dec_len);
+      mutt_buffer_addstr_n(&st->lower, addrs, addr_len);
+      for (char *p = st->lower.data; p < st->lower.dptr; p++)
+        if ((*p >= 'A') && (*p <= 'Z'))
+          *p |= 0x20;
+    }
+    raw = st->lower.data;
+    decoded = raw + raw_len;
+    addrs = decoded + dec_len;
+  }
+
+  /* The header search ends at the raw body; the body search starts there */
+  const size_t start = hdr ? 0 : st->hdr_len;
+  const size_t end = body ? raw_len : st->hdr_len;
+
+  char norm[128];
+  struct ListNode *np = NULL;
+  STAILQ_FOREACH(np, &pat->literals, entries)
+  {
+    const char *lit = np->data;
+    const size_t lit_len = mutt_str_len(lit);
+
+    /* A replacement character, '?', could match anywhere.  In the header,
+     * whitespace may be refolded. */
+    for (size_t i = 0; i < lit_len; i++)
+    {
+      const unsigned char ch = lit[i];
+      if ((ch < 0x20) || (ch > 0x7e) || (ch == '?') || (hdr && (ch == ' ')))
+        return true;
+    }
+
+    if (memmem(raw + start, end - start, lit, lit_len))
+      return true;
+    if (body && memmem(decoded, dec_len, lit, lit_len))
+      return true;
+
+    if (hdr)
+    {
+      size_t nlen = 0;
+      for (size_t i = 0; (i < lit_len) && (nlen < sizeof(norm)); i++)
+      {
+        if (!strchr(SEARCH_ADDR_PUNCT, lit[i]))
+          norm[nlen++] = lit[i];
+      }
+      if ((nlen == 0) || ((addr_len > 0) && memmem(addrs, addr_len, norm, nlen)))
+        return true;
+    }
+  }
+
+  return false;
+}
+
+/**
+ * prefilter_job - Rule out a message from a thorough search
+ * @param ps  PatternSearch
+ * @param job Message to search
+ * @param fp  Open message
+ *
+ * The messages that might match are left for msg_search() to decode.  This
+ * also pulls the message into the page cache, ready to be decoded.
+ */
+static void prefilter_job(const struct PatternSearch *ps, const struct SearchJob *job, FILE *fp)
+{
+  const LOFF_T size = job->body_offset + job->body_length - job->offset;
+  if ((size <= 0) || (size > SEARCH_MAX_TEXT) || (job->body_offset < job->offset))
+    return;
+
+  /* The worker's own Buffers, not the pool */
+  struct SearchText st = { 0 };
+  st.raw = mutt_buffer_make(size + 1);
+  st.decoded = mutt_buffer_make(size + 1);
+  st.hdr_len = job->body_offset - job->offset;
+
+  LOFF_T pos = 0;
+  while (pos < size)
+  {
+    ssize_t rc = pread(fileno(fp), st.raw.data + pos, size - pos, job->offset + pos);
+    if (rc <= 0)
+      break;
+    pos += rc;
+  }
+
+  if (pos == size)
+  {
+    st.raw.dptr = st.raw.data + size;
+    *st.raw.dptr = '\0';
+    search_text_scan(ps, &st);
+
+    struct Pattern **pp = NULL;
+    ARRAY_FOREACH(pp, &ps->leaves)
+    {
+      struct Pattern *pat = *pp;
+      if ((pat->search_results[job->msgno] == 0) && !STAILQ_EMPTY(&pat->literals) &&
+          !search_text_may_match(&st, pat))
+      {
+        pat->search_results[job->msgno] = 1;
+      }
+    }
+  }
+
+  mutt_buffer_dealloc(&st.raw);
+  mutt_buffer_dealloc(&st.decoded);
+  mutt_buffer_dealloc(&st.addrs);
+  mutt_buffer_dealloc(&st.lower);
+}
+
+/**
+ * search_job - Search, or read, one message - Implements ::worker_job_t
+ */
+static void search_job(void *data, size_t index)
+{
+  struct PatternSearch *ps = data;
+  const struct SearchJob *job = &ps->jobs[index];
+  if ((job->msgno < 0) || job->decided)
+    return;
+
+  char fn[PATH_MAX];
+  if (ps->is_dir)
+  {
+    if (!job->path)
+      return;
+    snprintf(fn, sizeof(fn), "%s/%s", ps->file, job->path);
+  }
+  else
+  {
+    mutt_str_copy(fn, ps->file, sizeof(fn));
+  }
+
+  /* If the message can't be opened, msg_search() will try again */
+  FILE *fp = fopen(fn, "r");
+  if (!fp)
+    return;
+
+  if (ps->thorough && ps->prefilter)
+  {
+    prefilter_job(ps, job, fp);
+  }
+  else if (ps->thorough)
+  {
+    /* Pull the message into the page cache; it will be decoded later.
+     * This is only a hint, so errors are left for msg_search() to find. */
+    char buf[SEARCH_READ_BYTES];
+    LOFF_T pos = job->offset;
+    const LOFF_T end = job->body_offset + job->body_length;
+    while (pos < end)
+    {
+      ssize_t rc = pread(fileno(fp), buf, sizeof(buf), pos);
+      if (rc <= 0)
+        break;
+      pos += rc;
+    }
+  }
+  else
+  {
+    struct Pattern **pp = NULL;
+    ARRAY_FOREACH(pp, &ps->leaves)
+    {
+      struct Pattern *pat = *pp;
+      if (pat->search_results[job->msgno] == 0)
+        pat->search_results[job->msgno] = search_leaf(job, pat, fp) ? 2 : 1;
+    }
+  }
+
+  fclose(fp);
+}
+
+/**
+ * prefilter_possible - Can a worker rule out messages from a thorough search?
+ * @retval true The config only decodes the text that #SearchText gathers
+ *
+ * Anything that converts text to ASCII, or autoviews a text part, could add
+ * text that the workers can't see.
+ */
+static bool prefilter_possible(void)
+{
+  const char *const c_charset = cs_subset_string(NeoMutt->sub, "charset");
+  const char *const c_assumed_charset =
+      cs_subset_string(NeoMutt->sub, "assumed_charset");
+  const bool c_implicit_autoview = cs_subset_bool(NeoMutt->sub, "implicit_autoview");
+  const char *const c_show_multipart_alternative =
+      cs_subset_string(NeoMutt->sub, "show_multipart_alternative");
+
+  if (!mutt_ch_is_utf8(c_charset) || c_assumed_charset || c_implicit_autoview ||
+      mutt_str_equal(c_show_multipart_alternative, "info"))
+  {
+    return false;
+  }
+
+  struct ListNode *np = NULL;
+  STAILQ_FOREACH(np, &AutoViewList, entries)
+  {
+    const char *slash = strchr(np->data, '/');
+    if (!slash || mutt_istr_startswith(np->data, "*") ||
+        mutt_istrn_equal(np->data, "text/", 5) || mutt_istrn_equal(np->data, "multipart/", 10))
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/**
+ * pattern_search_new - Start searching messages on worker threads
+ * @param m      Mailbox
+ * @param pat    Pattern to match
+ * @param msgnos Emails to search, in the order they'll be matched
+ * @param count  Number of Emails
+ * @retval ptr  New PatternSearch
+ * @retval NULL The search should be done on the main thread, without an index
+ *
+ * The caller must call pattern_search_wait() before matching each Email and
+ * must free the PatternSearch with pattern_search_free() before freeing the
+ * Pattern.
+ */
+struct PatternSearch *pattern_search_new(struct Mailbox *m, struct PatternList *pat,
+                                         const int *msgnos, size_t count)
+{
+  if (!m || !pat || !msgnos || (count < 2))
+    return NULL;
+
+  bool is_dir;
+  switch (m->type)
+  {
+    case MUTT_MBOX:
+    case MUTT_MMDF:
+      is_dir = false;
+      break;
+    case MUTT_MAILDIR:
+    case MUTT_MH:
+      is_dir = true;
+      break;
+    default:
+      return NULL;
+  }
+
+  struct PatternArray leaves = ARRAY_HEAD_INITIALIZER;
+  find_leaves(pat, &leaves);
+  if (ARRAY_EMPTY(&leaves))
+    return NULL;
+
+  const short c_search_threads = cs_subset_number(NeoMutt->sub, "search_threads");
+  const int threads = mutt_worker_threads(c_search_threads);
+
+  struct Pattern **pp = NULL;
+  struct BodyIndex *index = NULL;
+#ifdef USE_HCACHE
+  ARRAY_FOREACH(pp, &leaves)
+  {
+    if (!STAILQ_EMPTY(&(*pp)->literals))
+    {
+      index = body_index_open(m);
+      break;
+    }
+  }
+#endif
+  if ((threads < 2) && !index)
+  {
+    ARRAY_FREE(&leaves);
+    return NULL;
+  }
+
+  struct PatternSearch *ps = mutt_mem_calloc(1, sizeof(*ps));
+  ps->file = mutt_str_dup(mailbox_path(m));
+  ps->is_dir = is_dir;
+  ps->thorough = cs_subset_bool(NeoMutt->sub, "thorough_search");
+  ps->prefilter = ps->thorough && prefilter_possible();
+  ps->autoview = !STAILQ_EMPTY(&AutoViewList);
+  ps->reflow = cs_subset_bool(NeoMutt->sub, "reflow_text");
+  ps->leaves = leaves;
+#ifdef USE_HCACHE
+  ps->index = index;
+#endif
+
+  ARRAY_FOREACH(pp, &ps->leaves)
+  {
+    (*pp)->search_results = mutt_mem_calloc(m->msg_count, sizeof(unsigned char));
+
+    struct ListNode *np = NULL;
+    STAILQ_FOREACH(np, &(*pp)->literals, entries)
+    {
+      ps->max_literal = MAX(ps->max_literal, mutt_str_len(np->data));
+    }
+  }
+
+  /* Take a copy of the locations, so the workers don't touch the Emails */
+  ps->jobs = mutt_mem_calloc(count, sizeof(struct SearchJob));
+  ps->count = count;
+  for (size_t i = 0; i < count; i++)
+  {
+    struct SearchJob *job = &ps->jobs[i];
+    job->msgno = msgnos[i];
+
+    struct Email *e = m->emails[job->msgno];
+    if (!e || !e->body)
+    {
+      job->msgno = -1;
+      continue;
+    }
+
+    job->path = mutt_str_dup(e->path);
+    job->offset = e->offset;
+    job->body_offset = e->body->offset;
+    job->body_length = e->body->length;
+
+#ifdef USE_HCACHE
+    if (ps->index)
+    {
+      struct BodyIndexEntry *bie = body_index_fetch(ps->index, e);
+      if (bie)
+        apply_index(ps, job, bie);
+      else
+        job->build = true;
+      body_index_entry_free(&bie);
+    }
+#endif
+  }
+
+  if (threads > 1)
+    ps->pool = mutt_worker_new(count, threads, SEARCH_WINDOW * threads, search_job, ps);
+  return ps;
+}
+
+/**
+ * pattern_search_wait - Wait for an Email to be searched
+ * @param ps    PatternSearch
+ * @param index Index of the Email in the list passed to pattern_search_new()
+ */
+void pattern_search_wait(struct PatternSearch *ps, size_t index)
+{
+  if (!ps)
+    return;
+
+  if (ps->pool)
+    mutt_worker_wait(ps->pool, index);
+
+#ifdef USE_HCACHE
+  /* The worker has finished with the message, so it's safe to index it */
+  struct SearchJob *job = &ps->jobs[index];
+  if (job->build)
+  {
+    job->build = false;
+    struct BodyIndexEntry *bie = body_index_build(ps->index, job->msgno);
+    if (bie)
+      apply_index(ps, job, bie);
+    body_index_entry_free(&bie);
+  }
+#endif
+}
+
+/**
+ * pattern_search_free - Stop searching and free the PatternSearch
+ * @param[out] ptr PatternSearch to free
+ *
+ * The results are removed from the Pattern.
+ */
+void pattern_search_free(struct PatternSearch **ptr)
+{
+  if (!ptr || !*ptr)
+    return;
+
+  struct PatternSearch *ps = *ptr;
+  mutt_worker_free(&ps->pool);
+#ifdef USE_HCACHE
+  body_index_close(&ps->index);
+#endif
+
+  struct Pattern **pp = NULL;
+  ARRAY_FOREACH(pp, &ps->leaves)
+  {
+    FREE(&(*pp)->search_results);
+  }
+  ARRAY_FREE(&ps->leaves);
+
+  for (size_t i = 0; i < ps->count; i++)
+    FREE(&ps->jobs[i].path);
+  FREE(&ps->jobs);
+  FREE(&ps->file);
+  FREE(ptr);
+}
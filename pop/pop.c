@@ -229,7 +229,7 @@ static int fetch_uidl(const char *line, void *data)
       mx_alloc_memory(m);
 
     m->msg_count++;
-    m->emails[i] = email_new();
+    m->emails[i] = email_new_slab(m->slab);
 
     m->emails[i]->edata = pop_edata_new(line);
     m->emails[i]->edata_free = pop_edata_free;
@@ -327,6 +327,8 @@ static int pop_fetch_headers(struct Mailbox *m)
 
 #ifdef USE_HCACHE
   struct HeaderCache *hc = pop_hcache_open(adata, mailbox_path(m));
+  if (hc)
+    hc->slab = m->slab;
 #endif
 
   adata->check_time = mutt_date_epoch();
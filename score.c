@@ -53,12 +53,19 @@ struct Score
   char *str;
   struct PatternList *pat;
   int val;
-  bool exact; ///< if this rule matches, don't evaluate any more
+  bool exact;       ///< if this rule matches, don't evaluate any more
+  int seq;          ///< When the rule was added, see ScoreSeq
+  PatternDeps deps; ///< Inputs of the rule's pattern, see mutt_pattern_deps()
   struct Score *next;
 };
 
 static struct Score *ScoreList = NULL;
 
+/// Sequence number of the last change to the score rules
+static int ScoreSeq = 0;
+/// Sequence number of the last change that wasn't adding a rule
+static int ScoreReset = 0;
+
 /**
  * mutt_check_rescore - Do the emails need to have their scores recalculated?
  * @param m Mailbox
@@ -87,8 +94,8 @@ void mutt_check_rescore(struct Mailbox *m)
       if (!e)
         break;
 
-      mutt_score_message(m, e, true);
-      e->pair = 0;
+      mutt_rescore_message(m, e);
+      e->pair_stale |= PAT_DEP_SCORE;
     }
   }
   OptNeedRescore = false;
@@ -140,6 +147,8 @@ enum CommandResult mutt_parse_score(struct Buffer *buf, struct Buffer *s,
       ScoreList = ptr;
     ptr->pat = pat;
     ptr->str = pattern;
+    ptr->seq = ++ScoreSeq;
+    ptr->deps = mutt_pattern_deps(pat);
   }
   else
   {
@@ -147,6 +156,7 @@ enum CommandResult mutt_parse_score(struct Buffer *buf, struct Buffer *s,
      * as here 'ptr' != NULL -> update the value only in which case
      * ptr->str already has the string, so pattern should be freed.  */
     FREE(&pattern);
+    ScoreReset = ++ScoreSeq;
   }
   pc = buf->data;
   if (*pc == '=')
@@ -165,32 +175,46 @@ enum CommandResult mutt_parse_score(struct Buffer *buf, struct Buffer *s,
 }
 
 /**
- * mutt_score_message - Apply scoring to an email
- * @param m        Mailbox
- * @param e        Email
- * @param upd_mbox If true, update the Mailbox too
+ * score_apply - Apply the newer scoring rules to an email
+ * @param e   Email
+ * @param seq Only apply the rules added after this, see ScoreSeq
  */
-void mutt_score_message(struct Mailbox *m, struct Email *e, bool upd_mbox)
+static void score_apply(struct Email *e, int seq)
 {
   struct Score *tmp = NULL;
   struct PatternCache cache = { 0 };
 
-  e->score = 0; /* in case of re-scoring */
-  for (tmp = ScoreList; tmp; tmp = tmp->next)
+  for (tmp = ScoreList; tmp && !e->score_exact; tmp = tmp->next)
   {
+    if (tmp->seq <= seq)
+      continue;
+
     if (mutt_pattern_exec(SLIST_FIRST(tmp->pat), MUTT_MATCH_FULL_ADDRESS, NULL, e, &cache) > 0)
     {
       if (tmp->exact || (tmp->val == 9999) || (tmp->val == -9999))
       {
-        e->score = tmp->val;
+        e->score_sum = tmp->val;
+        e->score_exact = true;
         break;
       }
-      e->score += tmp->val;
+      e->score_sum += tmp->val;
     }
   }
+  e->score_seq = ScoreSeq;
+
+  e->score = e->score_sum;
   if (e->score < 0)
     e->score = 0;
+}
 
+/**
+ * score_thresholds - Set the flags of an email, according to its score
+ * @param m        Mailbox
+ * @param e        Email
+ * @param upd_mbox If true, update the Mailbox too
+ */
+static void score_thresholds(struct Mailbox *m, struct Email *e, bool upd_mbox)
+{
   const short c_score_threshold_delete =
       cs_subset_number(NeoMutt->sub, "score_threshold_delete");
   const short c_score_threshold_flag =
@@ -206,6 +230,54 @@ void mutt_score_message(struct Mailbox *m, struct Email *e, bool upd_mbox)
     mutt_set_flag_update(m, e, MUTT_FLAG, true, upd_mbox);
 }
 
+/**
+ * mutt_score_message - Apply scoring to an email
+ * @param m        Mailbox
+ * @param e        Email
+ * @param upd_mbox If true, update the Mailbox too
+ */
+void mutt_score_message(struct Mailbox *m, struct Email *e, bool upd_mbox)
+{
+  /* in case of re-scoring */
+  e->score_sum = 0;
+  e->score_exact = false;
+  e->score_stale = PAT_DEP_NO_FLAGS;
+  score_apply(e, 0);
+  score_thresholds(m, e, upd_mbox);
+}
+
+/**
+ * mutt_rescore_message - Update the score of an email after the rules change
+ * @param m Mailbox
+ * @param e Email
+ *
+ * If rules have only been added since the Email was scored, only they need to
+ * be matched.  The old rules are matched again if any of their inputs have
+ * changed, see Email::score_stale, or if the rules have changed in any other
+ * way.
+ */
+void mutt_rescore_message(struct Mailbox *m, struct Email *e)
+{
+  bool full = (e->score_seq < ScoreReset);
+
+  /* A rule that reads the score may be affected by the new rules, too */
+  const PatternDeps stale = e->score_stale | PAT_DEP_SCORE;
+  for (struct Score *tmp = ScoreList; tmp && !full; tmp = tmp->next)
+  {
+    if ((tmp->seq <= e->score_seq) && (tmp->deps & stale))
+      full = true;
+  }
+
+  if (full)
+  {
+    mutt_score_message(m, e, true);
+    return;
+  }
+
+  score_apply(e, e->score_seq);
+  score_thresholds(m, e, true);
+}
+
 /**
  * mutt_parse_unscore - Parse the 'unscore' command - Implements Command::parse()
  */
@@ -246,6 +318,7 @@ enum CommandResult mutt_parse_unscore(struct Buffer *buf, struct Buffer *s,
       }
     }
   }
+  ScoreReset = ++ScoreSeq;
   OptNeedRescore = true;
   return MUTT_CMD_SUCCESS;
 }
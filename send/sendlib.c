@@ -346,9 +346,9 @@ static size_t convert_file_to(FILE *fp, const char *fromcode, int ncodes,
 
   for (int i = 0; i < ncodes; i++)
     if (cd[i] != (iconv_t)(-1))
-      iconv_close(cd[i]);
+      mutt_ch_iconv_close(cd[i]);
 
-  iconv_close(cd1);
+  mutt_ch_iconv_close(cd1);
   FREE(&cd);
   FREE(&infos);
   FREE(&score);
@@ -551,6 +551,169 @@ struct Content *mutt_get_content_info(const char *fname, struct Body *b,
   return info;
 }
 
+/// Number of mime.types files that are searched
+#define MIME_TYPES_FILES 4
+
+/**
+ * struct MimeTypesEntry - The MIME type for a file extension
+ */
+struct MimeTypesEntry
+{
+  char *type;    ///< Major type, e.g. "image"
+  char *subtype; ///< Minor type, e.g. "png"
+};
+
+/**
+ * struct MimeTypes - The mime.types files, indexed by file extension
+ */
+struct MimeTypes
+{
+  struct HashTable *exts;                     ///< Extension -> MimeTypesEntry
+  struct FileStamp stamps[MIME_TYPES_FILES];  ///< Versions of the files that were read
+  bool loaded;                                ///< The files have been read
+  bool found;                                 ///< At least one file exists
+};
+
+static struct MimeTypes MimeTypes = { 0 };
+
+/**
+ * mime_types_path - Get the path of a mime.types file
+ * @param buf    Buffer for the result
+ * @param buflen Length of the buffer
+ * @param num    Number of the file, in the order they're read
+ */
+static void mime_types_path(char *buf, size_t buflen, int num)
+{
+  switch (num)
+  {
+    case 0:
+      /* check default unix mimetypes location first */
+      mutt_str_copy(buf, "/etc/mime.types", buflen);
+      break;
+    case 1:
+      mutt_str_copy(buf, SYSCONFDIR "/mime.types", buflen);
+      break;
+    case 2:
+      mutt_str_copy(buf, PKGDATADIR "/mime.types", buflen);
+      break;
+    default:
+      snprintf(buf, buflen, "%s/.mime.types", NONULL(HomeDir));
+      break;
+  }
+}
+
+/**
+ * mime_types_entry_free - Free a MimeTypesEntry - Implements ::hash_hdata_free_t
+ */
+static void mime_types_entry_free(int type, void *obj, intptr_t data)
+{
+  struct MimeTypesEntry *mte = obj;
+  FREE(&mte->type);
+  FREE(&mte->subtype);
+  FREE(&mte);
+}
+
+/**
+ * mime_types_read - Index the extensions of a mime.types file
+ * @param fp File to read
+ *
+ * If an extension is listed more than once, the first entry is used.
+ */
+static void mime_types_read(FILE *fp)
+{
+  char buf[PATH_MAX];
+  char *p = NULL, *q = NULL, *ct = NULL;
+
+  while (fgets(buf, sizeof(buf) - 1, fp))
+  {
+    /* weed out any comments */
+    p = strchr(buf, '#');
+    if (p)
+      *p = '\0';
+
+    /* remove any leading space. */
+    ct = buf;
+    SKIPWS(ct);
+
+    /* position on the next field in this line */
+    p = strpbrk(ct, " \t");
+    if (!p)
+      continue;
+    *p++ = 0;
+    SKIPWS(p);
+
+    /* get the content-type */
+    char *sub = strchr(ct, '/');
+    if (!sub)
+      continue; /* malformed line, just skip it. */
+    *sub++ = 0;
+
+    for (q = sub; *q && !IS_SPACE(*q); q++)
+      ; // do nothing
+    *q = '\0';
+
+    /* cycle through the file extensions */
+    while ((p = strtok(p, " \t\n")))
+    {
+      if (!mutt_hash_find(MimeTypes.exts, p))
+      {
+        struct MimeTypesEntry *mte = mutt_mem_calloc(1, sizeof(*mte));
+        mte->type = mutt_str_dup(ct);
+        mte->subtype = mutt_str_dup(sub);
+        mutt_hash_insert(MimeTypes.exts, p, mte);
+      }
+      p = NULL;
+    }
+  }
+}
+
+/**
+ * mime_types_load - Read the mime.types files, if they've changed
+ */
+static void mime_types_load(void)
+{
+  char path[PATH_MAX];
+  bool changed = !MimeTypes.loaded;
+
+  for (int i = 0; i < MIME_TYPES_FILES; i++)
+  {
+    mime_types_path(path, sizeof(path), i);
+    if (mutt_file_stamp_changed(path, &MimeTypes.stamps[i]))
+      changed = true;
+  }
+
+  if (!changed)
+    return;
+
+  mutt_hash_free(&MimeTypes.exts);
+  MimeTypes.exts = mutt_hash_new(1024, MUTT_HASH_STRCASECMP | MUTT_HASH_STRDUP_KEYS);
+  mutt_hash_set_destructor(MimeTypes.exts, mime_types_entry_free, 0);
+  MimeTypes.found = false;
+
+  for (int i = 0; i < MIME_TYPES_FILES; i++)
+  {
+    mime_types_path(path, sizeof(path), i);
+    FILE *fp = fopen(path, "r");
+    if (!fp)
+      continue;
+
+    MimeTypes.found = true;
+    mime_types_read(fp);
+    mutt_file_fclose(&fp);
+  }
+
+  MimeTypes.loaded = true;
+}
+
+/**
+ * mutt_mime_types_free - Free the index of the mime.types files
+ */
+void mutt_mime_types_free(void)
+{
+  mutt_hash_free(&MimeTypes.exts);
+  memset(&MimeTypes, 0, sizeof(MimeTypes));
+}
+
 /**
  * mutt_lookup_mime_type - Find the MIME type for an attachment
  * @param att  Email with attachment
@@ -562,116 +725,43 @@ struct Content *mutt_get_content_info(const char *fname, struct Body *b,
  * in a system mime.types if we can find one, then look for ~/.mime.types.
  * The longest match is used so that we can match 'ps.gz' when 'gz' also
  * exists.
+ *
+ * The files are only read again when they change.
  */
 enum ContentType mutt_lookup_mime_type(struct Body *att, const char *path)
 {
-  FILE *fp = NULL;
-  char *p = NULL, *q = NULL, *ct = NULL;
-  char buf[PATH_MAX];
-  char subtype[256] = { 0 };
-  char xtype[256] = { 0 };
-  int sze, cur_sze = 0;
-  bool found_mimetypes = false;
   enum ContentType type = TYPE_OTHER;
 
-  int szf = mutt_str_len(path);
+  mime_types_load();
 
-  for (int count = 0; count < 4; count++)
+  /* no mime.types file found */
+  if (!MimeTypes.found)
   {
-    /* can't use strtok() because we use it in an inner loop below, so use
-     * a switch statement here instead.  */
-    switch (count)
-    {
-      /* last file with last entry to match wins type/xtype */
-      case 0:
-        /* check default unix mimetypes location first */
-        mutt_str_copy(buf, "/etc/mime.types", sizeof(buf));
-        break;
-      case 1:
-        mutt_str_copy(buf, SYSCONFDIR "/mime.types", sizeof(buf));
-        break;
-      case 2:
-        mutt_str_copy(buf, PKGDATADIR "/mime.types", sizeof(buf));
-        break;
-      case 3:
-        snprintf(buf, sizeof(buf), "%s/.mime.types", NONULL(HomeDir));
-        break;
-      default:
-        mutt_debug(LL_DEBUG1, "Internal error, count = %d\n", count);
-        goto bye; /* shouldn't happen */
-    }
-
-    fp = fopen(buf, "r");
-    if (fp)
-    {
-      found_mimetypes = true;
-
-      while (fgets(buf, sizeof(buf) - 1, fp))
-      {
-        /* weed out any comments */
-        p = strchr(buf, '#');
-        if (p)
-          *p = '\0';
-
-        /* remove any leading space. */
-        ct = buf;
-        SKIPWS(ct);
-
-        /* position on the next field in this line */
-        p = strpbrk(ct, " \t");
-        if (!p)
-          continue;
-        *p++ = 0;
-        SKIPWS(p);
-
-        /* cycle through the file extensions */
-        while ((p = strtok(p, " \t\n")))
-        {
-          sze = mutt_str_len(p);
-          if ((sze > cur_sze) && (szf >= sze) && mutt_istr_equal(path + szf - sze, p) &&
-              ((szf == sze) || (path[szf - sze - 1] == '.')))
-          {
-            /* get the content-type */
-
-            p = strchr(ct, '/');
-            if (!p)
-            {
-              /* malformed line, just skip it. */
-              break;
-            }
-            *p++ = 0;
-
-            for (q = p; *q && !IS_SPACE(*q); q++)
-              ; // do nothing
-
-            mutt_strn_copy(subtype, p, q - p, sizeof(subtype));
-
-            type = mutt_check_mime_type(ct);
-            if (type == TYPE_OTHER)
-              mutt_str_copy(xtype, ct, sizeof(xtype));
-
-            cur_sze = sze;
-          }
-          p = NULL;
-        }
-      }
-      mutt_file_fclose(&fp);
-    }
+    mutt_error(_("Could not find any mime.types file"));
+    return type;
   }
 
-bye:
+  if (!path)
+    return type;
 
-  /* no mime.types file found */
-  if (!found_mimetypes)
+  /* The candidates are the whole path, then everything after each dot,
+   * so the first match is the longest */
+  const struct MimeTypesEntry *mte = NULL;
+  for (const char *ext = path; ext; ext = strchr(ext, '.'))
   {
-    mutt_error(_("Could not find any mime.types file"));
+    if (*ext == '.')
+      ext++;
+    mte = mutt_hash_find(MimeTypes.exts, ext);
+    if (mte)
+      break;
   }
 
-  if ((type != TYPE_OTHER) || (*xtype != '\0'))
+  if (mte)
   {
+    type = mutt_check_mime_type(mte->type);
     att->type = type;
-    mutt_str_replace(&att->subtype, subtype);
-    mutt_str_replace(&att->xtype, xtype);
+    mutt_str_replace(&att->subtype, mte->subtype);
+    mutt_str_replace(&att->xtype, (type == TYPE_OTHER) ? mte->type : NULL);
   }
 
   return type;
@@ -29,7 +29,9 @@
  */
 
 #include "config.h"
+#include <ctype.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 #include "mutt/lib.h"
@@ -38,6 +40,7 @@
 #include "core/lib.h"
 #include "alias/lib.h"
 #include "sort.h"
+#include "pattern/lib.h"
 #include "mutt_globals.h"
 #include "mutt_logging.h"
 #include "mutt_thread.h"
@@ -328,6 +331,362 @@ static int compare_label(const void *a, const void *b)
   return sort_code(result);
 }
 
+/**
+ * struct SortField - A precomputed sort key of an Email
+ *
+ * The members are compared in order.  Any that a sort method doesn't need are
+ * left as zero, or as the empty string.
+ */
+struct SortField
+{
+  int group;   ///< Coarse order, e.g. Emails with a label come first
+  int64_t num; ///< Number, e.g. the date sent
+  double dbl;  ///< Floating-point number, i.e. the spam score
+  size_t str;  ///< Offset of a lower-case string in SortKeys::strings
+};
+
+/**
+ * struct SortKey - The precomputed sort keys of an Email
+ */
+struct SortKey
+{
+  struct SortField primary; ///< Key for the primary sort method
+  struct SortField aux;     ///< Key for the secondary sort method
+};
+
+/**
+ * struct SortKeys - Precomputed sort keys for all the Emails of a Mailbox
+ *
+ * The keys are indexed by Email::index, which also breaks any ties.
+ */
+struct SortKeys
+{
+  struct SortKey *keys;  ///< Keys, indexed by Email::index
+  struct Email **emails; ///< Emails, indexed by Email::index
+  size_t count;          ///< Number of keys
+  char *strings;         ///< Lower-case strings of the keys
+  size_t str_len;        ///< Length of the strings
+  size_t str_size;       ///< Space allocated to the strings
+  bool use_aux;          ///< Compare the secondary keys, too
+  bool reverse;          ///< Reverse the primary sort
+  bool reverse_aux;      ///< Reverse the secondary sort
+};
+
+/**
+ * sort_keys_add_string - Add a copy of a string to the SortKeys
+ * @param sk   Sort keys
+ * @param str  String to add
+ * @param max  Maximum number of bytes to copy
+ * @param fold If true, make the copy lower-case
+ * @retval num Offset of the copy in SortKeys::strings
+ */
+static size_t sort_keys_add_string(struct SortKeys *sk, const char *str,
+                                   size_t max, bool fold)
+{
+  const size_t len = mutt_str_len(str);
+  if (len == 0)
+    return 0;
+  const size_t n = MIN(len, max);
+
+  if ((sk->str_len + n + 1) > sk->str_size)
+  {
+    sk->str_size = MAX(sk->str_size * 2, sk->str_len + n + 1);
+    mutt_mem_realloc(&sk->strings, sk->str_size);
+  }
+
+  const size_t off = sk->str_len;
+  for (size_t i = 0; i < n; i++)
+    sk->strings[off + i] = fold ? tolower((unsigned char) str[i]) : str[i];
+  sk->strings[off + n] = '\0';
+  sk->str_len += n + 1;
+  return off;
+}
+
+/**
+ * sort_keys_extract - Work out one sort key of an Email
+ * @param sk     Sort keys
+ * @param sf     Sort key to fill in
+ * @param e      Email
+ * @param method Sort type, see #SortType
+ * @param type   The Mailbox type
+ * @retval true  Success
+ * @retval false The sort method isn't supported
+ *
+ * The keys give the same order as the matching function from
+ * mutt_get_sort_func(), but they're worked out once per Email, not once per
+ * comparison.
+ */
+static bool sort_keys_extract(struct SortKeys *sk, struct SortField *sf,
+                              const struct Email *e, enum SortType method,
+                              enum MailboxType type)
+{
+  switch (method)
+  {
+    case SORT_DATE:
+      sf->num = e->date_sent;
+      return true;
+    case SORT_RECEIVED:
+      sf->num = e->received;
+      return true;
+    case SORT_SIZE:
+      sf->num = e->body ? e->body->length : 0;
+      return true;
+    case SORT_SCORE: /* note that this is reverse */
+      sf->num = -(int64_t) e->score;
+      return true;
+    case SORT_ORDER:
+#ifdef USE_NNTP
+      if (type == MUTT_NNTP)
+      {
+        sf->num = nntp_article_num((struct Email *) e);
+        return true;
+      }
+#endif
+      sf->num = e->index;
+      return true;
+    case SORT_SUBJECT:
+      /* Emails without a subject come first, by date */
+      if (e->env && e->env->real_subj)
+      {
+        sf->group = 1;
+        sf->str = sort_keys_add_string(sk, e->env->real_subj, SIZE_MAX, true);
+      }
+      else
+      {
+        sf->num = e->date_sent;
+      }
+      return true;
+    case SORT_FROM:
+      if (e->env)
+        sf->str = sort_keys_add_string(sk, mutt_get_name(TAILQ_FIRST(&e->env->from)), 127, true);
+      return true;
+    case SORT_TO:
+      if (e->env)
+        sf->str = sort_keys_add_string(sk, mutt_get_name(TAILQ_FIRST(&e->env->to)), 127, true);
+      return true;
+    case SORT_LABEL:
+      /* Emails with a label come first */
+      if (e->env && e->env->x_label && (e->env->x_label[0] != '\0'))
+        sf->str = sort_keys_add_string(sk, e->env->x_label, SIZE_MAX, true);
+      else
+        sf->group = 1;
+      return true;
+    case SORT_SPAM:
+    {
+      /* Emails without a spam attribute come first, then numeric ones */
+      if (!e->env || mutt_buffer_is_empty(&e->env->spam))
+        return true;
+
+      const char *data = e->env->spam.data;
+      char *end = NULL;
+      const double score = strtod(data, &end);
+      if (end == data)
+      {
+        sf->group = 2;
+      }
+      else
+      {
+        sf->group = 1;
+        sf->dbl = score;
+      }
+      /* The rest of the attribute is compared case-sensitively */
+      sf->str = sort_keys_add_string(sk, end, SIZE_MAX, false);
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+
+/**
+ * sort_field_cmp - Compare two sort keys
+ * @param sk Sort keys
+ * @param a  First key
+ * @param b  Second key
+ * @retval <0 a precedes b
+ * @retval  0 a and b are identical
+ * @retval >0 b precedes a
+ */
+static int sort_field_cmp(const struct SortKeys *sk, const struct SortField *a,
+                          const struct SortField *b)
+{
+  if (a->group != b->group)
+    return (a->group < b->group) ? -1 : 1;
+  if (a->num != b->num)
+    return (a->num < b->num) ? -1 : 1;
+  if (a->dbl != b->dbl)
+    return (a->dbl > b->dbl) - (a->dbl < b->dbl);
+  if (a->str == b->str)
+    return 0;
+  return strcmp(sk->strings + a->str, sk->strings + b->str);
+}
+
+/**
+ * sort_key_cmp - Compare the sort keys of two Emails
+ * @param sk Sort keys
+ * @param a  Email::index of the first Email
+ * @param b  Email::index of the second Email
+ * @retval <0 a precedes b
+ * @retval  0 a and b are identical
+ * @retval >0 b precedes a
+ *
+ * This gives the same order as the Email-based sort functions, i.e. $sort,
+ * then $sort_aux, then the index.
+ */
+static int sort_key_cmp(const struct SortKeys *sk, int a, int b)
+{
+  const struct SortKey *ka = &sk->keys[a];
+  const struct SortKey *kb = &sk->keys[b];
+
+  int rc = sort_field_cmp(sk, &ka->primary, &kb->primary);
+  if (rc == 0)
+  {
+    if (sk->use_aux)
+      rc = sort_field_cmp(sk, &ka->aux, &kb->aux);
+    if (rc == 0)
+      rc = (a > b) - (a < b);
+    if (sk->reverse_aux)
+      rc = -rc;
+  }
+
+  return sk->reverse ? -rc : rc;
+}
+
+/**
+ * compare_key_index - Compare the sort keys of two Emails - Implements ::merge_cmp_t
+ */
+static int compare_key_index(const void *a, const void *b, void *sdata)
+{
+  return sort_key_cmp(sdata, *(const int *) a, *(const int *) b);
+}
+
+/**
+ * mutt_sort_keys_new - Work out the sort keys of all the Emails in a Mailbox
+ * @param m        Mailbox
+ * @param sort     Primary sort method, e.g. $sort
+ * @param sort_aux Secondary sort method, e.g. $sort_aux, or 0 for none
+ * @retval ptr  New SortKeys
+ * @retval NULL The sort methods aren't supported
+ *
+ * The keys are only valid until the Emails change.
+ * They must be freed with mutt_sort_keys_free().
+ */
+struct SortKeys *mutt_sort_keys_new(struct Mailbox *m, short sort, short sort_aux)
+{
+  if (!m || (m->msg_count <= 0) || !m->emails)
+    return NULL;
+
+  const enum MailboxType type = mx_type(m);
+  const enum SortType method = sort & SORT_MASK;
+  const enum SortType method_aux = sort_aux & SORT_MASK;
+
+  struct SortKeys *sk = mutt_mem_calloc(1, sizeof(*sk));
+  sk->count = m->msg_count;
+  sk->keys = mutt_mem_calloc(sk->count, sizeof(struct SortKey));
+  sk->emails = mutt_mem_calloc(sk->count, sizeof(struct Email *));
+  sk->str_size = 4096;
+  sk->strings = mutt_mem_malloc(sk->str_size);
+  sk->strings[0] = '\0'; /* offset 0 is the empty string */
+  sk->str_len = 1;
+  sk->reverse = (sort & SORT_REVERSE);
+  sk->reverse_aux = (sort_aux & SORT_REVERSE);
+
+  /* The Mailbox order never has ties, so it doesn't use $sort_aux */
+  sk->use_aux = (method_aux != 0);
+  if (method == SORT_ORDER)
+  {
+#ifdef USE_NNTP
+    if (type != MUTT_NNTP)
+#endif
+      sk->use_aux = false;
+  }
+
+  for (size_t i = 0; i < sk->count; i++)
+  {
+    struct Email *e = m->emails[i];
+    /* Every Email must have its own slot */
+    if (!e || (e->index < 0) || ((size_t) e->index >= sk->count) || sk->emails[e->index])
+      goto fail;
+
+    struct SortKey *key = &sk->keys[e->index];
+    sk->emails[e->index] = e;
+    if (!sort_keys_extract(sk, &key->primary, e, method, type))
+      goto fail;
+    if (sk->use_aux && !sort_keys_extract(sk, &key->aux, e, method_aux, type))
+      goto fail;
+  }
+
+  return sk;
+
+fail:
+  mutt_sort_keys_free(&sk);
+  return NULL;
+}
+
+/**
+ * mutt_sort_keys_free - Free the sort keys
+ * @param[out] ptr SortKeys to free
+ */
+void mutt_sort_keys_free(struct SortKeys **ptr)
+{
+  if (!ptr || !*ptr)
+    return;
+
+  struct SortKeys *sk = *ptr;
+  FREE(&sk->keys);
+  FREE(&sk->emails);
+  FREE(&sk->strings);
+  FREE(ptr);
+}
+
+/**
+ * mutt_sort_keys_cmp - Compare two Emails by their sort keys
+ * @param sk Sort keys, from mutt_sort_keys_new()
+ * @param a  First Email
+ * @param b  Second Email
+ * @retval <0 a precedes b
+ * @retval  0 a and b are identical
+ * @retval >0 b precedes a
+ */
+int mutt_sort_keys_cmp(const struct SortKeys *sk, const struct Email *a, const struct Email *b)
+{
+  return sort_key_cmp(sk, a->index, b->index);
+}
+
+/**
+ * sort_by_keys - Sort the Emails using precomputed keys
+ * @param m          Mailbox
+ * @param c_sort     Primary sort method, $sort
+ * @param c_sort_aux Secondary sort method, $sort_aux
+ * @retval true  The Emails were sorted
+ * @retval false The sort methods need the full Emails
+ *
+ * Deriving a key, e.g. the sender's name, can be much slower than comparing
+ * it.  The keys are worked out once, then the sort only compares them, so it
+ * can be split between several threads.
+ */
+static bool sort_by_keys(struct Mailbox *m, short c_sort, short c_sort_aux)
+{
+  struct SortKeys *sk = mutt_sort_keys_new(m, c_sort, c_sort_aux);
+  if (!sk)
+    return false;
+
+  const size_t count = sk->count;
+  int *order = mutt_mem_malloc(count * sizeof(int));
+  for (size_t i = 0; i < count; i++)
+    order[i] = m->emails[i]->index;
+
+  const short c_sort_threads = cs_subset_number(NeoMutt->sub, "sort_threads");
+  mutt_merge_sort(order, count, sizeof(int), compare_key_index, sk, c_sort_threads);
+
+  for (size_t i = 0; i < count; i++)
+    m->emails[i] = sk->emails[order[i]];
+
+  FREE(&order);
+  mutt_sort_keys_free(&sk);
+  return true;
+}
+
 /**
  * mutt_get_sort_func - Get the sort function for a given sort id
  * @param method Sort type, see #SortType
@@ -408,7 +767,7 @@ void mutt_sort_headers(struct Mailbox *m, struct ThreadsContext *threads,
       struct Email *e = m->emails[i];
       if (!e)
         break;
-      mutt_score_message(m, e, true);
+      mutt_rescore_message(m, e);
     }
   }
   OptNeedRescore = false;
@@ -434,9 +793,10 @@ void mutt_sort_headers(struct Mailbox *m, struct ThreadsContext *threads,
       cs_subset_str_native_set(NeoMutt->sub, "sort", c_sort_aux, NULL);
       mutt_sort_subthreads(threads, true);
       cs_subset_str_native_set(NeoMutt->sub, "sort", c_sort, NULL);
-      OptSortSubthreads = false;
     }
+    /* the top-level threads are out of order until this has finished */
     mutt_sort_threads(threads, init);
+    OptSortSubthreads = false;
   }
   else if (!(sortfunc = mutt_get_sort_func(c_sort & SORT_MASK, mx_type(m))) ||
            !(AuxSort = mutt_get_sort_func(c_sort_aux & SORT_MASK, mx_type(m))))
@@ -444,7 +804,7 @@ void mutt_sort_headers(struct Mailbox *m, struct ThreadsContext *threads,
     mutt_error(_("Could not find sorting function [report this bug]"));
     return;
   }
-  else
+  else if (!sort_by_keys(m, c_sort, c_sort_aux))
   {
     qsort((void *) m->emails, m->msg_count, sizeof(struct Email *), sortfunc);
   }
@@ -464,6 +824,9 @@ void mutt_sort_headers(struct Mailbox *m, struct ThreadsContext *threads,
       m->vcount++;
     }
     e_cur->msgno = i;
+    /* The threads and numbers may have changed; see mutt_set_header_color() */
+    e_cur->pair_stale |= PAT_DEP_THREAD;
+    e_cur->score_stale |= PAT_DEP_THREAD;
   }
 
   /* re-collapse threads marked as collapsed */
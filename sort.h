@@ -31,7 +31,9 @@
 #include "options.h" // IWYU pragma: keep
 
 struct Address;
+struct Email;
 struct Mailbox;
+struct SortKeys;
 struct ThreadsContext;
 
 /**
@@ -51,6 +53,10 @@ int perform_auxsort(int retval, const void *a, const void *b);
 
 const char *mutt_get_name(const struct Address *a);
 
+struct SortKeys *mutt_sort_keys_new (struct Mailbox *m, short sort, short sort_aux);
+int              mutt_sort_keys_cmp (const struct SortKeys *sk, const struct Email *a, const struct Email *b);
+void             mutt_sort_keys_free(struct SortKeys **ptr);
+
 int sort_code(int rc);
 
 #endif /* MUTT_SORT_H */
@@ -123,6 +123,33 @@ static int store_gdbm_delete_record(void *store, const char *key, size_t klen)
   return gdbm_delete(db, dkey);
 }
 
+/**
+ * store_gdbm_begin - Implements StoreOps::begin()
+ *
+ * GDBM doesn't have transactions.  The writes are already unsynchronised, so
+ * there's nothing to do until the commit.
+ */
+static int store_gdbm_begin(void *store)
+{
+  if (!store)
+    return -1;
+
+  return 0;
+}
+
+/**
+ * store_gdbm_commit - Implements StoreOps::commit()
+ */
+static int store_gdbm_commit(void *store)
+{
+  if (!store)
+    return -1;
+
+  GDBM_FILE db = store;
+  gdbm_sync(db);
+  return 0;
+}
+
 /**
  * store_gdbm_close - Implements StoreOps::close()
  */
@@ -144,4 +171,4 @@ static const char *store_gdbm_version(void)
   return gdbm_version;
 }
 
-STORE_BACKEND_OPS(gdbm)
+STORE_BACKEND_OPS_TXN(gdbm)
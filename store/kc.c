@@ -124,6 +124,43 @@ static int store_kyotocabinet_delete_record(void *store, const char *key, size_t
   return 0;
 }
 
+/**
+ * store_kyotocabinet_begin - Implements StoreOps::begin()
+ */
+static int store_kyotocabinet_begin(void *store)
+{
+  if (!store)
+    return -1;
+
+  KCDB *db = store;
+  /* A "soft" transaction: don't sync to the device on commit */
+  if (!kcdbbegintran(db, 0))
+  {
+    int ecode = kcdbecode(db);
+    mutt_debug(LL_DEBUG2, "kcdbbegintran failed: %s (ecode %d)\n", kcdbemsg(db), ecode);
+    return ecode ? ecode : -1;
+  }
+  return 0;
+}
+
+/**
+ * store_kyotocabinet_commit - Implements StoreOps::commit()
+ */
+static int store_kyotocabinet_commit(void *store)
+{
+  if (!store)
+    return -1;
+
+  KCDB *db = store;
+  if (!kcdbendtran(db, 1))
+  {
+    int ecode = kcdbecode(db);
+    mutt_debug(LL_DEBUG2, "kcdbendtran failed: %s (ecode %d)\n", kcdbemsg(db), ecode);
+    return ecode ? ecode : -1;
+  }
+  return 0;
+}
+
 /**
  * store_kyotocabinet_close - Implements StoreOps::close()
  */
@@ -154,4 +191,4 @@ static const char *store_kyotocabinet_version(void)
   return version_cache;
 }
 
-STORE_BACKEND_OPS(kyotocabinet)
+STORE_BACKEND_OPS_TXN(kyotocabinet)
@@ -33,6 +33,10 @@
  *
  * Each Store backend implements the StoreOps API.
  *
+ * Backends that support transactions also implement StoreOps::begin() and
+ * StoreOps::commit().  These allow many writes to be grouped together, which
+ * is much faster than committing each one separately.
+ *
  * ## Source
  *
  * @subpage store_store
@@ -114,6 +118,28 @@ struct StoreOps
    */
   int (*delete_record)(void *store, const char *key, size_t klen);
 
+  /**
+   * begin - Start a transaction (OPTIONAL)
+   * @param[in] store Store retrieved via open()
+   * @retval 0   Success
+   * @retval num Error, a backend-specific error code
+   *
+   * All the writes, until commit() is called, will be grouped together.
+   * Transactions don't nest.  Backends that don't support transactions will
+   * leave this NULL.
+   */
+  int (*begin)(void *store);
+
+  /**
+   * commit - Commit a transaction (OPTIONAL)
+   * @param[in] store Store retrieved via open()
+   * @retval 0   Success
+   * @retval num Error, a backend-specific error code
+   *
+   * Write all the changes made since begin().
+   */
+  int (*commit)(void *store);
+
   /**
    * close - Close a Store connection
    * @param[in,out] ptr Store retrieved via open()
@@ -143,4 +169,18 @@ bool                   store_is_valid_backend(const char *str);
     .version        = store_##_name##_version,                                 \
   };
 
+#define STORE_BACKEND_OPS_TXN(_name)                                           \
+  const struct StoreOps store_##_name##_ops = {                                \
+    .name           = #_name,                                                  \
+    .open           = store_##_name##_open,                                    \
+    .fetch          = store_##_name##_fetch,                                   \
+    .free           = store_##_name##_free,                                    \
+    .store          = store_##_name##_store,                                   \
+    .delete_record  = store_##_name##_delete_record,                           \
+    .begin          = store_##_name##_begin,                                   \
+    .commit         = store_##_name##_commit,                                  \
+    .close          = store_##_name##_close,                                   \
+    .version        = store_##_name##_version,                                 \
+  };
+
 #endif /* MUTT_STORE_LIB_H */
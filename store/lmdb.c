@@ -287,6 +287,46 @@ static int store_lmdb_delete_record(void *store, const char *key, size_t klen)
   return rc;
 }
 
+/**
+ * store_lmdb_begin - Implements StoreOps::begin()
+ */
+static int store_lmdb_begin(void *store)
+{
+  if (!store)
+    return -1;
+
+  struct StoreLmdbCtx *ctx = store;
+
+  int rc = mdb_get_w_txn(ctx);
+  if (rc != MDB_SUCCESS)
+    mutt_debug(LL_DEBUG2, "mdb_get_w_txn: %s\n", mdb_strerror(rc));
+
+  return rc;
+}
+
+/**
+ * store_lmdb_commit - Implements StoreOps::commit()
+ */
+static int store_lmdb_commit(void *store)
+{
+  if (!store)
+    return -1;
+
+  struct StoreLmdbCtx *ctx = store;
+
+  if (!ctx->txn || (ctx->txn_mode != TXN_WRITE))
+    return MDB_SUCCESS;
+
+  /* The transaction handle is freed, whether or not the commit succeeds */
+  int rc = mdb_txn_commit(ctx->txn);
+  if (rc != MDB_SUCCESS)
+    mutt_debug(LL_DEBUG2, "mdb_txn_commit: %s\n", mdb_strerror(rc));
+
+  ctx->txn_mode = TXN_UNINITIALIZED;
+  ctx->txn = NULL;
+  return rc;
+}
+
 /**
  * store_lmdb_close - Implements StoreOps::close()
  */
@@ -320,4 +360,4 @@ static const char *store_lmdb_version(void)
   return "lmdb " MDB_VERSION_STRING;
 }
 
-STORE_BACKEND_OPS(lmdb)
+STORE_BACKEND_OPS_TXN(lmdb)
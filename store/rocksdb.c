@@ -42,9 +42,34 @@ struct RocksDbCtx
   rocksdb_options_t *options;
   rocksdb_readoptions_t *read_options;
   rocksdb_writeoptions_t *write_options;
+  rocksdb_writebatch_t *batch; ///< Pending writes, between begin() and commit()
   char *err;
 };
 
+/**
+ * rocksdb_write_batch - Write any pending changes to the database
+ * @param ctx RocksDB context
+ * @retval  0 Success
+ * @retval -1 Error
+ */
+static int rocksdb_write_batch(struct RocksDbCtx *ctx)
+{
+  if (!ctx->batch || (rocksdb_writebatch_count(ctx->batch) == 0))
+    return 0;
+
+  rocksdb_write(ctx->db, ctx->write_options, ctx->batch, &ctx->err);
+  rocksdb_writebatch_clear(ctx->batch);
+  if (ctx->err)
+  {
+    mutt_debug(LL_DEBUG2, "rocksdb_write: %s\n", ctx->err);
+    rocksdb_free(ctx->err);
+    ctx->err = NULL;
+    return -1;
+  }
+
+  return 0;
+}
+
 /**
  * store_rocksdb_open - Implements StoreOps::open()
  */
@@ -53,10 +78,7 @@ static void *store_rocksdb_open(const char *path)
   if (!path)
     return NULL;
 
-  struct RocksDbCtx *ctx = mutt_mem_malloc(sizeof(struct RocksDbCtx));
-
-  /* RocksDB store errors in form of strings */
-  ctx->err = NULL;
+  struct RocksDbCtx *ctx = mutt_mem_calloc(1, sizeof(struct RocksDbCtx));
 
   /* setup generic options, create new db and limit log to one file */
   ctx->options = rocksdb_options_create();
@@ -96,6 +118,9 @@ static void *store_rocksdb_fetch(void *store, const char *key, size_t klen, size
 
   struct RocksDbCtx *ctx = store;
 
+  /* Reads don't see the batch, so flush it first */
+  rocksdb_write_batch(ctx);
+
   void *rv = rocksdb_get(ctx->db, ctx->read_options, key, klen, vlen, &ctx->err);
   if (ctx->err)
   {
@@ -126,6 +151,12 @@ static int store_rocksdb_store(void *store, const char *key, size_t klen,
 
   struct RocksDbCtx *ctx = store;
 
+  if (ctx->batch)
+  {
+    rocksdb_writebatch_put(ctx->batch, key, klen, value, vlen);
+    return 0;
+  }
+
   rocksdb_put(ctx->db, ctx->write_options, key, klen, value, vlen, &ctx->err);
   if (ctx->err)
   {
@@ -147,6 +178,12 @@ static int store_rocksdb_delete_record(void *store, const char *key, size_t klen
 
   struct RocksDbCtx *ctx = store;
 
+  if (ctx->batch)
+  {
+    rocksdb_writebatch_delete(ctx->batch, key, klen);
+    return 0;
+  }
+
   rocksdb_delete(ctx->db, ctx->write_options, key, klen, &ctx->err);
   if (ctx->err)
   {
@@ -158,6 +195,42 @@ static int store_rocksdb_delete_record(void *store, const char *key, size_t klen
   return 0;
 }
 
+/**
+ * store_rocksdb_begin - Implements StoreOps::begin()
+ */
+static int store_rocksdb_begin(void *store)
+{
+  if (!store)
+    return -1;
+
+  struct RocksDbCtx *ctx = store;
+
+  if (!ctx->batch)
+    ctx->batch = rocksdb_writebatch_create();
+
+  return 0;
+}
+
+/**
+ * store_rocksdb_commit - Implements StoreOps::commit()
+ */
+static int store_rocksdb_commit(void *store)
+{
+  if (!store)
+    return -1;
+
+  struct RocksDbCtx *ctx = store;
+
+  int rc = rocksdb_write_batch(ctx);
+  if (ctx->batch)
+  {
+    rocksdb_writebatch_destroy(ctx->batch);
+    ctx->batch = NULL;
+  }
+
+  return rc;
+}
+
 /**
  * store_rocksdb_close - Implements StoreOps::close()
  */
@@ -168,6 +241,9 @@ static void store_rocksdb_close(void **ptr)
 
   struct RocksDbCtx *ctx = *ptr;
 
+  /* don't lose any pending writes */
+  store_rocksdb_commit(ctx);
+
   /* close database and free resources */
   rocksdb_close(ctx->db);
   rocksdb_options_destroy(ctx->options);
@@ -188,4 +264,4 @@ static const char *store_rocksdb_version(void)
   return "RocksDB " RDBVER(ROCKSDB_MAJOR, ROCKSDB_MINOR, ROCKSDB_PATCH);
 }
 
-STORE_BACKEND_OPS(rocksdb)
+STORE_BACKEND_OPS_TXN(rocksdb)
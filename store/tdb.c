@@ -117,6 +117,30 @@ static int store_tdb_delete_record(void *store, const char *key, size_t klen)
   return tdb_delete(db, dkey);
 }
 
+/**
+ * store_tdb_begin - Implements StoreOps::begin()
+ */
+static int store_tdb_begin(void *store)
+{
+  if (!store)
+    return -1;
+
+  TDB_CONTEXT *db = store;
+  return tdb_transaction_start(db);
+}
+
+/**
+ * store_tdb_commit - Implements StoreOps::commit()
+ */
+static int store_tdb_commit(void *store)
+{
+  if (!store)
+    return -1;
+
+  TDB_CONTEXT *db = store;
+  return tdb_transaction_commit(db);
+}
+
 /**
  * store_tdb_close - Implements StoreOps::close()
  */
@@ -139,4 +163,4 @@ static const char *store_tdb_version(void)
   return "tdb";
 }
 
-STORE_BACKEND_OPS(tdb)
+STORE_BACKEND_OPS_TXN(tdb)
@@ -140,6 +140,37 @@ void test_config_helpers(void)
   TEST_CHECK(cs_subset_sort(sub, "Mango") == 1);
   TEST_CHECK(mutt_str_equal(cs_subset_string(sub, "Nectarine"), "nectarine"));
 
+  {
+    struct ConfigHandle ch_apple = CONFIG_HANDLE("Apple");
+    struct ConfigHandle ch_cherry = CONFIG_HANDLE("Cherry");
+    struct ConfigHandle ch_mango = CONFIG_HANDLE("Mango");
+    struct ConfigHandle ch_nectarine = CONFIG_HANDLE("Nectarine");
+
+    TEST_CHECK(cs_handle_bool(sub, &ch_apple) == false);
+    TEST_CHECK(cs_handle_number(sub, &ch_cherry) == 0);
+    TEST_CHECK(cs_handle_sort(sub, &ch_mango) == 1);
+    TEST_CHECK(mutt_str_equal(cs_handle_string(sub, &ch_nectarine), "nectarine"));
+
+    /* Changes are seen through the handle */
+    struct HashElem *he = ch_cherry.he;
+    cs_subset_str_native_set(sub, "Cherry", 42, NULL);
+    TEST_CHECK(cs_handle_number(sub, &ch_cherry) == 42);
+    TEST_CHECK(ch_cherry.he == he);
+
+    /* A child Subset resolves its own, inherited, config item */
+    struct ConfigSubset *child = cs_subset_new("child", sub, NULL);
+    TEST_CHECK(cs_handle_bool(child, &ch_apple) == false);
+    TEST_CHECK(cs_subset_str_native_set(child, "Apple", true, NULL) == CSR_SUCCESS);
+    TEST_CHECK(cs_handle_bool(child, &ch_apple) == true);
+    TEST_CHECK(cs_handle_bool(sub, &ch_apple) == false);
+    TEST_CHECK(cs_handle_number(child, &ch_cherry) == 42);
+
+    /* Removing the inherited item invalidates the handle */
+    cs_uninherit_variable(cs, "child:Apple");
+    TEST_CHECK(cs_handle_bool(child, &ch_apple) == false);
+    cs_subset_free(&child);
+  }
+
   neomutt_free(&NeoMutt);
   cs_subset_free(&sub);
   cs_free(&cs);
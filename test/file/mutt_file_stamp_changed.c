@@ -0,0 +1,64 @@
+/**
+ * @file
+ * Test code for mutt_file_stamp_changed()
+ *
+ * @authors
+ * Copyright (C) 2021 Richard Russon <rich@flatcap.org>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "mutt/lib.h"
+
+void test_mutt_file_stamp_changed(void)
+{
+  // bool mutt_file_stamp_changed(const char *path, struct FileStamp *stamp);
+
+  {
+    struct FileStamp stamp = { 0 };
+    TEST_CHECK(!mutt_file_stamp_changed(NULL, &stamp));
+    TEST_CHECK(!mutt_file_stamp_changed("apple", NULL));
+  }
+
+  {
+    struct FileStamp stamp = { 0 };
+    TEST_CHECK(!mutt_file_stamp_changed("/does/not/exist", &stamp));
+  }
+
+  {
+    char path[] = "/tmp/neomutt-stamp-XXXXXX";
+    int fd = mkstemp(path);
+    if (!TEST_CHECK(fd >= 0))
+      return;
+
+    struct FileStamp stamp = { 0 };
+    TEST_CHECK(mutt_file_stamp_changed(path, &stamp));  // created
+    TEST_CHECK(!mutt_file_stamp_changed(path, &stamp)); // unchanged
+
+    TEST_CHECK(write(fd, "x", 1) == 1);
+    close(fd);
+    TEST_CHECK(mutt_file_stamp_changed(path, &stamp)); // modified
+
+    unlink(path);
+    TEST_CHECK(mutt_file_stamp_changed(path, &stamp)); // deleted
+    TEST_CHECK(!mutt_file_stamp_changed(path, &stamp));
+  }
+}
@@ -0,0 +1,113 @@
+/**
+ * @file
+ * Microbenchmark for the Hash Table
+ *
+ * @authors
+ * Copyright (C) 2021 Richard Russon <rich@flatcap.org>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include <stdio.h>
+#include <time.h>
+#include "mutt/lib.h"
+
+#define BENCH_KEYS 100000
+
+/**
+ * elapsed_ms - Milliseconds since a start time
+ * @param start Start time
+ * @retval num Elapsed time
+ */
+static double elapsed_ms(const struct timespec *start)
+{
+  struct timespec now = { 0 };
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return ((now.tv_sec - start->tv_sec) * 1000.0) +
+         ((now.tv_nsec - start->tv_nsec) / 1000000.0);
+}
+
+void test_mutt_hash_benchmark(void)
+{
+  // Like a Message-ID hash: the table is sized for a few keys, then grows
+
+  char **keys = mutt_mem_calloc(BENCH_KEYS, sizeof(char *));
+  char buf[128];
+  for (int i = 0; i < BENCH_KEYS; i++)
+  {
+    snprintf(buf, sizeof(buf), "<%08x.%d.neomutt@example.com>", i * 2654435761U, i);
+    keys[i] = mutt_str_dup(buf);
+  }
+
+  struct timespec start = { 0 };
+
+  {
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    struct HashTable *table = mutt_hash_new(16, MUTT_HASH_NO_FLAGS);
+    for (int i = 0; i < BENCH_KEYS; i++)
+      mutt_hash_insert(table, keys[i], keys[i]);
+    const double t_insert = elapsed_ms(&start);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    size_t found = 0;
+    for (int round = 0; round < 10; round++)
+      for (int i = 0; i < BENCH_KEYS; i++)
+        found += (mutt_hash_find(table, keys[i]) == keys[i]);
+    const double t_find = elapsed_ms(&start);
+    TEST_CHECK(found == (BENCH_KEYS * 10));
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    size_t missed = 0;
+    for (int i = 0; i < BENCH_KEYS; i++)
+    {
+      snprintf(buf, sizeof(buf), "%s-missing", keys[i]);
+      missed += !mutt_hash_find(table, buf);
+    }
+    const double t_miss = elapsed_ms(&start);
+    TEST_CHECK(missed == BENCH_KEYS);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < BENCH_KEYS; i++)
+      mutt_hash_delete(table, keys[i], NULL);
+    const double t_delete = elapsed_ms(&start);
+    TEST_CHECK(!mutt_hash_find(table, keys[0]));
+
+    mutt_hash_free(&table);
+    TEST_CHECK_(1, "string: insert %.1fms, find %.1fms, miss %.1fms, delete %.1fms",
+                t_insert, t_find, t_miss, t_delete);
+  }
+
+  {
+    // Like an IMAP UID hash
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    struct HashTable *table = mutt_hash_int_new(16, MUTT_HASH_NO_FLAGS);
+    for (unsigned int i = 0; i < BENCH_KEYS; i++)
+      mutt_hash_int_insert(table, i + 1, keys[i]);
+    size_t found = 0;
+    for (unsigned int i = 0; i < BENCH_KEYS; i++)
+      found += (mutt_hash_int_find(table, i + 1) == keys[i]);
+    const double t_int = elapsed_ms(&start);
+    TEST_CHECK(found == BENCH_KEYS);
+    mutt_hash_free(&table);
+    TEST_CHECK_(1, "int: insert+find %.1fms", t_int);
+  }
+
+  for (int i = 0; i < BENCH_KEYS; i++)
+    FREE(&keys[i]);
+  FREE(&keys);
+}
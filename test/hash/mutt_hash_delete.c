@@ -60,4 +60,28 @@ void test_mutt_hash_delete(void)
     mutt_hash_delete(table, "banana", NULL);
     mutt_hash_free(&table);
   }
+
+  {
+    // Deleting must leave the other keys findable, after the table has grown
+    struct HashTable *table = mutt_hash_new(4, MUTT_HASH_STRDUP_KEYS);
+    char buf[32];
+    for (int i = 0; i < 1000; i++)
+    {
+      snprintf(buf, sizeof(buf), "key%d", i);
+      mutt_hash_insert(table, buf, &dummy1);
+    }
+    for (int i = 0; i < 1000; i += 2)
+    {
+      snprintf(buf, sizeof(buf), "key%d", i);
+      mutt_hash_delete(table, buf, NULL);
+    }
+    for (int i = 0; i < 1000; i++)
+    {
+      snprintf(buf, sizeof(buf), "key%d", i);
+      void *data = mutt_hash_find(table, buf);
+      if (!TEST_CHECK((data != NULL) == ((i % 2) == 1)))
+        TEST_MSG("Key: %s", buf);
+    }
+    mutt_hash_free(&table);
+  }
 }
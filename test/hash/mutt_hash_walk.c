@@ -38,4 +38,24 @@ void test_mutt_hash_walk(void)
     struct HashTable table = { 0 };
     TEST_CHECK(!mutt_hash_walk(&table, NULL));
   }
+
+  {
+    // Every element is visited once, including duplicates
+    int dummy = 42;
+    struct HashTable *table = mutt_hash_int_new(2, MUTT_HASH_ALLOW_DUPS);
+    for (unsigned int i = 0; i < 500; i++)
+    {
+      mutt_hash_int_insert(table, i, &dummy);
+      if ((i % 10) == 0)
+        mutt_hash_int_insert(table, i, &dummy);
+    }
+
+    struct HashWalkState walkstate = { 0 };
+    size_t count = 0;
+    while (mutt_hash_walk(table, &walkstate))
+      count++;
+    TEST_CHECK(count == 550);
+    TEST_MSG("Expected: 550, Actual: %zu", count);
+    mutt_hash_free(&table);
+  }
 }
@@ -0,0 +1,83 @@
+/**
+ * @file
+ * Test code for mailbox_columns_new()
+ *
+ * @authors
+ * Copyright (C) 2020 Richard Russon <rich@flatcap.org>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include "mutt/lib.h"
+#include "email/lib.h"
+#include "core/lib.h"
+
+void test_mailbox_columns_new(void)
+{
+  // struct MailboxColumns *mailbox_columns_new(struct Mailbox *m);
+
+  {
+    struct MailboxColumns *mc = mailbox_columns_new(NULL);
+    TEST_CHECK(mc != NULL);
+    TEST_CHECK(mc->count == 0);
+    mailbox_columns_free(&mc);
+    TEST_CHECK(mc == NULL);
+    mailbox_columns_free(NULL);
+  }
+
+  {
+    struct Mailbox *m = mailbox_new();
+    for (int i = 0; i < 3; i++)
+    {
+      struct Email *e = email_new();
+      e->body = mutt_body_new();
+      e->body->length = 100 * i;
+      e->date_sent = 1000 + i;
+      e->received = 2000 + i;
+      e->score = -i;
+      e->index = i;
+      m->emails[i] = e;
+      m->msg_count++;
+    }
+    m->emails[0]->read = true;
+    m->emails[1]->old = true;
+    m->emails[1]->flagged = true;
+    m->emails[2]->deleted = true;
+    m->emails[2]->tagged = true;
+
+    struct MailboxColumns *mc = mailbox_columns_new(m);
+    TEST_CHECK(mc->count == 3);
+    TEST_CHECK(mc->flags[0] == EMAIL_COL_READ);
+    TEST_CHECK(mc->flags[1] == (EMAIL_COL_OLD | EMAIL_COL_FLAGGED));
+    TEST_CHECK(mc->flags[2] == (EMAIL_COL_DELETED | EMAIL_COL_TAGGED));
+    TEST_CHECK(mc->date_sent[2] == 1002);
+    TEST_CHECK(mc->received[1] == 2001);
+    TEST_CHECK(mc->size[2] == 200);
+    TEST_CHECK(mc->score[2] == -2);
+    TEST_CHECK(mc->index[1] == 1);
+    mailbox_columns_free(&mc);
+
+    // The columns stop at the first missing Email
+    email_free(&m->emails[1]);
+    mc = mailbox_columns_new(m);
+    TEST_CHECK(mc->count == 1);
+    mailbox_columns_free(&mc);
+
+    mailbox_free(&m);
+  }
+}
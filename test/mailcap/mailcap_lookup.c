@@ -0,0 +1,138 @@
+/**
+ * @file
+ * Test code for mailcap_lookup()
+ *
+ * @authors
+ * Copyright (C) 2021 Richard Russon <rich@flatcap.org>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include <limits.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <unistd.h>
+#include "mutt/lib.h"
+#include "config/lib.h"
+#include "email/lib.h"
+#include "core/lib.h"
+#include "mailcap.h"
+#include "test_common.h"
+
+static struct ConfigDef Vars[] = {
+  // clang-format off
+  { "mailcap_path",     DT_SLIST|SLIST_SEP_COLON, 0,    0, NULL, },
+  { "mailcap_sanitize", DT_BOOL,                  true, 0, NULL, },
+  { NULL },
+  // clang-format on
+};
+
+/**
+ * struct MailcapTest - A mailcap lookup and its expected result
+ */
+struct MailcapTest
+{
+  const char *mailcap;    ///< Contents of the mailcap file
+  const char *type;       ///< Type to look up
+  enum MailcapLookup opt; ///< Type of entry to look up
+  const char *command;    ///< Expected command, or NULL if there's no match
+};
+
+/* The entries for "text/plain", "text" and "text/\*" are interleaved.
+ * Whichever matches first, in file order, must win. */
+static const struct MailcapTest MailcapTests[] = {
+  // clang-format off
+  { "text/*; wild1\ntext/plain; exact1\ntext; base1\ntext/plain; exact2\n",
+    "text/plain", MUTT_MC_NO_FLAGS, "wild1" },
+  { "text; base1\ntext/*; wild1\ntext/plain; exact1\n",
+    "text/plain", MUTT_MC_NO_FLAGS, "base1" },
+  { "# comment\nimage/png; png1\ntext/plain; exact1\ntext; base1\ntext/*; wild1\n",
+    "text/plain", MUTT_MC_NO_FLAGS, "exact1" },
+  { "text/plain; exact1\ntext/*; wild1\ntext; base1\n",
+    "text/html", MUTT_MC_NO_FLAGS, "wild1" },
+  { "TEXT/Plain; upper1\ntext/plain; exact1\n",
+    "text/plain", MUTT_MC_NO_FLAGS, "upper1" },
+
+  /* A failed test moves on to the next entry of any of the three types */
+  { "text/plain; exact1; test=false\ntext; base1; test=false\n"
+    "text/*; wild1\ntext/plain; exact2\ntext; base2\n",
+    "text/plain", MUTT_MC_NO_FLAGS, "wild1" },
+  { "text/*; wild1; test=false\ntext/plain; exact1; test=true\n"
+    "text; base1\n",
+    "text/plain", MUTT_MC_NO_FLAGS, "exact1" },
+  { "text/plain; exact1; test=false\ntext/*; wild1; test=false\n"
+    "text/plain; exact2; test=false\ntext; base1\ntext/*; wild2\n",
+    "text/plain", MUTT_MC_NO_FLAGS, "base1" },
+  { "text/plain; exact1; test=false\ntext; base1; test=false\n"
+    "text/*; wild1; test=false\n",
+    "text/plain", MUTT_MC_NO_FLAGS, NULL },
+
+  /* Entries without the wanted field are skipped, too */
+  { "text/*; wild1\ntext; base1; copiousoutput; test=false\n"
+    "text/plain; exact1; copiousoutput\ntext/*; wild2; copiousoutput\n",
+    "text/plain", MUTT_MC_AUTOVIEW, "exact1" },
+  { "text/*; wild1\ntext; base1; copiousoutput; test=false\n"
+    "text/plain; exact1; copiousoutput\ntext/*; wild2; copiousoutput\n",
+    "text/html", MUTT_MC_AUTOVIEW, "wild2" },
+  // clang-format on
+};
+
+void test_mailcap_lookup(void)
+{
+  // bool mailcap_lookup(struct Body *a, char *type, size_t typelen, struct MailcapEntry *entry, enum MailcapLookup opt);
+
+  NeoMutt = test_neomutt_create();
+  TEST_CHECK(cs_register_variables(NeoMutt->sub->cs, Vars, 0));
+
+  char path[PATH_MAX];
+  snprintf(path, sizeof(path), "/tmp/neomutt-test-mailcap-%d", (int) getpid());
+  cs_subset_str_string_set(NeoMutt->sub, "mailcap_path", path, NULL);
+
+  for (size_t i = 0; i < mutt_array_size(MailcapTests); i++)
+  {
+    const struct MailcapTest *mt = &MailcapTests[i];
+    TEST_CASE_("%zu: %s", i, mt->type);
+
+    FILE *fp = fopen(path, "w");
+    if (!TEST_CHECK(fp != NULL))
+      break;
+    fputs(mt->mailcap, fp);
+    fclose(fp);
+
+    struct Body *b = mutt_body_new();
+    struct MailcapEntry *entry = mailcap_entry_new();
+    char type[256];
+    mutt_str_copy(type, mt->type, sizeof(type));
+
+    const bool found = mailcap_lookup(b, type, sizeof(type), entry, mt->opt);
+    TEST_CHECK(found == (mt->command != NULL));
+    if (!TEST_CHECK(mutt_str_equal(entry->command, mt->command)))
+    {
+      TEST_MSG("Expected: %s", NONULL(mt->command));
+      TEST_MSG("Actual:   %s", NONULL(entry->command));
+    }
+
+    mailcap_entry_free(&entry);
+    mutt_body_free(&b);
+    /* The file may change within the same second */
+    mailcap_cache_free();
+  }
+
+  unlink(path);
+  test_neomutt_destroy(&NeoMutt);
+}
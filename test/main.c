@@ -130,6 +130,7 @@
   NEOMUTT_TEST_ITEM(test_mutt_ch_get_default_charset)                          \
   NEOMUTT_TEST_ITEM(test_mutt_ch_get_langinfo_charset)                         \
   NEOMUTT_TEST_ITEM(test_mutt_ch_iconv)                                        \
+  NEOMUTT_TEST_ITEM(test_mutt_ch_iconv_close)                                  \
   NEOMUTT_TEST_ITEM(test_mutt_ch_iconv_lookup)                                 \
   NEOMUTT_TEST_ITEM(test_mutt_ch_iconv_open)                                   \
   NEOMUTT_TEST_ITEM(test_mutt_ch_lookup_add)                                   \
@@ -240,6 +241,7 @@
   NEOMUTT_TEST_ITEM(test_mutt_file_sanitize_filename)                          \
   NEOMUTT_TEST_ITEM(test_mutt_file_sanitize_regex)                             \
   NEOMUTT_TEST_ITEM(test_mutt_file_set_mtime)                                  \
+  NEOMUTT_TEST_ITEM(test_mutt_file_stamp_changed)                              \
   NEOMUTT_TEST_ITEM(test_mutt_file_stat_compare)                               \
   NEOMUTT_TEST_ITEM(test_mutt_file_stat_timespec_compare)                      \
   NEOMUTT_TEST_ITEM(test_mutt_file_symlink)                                    \
@@ -275,6 +277,7 @@
   NEOMUTT_TEST_ITEM(test_window_visible)                                       \
                                                                                \
   /* hash */                                                                   \
+  NEOMUTT_TEST_ITEM(test_mutt_hash_benchmark)                                  \
   NEOMUTT_TEST_ITEM(test_mutt_hash_delete)                                     \
   NEOMUTT_TEST_ITEM(test_mutt_hash_find)                                       \
   NEOMUTT_TEST_ITEM(test_mutt_hash_find_bucket)                                \
@@ -339,6 +342,7 @@
                                                                                \
   /* mailbox */                                                                \
   NEOMUTT_TEST_ITEM(test_mailbox_changed)                                      \
+  NEOMUTT_TEST_ITEM(test_mailbox_columns_new)                                  \
   NEOMUTT_TEST_ITEM(test_mailbox_find)                                         \
   NEOMUTT_TEST_ITEM(test_mailbox_find_name)                                    \
   NEOMUTT_TEST_ITEM(test_mailbox_free)                                         \
@@ -348,6 +352,9 @@
   NEOMUTT_TEST_ITEM(test_mailbox_size_sub)                                     \
   NEOMUTT_TEST_ITEM(test_mailbox_update)                                       \
                                                                                \
+  /* mailcap */                                                                \
+  NEOMUTT_TEST_ITEM(test_mailcap_lookup)                                       \
+                                                                               \
   /* mapping */                                                                \
   NEOMUTT_TEST_ITEM(test_mutt_map_get_name)                                    \
   NEOMUTT_TEST_ITEM(test_mutt_map_get_value)                                   \
@@ -382,6 +389,9 @@
   NEOMUTT_TEST_ITEM(test_mutt_mem_malloc)                                      \
   NEOMUTT_TEST_ITEM(test_mutt_mem_realloc)                                     \
                                                                                \
+  /* mergesort */                                                              \
+  NEOMUTT_TEST_ITEM(test_mutt_merge_sort)                                      \
+                                                                               \
   /* neomutt */                                                                \
   NEOMUTT_TEST_ITEM(test_neomutt_account_add)                                  \
   NEOMUTT_TEST_ITEM(test_neomutt_account_remove)                               \
@@ -422,6 +432,7 @@
   NEOMUTT_TEST_ITEM(test_mutt_rfc822_parse_line)                               \
   NEOMUTT_TEST_ITEM(test_mutt_rfc822_parse_message)                            \
   NEOMUTT_TEST_ITEM(test_mutt_rfc822_read_header)                              \
+  NEOMUTT_TEST_ITEM(test_mutt_rfc822_read_header_mem)                          \
   NEOMUTT_TEST_ITEM(test_mutt_rfc822_read_line)                                \
                                                                                \
   /* path */                                                                   \
@@ -443,6 +454,7 @@
                                                                                \
   /* pattern */                                                                \
   NEOMUTT_TEST_ITEM(test_mutt_pattern_comp)                                    \
+  NEOMUTT_TEST_ITEM(test_pattern_search)                                       \
                                                                                \
   /* prex */                                                                   \
   NEOMUTT_TEST_ITEM(test_mutt_prex_capture)                                    \
@@ -478,6 +490,9 @@
   NEOMUTT_TEST_ITEM(test_rfc2231_decode_parameters)                            \
   NEOMUTT_TEST_ITEM(test_rfc2231_encode_string)                                \
                                                                                \
+  /* score */                                                                  \
+  NEOMUTT_TEST_ITEM(test_mutt_rescore_message)                                 \
+                                                                               \
   /* signal */                                                                 \
   NEOMUTT_TEST_ITEM(test_mutt_sig_allow_interrupt)                             \
   NEOMUTT_TEST_ITEM(test_mutt_sig_block)                                       \
@@ -488,6 +503,11 @@
   NEOMUTT_TEST_ITEM(test_mutt_sig_unblock)                                     \
   NEOMUTT_TEST_ITEM(test_mutt_sig_unblock_system)                              \
                                                                                \
+  /* slab */                                                                   \
+  NEOMUTT_TEST_ITEM(test_mutt_slab_alloc)                                      \
+  NEOMUTT_TEST_ITEM(test_mutt_slab_free)                                       \
+  NEOMUTT_TEST_ITEM(test_mutt_slab_release)                                    \
+                                                                               \
   /* slist */                                                                  \
   NEOMUTT_TEST_ITEM(test_slist_add_list)                                       \
   NEOMUTT_TEST_ITEM(test_slist_add_string)                                     \
@@ -557,6 +577,8 @@
   NEOMUTT_TEST_ITEM(test_insert_message)                                       \
   NEOMUTT_TEST_ITEM(test_is_descendant)                                        \
   NEOMUTT_TEST_ITEM(test_mutt_break_thread)                                    \
+  NEOMUTT_TEST_ITEM(test_mutt_sort_headers)                                    \
+  NEOMUTT_TEST_ITEM(test_mutt_sort_threads)                                    \
   NEOMUTT_TEST_ITEM(test_thread_hash_destructor)                               \
   NEOMUTT_TEST_ITEM(test_unlink_message)                                       \
                                                                                \
@@ -567,7 +589,11 @@
   NEOMUTT_TEST_ITEM(test_url_pct_decode)                                       \
   NEOMUTT_TEST_ITEM(test_url_pct_encode)                                       \
   NEOMUTT_TEST_ITEM(test_url_tobuffer)                                         \
-  NEOMUTT_TEST_ITEM(test_url_tostring)
+  NEOMUTT_TEST_ITEM(test_url_tostring)                                         \
+                                                                               \
+  /* worker */                                                                 \
+  NEOMUTT_TEST_ITEM(test_mutt_worker_new)                                      \
+  NEOMUTT_TEST_ITEM(test_mutt_worker_wait)
 
 /******************************************************************************
  * You probably don't need to touch what follows.
@@ -581,6 +607,9 @@ NEOMUTT_TEST_LIST
 #ifdef USE_LZ4
   NEOMUTT_TEST_ITEM(test_compress_lz4)
 #endif
+#ifdef USE_HCACHE
+  NEOMUTT_TEST_ITEM(test_body_index)
+#endif
 #ifdef USE_NOTMUCH
   NEOMUTT_TEST_ITEM(test_nm_parse_type_from_query)
   NEOMUTT_TEST_ITEM(test_nm_query_type_to_string)
@@ -631,6 +660,9 @@ NEOMUTT_TEST_ITEM(test_compress_common)
 #ifdef USE_LZ4
   NEOMUTT_TEST_ITEM(test_compress_lz4)
 #endif
+#ifdef USE_HCACHE
+  NEOMUTT_TEST_ITEM(test_body_index)
+#endif
 #ifdef USE_NOTMUCH
   NEOMUTT_TEST_ITEM(test_nm_parse_type_from_query)
   NEOMUTT_TEST_ITEM(test_nm_query_type_to_string)
@@ -0,0 +1,119 @@
+/**
+ * @file
+ * Test code for mutt_merge_sort()
+ *
+ * @authors
+ * Copyright (C) 2021 Richard Russon <rich@flatcap.org>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include "mutt/lib.h"
+
+struct Item
+{
+  int key; ///< Sort key
+  int pos; ///< Original position
+};
+
+static int compare_items(const void *a, const void *b, void *sdata)
+{
+  const struct Item *ia = a;
+  const struct Item *ib = b;
+  return (ia->key > ib->key) - (ia->key < ib->key);
+}
+
+static int compare_count(const void *a, const void *b, void *sdata)
+{
+  int *calls = sdata;
+  (*calls)++;
+  return 0;
+}
+
+static int compare_ints(const void *a, const void *b, void *sdata)
+{
+  return *(const int *) a - *(const int *) b;
+}
+
+static bool check_items(const struct Item *items, size_t num)
+{
+  for (size_t i = 1; i < num; i++)
+  {
+    if (items[i - 1].key > items[i].key)
+      return false;
+    /* equal keys keep their original order */
+    if ((items[i - 1].key == items[i].key) && (items[i - 1].pos > items[i].pos))
+      return false;
+  }
+  return true;
+}
+
+void test_mutt_merge_sort(void)
+{
+  // void mutt_merge_sort(void *base, size_t num, size_t size, merge_cmp_t cmp, void *sdata, int threads);
+
+  {
+    int calls = 0;
+    mutt_merge_sort(NULL, 10, sizeof(struct Item), compare_count, &calls, 1);
+    TEST_CHECK(calls == 0);
+  }
+
+  {
+    int calls = 0;
+    struct Item item = { 1, 0 };
+    mutt_merge_sort(&item, 1, sizeof(struct Item), compare_count, &calls, 1);
+    TEST_CHECK(calls == 0);
+  }
+
+  {
+    int nums[] = { 5, 3, 9, 1, 7, 3, 0, 8, 2, 6, 4 };
+    mutt_merge_sort(nums, mutt_array_size(nums), sizeof(int), compare_ints, NULL, 1);
+    bool ok = true;
+    for (size_t i = 1; i < mutt_array_size(nums); i++)
+      if (nums[i - 1] > nums[i])
+        ok = false;
+    TEST_CHECK(ok);
+  }
+
+  static const size_t sizes[] = { 2, 17, 100, 1000, 100000 };
+  static const int threads[] = { 1, 2, 3, 0 };
+  for (size_t s = 0; s < mutt_array_size(sizes); s++)
+  {
+    const size_t num = sizes[s];
+    struct Item *items = mutt_mem_calloc(num, sizeof(struct Item));
+
+    for (size_t t = 0; t < mutt_array_size(threads); t++)
+    {
+      /* lots of duplicate keys, in a scrambled order */
+      for (size_t i = 0; i < num; i++)
+      {
+        items[i].key = (i * 7919) % 97;
+        items[i].pos = i;
+      }
+
+      mutt_merge_sort(items, num, sizeof(struct Item), compare_items, NULL, threads[t]);
+      TEST_CHECK(check_items(items, num));
+      TEST_MSG("num = %zu, threads = %d", num, threads[t]);
+    }
+
+    FREE(&items);
+  }
+}
@@ -0,0 +1,144 @@
+/**
+ * @file
+ * Test code for mutt_rfc822_read_header_mem()
+ *
+ * @authors
+ * Copyright (C) 2021 Richard Russon <rich@flatcap.org>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include <stdio.h>
+#include "mutt/lib.h"
+#include "address/lib.h"
+#include "config/lib.h"
+#include "email/lib.h"
+#include "core/lib.h"
+#include "test_common.h"
+
+static struct ConfigDef Vars[] = {
+  // clang-format off
+  { "assumed_charset",    DT_STRING, 0,                                   0, NULL, },
+  { "reply_regex",        DT_REGEX,  IP "^((re)(\\[[0-9]+\\])*:[ \t]*)*", 0, NULL, },
+  { "rfc2047_parameters", DT_BOOL,   false,                               0, NULL, },
+  { "spam_separator",     DT_STRING, IP ",",                              0, NULL, },
+  { NULL },
+  // clang-format on
+};
+
+/* Headers whose lines all end in a newline are parsed the same from a stream */
+static const char *const Headers[] = {
+  "From: Alice <alice@example.com>\n"
+  "To: bob@example.com,\n"
+  "\tcarol@example.com\n"
+  "Subject: Re: apple   \n"
+  "   banana\n"
+  "Message-ID: <1@example.com>\n"
+  "Date: Mon, 1 Feb 2021 10:00:00 +0000\n"
+  "\n"
+  "body\n",
+
+  ">From bogus\n"
+  "Subject: cherry\n"
+  "Content-Type: text/html; charset=us-ascii\n"
+  "not a header\n"
+  "Subject: damson\n",
+
+  "Subject: empty\n"
+  "X-Empty:\n"
+  " \n"
+  "\n",
+
+  "\n"
+  "Subject: none\n",
+};
+
+static void check_same(const char *data)
+{
+  FILE *fp = tmpfile();
+  if (!TEST_CHECK(fp != NULL))
+    return;
+  fputs(data, fp);
+  rewind(fp);
+
+  struct Email *e_file = email_new();
+  struct Email *e_mem = email_new();
+
+  struct Envelope *env_file = mutt_rfc822_read_header(fp, e_file, false, false);
+  struct Envelope *env_mem = mutt_rfc822_read_header_mem(data, strlen(data), e_mem,
+                                                         false, false);
+  TEST_CHECK(env_file && env_mem);
+
+  TEST_CHECK(mutt_str_equal(env_file->subject, env_mem->subject));
+  TEST_CHECK(mutt_str_equal(env_file->real_subj, env_mem->real_subj));
+  TEST_CHECK(mutt_str_equal(env_file->message_id, env_mem->message_id));
+  TEST_CHECK(mutt_addrlist_equal(&env_file->from, &env_mem->from));
+  TEST_CHECK(mutt_addrlist_equal(&env_file->to, &env_mem->to));
+  TEST_CHECK(e_file->date_sent == e_mem->date_sent);
+  TEST_CHECK(e_file->body->type == e_mem->body->type);
+  TEST_CHECK(mutt_str_equal(e_file->body->subtype, e_mem->body->subtype));
+  TEST_CHECK(e_file->body->offset == e_mem->body->offset);
+  TEST_MSG("Expected: %ld", (long) e_file->body->offset);
+  TEST_MSG("Actual  : %ld", (long) e_mem->body->offset);
+
+  mutt_env_free(&env_file);
+  mutt_env_free(&env_mem);
+  email_free(&e_file);
+  email_free(&e_mem);
+  fclose(fp);
+}
+
+void test_mutt_rfc822_read_header_mem(void)
+{
+  // struct Envelope *mutt_rfc822_read_header_mem(const char *data, size_t len, struct Email *e, bool user_hdrs, bool weed);
+
+  {
+    struct Email e = { 0 };
+    TEST_CHECK(!mutt_rfc822_read_header_mem(NULL, 0, &e, false, false));
+  }
+
+  {
+    struct Envelope *env = NULL;
+    TEST_CHECK((env = mutt_rfc822_read_header_mem("", 0, NULL, false, false)) != NULL);
+    mutt_env_free(&env);
+  }
+
+  NeoMutt = test_neomutt_create();
+  TEST_CHECK(cs_register_variables(NeoMutt->sub->cs, Vars, 0));
+
+  for (size_t i = 0; i < mutt_array_size(Headers); i++)
+  {
+    TEST_CASE_("%zu", i);
+    check_same(Headers[i]);
+  }
+
+  {
+    /* The end of the data also ends the last header */
+    static const char data[] = "Subject: elder\nMessage-ID: <2@example.com>XXX";
+    struct Email *e = email_new();
+    struct Envelope *env = mutt_rfc822_read_header_mem(data, sizeof(data) - 4,
+                                                       e, false, false);
+    TEST_CHECK(mutt_str_equal(env->subject, "elder"));
+    TEST_CHECK(mutt_str_equal(env->message_id, "<2@example.com>"));
+    TEST_CHECK(e->body->offset == (sizeof(data) - 4));
+    mutt_env_free(&env);
+    email_free(&e);
+  }
+
+  test_neomutt_destroy(&NeoMutt);
+}
@@ -0,0 +1,182 @@
+/**
+ * @file
+ * Test code for the body index
+ *
+ * @authors
+ * Copyright (C) 2021 Richard Russon <rich@flatcap.org>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "mutt/lib.h"
+#include "config/lib.h"
+#include "core/lib.h"
+#include "pattern/lib.h"
+#include "pattern/private.h"
+#include "mutt_globals.h"
+#include "test_common.h"
+
+static struct ConfigDef Vars[] = {
+  // clang-format off
+  { "assumed_charset", DT_STRING,                                0,          0, NULL, },
+  { "charset",         DT_STRING|DT_NOT_EMPTY|DT_CHARSET_SINGLE, IP "utf-8", 0, NULL, },
+  { "mailcap_path",    DT_SLIST|SLIST_SEP_COLON,                 0,          0, NULL, },
+  { NULL },
+  // clang-format on
+};
+
+static struct BodyIndexEntry *index_text(const char *text, uint64_t size, uint32_t check)
+{
+  FILE *fp = tmpfile();
+  if (!fp)
+    return NULL;
+
+  const size_t len = mutt_str_len(text);
+  fwrite(text, 1, len, fp);
+  rewind(fp);
+
+  struct BodyIndexEntry *bie = body_index_entry_new(size, check, len);
+  body_index_entry_add(bie, fp, len);
+  fclose(fp);
+  return bie;
+}
+
+void test_body_index(void)
+{
+  NeoMutt = test_neomutt_create();
+  TEST_CHECK(cs_register_variables(NeoMutt->sub->cs, Vars, 0));
+
+  { /* trigrams of the text */
+    struct BodyIndexEntry *bie =
+        index_text("Subject: Quarterly Report\n\nThe numbers are in.\n", 100, 42);
+    if (TEST_CHECK(bie != NULL))
+    {
+      TEST_CHECK(body_index_entry_has(bie, "quarterly"));
+      TEST_CHECK(body_index_entry_has(bie, "REPORT"));
+      TEST_CHECK(body_index_entry_has(bie, "numbers are"));
+      TEST_CHECK(body_index_entry_has(bie, "ly Rep"));
+      TEST_CHECK(!body_index_entry_has(bie, "invoice"));
+      TEST_CHECK(!body_index_entry_has(bie, "zyxwv"));
+      TEST_CHECK(!body_index_entry_has(bie, "reportq"));
+    }
+    body_index_entry_free(&bie);
+  }
+
+  { /* text split across reads */
+    struct Buffer *buf = mutt_buffer_pool_get();
+    for (int i = 0; i < 20000; i++)
+      mutt_buffer_addstr(buf, "lorem ipsum ");
+    mutt_buffer_addstr(buf, "needle");
+
+    struct BodyIndexEntry *bie = index_text(mutt_buffer_string(buf), 1, 1);
+    if (TEST_CHECK(bie != NULL))
+    {
+      TEST_CHECK(body_index_entry_has(bie, "needle"));
+      TEST_CHECK(body_index_entry_has(bie, "ipsum lorem"));
+    }
+    body_index_entry_free(&bie);
+    mutt_buffer_pool_release(&buf);
+  }
+
+  { /* stored entries */
+    struct BodyIndexEntry *bie = index_text("hello world", 100, 42);
+    size_t dlen = 0;
+    void *data = body_index_entry_pack(bie, &dlen);
+    TEST_CHECK(data != NULL);
+
+    struct BodyIndexEntry *copy = body_index_entry_unpack(data, dlen, 100, 42);
+    if (TEST_CHECK(copy != NULL))
+    {
+      TEST_CHECK(body_index_entry_has(copy, "hello"));
+      TEST_CHECK(!body_index_entry_has(copy, "goodbye"));
+    }
+    body_index_entry_free(&copy);
+
+    /* The message has changed size */
+    TEST_CHECK(body_index_entry_unpack(data, dlen, 101, 42) == NULL);
+    /* The Message-ID, or the decoding config, has changed */
+    TEST_CHECK(body_index_entry_unpack(data, dlen, 100, 43) == NULL);
+    /* The record is truncated */
+    TEST_CHECK(body_index_entry_unpack(data, dlen - 1, 100, 42) == NULL);
+    TEST_CHECK(body_index_entry_unpack(data, 4, 100, 42) == NULL);
+    TEST_CHECK(body_index_entry_unpack(NULL, dlen, 100, 42) == NULL);
+
+    FREE(&data);
+    body_index_entry_free(&bie);
+  }
+
+  { /* the decoding config */
+    const uint32_t check = body_index_config(NeoMutt->sub);
+    TEST_CHECK(body_index_config(NeoMutt->sub) == check);
+
+    cs_subset_str_string_set(NeoMutt->sub, "assumed_charset", "iso-2022-jp", NULL);
+    const uint32_t check_assumed = body_index_config(NeoMutt->sub);
+    TEST_CHECK(check_assumed != check);
+
+    cs_subset_str_string_set(NeoMutt->sub, "charset", "iso-8859-1", NULL);
+    TEST_CHECK(body_index_config(NeoMutt->sub) != check_assumed);
+
+    cs_subset_str_string_set(NeoMutt->sub, "charset", "utf-8", NULL);
+    cs_subset_str_string_set(NeoMutt->sub, "assumed_charset", NULL, NULL);
+    TEST_CHECK(body_index_config(NeoMutt->sub) == check);
+  }
+
+  { /* the lists and files that the handlers use */
+    const uint32_t check = body_index_config(NeoMutt->sub);
+
+    mutt_list_insert_tail(&AutoViewList, mutt_str_dup("text/html"));
+    const uint32_t check_autoview = body_index_config(NeoMutt->sub);
+    TEST_CHECK(check_autoview != check);
+
+    mutt_list_insert_tail(&AlternativeOrderList, mutt_str_dup("text/html"));
+    TEST_CHECK(body_index_config(NeoMutt->sub) != check_autoview);
+
+    mutt_list_free(&AlternativeOrderList);
+    mutt_list_free(&AutoViewList);
+    TEST_CHECK(body_index_config(NeoMutt->sub) == check);
+
+    char path[] = "/tmp/neomutt-test-mailcap-XXXXXX";
+    int fd = mkstemp(path);
+    if (TEST_CHECK(fd >= 0))
+    {
+      FILE *fp = fdopen(fd, "w");
+      fputs("text/html; lynx -dump %s; copiousoutput\n", fp);
+      fflush(fp);
+
+      cs_subset_str_string_set(NeoMutt->sub, "mailcap_path", path, NULL);
+      const uint32_t check_mailcap = body_index_config(NeoMutt->sub);
+      TEST_CHECK(check_mailcap != check);
+      TEST_CHECK(body_index_config(NeoMutt->sub) == check_mailcap);
+
+      /* The mailcap file has changed */
+      fputs("text/*; cat %s; copiousoutput\n", fp);
+      fclose(fp);
+      TEST_CHECK(body_index_config(NeoMutt->sub) != check_mailcap);
+
+      unlink(path);
+      cs_subset_str_string_set(NeoMutt->sub, "mailcap_path", NULL, NULL);
+      TEST_CHECK(body_index_config(NeoMutt->sub) == check);
+    }
+  }
+
+  test_neomutt_destroy(&NeoMutt);
+}
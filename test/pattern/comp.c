@@ -27,7 +27,9 @@
 #include <assert.h>
 #include <string.h>
 #include "mutt/buffer.h"
+#include "mutt/list.h"
 #include "mutt/memory.h"
+#include "mutt/string2.h"
 #include "alias/lib.h"
 #include "pattern/lib.h"
 #include "mutt_globals.h"
@@ -783,5 +785,141 @@ void test_mutt_pattern_comp(void)
     mutt_pattern_free(&pat);
   }
 
+  { /* cheap arguments are tested first */
+    static const struct
+    {
+      const char *pattern;
+      int ops[5];
+    } tests[] = {
+      // clang-format off
+      { "=b foo =f bar =s baz ~F", { MUTT_FLAG, MUTT_PAT_SUBJECT, MUTT_PAT_FROM, MUTT_PAT_BODY } },
+      { "=b foo | ~d <1d | =t bar", { MUTT_PAT_DATE, MUTT_PAT_TO, MUTT_PAT_BODY } },
+      { "~A =s foo ~A",            { MUTT_PAT_SUBJECT } },
+      { "=s foo | ~A | =b bar",    { MUTT_ALL } },
+      { "!~A =s foo",              { MUTT_ALL } },
+      { "~A ~A",                   { MUTT_ALL } },
+      // clang-format on
+    };
+
+    for (size_t i = 0; i < mutt_array_size(tests); i++)
+    {
+      TEST_CASE(tests[i].pattern);
+      mutt_buffer_reset(&err);
+      struct PatternList *pat = mutt_pattern_comp(NULL, NULL, tests[i].pattern, MUTT_PC_FULL_MSG, &err);
+      if (!TEST_CHECK(pat != NULL))
+      {
+        TEST_MSG("Error: %s", mutt_buffer_string(&err));
+        continue;
+      }
+
+      size_t j = 0;
+      struct Pattern *np = NULL;
+      SLIST_FOREACH(np, SLIST_FIRST(pat)->child, entries)
+      {
+        if (!TEST_CHECK(np->op == tests[i].ops[j]))
+        {
+          TEST_MSG("Argument %zu", j);
+          TEST_MSG("Expected: %d", tests[i].ops[j]);
+          TEST_MSG("Actual  : %d", np->op);
+        }
+        j++;
+      }
+      TEST_CHECK(tests[i].ops[j] == 0);
+
+      mutt_pattern_free(&pat);
+    }
+  }
+
+  { /* literals for full-message searches */
+    static const char *tests[][2] = {
+      // clang-format off
+      { "~b foobar",              "foobar"    },
+      { "~b foo.*quux",           "quux"      },
+      { "~b 'ab+cdef?g'",         "cde"       },
+      { "~b 'hello|world'",       "hello,world" },
+      { "~b 'hello|a'",           ""          },
+      { "~b 'x(abcdef)?y'",       ""          },
+      { "~b 'abc[]xyz]defg'",     "defg"      },
+      { "~b 'abc\\.defg'",        "abc.defg"  },
+      { "~b 'a\\.b'",             "a.b"       },
+      { "~b '\\<word\\>'",        "word"      },
+      { "~b '\\`words'",          "words"     },
+      { "~b '\\bfoo'",            "foo"       },
+      { "~b '\\bfo'",             ""          },
+      { "~b 'a{2}bcd'",           "bcd"       },
+      { "~h 'subject: hello'",    "subject:"  },
+      { "=b 'some words'",        "some words" },
+      { "~s foobar",              ""          },
+      // clang-format on
+    };
+
+    for (size_t i = 0; i < mutt_array_size(tests); i++)
+    {
+      TEST_CASE(tests[i][0]);
+      mutt_buffer_reset(&err);
+      struct PatternList *pat = mutt_pattern_comp(NULL, NULL, tests[i][0], MUTT_PC_FULL_MSG, &err);
+      if (!TEST_CHECK(pat != NULL))
+      {
+        TEST_MSG("Error: %s", mutt_buffer_string(&err));
+        continue;
+      }
+
+      char lits[256] = { 0 };
+      struct ListNode *np = NULL;
+      STAILQ_FOREACH(np, &SLIST_FIRST(pat)->literals, entries)
+      {
+        if (lits[0] != '\0')
+          mutt_str_cat(lits, sizeof(lits), ",");
+        mutt_str_cat(lits, sizeof(lits), np->data);
+      }
+
+      if (!TEST_CHECK(mutt_str_equal(lits, tests[i][1])))
+      {
+        TEST_MSG("Expected: %s", tests[i][1]);
+        TEST_MSG("Actual  : %s", lits);
+      }
+
+      mutt_pattern_free(&pat);
+    }
+  }
+
+  { /* inputs of a pattern */
+    static const struct
+    {
+      const char *pattern;
+      PatternDeps deps;
+    } tests[] = {
+      // clang-format off
+      { "~A",             PAT_DEP_NO_FLAGS },
+      { "~N | ~T",        PAT_DEP_FLAGS },
+      { "~N =s foo",      PAT_DEP_FLAGS | PAT_DEP_MESSAGE },
+      { "~y foo | ~n 5-", PAT_DEP_TAGS | PAT_DEP_SCORE },
+      { "~(~F)",          PAT_DEP_THREAD | PAT_DEP_FLAGS },
+      { "!~v",            PAT_DEP_THREAD },
+      // clang-format on
+    };
+
+    for (size_t i = 0; i < mutt_array_size(tests); i++)
+    {
+      TEST_CASE(tests[i].pattern);
+      mutt_buffer_reset(&err);
+      struct PatternList *pat = mutt_pattern_comp(NULL, NULL, tests[i].pattern, MUTT_PC_FULL_MSG, &err);
+      if (!TEST_CHECK(pat != NULL))
+      {
+        TEST_MSG("Error: %s", mutt_buffer_string(&err));
+        continue;
+      }
+
+      PatternDeps deps = mutt_pattern_deps(pat);
+      if (!TEST_CHECK(deps == tests[i].deps))
+      {
+        TEST_MSG("Expected: %d", tests[i].deps);
+        TEST_MSG("Actual  : %d", deps);
+      }
+
+      mutt_pattern_free(&pat);
+    }
+  }
+
   mutt_buffer_dealloc(&err);
 }
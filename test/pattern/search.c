@@ -0,0 +1,267 @@
+/**
+ * @file
+ * Test code for searching messages on worker threads
+ *
+ * @authors
+ * Copyright (C) 2021 Richard Russon <rich@flatcap.org>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include <limits.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "mutt/lib.h"
+#include "config/lib.h"
+#include "email/lib.h"
+#include "core/lib.h"
+#include "pattern/lib.h"
+#include "pattern/private.h"
+#include "test_common.h"
+
+static struct ConfigDef Vars[] = {
+  // clang-format off
+  { "assumed_charset",            DT_STRING,                                0,          0, NULL, },
+  { "charset",                    DT_STRING|DT_NOT_EMPTY|DT_CHARSET_SINGLE, IP "utf-8", 0, NULL, },
+  { "header_cache",               DT_PATH,                                  0,          0, NULL, },
+  { "header_cache_body_index",    DT_BOOL,                                  false,      0, NULL, },
+  { "implicit_autoview",          DT_BOOL,                                  false,      0, NULL, },
+  { "reflow_text",                DT_BOOL,                                  true,       0, NULL, },
+  { "search_threads",             DT_NUMBER,                                4,          0, NULL, },
+  { "show_multipart_alternative", DT_STRING,                                0,          0, NULL, },
+  { "thorough_search",            DT_BOOL,                                  true,       0, NULL, },
+  { "tmpdir",                     DT_PATH,                                  IP "/tmp",  0, NULL, },
+  { NULL },
+  // clang-format on
+};
+
+/**
+ * struct TestMessage - A message to search
+ */
+struct TestMessage
+{
+  const char *text;      ///< Header and body
+  unsigned char body;    ///< Expected prefilter result of `~b quarterly`
+  unsigned char header;  ///< Expected prefilter result of `~h quarterly`
+};
+
+/* A result of 1 means the worker ruled the message out; 0 means it must be
+ * decoded and searched by the main thread. */
+static const struct TestMessage TestMessages[] = {
+  // clang-format off
+  { "From: Alice <alice@example.com>\nTo: bob@example.com\nSubject: lunch\n\n"
+    "Shall we meet for lunch tomorrow?\n", 1, 1 },
+  { "From: Bob <bob@example.com>\nSubject: report\n\n"
+    "The quarterly numbers are in.\n", 0, 1 },
+  { "Subject: qp\nContent-Type: text/plain; charset=utf-8\n"
+    "Content-Transfer-Encoding: quoted-printable\n\n"
+    "The qu=61rterly numbers\n", 0, 1 },
+  { "Subject: soft\nContent-Transfer-Encoding: quoted-printable\n\n"
+    "The quar=\nterly numbers\n", 0, 1 },
+  { "Subject: base64\nContent-Transfer-Encoding: base64\n\n"
+    "UXVhcnRlcmx5IG51bWJlcnMgYXR0YWNoZWQK\n", 0, 1 },
+  { "Subject: =?utf-8?q?quarterly?=\n\n"
+    "Nothing to see here\n", 1, 0 },
+  { "Subject: forward\nContent-Type: message/rfc822\n\n"
+    "Subject: inner\n\nNothing to see here\n", 0, 1 },
+  { "Subject: multipart\nContent-Type: multipart/mixed; boundary=\"xyz\"\n\n"
+    "--xyz\nContent-Type: text/plain\n\nHello\n"
+    "--xyz\nContent-Type: text/plain\nContent-Transfer-Encoding: base64\n\n"
+    "VGhlIHF1YXJ0ZXJseSByZXN1bHRzCg==\n--xyz--\n", 0, 1 },
+  { "Subject: multipart\nContent-Type: multipart/mixed; boundary=\"xyz\"\n\n"
+    "--xyz\nContent-Type: text/plain\n\nHello\n"
+    "--xyz\nContent-Type: text/plain\nContent-Transfer-Encoding: base64\n\n"
+    "Tm90aGluZyB0byBzZWUgaGVyZQo=\n--xyz--\n", 1, 1 },
+  { "Subject: charset\nContent-Type: text/plain; charset=iso-2022-jp\n\n"
+    "Nothing to see here\n", 0, 1 },
+  // clang-format on
+};
+
+static const char *const TestPatterns[] = {
+  "~b quarterly", "~h quarterly", "~B quarterly", "~b numbers",
+  "~h alice",     "~B Nothing",   "~b lunch | ~h report",
+};
+
+static struct Mailbox *mailbox_create(const char *dir)
+{
+  struct Mailbox *m = mailbox_new();
+  m->type = MUTT_MAILDIR;
+  mutt_buffer_strcpy(&m->pathbuf, dir);
+  m->email_max = mutt_array_size(TestMessages);
+  m->emails = mutt_mem_calloc(m->email_max, sizeof(struct Email *));
+
+  char path[PATH_MAX];
+  for (size_t i = 0; i < mutt_array_size(TestMessages); i++)
+  {
+    const char *text = TestMessages[i].text;
+    snprintf(path, sizeof(path), "%s/%zu", dir, i);
+    FILE *fp = fopen(path, "w");
+    if (!fp)
+      break;
+    fputs(text, fp);
+    fclose(fp);
+
+    struct Email *e = email_new();
+    e->path = mutt_str_dup(strrchr(path, '/') + 1);
+    e->index = i;
+    e->msgno = i;
+    e->offset = 0;
+    e->body = mutt_body_new();
+    e->body->offset = strstr(text, "\n\n") + 2 - text;
+    e->body->length = mutt_str_len(text) - e->body->offset;
+    m->emails[i] = e;
+    m->msg_count++;
+  }
+
+  return m;
+}
+
+static void mailbox_remove(struct Mailbox *m)
+{
+  char path[PATH_MAX];
+  for (int i = 0; i < m->msg_count; i++)
+  {
+    snprintf(path, sizeof(path), "%s/%s", mailbox_path(m), m->emails[i]->path);
+    unlink(path);
+  }
+  rmdir(mailbox_path(m));
+}
+
+/**
+ * search_mailbox - Match each Email against a Pattern
+ * @param m       Mailbox
+ * @param s       Pattern to compile
+ * @param workers Search on the worker threads
+ * @param results Results of the worker threads, may be NULL
+ * @param buf     Buffer for the matches, one character per Email
+ */
+static void search_mailbox(struct Mailbox *m, const char *s, bool workers,
+                           unsigned char *results, struct Buffer *buf)
+{
+  struct Buffer err = mutt_buffer_make(256);
+  struct PatternList *pat = mutt_pattern_comp(m, NULL, s, MUTT_PC_FULL_MSG, &err);
+  mutt_buffer_reset(buf);
+  if (!TEST_CHECK(pat != NULL))
+  {
+    TEST_MSG("%s: %s", s, mutt_buffer_string(&err));
+    mutt_buffer_dealloc(&err);
+    return;
+  }
+  mutt_buffer_dealloc(&err);
+
+  int *msgnos = mutt_mem_calloc(m->msg_count, sizeof(int));
+  for (int i = 0; i < m->msg_count; i++)
+    msgnos[i] = i;
+
+  struct PatternSearch *ps = NULL;
+  if (workers)
+  {
+    ps = pattern_search_new(m, pat, msgnos, m->msg_count);
+    TEST_CHECK(ps != NULL);
+  }
+
+  for (int i = 0; i < m->msg_count; i++)
+  {
+    pattern_search_wait(ps, i);
+    if (ps && results)
+      results[i] = SLIST_FIRST(pat)->search_results[i];
+    const int match = mutt_pattern_exec(SLIST_FIRST(pat), MUTT_MATCH_FULL_ADDRESS,
+                                        m, m->emails[i], NULL);
+    mutt_buffer_addch(buf, (match > 0) ? 'y' : 'n');
+  }
+
+  pattern_search_free(&ps);
+  FREE(&msgnos);
+  mutt_pattern_free(&pat);
+}
+
+void test_pattern_search(void)
+{
+  // struct PatternSearch *pattern_search_new(struct Mailbox *m, struct PatternList *pat, const int *msgnos, size_t count);
+
+  NeoMutt = test_neomutt_create();
+  TEST_CHECK(cs_register_variables(NeoMutt->sub->cs, Vars, 0));
+
+  char dir[] = "/tmp/neomutt-test-search-XXXXXX";
+  if (!TEST_CHECK(mkdtemp(dir) != NULL))
+    return;
+
+  struct Mailbox *m = mailbox_create(dir);
+  TEST_CHECK(m->msg_count == mutt_array_size(TestMessages));
+
+  struct Buffer *serial = mutt_buffer_pool_get();
+  struct Buffer *workers = mutt_buffer_pool_get();
+
+  { /* the workers match the same messages as the main thread */
+    static const char *const thorough[] = { "yes", "no" };
+    for (size_t t = 0; t < mutt_array_size(thorough); t++)
+    {
+      cs_subset_str_string_set(NeoMutt->sub, "thorough_search", thorough[t], NULL);
+      for (size_t p = 0; p < mutt_array_size(TestPatterns); p++)
+      {
+        search_mailbox(m, TestPatterns[p], false, NULL, serial);
+        search_mailbox(m, TestPatterns[p], true, NULL, workers);
+        if (!TEST_CHECK(mutt_str_equal(mutt_buffer_string(serial),
+                                       mutt_buffer_string(workers))))
+        {
+          TEST_MSG("thorough_search = %s, pattern = %s", thorough[t], TestPatterns[p]);
+          TEST_MSG("Expected: %s", mutt_buffer_string(serial));
+          TEST_MSG("Actual:   %s", mutt_buffer_string(workers));
+        }
+      }
+    }
+  }
+
+  { /* a thorough search only rules out the messages that can't match */
+    cs_subset_str_string_set(NeoMutt->sub, "thorough_search", "yes", NULL);
+    unsigned char results[mutt_array_size(TestMessages)];
+
+    memset(results, 0xff, sizeof(results));
+    search_mailbox(m, "~b quarterly", true, results, workers);
+    for (size_t i = 0; i < mutt_array_size(TestMessages); i++)
+    {
+      if (!TEST_CHECK(results[i] == TestMessages[i].body))
+        TEST_MSG("~b message %zu: expected %d, got %d", i, TestMessages[i].body, results[i]);
+    }
+
+    memset(results, 0xff, sizeof(results));
+    search_mailbox(m, "~h quarterly", true, results, workers);
+    for (size_t i = 0; i < mutt_array_size(TestMessages); i++)
+    {
+      if (!TEST_CHECK(results[i] == TestMessages[i].header))
+        TEST_MSG("~h message %zu: expected %d, got %d", i, TestMessages[i].header, results[i]);
+    }
+
+    /* An autoviewed attachment could contain anything */
+    cs_subset_str_string_set(NeoMutt->sub, "implicit_autoview", "yes", NULL);
+    memset(results, 0xff, sizeof(results));
+    search_mailbox(m, "~b quarterly", true, results, workers);
+    for (size_t i = 0; i < mutt_array_size(TestMessages); i++)
+      TEST_CHECK(results[i] == 0);
+    cs_subset_str_string_set(NeoMutt->sub, "implicit_autoview", "no", NULL);
+  }
+
+  mutt_buffer_pool_release(&serial);
+  mutt_buffer_pool_release(&workers);
+  mailbox_remove(m);
+  mailbox_free(&m);
+  test_neomutt_destroy(&NeoMutt);
+}
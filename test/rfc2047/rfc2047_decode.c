@@ -84,5 +84,80 @@ void test_rfc2047_decode(void)
     }
   }
 
+  {
+    /* plain headers are left alone */
+    char *s = mutt_str_dup("Hello, world");
+    char *orig = s;
+    rfc2047_decode(&s);
+    TEST_CHECK(s == orig);
+    TEST_CHECK(mutt_str_equal(s, "Hello, world"));
+    FREE(&s);
+  }
+
+  {
+    /* utf-8 words for a utf-8 display */
+    static const char *tests[][2] = {
+      // clang-format off
+      { "=?utf-8?Q?hello_world?=",                 "hello world" },
+      { "=?utf-8?B?aGVsbG8=?= =?UTF-8?Q?_world?=", "hello world" },
+      { "=?utf-8?Q?a=00b?=",                       "a"           },
+      { "=?utf-8?Q?a=09b?=",                       "a?b"         },
+      // clang-format on
+    };
+
+    const bool was_utf8 = CharsetIsUtf8;
+    CharsetIsUtf8 = true;
+    for (size_t i = 0; i < mutt_array_size(tests); i++)
+    {
+      TEST_CASE(tests[i][0]);
+      char *s = mutt_str_dup(tests[i][0]);
+      rfc2047_decode(&s);
+      if (!TEST_CHECK(mutt_str_equal(s, tests[i][1])))
+      {
+        TEST_MSG("Expected : %s", tests[i][1]);
+        TEST_MSG("Actual   : %s", s);
+      }
+      FREE(&s);
+    }
+    CharsetIsUtf8 = was_utf8;
+  }
+
+  {
+    /* raw 7-bit headers in a stateful charset are converted, too */
+    static const char *tests[] = {
+      "\033$B$3$s$K$A$O\033(B", // ISO-2022-JP
+      "~{<:Ky2;S{#,NR<4R;Ub~}",   // HZ
+      "Hi Mom -+Jjo--!",          // UTF-7
+    };
+
+    cs_subset_str_string_set(NeoMutt->sub, "assumed_charset", "iso-2022-jp:hz:utf-7", NULL);
+    for (size_t i = 0; i < mutt_array_size(tests); i++)
+    {
+      TEST_CASE(tests[i]);
+      char *expected = mutt_str_dup(tests[i]);
+      mutt_ch_convert_nonmime_string(&expected);
+
+      char *s = mutt_str_dup(tests[i]);
+      char *orig = s;
+      rfc2047_decode(&s);
+      TEST_CHECK(s != orig);
+      if (!TEST_CHECK(mutt_str_equal(s, expected)))
+      {
+        TEST_MSG("Expected : %s", expected);
+        TEST_MSG("Actual   : %s", s);
+      }
+      FREE(&s);
+      FREE(&expected);
+    }
+
+    /* plain headers are still left alone */
+    char *s = mutt_str_dup("Hello, world");
+    char *orig = s;
+    rfc2047_decode(&s);
+    TEST_CHECK(s == orig);
+    FREE(&s);
+    cs_subset_str_string_set(NeoMutt->sub, "assumed_charset", NULL, NULL);
+  }
+
   test_neomutt_destroy(&NeoMutt);
 }
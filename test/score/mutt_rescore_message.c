@@ -0,0 +1,125 @@
+/**
+ * @file
+ * Test code for mutt_rescore_message()
+ *
+ * @authors
+ * Copyright (C) 2021 Richard Russon <rich@flatcap.org>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include "mutt/lib.h"
+#include "config/lib.h"
+#include "email/lib.h"
+#include "core/lib.h"
+#include "pattern/lib.h"
+#include "score.h"
+#include "test_common.h"
+
+static struct ConfigDef Vars[] = {
+  // clang-format off
+  { "score_threshold_delete", DT_NUMBER, -1,   0, NULL, },
+  { "score_threshold_flag",   DT_NUMBER, 9999, 0, NULL, },
+  { "score_threshold_read",   DT_NUMBER, -1,   0, NULL, },
+  { NULL },
+  // clang-format on
+};
+
+static void score(const char *pattern, const char *value)
+{
+  struct Buffer *buf = mutt_buffer_pool_get();
+  struct Buffer *err = mutt_buffer_pool_get();
+  struct Buffer *line = mutt_buffer_pool_get();
+
+  mutt_buffer_printf(line, "'%s' %s", pattern, value);
+  line->dptr = line->data;
+  TEST_CHECK(mutt_parse_score(buf, line, 0, err) == MUTT_CMD_SUCCESS);
+
+  mutt_buffer_pool_release(&buf);
+  mutt_buffer_pool_release(&err);
+  mutt_buffer_pool_release(&line);
+}
+
+static void unscore_all(void)
+{
+  struct Buffer *buf = mutt_buffer_pool_get();
+  struct Buffer *err = mutt_buffer_pool_get();
+  struct Buffer *line = mutt_buffer_pool_get();
+
+  mutt_buffer_strcpy(line, "*");
+  line->dptr = line->data;
+  mutt_parse_unscore(buf, line, 0, err);
+
+  mutt_buffer_pool_release(&buf);
+  mutt_buffer_pool_release(&err);
+  mutt_buffer_pool_release(&line);
+}
+
+void test_mutt_rescore_message(void)
+{
+  // void mutt_rescore_message(struct Mailbox *m, struct Email *e);
+
+  NeoMutt = test_neomutt_create();
+  TEST_CHECK(cs_register_variables(NeoMutt->sub->cs, Vars, 0));
+
+  struct Email *e = email_new();
+  e->env = mutt_env_new();
+  e->env->subject = mutt_str_dup("hello");
+
+  {
+    /* Only the new rules are matched */
+    score("~s hello", "5");
+    mutt_score_message(NULL, e, false);
+    TEST_CHECK(e->score == 5);
+
+    score("~s goodbye", "100");
+    score("~A", "1");
+    mutt_rescore_message(NULL, e);
+    TEST_CHECK(e->score == 6);
+
+    /* Changing a rule matches them all again */
+    score("~s hello", "=5");
+    mutt_rescore_message(NULL, e);
+    TEST_CHECK(e->score == 5);
+    unscore_all();
+  }
+
+  {
+    /* The old rules are matched again, if their inputs have changed */
+    e->flagged = false;
+    score("~F", "10");
+    mutt_score_message(NULL, e, false);
+    TEST_CHECK(e->score == 0);
+
+    e->flagged = true;
+    e->score_stale |= PAT_DEP_FLAGS;
+    score("~A", "1");
+    mutt_rescore_message(NULL, e);
+    TEST_CHECK(e->score == 11);
+
+    e->flagged = false;
+    e->score_stale |= PAT_DEP_FLAGS;
+    score("~s hello", "2");
+    mutt_rescore_message(NULL, e);
+    TEST_CHECK(e->score == 3);
+    unscore_all();
+  }
+
+  email_free(&e);
+  test_neomutt_destroy(&NeoMutt);
+}
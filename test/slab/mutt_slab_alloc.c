@@ -0,0 +1,87 @@
+/**
+ * @file
+ * Test code for mutt_slab_alloc()
+ *
+ * @authors
+ * Copyright (C) 2021 Richard Russon <rich@flatcap.org>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include <stdint.h>
+#include <string.h>
+#include "mutt/lib.h"
+
+void test_mutt_slab_alloc(void)
+{
+  // void *mutt_slab_alloc(struct Slab *slab, size_t size);
+
+  {
+    // No Slab, use the heap
+    char *p = mutt_slab_alloc(NULL, 32);
+    TEST_CHECK(p != NULL);
+    TEST_CHECK(p[0] == '\0');
+    mutt_slab_release(NULL, p, 32);
+  }
+
+  {
+    struct Slab *slab = mutt_slab_new();
+    TEST_CHECK(slab != NULL);
+    TEST_CHECK(mutt_slab_live(slab) == 0);
+
+    // Enough objects to need several blocks
+    const size_t count = 10000;
+    char **objs = mutt_mem_calloc(count, sizeof(char *));
+    bool zeroed = true;
+    bool aligned = true;
+    for (size_t i = 0; i < count; i++)
+    {
+      const size_t size = 8 + (i % 200);
+      objs[i] = mutt_slab_alloc(slab, size);
+      for (size_t j = 0; j < size; j++)
+        if (objs[i][j] != '\0')
+          zeroed = false;
+      if (((uintptr_t) objs[i] % 16) != 0)
+        aligned = false;
+      memset(objs[i], 0xff, size);
+    }
+    TEST_CHECK(zeroed);
+    TEST_CHECK(aligned);
+    TEST_CHECK(mutt_slab_live(slab) == count);
+
+    for (size_t i = 0; i < count; i++)
+      mutt_slab_release(slab, objs[i], 8 + (i % 200));
+    TEST_CHECK(mutt_slab_live(slab) == 0);
+
+    FREE(&objs);
+    mutt_slab_free(&slab);
+    TEST_CHECK(slab == NULL);
+  }
+
+  {
+    // Objects too big for the Slab
+    struct Slab *slab = mutt_slab_new();
+    char *p = mutt_slab_alloc(slab, 64 * 1024);
+    TEST_CHECK(p != NULL);
+    TEST_CHECK(p[64 * 1024 - 1] == '\0');
+    TEST_CHECK(mutt_slab_live(slab) == 1);
+    mutt_slab_release(slab, p, 64 * 1024);
+    TEST_CHECK(mutt_slab_live(slab) == 0);
+    mutt_slab_free(&slab);
+  }
+}
@@ -0,0 +1,60 @@
+/**
+ * @file
+ * Test code for mutt_slab_free()
+ *
+ * @authors
+ * Copyright (C) 2021 Richard Russon <rich@flatcap.org>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include "mutt/lib.h"
+
+void test_mutt_slab_free(void)
+{
+  // void mutt_slab_free(struct Slab **ptr);
+
+  {
+    mutt_slab_free(NULL);
+    struct Slab *slab = NULL;
+    mutt_slab_free(&slab);
+  }
+
+  {
+    struct Slab *slab = mutt_slab_new();
+    mutt_slab_free(&slab);
+    TEST_CHECK(slab == NULL);
+  }
+
+  {
+    // The objects outlive the owner's reference
+    struct Slab *slab = mutt_slab_new();
+    struct Slab *keep = slab;
+    int *a = mutt_slab_alloc(slab, sizeof(int));
+    int *b = mutt_slab_alloc(slab, sizeof(int));
+    mutt_slab_free(&slab);
+    TEST_CHECK(slab == NULL);
+
+    *a = 42;
+    *b = 43;
+    TEST_CHECK(mutt_slab_live(keep) == 2);
+    mutt_slab_release(keep, a, sizeof(int));
+    TEST_CHECK(*b == 43);
+    mutt_slab_release(keep, b, sizeof(int)); // Destroys the Slab
+  }
+}
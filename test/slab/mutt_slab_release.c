@@ -0,0 +1,78 @@
+/**
+ * @file
+ * Test code for mutt_slab_release()
+ *
+ * @authors
+ * Copyright (C) 2021 Richard Russon <rich@flatcap.org>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include "mutt/lib.h"
+#include "email/lib.h"
+
+void test_mutt_slab_release(void)
+{
+  // void mutt_slab_release(struct Slab *slab, void *ptr, size_t size);
+
+  {
+    mutt_slab_release(NULL, NULL, 0);
+    struct Slab *slab = mutt_slab_new();
+    mutt_slab_release(slab, NULL, 16);
+    TEST_CHECK(mutt_slab_live(slab) == 0);
+    mutt_slab_free(&slab);
+  }
+
+  {
+    // Released objects are reused, and zeroed
+    struct Slab *slab = mutt_slab_new();
+    char *p = mutt_slab_alloc(slab, 40);
+    p[0] = 'x';
+    mutt_slab_release(slab, p, 40);
+
+    char *q = mutt_slab_alloc(slab, 48);
+    TEST_CHECK(q == p);
+    TEST_CHECK(q[0] == '\0');
+
+    char *r = mutt_slab_alloc(slab, 40);
+    TEST_CHECK(r != q);
+    TEST_CHECK(mutt_slab_live(slab) == 2);
+
+    mutt_slab_release(slab, q, 48);
+    mutt_slab_release(slab, r, 40);
+    mutt_slab_free(&slab);
+  }
+
+  {
+    // Email, Envelope and Body from a Slab
+    struct Slab *slab = mutt_slab_new();
+    struct Email *e = email_new_slab(slab);
+    e->env = mutt_env_new_slab(slab);
+    e->env->subject = mutt_str_dup("apple");
+    e->body = mutt_body_new_slab(slab);
+    TEST_CHECK(e->slab == slab);
+    TEST_CHECK(e->env->slab == slab);
+    TEST_CHECK(e->body->slab == slab);
+    TEST_CHECK(mutt_slab_live(slab) == 3);
+
+    email_free(&e);
+    TEST_CHECK(e == NULL);
+    TEST_CHECK(mutt_slab_live(slab) == 0);
+    mutt_slab_free(&slab);
+  }
+}
@@ -67,6 +67,12 @@ bool test_store_degenerate(const struct StoreOps *sops, const char *name)
   if (!TEST_CHECK(sops->delete_record(NULL, NULL, 0) != 0))
     return false;
 
+  if (sops->begin && !TEST_CHECK(sops->begin(NULL) != 0))
+    return false;
+
+  if (sops->commit && !TEST_CHECK(sops->commit(NULL) != 0))
+    return false;
+
   sops->close(NULL);
   TEST_CHECK_(1, "sops->close(NULL)");
 
@@ -103,6 +109,33 @@ bool test_store_db(const struct StoreOps *sops, void *db)
   sops->free(db, &data);
   TEST_CHECK_(1, "sops->free(db, &data)");
 
+  rc = sops->delete_record(db, key, klen);
+  if (!TEST_CHECK(rc == 0))
+    return false;
+
+  if (!sops->begin || !sops->commit)
+    return true;
+
+  rc = sops->begin(db);
+  if (!TEST_CHECK(rc == 0))
+    return false;
+
+  rc = sops->store(db, key, klen, value, strlen(value));
+  if (!TEST_CHECK(rc == 0))
+    return false;
+
+  rc = sops->commit(db);
+  if (!TEST_CHECK(rc == 0))
+    return false;
+
+  vlen = 0;
+  data = sops->fetch(db, key, klen, &vlen);
+  if (!TEST_CHECK(data != NULL))
+    return false;
+  TEST_CHECK(vlen == strlen(value));
+
+  sops->free(db, &data);
+
   rc = sops->delete_record(db, key, klen);
   if (!TEST_CHECK(rc == 0))
     return false;
@@ -0,0 +1,211 @@
+/**
+ * @file
+ * Test code for mutt_sort_headers()
+ *
+ * @authors
+ * Copyright (C) 2021 Richard Russon <rich@flatcap.org>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "mutt/lib.h"
+#include "config/lib.h"
+#include "email/lib.h"
+#include "core/lib.h"
+#include "sort.h"
+#include "test_common.h"
+
+static const struct Mapping SortTestMethods[] = {
+  // clang-format off
+  { "date",          SORT_DATE },
+  { "date-received", SORT_RECEIVED },
+  { "mailbox-order", SORT_ORDER },
+  { "score",         SORT_SCORE },
+  { "size",          SORT_SIZE },
+  { "subject",       SORT_SUBJECT },
+  { "threads",       SORT_THREADS },
+  { NULL,            0 },
+  // clang-format on
+};
+
+static struct ConfigDef Vars[] = {
+  // clang-format off
+  { "score",        DT_BOOL,                              false,     0,                  NULL, },
+  { "sort",         DT_SORT|DT_SORT_REVERSE,              SORT_DATE, IP SortTestMethods, NULL, },
+  { "sort_aux",     DT_SORT|DT_SORT_REVERSE|DT_SORT_LAST, SORT_DATE, IP SortTestMethods, NULL, },
+  { "sort_threads", DT_NUMBER,                            1,         0,                  NULL, },
+  { NULL },
+  // clang-format on
+};
+
+/**
+ * struct TestEmail - A made-up Email to sort
+ */
+struct TestEmail
+{
+  const char *subject; ///< Subject
+  time_t date_sent;    ///< Date sent
+  time_t received;     ///< Date received
+  LOFF_T size;         ///< Size of the body
+  int score;           ///< Score
+};
+
+/* Indexed by Email::index.  Some of the keys tie, so $sort_aux matters. */
+static const struct TestEmail TestEmails[] = {
+  // clang-format off
+  { "cherry", 300, 500, 40, 2 },
+  { "apple",  100, 600, 10, 5 },
+  { "banana", 200, 400, 30, 5 },
+  { "apple",  100, 700, 20, 1 },
+  { "damson", 500, 100, 30, 3 },
+  { "banana", 400, 200, 50, 5 },
+  // clang-format on
+};
+
+/* The order the Emails are stored in, before sorting */
+static const int TestOrder[] = { 3, 0, 5, 1, 4, 2 };
+
+/**
+ * struct SortTest - A sort and the order it should produce
+ */
+struct SortTest
+{
+  const char *sort;     ///< Value of $sort
+  const char *sort_aux; ///< Value of $sort_aux
+  const char *expected; ///< Email::index of each Email, after sorting
+};
+
+static const struct SortTest SortTests[] = {
+  // clang-format off
+  { "date",                  "date",         "132054" },
+  { "reverse-date",          "date",         "450231" },
+  { "date-received",         "date",         "452013" },
+  { "reverse-date-received", "date",         "310254" },
+  { "size",                  "date",         "132405" },
+  { "size",                  "reverse-date", "134205" },
+  { "score",                 "date",         "125403" },
+  { "score",                 "reverse-date", "521403" },
+  { "reverse-score",         "date",         "304521" },
+  { "subject",               "date",         "132504" },
+  { "mailbox-order",         "date",         "012345" },
+  { "reverse-mailbox-order", "date",         "543210" },
+  // clang-format on
+};
+
+static struct Mailbox *mailbox_create(void)
+{
+  struct Mailbox *m = mailbox_new();
+  m->email_max = mutt_array_size(TestOrder);
+  m->emails = mutt_mem_calloc(m->email_max, sizeof(struct Email *));
+  m->v2r = mutt_mem_calloc(m->email_max, sizeof(int));
+
+  for (size_t i = 0; i < mutt_array_size(TestOrder); i++)
+  {
+    const int index = TestOrder[i];
+    const struct TestEmail *te = &TestEmails[index];
+    struct Email *e = email_new();
+    e->env = mutt_env_new();
+    e->env->subject = mutt_str_dup(te->subject);
+    e->env->real_subj = e->env->subject;
+    e->body = mutt_body_new();
+    e->body->length = te->size;
+    e->date_sent = te->date_sent;
+    e->received = te->received;
+    e->score = te->score;
+    e->index = index;
+    e->msgno = i;
+    e->vnum = i;
+    m->emails[i] = e;
+    m->msg_count++;
+  }
+  m->vcount = m->msg_count;
+
+  return m;
+}
+
+static void dump_order(struct Mailbox *m, struct Buffer *buf)
+{
+  mutt_buffer_reset(buf);
+  for (int i = 0; i < m->msg_count; i++)
+    mutt_buffer_add_printf(buf, "%d", m->emails[i]->index);
+}
+
+void test_mutt_sort_headers(void)
+{
+  // void mutt_sort_headers(struct Mailbox *m, struct ThreadsContext *threads, bool init, off_t *vsize);
+
+  NeoMutt = test_neomutt_create();
+  TEST_CHECK(cs_register_variables(NeoMutt->sub->cs, Vars, 0));
+
+  struct Buffer *keys = mutt_buffer_pool_get();
+  struct Buffer *emails = mutt_buffer_pool_get();
+
+  static const char *const sort_threads[] = { "1", "4" };
+  for (size_t t = 0; t < mutt_array_size(sort_threads); t++)
+  {
+    cs_subset_str_string_set(NeoMutt->sub, "sort_threads", sort_threads[t], NULL);
+    for (size_t i = 0; i < mutt_array_size(SortTests); i++)
+    {
+      const struct SortTest *st = &SortTests[i];
+      TEST_CASE(st->sort);
+      int rc = cs_subset_str_string_set(NeoMutt->sub, "sort", st->sort, NULL);
+      TEST_CHECK(CSR_RESULT(rc) == CSR_SUCCESS);
+      rc = cs_subset_str_string_set(NeoMutt->sub, "sort_aux", st->sort_aux, NULL);
+      TEST_CHECK(CSR_RESULT(rc) == CSR_SUCCESS);
+
+      /* The sort keys give the expected order */
+      struct Mailbox *m = mailbox_create();
+      struct SortKeys *sk = mutt_sort_keys_new(m, cs_subset_sort(NeoMutt->sub, "sort"),
+                                               cs_subset_sort(NeoMutt->sub, "sort_aux"));
+      TEST_CHECK(sk != NULL);
+      mutt_sort_keys_free(&sk);
+
+      off_t vsize = 0;
+      mutt_sort_headers(m, NULL, false, &vsize);
+      dump_order(m, keys);
+      if (!TEST_CHECK(mutt_str_equal(mutt_buffer_string(keys), st->expected)))
+      {
+        TEST_MSG("sort = %s, sort_aux = %s, sort_threads = %s", st->sort,
+                 st->sort_aux, sort_threads[t]);
+        TEST_MSG("Expected: %s", st->expected);
+        TEST_MSG("Actual:   %s", mutt_buffer_string(keys));
+      }
+
+      /* ... which matches comparing the Emails themselves */
+      qsort(m->emails, m->msg_count, sizeof(struct Email *),
+            mutt_get_sort_func(cs_subset_sort(NeoMutt->sub, "sort") & SORT_MASK,
+                               MUTT_UNKNOWN));
+      dump_order(m, emails);
+      if (!TEST_CHECK(mutt_str_equal(mutt_buffer_string(keys), mutt_buffer_string(emails))))
+      {
+        TEST_MSG("sort = %s, sort_aux = %s", st->sort, st->sort_aux);
+        TEST_MSG("Expected: %s", mutt_buffer_string(emails));
+        TEST_MSG("Actual:   %s", mutt_buffer_string(keys));
+      }
+
+      mailbox_free(&m);
+    }
+  }
+
+  mutt_buffer_pool_release(&keys);
+  mutt_buffer_pool_release(&emails);
+  test_neomutt_destroy(&NeoMutt);
+}
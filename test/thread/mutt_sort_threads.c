@@ -0,0 +1,248 @@
+/**
+ * @file
+ * Test code for mutt_sort_threads()
+ *
+ * @authors
+ * Copyright (C) 2021 Richard Russon <rich@flatcap.org>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include "mutt/lib.h"
+#include "config/lib.h"
+#include "email/lib.h"
+#include "core/lib.h"
+#include "mutt_thread.h"
+#include "test_common.h"
+
+static const struct Mapping SortTestMethods[] = {
+  // clang-format off
+  { "date",          SORT_DATE },
+  { "date-received", SORT_RECEIVED },
+  { "from",          SORT_FROM },
+  { "mailbox-order", SORT_ORDER },
+  { "score",         SORT_SCORE },
+  { "size",          SORT_SIZE },
+  { "subject",       SORT_SUBJECT },
+  { "threads",       SORT_THREADS },
+  { NULL,            0 },
+  // clang-format on
+};
+
+static struct ConfigDef Vars[] = {
+  // clang-format off
+  { "duplicate_threads",   DT_BOOL,                              true,         0,                  NULL, },
+  { "hide_limited",        DT_BOOL,                              false,        0,                  NULL, },
+  { "hide_missing",        DT_BOOL,                              true,         0,                  NULL, },
+  { "hide_thread_subject", DT_BOOL,                              true,         0,                  NULL, },
+  { "hide_top_limited",    DT_BOOL,                              false,        0,                  NULL, },
+  { "hide_top_missing",    DT_BOOL,                              true,         0,                  NULL, },
+  { "narrow_tree",         DT_BOOL,                              false,        0,                  NULL, },
+  { "sort",                DT_SORT|DT_SORT_REVERSE,              SORT_THREADS, IP SortTestMethods, NULL, },
+  { "sort_aux",            DT_SORT|DT_SORT_REVERSE|DT_SORT_LAST, SORT_DATE,    IP SortTestMethods, NULL, },
+  { "sort_re",             DT_BOOL,                              true,         0,                  NULL, },
+  { "sort_threads",        DT_NUMBER,                            1,            0,                  NULL, },
+  { "strict_threads",      DT_BOOL,                              false,        0,                  NULL, },
+  { "thread_received",     DT_BOOL,                              false,        0,                  NULL, },
+  { NULL },
+  // clang-format on
+};
+
+/**
+ * struct TestEmail - A made-up Email to thread
+ */
+struct TestEmail
+{
+  const char *message_id;    ///< Message-ID
+  const char *subject;       ///< Subject
+  time_t date;               ///< Date sent
+  const char *references[4]; ///< References, oldest first
+};
+
+/* These arrive in order.  Some Emails arrive before their parents, some share a
+ * Message-ID and some replies are only linked by their subject. */
+static const struct TestEmail TestEmails[] = {
+  // clang-format off
+  { "<a1@x>", "apple",      1000, { NULL } },
+  { "<b1@x>", "banana",     1100, { NULL } },
+  { "<a3@x>", "apple",      1300, { "<a1@x>", "<a2@x>", NULL } },
+  { "<c1@x>", "cherry",     1050, { NULL } },
+  { "<d2@x>", "damson",     1400, { "<d1@x>", NULL } },
+  { "<b2@x>", "banana",     1500, { "<b1@x>", NULL } },
+  { "<e1@x>", "Re: banana", 1600, { NULL } },
+  { "<a2@x>", "apple",      1200, { "<a1@x>", NULL } },
+  { "<c1@x>", "cherry",     1700, { NULL } },
+  { "<f1@x>", "Re: fig",    1800, { NULL } },
+  { "<d1@x>", "damson",     900,  { NULL } },
+  { "<c2@x>", "cherry",     1750, { "<c1@x>", NULL } },
+  { "<g1@x>", "Re: cherry", 1000, { NULL } },
+  { "<a4@x>", "apple",      1250, { "<a1@x>", "<a2@x>", "<a3@x>", NULL } },
+  { "<f0@x>", "fig",        500,  { NULL } },
+  { "<h2@x>", "grape",      2000, { "<h1@x>", NULL } },
+  { "<i1@x>", "Re: grape",  2100, { NULL } },
+  // clang-format on
+};
+
+static struct Mailbox *mailbox_create(void)
+{
+  struct Mailbox *m = mailbox_new();
+  m->email_max = mutt_array_size(TestEmails);
+  m->emails = mutt_mem_calloc(m->email_max, sizeof(struct Email *));
+  m->v2r = mutt_mem_calloc(m->email_max, sizeof(int));
+
+  for (size_t i = 0; i < mutt_array_size(TestEmails); i++)
+  {
+    const struct TestEmail *te = &TestEmails[i];
+    struct Email *e = email_new();
+    e->env = mutt_env_new();
+    e->env->message_id = mutt_str_dup(te->message_id);
+    e->env->subject = mutt_str_dup(te->subject);
+    e->env->real_subj = e->env->subject;
+    if (mutt_str_startswith(e->env->subject, "Re: "))
+      e->env->real_subj += 4;
+    /* The References are stored newest first */
+    for (size_t j = 0; te->references[j]; j++)
+      mutt_list_insert_head(&e->env->references, mutt_str_dup(te->references[j]));
+    if (!STAILQ_EMPTY(&e->env->references))
+    {
+      mutt_list_insert_head(&e->env->in_reply_to,
+                            mutt_str_dup(STAILQ_FIRST(&e->env->references)->data));
+    }
+    e->date_sent = te->date;
+    e->received = te->date;
+    e->index = i;
+    e->msgno = i;
+    e->vnum = i;
+    m->emails[i] = e;
+  }
+
+  return m;
+}
+
+/**
+ * dump_tree - Describe a thread tree
+ * @param m   Mailbox
+ * @param buf Buffer for the result
+ *
+ * Each node is written as its Message-ID, or "-" if it's missing, and its
+ * depth.  Pseudo-threads and duplicates are marked.
+ */
+static void dump_tree(struct Mailbox *m, struct Buffer *buf)
+{
+  mutt_buffer_reset(buf);
+
+  struct MuttThread *thread = m->emails[0]->thread;
+  while (thread->parent)
+    thread = thread->parent;
+  while (thread->prev)
+    thread = thread->prev;
+
+  int depth = 0;
+  while (thread)
+  {
+    const struct Email *e = thread->message;
+    mutt_buffer_add_printf(buf, "%*s%s%s%s\n", depth * 2, "",
+                           e ? e->env->message_id : "-",
+                           thread->fake_thread ? " fake" : "",
+                           thread->duplicate_thread ? " dup" : "");
+
+    if (thread->child)
+    {
+      thread = thread->child;
+      depth++;
+      continue;
+    }
+
+    while (!thread->next && thread->parent)
+    {
+      thread = thread->parent;
+      depth--;
+    }
+    thread = thread->next;
+  }
+}
+
+static void thread_mailbox(int initial, struct Buffer *buf)
+{
+  struct Mailbox *m = mailbox_create();
+  struct ThreadsContext *tctx = mutt_thread_ctx_init(m);
+
+  m->msg_count = initial;
+  m->vcount = initial;
+  mutt_sort_threads(tctx, true);
+
+  if (initial < m->email_max)
+  {
+    /* New mail is added to the subject hash, as in ctx_update() */
+    for (int i = initial; i < m->email_max; i++)
+    {
+      struct Email *e = m->emails[i];
+      if (m->subj_hash && e->env->real_subj)
+        mutt_hash_insert(m->subj_hash, e->env->real_subj, e);
+    }
+
+    m->msg_count = m->email_max;
+    m->vcount = m->email_max;
+    mutt_sort_threads(tctx, false);
+  }
+
+  dump_tree(m, buf);
+
+  mutt_thread_ctx_free(&tctx);
+  mailbox_free(&m);
+}
+
+void test_mutt_sort_threads(void)
+{
+  // void mutt_sort_threads(struct ThreadsContext *tctx, bool init);
+
+  NeoMutt = test_neomutt_create();
+  TEST_CHECK(cs_register_variables(NeoMutt->sub->cs, Vars, 0));
+
+  static const char *const aux_sorts[] = { "date", "reverse-date", "last-date",
+                                           "subject", "reverse-last-date-received" };
+  const int num = mutt_array_size(TestEmails);
+
+  struct Buffer *all = mutt_buffer_pool_get();
+  struct Buffer *inc = mutt_buffer_pool_get();
+
+  for (size_t s = 0; s < mutt_array_size(aux_sorts); s++)
+  {
+    int rc = cs_subset_str_string_set(NeoMutt->sub, "sort_aux", aux_sorts[s], NULL);
+    TEST_CHECK(CSR_RESULT(rc) == CSR_SUCCESS);
+
+    /* Threading the Emails all at once, or in two batches, gives the same tree */
+    thread_mailbox(num, all);
+    for (int k = 1; k < num; k++)
+    {
+      thread_mailbox(num - k, inc);
+      if (!TEST_CHECK(mutt_str_equal(mutt_buffer_string(all), mutt_buffer_string(inc))))
+      {
+        TEST_MSG("sort_aux = %s, %d new Emails", aux_sorts[s], k);
+        TEST_MSG("Expected:\n%s", mutt_buffer_string(all));
+        TEST_MSG("Actual:\n%s", mutt_buffer_string(inc));
+      }
+    }
+  }
+
+  mutt_buffer_pool_release(&all);
+  mutt_buffer_pool_release(&inc);
+  test_neomutt_destroy(&NeoMutt);
+}
@@ -0,0 +1,63 @@
+/**
+ * @file
+ * Test code for mutt_worker_new()
+ *
+ * @authors
+ * Copyright (C) 2021 Richard Russon <rich@flatcap.org>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include <stddef.h>
+#include "mutt/lib.h"
+
+static void dummy_job(void *data, size_t index)
+{
+}
+
+void test_mutt_worker_new(void)
+{
+  // struct WorkerPool *mutt_worker_new(size_t count, int threads, size_t window, worker_job_t job, void *data);
+
+  {
+    struct WorkerPool *wp = mutt_worker_new(0, 4, 8, dummy_job, NULL);
+    TEST_CHECK(wp != NULL);
+    mutt_worker_free(&wp);
+    TEST_CHECK(wp == NULL);
+  }
+
+  {
+    // Free without waiting for any jobs
+    struct WorkerPool *wp = mutt_worker_new(1000, 4, 0, dummy_job, NULL);
+    TEST_CHECK(wp != NULL);
+    mutt_worker_free(&wp);
+    TEST_CHECK(wp == NULL);
+  }
+
+  {
+    mutt_worker_free(NULL);
+    struct WorkerPool *wp = NULL;
+    mutt_worker_free(&wp);
+  }
+
+  {
+    TEST_CHECK(mutt_worker_threads(1) == 1);
+    TEST_CHECK(mutt_worker_threads(0) >= 1);
+    TEST_CHECK(mutt_worker_threads(-1) >= 1);
+  }
+}
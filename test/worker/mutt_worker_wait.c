@@ -0,0 +1,65 @@
+/**
+ * @file
+ * Test code for mutt_worker_wait()
+ *
+ * @authors
+ * Copyright (C) 2021 Richard Russon <rich@flatcap.org>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include <stddef.h>
+#include "mutt/lib.h"
+
+static void square_job(void *data, size_t index)
+{
+  size_t *results = data;
+  results[index] = index * index;
+}
+
+void test_mutt_worker_wait(void)
+{
+  // void mutt_worker_wait(struct WorkerPool *wp, size_t index);
+
+  {
+    mutt_worker_wait(NULL, 0);
+  }
+
+  static const int threads[] = { 1, 2, 4, 0 };
+  for (size_t t = 0; t < mutt_array_size(threads); t++)
+  {
+    size_t results[500] = { 0 };
+    struct WorkerPool *wp = mutt_worker_new(mutt_array_size(results), threads[t],
+                                            16, square_job, results);
+    TEST_CHECK(wp != NULL);
+
+    bool ok = true;
+    for (size_t i = 0; i < mutt_array_size(results); i++)
+    {
+      mutt_worker_wait(wp, i);
+      if (results[i] != (i * i))
+        ok = false;
+    }
+    TEST_CHECK(ok);
+    TEST_MSG("threads = %d", threads[t]);
+
+    // Out of range
+    mutt_worker_wait(wp, mutt_array_size(results));
+    mutt_worker_free(&wp);
+  }
+}
@@ -296,6 +296,11 @@ static struct CompileOptions comp_opts[] = {
 #else
   { "pgp", 0 },
 #endif
+#ifdef USE_PTHREADS
+  { "pthreads", 1 },
+#else
+  { "pthreads", 0 },
+#endif
 #ifndef HAVE_PCRE2
   { "regex", 1 },
 #endif